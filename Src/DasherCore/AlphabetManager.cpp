@@ -33,7 +33,10 @@
 #include "LanguageModelling/MixtureLanguageModel.h"
 #include "LanguageModelling/PPMPYLanguageModel.h"
 #include "LanguageModelling/CTWLanguageModel.h"
+#include "LanguageModelling/PPMStarLanguageModel.h"
+#include "LanguageModelling/OverlayLanguageModel.h"
 #include "FileWordGenerator.h"
+#include "PerfTrace.h"
 
 #include <vector>
 #include <sstream>
@@ -53,7 +56,8 @@ static char THIS_FILE[] = __FILE__;
 #endif
 
 CAlphabetManager::CAlphabetManager(CSettingsUser *pCreateFrom, CDasherInterfaceBase *pInterface, CNodeCreationManager *pNCManager, const CAlphInfo *pAlphabet)
-  : CSettingsUser(pCreateFrom), m_pBaseGroup(NULL), m_pInterface(pInterface), m_pNCManager(pNCManager), m_pAlphabet(pAlphabet), m_pLastOutput(NULL) {
+  : CSettingsUser(pCreateFrom), m_pBaseGroup(NULL), m_pInterface(pInterface), m_pNCManager(pNCManager), m_pAlphabet(pAlphabet),
+    m_iProbCacheUniform(-1), m_iProbCacheNorm(0), m_pLastOutput(NULL), m_pJournal(NULL) {
 }
 
 const string &CAlphabetManager::GetLabelText(symbol i) const {
@@ -77,11 +81,15 @@ void CAlphabetManager::Setup() {
 }
 
 void CAlphabetManager::InitMap() {
-  int iPara = m_pAlphabet->GetParagraphSymbol();
-  if (iPara) m_map.AddParagraphSymbol(iPara);
+  MapSymbols(m_pAlphabet, m_map);
+}
+
+void CAlphabetManager::MapSymbols(const CAlphInfo *pAlphabet, CAlphabetMap &map) {
+  int iPara = pAlphabet->GetParagraphSymbol();
+  if (iPara) map.AddParagraphSymbol(iPara);
   int i;
-  for(i = 1; i < m_pAlphabet->iEnd; i++) // 1-indexed
-    if (i!=iPara) m_map.Add(m_pAlphabet->GetText(i), i);
+  for(i = 1; i < pAlphabet->iEnd; i++) // 1-indexed
+    if (i!=iPara) map.Add(pAlphabet->GetText(i), i);
   
   /*ACL I'm really not sure where conversion characters should/shouldn't be included.
    They seemed to be included in the Alphabet Map, i.e. for reading training text via GetSymbols;
@@ -99,6 +107,10 @@ void CAlphabetManager::InitMap() {
 }
 
 void CAlphabetManager::CreateLanguageModel() {
+  if (CLanguageModel *pShared = m_pInterface->GetSharedLanguageModel(m_pAlphabet)) {
+    m_pLanguageModel = new COverlayLanguageModel(this, m_pAlphabet->iEnd-1, pShared);
+    return;
+  }
   // FIXME - return to using enum here
   switch (GetLongParameter(LP_LANGUAGE_MODEL_ID)) {
     default:
@@ -116,6 +128,9 @@ void CAlphabetManager::CreateLanguageModel() {
     case 4:
       m_pLanguageModel = new CCTWLanguageModel(m_pAlphabet->iEnd-1);
       break;
+    case 5:
+      m_pLanguageModel = new CPPMStarLanguageModel(this, m_pAlphabet->iEnd-1);
+      break;
   }
 }
 
@@ -124,7 +139,7 @@ CTrainer *CAlphabetManager::GetTrainer() {
 }
 
 void CAlphabetManager::MakeLabels(CDasherScreen *pScreen) {
-  m_pBaseGroup->RecursiveDelete();
+  SGroupInfo::RecursiveDelete(m_pBaseGroup);
   for (vector<CDasherScreen::Label *>::iterator it=m_vLabels.begin(); it!=m_vLabels.end(); it++)
     delete (*it);
   m_vLabels.clear();
@@ -235,26 +250,35 @@ CAlphabetManager::~CAlphabetManager() {
 }
 
 void CAlphabetManager::WriteTrainFileFull(CDasherInterfaceBase *pInterface) {
+  if (m_pJournal) {
+    //text has been recorded as it was written; just make sure it's all on disk
+    m_pJournal->Flush();
+    return;
+  }
   if (strTrainfileBuffer == "") return;
   if (strTrainfileContext != "") {
-    //If context begins with the default, skip that - it'll be entered by Trainer 1st anyway
-    string defCtx(m_pAlphabet->GetDefaultContext());
-    if (strTrainfileContext.substr(0,defCtx.length()) == defCtx)
-      strTrainfileContext = strTrainfileContext.substr(defCtx.length());
-    string sDelim(m_sDelim);
-    if (sDelim == "") {
-      //find a character not in the context we want to write out
-      char c=33;
-      while (strTrainfileContext.find(c)!=strTrainfileContext.length()) c++; //will terminate, context is ~~5 chars
-      sDelim = string(&c,1);
-    }
-    strTrainfileBuffer = m_pAlphabet->GetContextEscapeChar() + sDelim + strTrainfileContext + sDelim + strTrainfileBuffer;
+    strTrainfileBuffer = ContextSwitch(strTrainfileContext) + strTrainfileBuffer;
     strTrainfileContext="";
   }
   pInterface->WriteTrainFile(m_pAlphabet->GetTrainingFile(), strTrainfileBuffer);
   strTrainfileBuffer="";
 }
 
+string CAlphabetManager::ContextSwitch(string strContext) const {
+  //If context begins with the default, skip that - it'll be entered by Trainer 1st anyway
+  string defCtx(m_pAlphabet->GetDefaultContext());
+  if (strContext.substr(0,defCtx.length()) == defCtx)
+    strContext = strContext.substr(defCtx.length());
+  string sDelim(m_sDelim);
+  if (sDelim == "") {
+    //find a character not in the context we want to write out
+    char c=33;
+    while (strContext.find(c)!=strContext.length()) c++; //will terminate, context is ~~5 chars
+    sDelim = string(&c,1);
+  }
+  return m_pAlphabet->GetContextEscapeChar() + sDelim + strContext + sDelim;
+}
+
 int CAlphabetManager::GetColour(symbol sym, int iOffset) const {
   int iColour = m_pAlphabet->GetColour(sym);
 
@@ -290,7 +314,7 @@ void CAlphabetManager::CAlphBase::Undo() {
   if (m_pMgr->m_pLastOutput==this) m_pMgr->m_pLastOutput = Parent();
 }
 CAlphabetManager::CAlphNode::CAlphNode(int iOffset, int iColour, CDasherScreen::Label *pLabel, CAlphabetManager *pMgr)
-: CAlphBase(iOffset, iColour, pLabel, pMgr), m_pProbInfo(NULL) {
+: CAlphBase(iOffset, iColour, pLabel, pMgr) {
 }
 
 CAlphabetManager::CSymbolNode::CSymbolNode(int iOffset, CDasherScreen::Label *pLabel, CAlphabetManager *pMgr, symbol _iSymbol)
@@ -336,7 +360,19 @@ CAlphabetManager::CAlphNode *CAlphabetManager::CreateSymbolRoot(int iOffset, CLa
 }
 
 pair<symbol, CLanguageModel::Context> CAlphabetManager::GetContextSymbols(CDasherNode *pParent, int iRootOffset, const CAlphabetMap *pAlphMap) {
-  vector<symbol> vContextSymbols; bool bHaveFinalSymbol = true;
+  vector<symbol> vContextSymbols;
+  const bool bHaveFinalSymbol(ReadContext(pParent, iRootOffset, pAlphMap, vContextSymbols));
+
+  CLanguageModel::Context iContext = m_pLanguageModel->CreateEmptyContext();
+
+  //enter the symbols we could make sense of, into the LM context...
+  for (vector<symbol>::iterator it=vContextSymbols.begin(); it != vContextSymbols.end(); it++) {
+    m_pLanguageModel->EnterSymbol(iContext, *it);
+  }
+  return pair<symbol,CLanguageModel::Context>(bHaveFinalSymbol ? vContextSymbols[vContextSymbols.size()-1] : 0, iContext);
+}
+
+bool CAlphabetManager::ReadContext(CDasherNode *pParent, int iRootOffset, const CAlphabetMap *pAlphMap, vector<symbol> &vContextSymbols) {
   //no context is ever available at offset -1 (=choice between symbols with offset 0)
   if (iRootOffset!=-1) {
     // TODO: make the LM get the context, rather than force it to fix max context length as an int
@@ -356,17 +392,20 @@ pair<symbol, CLanguageModel::Context> CAlphabetManager::GetContextSymbols(CDashe
     }
   }
   if (vContextSymbols.empty()) {
-    bHaveFinalSymbol = false;
     pAlphMap->GetSymbols(vContextSymbols, m_pAlphabet->GetDefaultContext());
+    return false;
   }
+  return true;
+}
 
-  CLanguageModel::Context iContext = m_pLanguageModel->CreateEmptyContext();
-
-  //enter the symbols we could make sense of, into the LM context...
-  for (vector<symbol>::iterator it=vContextSymbols.begin(); it != vContextSymbols.end(); it++) {
-    m_pLanguageModel->EnterSymbol(iContext, *it);
-  }
-  return pair<symbol,CLanguageModel::Context>(bHaveFinalSymbol ? vContextSymbols[vContextSymbols.size()-1] : 0, iContext);
+bool CAlphabetManager::GetProbKey(CAlphNode *pNode, vector<symbol> &vKey) {
+  //GetContext takes symbols from unseen nodes, and reads the rest from the edit
+  // buffer; it can't do that if an unseen node has no parent (e.g. a new root
+  // whose context came from elsewhere)
+  for (CDasherNode *p = pNode; !p->GetFlag(NF_SEEN); p = p->Parent())
+    if (!p->Parent()) return false;
+  ReadContext(pNode, pNode->offset(), &m_map, vKey);
+  return true;
 }
 
 bool CAlphabetManager::CSymbolNode::GameSearchNode(symbol sym) {
@@ -410,6 +449,11 @@ int CAlphabetManager::CAlphNode::ExpectedNumChildren() {
   return (m_pMgr->GetBoolParameter(BP_CONTROL_MODE)) ? i+1 : i;
 }
 
+unsigned long CAlphabetManager::UniformSplit(unsigned long iNorm, long iUniform, unsigned int iSymbols, unsigned int &iUniformAdd) {
+  iUniformAdd = max(1ul, ((iNorm * iUniform) / 1000) / iSymbols);
+  return iNorm - iSymbols * iUniformAdd;
+}
+
 void CAlphabetManager::GetProbs(vector<unsigned int> *pProbInfo, CLanguageModel::Context context) {
   const unsigned int iSymbols = m_pBaseGroup->iEnd-1;
   
@@ -419,14 +463,17 @@ void CAlphabetManager::GetProbs(vector<unsigned int> *pProbInfo, CLanguageModel:
   const unsigned long iNorm(m_pNCManager->GetAlphNodeNormalization());
   //the case for control mode on, generalizes to handle control mode off also,
   // as then iNorm - control_space == iNorm...
-  const unsigned int iUniformAdd = max(1ul, ((iNorm * GetLongParameter(LP_UNIFORM)) / 1000) / iSymbols);
-  const unsigned long iNonUniformNorm = iNorm - iSymbols * iUniformAdd;
+  unsigned int iUniformAdd;
+  const unsigned long iNonUniformNorm = UniformSplit(iNorm, GetLongParameter(LP_UNIFORM), iSymbols, iUniformAdd);
   //  m_pLanguageModel->GetProbs(context, Probs, iNorm, ((iNorm * uniform) / 1000));
 
   //ACL used to test explicitly for MandarinDasher and if so called GetPYProbs instead
   // (by statically casting to PPMPYLanguageModel). However, have renamed PPMPYLanguageModel::GetPYProbs
   // to GetProbs as per ordinary language model, so no need to test....
-  m_pLanguageModel->GetProbs(context, *pProbInfo, iNonUniformNorm, 0);
+  {
+    PERF_TRACE_SPAN("GetProbs");
+    m_pLanguageModel->GetProbs(context, *pProbInfo, iNonUniformNorm, 0);
+  }
 
   DASHER_ASSERT(pProbInfo->size() == iSymbols+1);//initial 0
 
@@ -443,20 +490,45 @@ void CAlphabetManager::GetProbs(vector<unsigned int> *pProbInfo, CLanguageModel:
 #endif
 }
 
-std::vector<unsigned int> *CAlphabetManager::CAlphNode::GetProbInfo() {
-  if (!m_pProbInfo) {
-    m_pProbInfo = new std::vector<unsigned int>();
-    m_pMgr->GetProbs(m_pProbInfo, iContext);
+CProbCache::Probs CAlphabetManager::GetCumulativeProbs(CAlphNode *pNode) {
+  //tables also depend on these; if they've changed, those cached are no use
+  const long iUniform(GetLongParameter(LP_UNIFORM));
+  const unsigned long iNorm(m_pNCManager->GetAlphNodeNormalization());
+  if (iUniform != m_iProbCacheUniform || iNorm != m_iProbCacheNorm) {
+    m_probCache.Clear();
+    m_iProbCacheUniform = iUniform;
+    m_iProbCacheNorm = iNorm;
+  }
 
-    // work out cumulative probs in place
-    for(unsigned int i = 1; i < m_pProbInfo->size(); i++) {
-      (*m_pProbInfo)[i] += (*m_pProbInfo)[i - 1];
-    }
+  vector<symbol> vKey;
+  const bool bKey(GetProbKey(pNode, vKey));
+  if (bKey) {
+    CProbCache::Probs pCached(m_probCache.Find(pNode->offset(), vKey));
+    if (pCached) return pCached;
   }
-  return m_pProbInfo;
+
+  std::vector<unsigned int> *pProbs = new std::vector<unsigned int>();
+  GetProbs(pProbs, pNode->iContext);
+  // work out cumulative probs in place
+  for(unsigned int i = 1; i < pProbs->size(); i++) {
+    (*pProbs)[i] += (*pProbs)[i - 1];
+  }
+  CProbCache::Probs pRet(pProbs);
+  if (bKey) m_probCache.Add(pNode->offset(), vKey, pRet);
+  return pRet;
 }
 
-std::vector<unsigned int> *CAlphabetManager::CGroupNode::GetProbInfo() {
+void CAlphabetManager::ReportMemory(CMemoryReport &report) const {
+  m_pLanguageModel->ReportMemory(report);
+  m_probCache.ReportMemory(report);
+}
+
+const std::vector<unsigned int> *CAlphabetManager::CAlphNode::GetProbInfo() {
+  if (!m_pProbInfo) m_pProbInfo = m_pMgr->GetCumulativeProbs(this);
+  return m_pProbInfo.get();
+}
+
+const std::vector<unsigned int> *CAlphabetManager::CGroupNode::GetProbInfo() {
   if (Parent() && Parent()->mgr() == mgr() && Parent()->offset()==offset()) {
     return (static_cast<CAlphNode *>(Parent()))->GetProbInfo();
   }
@@ -545,7 +617,7 @@ CDasherNode *CAlphabetManager::CSymbolNode::RebuildSymbol(CAlphNode *pParent, sy
 }
 
 void CAlphabetManager::IterateChildGroups(CAlphNode *pParent, const SGroupInfo *pParentGroup, CAlphBase *buildAround) {
-  std::vector<unsigned int> *pCProb(pParent->GetProbInfo());
+  const std::vector<unsigned int> *pCProb(pParent->GetProbInfo());
   DASHER_ASSERT((*pCProb)[0] == 0);
   const int iMin(pParentGroup->iStart);
   const int iMax(pParentGroup->iEnd);
@@ -591,7 +663,6 @@ void CAlphabetManager::IterateChildGroups(CAlphNode *pParent, const SGroupInfo *
 }
 
 CAlphabetManager::CAlphNode::~CAlphNode() {
-  delete m_pProbInfo;
   m_pMgr->m_pLanguageModel->ReleaseContext(iContext);
 }
 
@@ -622,8 +693,9 @@ int CAlphabetManager::CSymbolNode::numChars() {
 void CAlphabetManager::CSymbolNode::Output() {
   if (m_pMgr->GetBoolParameter(BP_LM_ADAPTIVE)) {
     if (m_pMgr->m_pLastOutput != Parent()) {
-      //Context changed. Flush to disk the old context + text written in it...
-      m_pMgr->WriteTrainFileFull(m_pMgr->m_pInterface);
+      //Context changed. Flush to disk the old context + text written in it
+      // (unless journalling, which records as we go)...
+      if (!m_pMgr->m_pJournal) m_pMgr->WriteTrainFileFull(m_pMgr->m_pInterface);
 
       ///Now extract the context in which this node was written.
       /// Since this node is being output now, its parent must already have been,
@@ -632,13 +704,19 @@ void CAlphabetManager::CSymbolNode::Output() {
       m_pMgr->strTrainfileContext = m_pMgr->m_pInterface->GetContext(iStart, offset()-iStart);
       if (m_pMgr->strTrainfileContext=="") //Even the empty context (as for a new document)
         m_pMgr->strTrainfileContext = m_pMgr->m_pAlphabet->GetDefaultContext(); //is a new ctx!
+      if (m_pMgr->m_pJournal) {
+        //the buffer is then only used to match up Undo()s
+        m_pMgr->m_pJournal->Context(m_pMgr->ContextSwitch(m_pMgr->strTrainfileContext));
+        m_pMgr->strTrainfileBuffer="";
+      }
     }
     //Now handle outputting of this node
     m_pMgr->m_pLastOutput = this;
     string tr(trainText());
-    m_pMgr->strTrainfileBuffer += tr;
     //an actual occurrence of the escape character, must be doubled (like \\)
-    if (tr == m_pMgr->m_pAlphabet->GetContextEscapeChar()) m_pMgr->strTrainfileBuffer+=tr;
+    if (tr == m_pMgr->m_pAlphabet->GetContextEscapeChar()) tr+=tr;
+    m_pMgr->strTrainfileBuffer += tr;
+    if (m_pMgr->m_pJournal) m_pMgr->m_pJournal->Symbol(tr);
   }
   //std::cout << this << " " << Parent() << ": Output at offset " << m_iOffset << " *" << m_pMgr->m_pAlphabet->GetText(t) << "* " << std::endl;
 
@@ -658,10 +736,12 @@ void CAlphabetManager::CSymbolNode::Undo() {
       // iff this node was actually written (i.e. not rebuilt _from_ context!)
       std::string &buf(m_pMgr->strTrainfileBuffer);
       std::string tr(trainText());
+      if (tr == m_pMgr->m_pAlphabet->GetContextEscapeChar()) tr+=tr; //as Output()
       if (tr.length()<=buf.length()
           && buf.substr(buf.length()-tr.length(),tr.length())==tr) {
         buf=buf.substr(0,buf.length()-tr.length());
         m_pMgr->m_pLastOutput = Parent();
+        if (m_pMgr->m_pJournal) m_pMgr->m_pJournal->Undo(tr);
       }
     }
   } else CAlphBase::Undo();
@@ -715,7 +795,10 @@ void CAlphabetManager::CSymbolNode::SetFlag(int iFlag, bool bValue) {
       CLanguageModel *pLM(m_pMgr->m_pLanguageModel);
       // (Note: for first symbol after startup: parent is (root) group node, which'll have the alphabet default context)
       CLanguageModel::Context ctx = pLM->CloneContext(static_cast<CAlphabetManager::CAlphNode *>(Parent())->iContext);
-      pLM->LearnSymbol(ctx, iSymbol);
+      {
+        CLanguageModel::CWriter writer(pLM);
+        pLM->LearnSymbol(ctx, iSymbol);
+      }
       //could: pLM->ReleaseContext(ctx);
       //however, seems better to replace this node's context (i.e. which it uses to create its own children)
       // with the new (learned) context: the former was obtained by EnterSymbol rather than LearnSymbol, so
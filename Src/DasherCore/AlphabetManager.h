@@ -29,6 +29,8 @@
 #include "SettingsStore.h"
 #include "Observable.h"
 #include "WordGeneratorBase.h"
+#include "LearningJournal.h"
+#include "ProbCache.h"
 
 class CNodeCreationManager;
 struct SGroupInfo;
@@ -74,7 +76,31 @@ namespace Dasher {
     virtual ~CAlphabetManager();
     /// Flush to the user's training file everything written in this AlphMgr
     /// \param pInterface to use for I/O by calling WriteTrainFile(fname,txt)
+    /// (unused if there is a journal, which is flushed instead)
     void WriteTrainFileFull(CDasherInterfaceBase *pInterface);
+
+    ///Record text written (with BP_LM_ADAPTIVE) in a journal, rather than by
+    /// appending to the training file in WriteTrainFileFull.
+    /// \param pJournal already Start()ed; not owned by the AlphMgr
+    void SetJournal(CLearningJournal *pJournal) {m_pJournal = pJournal;}
+
+    ///The model created by Setup(), e.g. for the NCManager to snapshot
+    CLanguageModel *GetLanguageModel() const {return m_pLanguageModel;}
+
+    ///Adds the language model, and the probabilities cached, to a report
+    /// (the nodes are reported by the model owning the tree)
+    virtual void ReportMemory(CMemoryReport &report) const;
+
+    ///Adds every symbol of an alphabet to a map, as the default InitMap does
+    /// to m_map; for anything else reading text into the alphabet's symbols.
+    static void MapSymbols(const CAlphInfo *pAlphabet, CAlphabetMap &map);
+
+    ///Divides iNorm between the language model and a uniform distribution
+    /// over iSymbols symbols, as GetProbs does: the uniform part is iUniform
+    /// thousandths of iNorm (as LP_UNIFORM), but at least 1 per symbol.
+    /// \param iUniformAdd set to the amount to add to every symbol's probability
+    /// \return the normalization the language model should predict to
+    static unsigned long UniformSplit(unsigned long iNorm, long iUniform, unsigned int iSymbols, unsigned int &iUniformAdd);
   protected:
     ///Initializes the alphabet map (m_map) from the characters in the alphabet.
     /// Called from Setup(), i.e. before the manager is or need be usable.
@@ -163,10 +189,18 @@ namespace Dasher {
       ///
       virtual ~CAlphNode();
       ///Have to call this from CAlphabetManager, and from CGroupNode on a _different_ CAlphNode, hence public...
-      virtual std::vector<unsigned int> *GetProbInfo();
+      /// Returns cumulative probabilities of the symbols, computed on first call
+      /// (or taken from the manager's cache of those computed for other nodes)
+      virtual const std::vector<unsigned int> *GetProbInfo();
       virtual int ExpectedNumChildren();
+    protected:
+      ///Adds the probabilities computed for this node, if any (usually shared
+      /// with other nodes and the manager's CProbCache), under "probs"
+      void ReportProbs(CMemoryReport &report) const {
+        if (m_pProbInfo) report.AddShared("probs", m_pProbInfo.get(), sizeof(*m_pProbInfo) + m_pProbInfo->capacity() * sizeof(unsigned int));
+      }
     private:
-      std::vector<unsigned int> *m_pProbInfo;
+      CProbCache::Probs m_pProbInfo;
     };
     class CSymbolNode : public CAlphNode {
     public:
@@ -188,6 +222,10 @@ namespace Dasher {
       virtual symbol GetAlphSymbol();
       ///Override: if the symbol to create is the same as this node's symbol, return this node instead of creating a new one
       virtual CDasherNode *RebuildSymbol(CAlphNode *pParent, symbol iSymbol);
+      virtual void ReportMemory(CMemoryReport &report) const {
+        report.Add("nodes/symbol", 1, sizeof(CSymbolNode));
+        ReportProbs(report);
+      }
     protected:
       virtual const std::string &outputText() const;
       ///Text to write to user training file/buffer when this symbol output.
@@ -217,9 +255,13 @@ namespace Dasher {
       virtual void PopulateChildren();
       virtual int ExpectedNumChildren();
       virtual bool GameSearchNode(symbol sym);
-      std::vector<unsigned int> *GetProbInfo();
+      const std::vector<unsigned int> *GetProbInfo();
       ///Override: if the group to create is the same as this node's group, return this node instead of creating a new one
       virtual CDasherNode *RebuildGroup(CAlphNode *pParent, int iBkgCol, const SGroupInfo *pInfo);
+      virtual void ReportMemory(CMemoryReport &report) const {
+        report.Add("nodes/group", 1, sizeof(CGroupNode));
+        ReportProbs(report);
+      }
     protected:
       ///Override: true if pGroup encloses this one (by start/end symbol#)
       bool isInGroup(const SGroupInfo *pGroup);
@@ -252,6 +294,15 @@ namespace Dasher {
     /// element is the result of entering the symbols retrieved, into a fresh LM context.
     std::pair<symbol, CLanguageModel::Context> GetContextSymbols(CDasherNode *pParent, int iRootOffset, const CAlphabetMap *pAlphMap);
 
+    ///Called to identify the context of a node, for caching its probabilities (see CProbCache).
+    /// Default reads the symbols GetContextSymbols would to rebuild the node's context
+    /// (i.e. from the node and its unseen ancestors, then the edit buffer), which
+    /// identifies it for any LM whose predictions depend on at most the last
+    /// GetContextLength() symbols. Subclasses whose nodes' symbols are not those
+    /// entered into the LM should override, to fail or to compute equivalent keys.
+    /// \return false if the node's context cannot be identified (so its probabilities aren't cached)
+    virtual bool GetProbKey(CAlphNode *pNode, std::vector<symbol> &vKey);
+
     ///Called to create a node for a given symbol (leaf), as a child of a specified parent node
     /// \param iBkgCol colour behind the new node, i.e. that should show through if the (group) node is transparent
     virtual CDasherNode *CreateSymbolNode(CAlphNode *pParent, symbol iSymbol);
@@ -280,6 +331,20 @@ namespace Dasher {
     /// (also leaves space for NCManager::AddExtras to add control node)
     /// Returns array of non-cumulative probs. Should this be protected and/or virtual???
     void GetProbs(std::vector<unsigned int> *pProbs, CLanguageModel::Context iContext);
+
+    ///Cumulative probabilities for a node's children, from m_probCache if possible,
+    /// else via GetProbs (and then cached)
+    CProbCache::Probs GetCumulativeProbs(CAlphNode *pNode);
+
+    ///Reads the symbols in the context preceding a new node, as per GetContextSymbols.
+    /// \return true if the context was obtained, false if the alphabet default was used.
+    bool ReadContext(CDasherNode *pParent, int iRootOffset, const CAlphabetMap *pAlphMap, std::vector<symbol> &vContextSymbols);
+
+    ///Probability tables computed previously, perhaps for nodes since deleted
+    CProbCache m_probCache;
+    ///Parameters affecting probability tables, when those in m_probCache were computed
+    long m_iProbCacheUniform;
+    unsigned long m_iProbCacheNorm;
     
     ///Constructs child nodes under the specified parent according to provided group.
     /// Nodes are created by calling CreateSymbolNode and CreateGroupNode, unless buildAround is non-null.
@@ -307,6 +372,13 @@ namespace Dasher {
     ///A character, 33<=c<=255, not in the alphabet; used to delimit contexts.
     ///"" if no such could be found (=> will be found on a per-context basis)
     std::string m_sDelim;
+
+    ///Context-switch command to write to the training file before text written
+    /// after the specified context (which may begin with the alphabet's default).
+    std::string ContextSwitch(std::string strContext) const;
+
+    ///If non-null, where to record text written; see SetJournal.
+    CLearningJournal *m_pJournal;
   };
 /// @}
 
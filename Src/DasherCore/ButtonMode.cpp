@@ -42,7 +42,7 @@ static SModuleSettings sSettings[] = {
 // FIX iStyle == 0
 
 CButtonMode::CButtonMode(CSettingsUser *pCreator, CDasherInterfaceBase *pInterface, bool bMenu, int iID, const char *szName)
-: CDasherButtons(pCreator, pInterface, bMenu, iID, szName), CSettingsObserver(pCreator) {}
+: CDasherButtons(pCreator, pInterface, bMenu, iID, szName), CSettingsObserver(pCreator, {LP_B, LP_R}) {}
 
 void CButtonMode::SetupBoxes()
 {
@@ -39,6 +39,8 @@ class CButtonMultiPress : public CDynamicButtons {
   void KeyDown(unsigned long iTime, int iId, CDasherView *pView, CDasherInput *pInput, CDasherModel *pModel);
 
   void pause();
+  ///Also need frames to detect a long press, even when paused
+  bool NeedsFrames() {return CDynamicButtons::NeedsFrames() || (m_bKeyDown && !m_bKeyHandled);}
  protected:
   virtual unsigned int maxClickCount()=0;
   void reverse(unsigned long iTime);
@@ -29,7 +29,7 @@
 using namespace Dasher;
 
 CCircleStartHandler::CCircleStartHandler(CDefaultFilter *pCreator)
-: CStartHandler(pCreator), CSettingsUserObserver(pCreator), m_iEnterTime(std::numeric_limits<long>::max()), m_iScreenRadius(-1), m_pView(NULL) {
+: CStartHandler(pCreator), CSettingsUserObserver(pCreator, {LP_CIRCLE_PERCENT}), m_iEnterTime(std::numeric_limits<long>::max()), m_iScreenRadius(-1), m_pView(NULL) {
 }
 
 CCircleStartHandler::~CCircleStartHandler() {
@@ -5,6 +5,8 @@
 #include "SettingsStore.h"
 #include "DasherScreen.h"
 
+#include <limits>
+
 /// \ingroup Start
 /// @{
 namespace Dasher {
@@ -18,6 +20,10 @@ public:
   virtual void HandleEvent(CDasherView *pView);
   void onPause();
   void onRun(unsigned long iTime);
+  ///Always true: we must keep checking whether the user is in the circle, and
+  /// only pointer devices generate events (requesting frames) when they move;
+  /// socket, joystick, tilt etc. coordinates are only read in NewFrame.
+  bool NeedsFrames() {return true;}
 protected:
   ///Time (as unix timestamp) when user entered circle; max() => already acted upon
   long m_iEnterTime;
@@ -345,7 +345,7 @@ public:
 
 
 CControlManager::CControlManager(CSettingsUser *pCreateFrom, CNodeCreationManager *pNCManager, CDasherInterfaceBase *pInterface)
-: CSettingsObserver(pCreateFrom), CControlBase(pCreateFrom, pInterface, pNCManager), CControlParser(pInterface), m_pSpeech(NULL), m_pCopy(NULL) {
+: CSettingsObserver(pCreateFrom, {BP_COPY_ALL_ON_STOP, BP_SPEAK_ALL_ON_STOP, SP_INPUT_FILTER}), CControlBase(pCreateFrom, pInterface, pNCManager), CControlParser(pInterface), m_pSpeech(NULL), m_pCopy(NULL) {
   //TODO, used to be able to change label+colour of root/pause/stop from controllabels.xml
   // (or, get the root node title "control" from the alphabet!)
   m_pSpeech = new SpeechHeader(pInterface);
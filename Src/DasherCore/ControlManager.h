@@ -72,6 +72,10 @@ namespace Dasher {
 
       virtual void Output() override;
 
+      void ReportMemory(CMemoryReport &report) const override {
+        report.Add("nodes/control", 1, sizeof(CContNode));
+      }
+
     private:
       NodeTemplate *m_pTemplate;
       CControlBase *m_pMgr;
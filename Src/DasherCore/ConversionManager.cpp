@@ -295,8 +295,10 @@ void CConversionManager::CConvNode::SetFlag(int iFlag, bool bValue) {
         symbol s =pSCENode ->Symbol;
         
         
-        if(s!=-1)
+        if(s!=-1) {
+          CLanguageModel::CWriter writer(mgr()->m_pLanguageModel);
           mgr()->m_pLanguageModel->LearnSymbol(mgr()->m_iLearnContext, s);
+        }
       }
       break;
   }
@@ -108,6 +108,10 @@ namespace Dasher {
 
     virtual void Undo();
 
+    virtual void ReportMemory(CMemoryReport &report) const {
+      report.Add("nodes/conversion", 1, sizeof(CConvNode));
+    }
+
     protected:
       CConversionManager *m_pMgr;
     public: //to ConversionManager and subclasses only, of course...
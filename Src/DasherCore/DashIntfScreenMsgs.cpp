@@ -16,6 +16,7 @@ void CDashIntfScreenMsgs::Message(const string &strText, bool bInterrupt) {
   }
   else
     m_dqAsyncMessages.push_back(pair<CDasherScreen::Label*,unsigned long>(lab, 0));
+  RequestFrame(); //to display it
 }
 
 bool CDashIntfScreenMsgs::FinishRender(unsigned long ulTime) {
@@ -75,6 +76,12 @@ bool CDashIntfScreenMsgs::FinishRender(unsigned long ulTime) {
       pScreen->DrawString(it->first, (iSW-textDims.first)/2, iY, GetLongParameter(LP_MESSAGE_FONTSIZE), bModal ? 111 : 0);
       iY+=textDims.second;
     }
+    //need another frame to remove the oldest non-modal message when it expires
+    if (!m_dqAsyncMessages.empty() && m_dqAsyncMessages.front().second) {
+      const unsigned long ulShown(ulTime - m_dqAsyncMessages.front().second);
+      const unsigned long ulMax(GetLongParameter(LP_MESSAGE_TIME));
+      RequestFrame(ulShown < ulMax ? ulMax - ulShown + 1 : 0);
+    }
   }
   return bMsgsChanged;
 }
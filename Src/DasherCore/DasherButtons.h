@@ -30,6 +30,8 @@ class CDasherButtons : public CStaticFilter
   void KeyDown(unsigned long iTime, int iId, CDasherView *pView, CDasherInput *pInput, CDasherModel *pModel);
   void Timer(unsigned long Time, CDasherView *pView, CDasherInput *pInput, CDasherModel *m_pDasherModel, CExpansionPolicy **pol);
   void Activate();
+  ///In menu mode, the active box advances by itself if LP_BUTTON_SCAN_TIME is set
+  bool NeedsFrames() {return m_bMenu && GetLongParameter(LP_BUTTON_SCAN_TIME);}
   
   struct SBoxInfo {
     int iTop;
@@ -35,6 +35,8 @@
 #include "BasicLog.h"
 #include "GameModule.h"
 #include "FileWordGenerator.h"
+#include "PerfTrace.h"
+#include "MemoryReport.h"
 
 // Input filters
 #include "AlternatingDirectMode.h"
@@ -52,6 +54,8 @@
 
 // STL headers
 #include <cstdio>
+#include <ctime>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -88,10 +92,13 @@ CDasherInterfaceBase::CDasherInterfaceBase(CSettingsStore *pSettingsStore, CFile
   m_pSettingsStore(pSettingsStore), 
   m_pLockLabel(NULL),
   m_preSetObserver(*pSettingsStore),
-  m_bLastMoved(false) {
+  m_labelPrewarmer(this),
+  m_bLastMoved(false), m_bInFrame(false), m_bBatchEdits(false) {
   
   pSettingsStore->Register(this);
   pSettingsStore->PreSetObservable().Register(&m_preSetObserver);
+  //(model is deleted before us, so no need to unregister)
+  m_pDasherModel->RegisterBatched(&m_labelPrewarmer);
 
   m_fileUtils = fileUtils;
   
@@ -106,12 +113,16 @@ CDasherInterfaceBase::CDasherInterfaceBase(CSettingsStore *pSettingsStore, CFile
   m_pUserLog = NULL;
   m_pNCManager = NULL;
   m_defaultPolicy = NULL;
+  m_pBudgetController = NULL;
   m_pWordSpeaker = NULL;
   m_pGameModule = NULL;
 
   // Various state variables
   m_bRedrawScheduled = false;
 
+  CPerfTrace::SetThreadName("main");
+  CPerfTrace::Enable(GetBoolParameter(BP_PERF_TRACE));
+
   //  m_bGlobalLock = false;
 
   // Global logging object we can use from anywhere
@@ -187,6 +198,8 @@ CDasherInterfaceBase::~CDasherInterfaceBase() {
   delete m_ColourIO;
   delete m_AlphIO;
   delete m_pNCManager;
+  delete m_pBudgetController;
+  delete m_defaultPolicy;
   // Do NOT delete Edit box or Screen. This class did not create them.
 
   // When we destruct on shutdown, we'll output any detailed log file
@@ -205,6 +218,16 @@ CDasherInterfaceBase::~CDasherInterfaceBase() {
   delete m_pFramerate;
 }
 
+const long CDasherInterfaceBase::PREWARM_TIME;
+
+void CDasherInterfaceBase::CLabelPrewarmer::HandleEvents(const std::vector<CDasherNode *> &vNodes) {
+  if (!m_pIntf->m_pDasherView) return;
+  dasherint y1, y2;
+  for (std::vector<CDasherNode *>::const_iterator it = vNodes.begin(); it != vNodes.end(); it++)
+    if (m_pIntf->m_pDasherModel->GetNodeRange(*it, y1, y2))
+      m_pIntf->m_pDasherView->PrewarmChildLabels(*it, y2-y1);
+}
+
 void CDasherInterfaceBase::CPreSetObserver::HandleEvent(CParameterChange d) {
   switch(d.iParameter) {
   case SP_ALPHABET_ID:
@@ -285,9 +308,16 @@ void CDasherInterfaceBase::HandleEvent(int iParameter) {
   case LP_SHAPE_TYPE: //for platforms which actually have this as a GUI pref!
       ScheduleRedraw();
       break;
+  case BP_PERF_TRACE:
+    CPerfTrace::Enable(GetBoolParameter(BP_PERF_TRACE));
+    break;
   case LP_NODE_BUDGET:
+  case LP_TARGET_FRAME_TIME:
+    delete m_pBudgetController;
     delete m_defaultPolicy;
     m_defaultPolicy = new AmortizedPolicy(m_pDasherModel,GetLongParameter(LP_NODE_BUDGET));
+    m_pBudgetController = GetLongParameter(LP_TARGET_FRAME_TIME)
+      ? new CNodeBudgetController(m_defaultPolicy, GetLongParameter(LP_TARGET_FRAME_TIME)*1000) : NULL;
     break;
   case BP_SPEAK_WORDS:
     delete m_pWordSpeaker;
@@ -368,11 +398,19 @@ void CDasherInterfaceBase::SetLockStatus(const string &strText, int iPercent) {
 }
 
 void CDasherInterfaceBase::editOutput(const std::string &strText, CDasherNode *pCause) {
+  if (m_bBatchEdits) {
+    m_outputQueue.Output(strText);
+    if (!m_bInFrame) FlushEdits();
+  }
   CEditEvent evt(CEditEvent::EDIT_OUTPUT, strText, pCause);
   DispatchEvent(&evt);
 }
 
 void CDasherInterfaceBase::editDelete(const std::string &strText, CDasherNode *pCause) {
+  if (m_bBatchEdits) {
+    m_outputQueue.Delete(strText);
+    if (!m_bInFrame) FlushEdits();
+  }
   CEditEvent evt(CEditEvent::EDIT_DELETE, strText, pCause);
   DispatchEvent(&evt);
 }
@@ -387,6 +425,18 @@ void CDasherInterfaceBase::editProtect(CDasherNode *pCause) {
   DispatchEvent(&evt);
 }
 
+void CDasherInterfaceBase::SetBatchEdits(bool bBatch) {
+  if (!bBatch) FlushEdits();
+  m_bBatchEdits = bBatch;
+}
+
+void CDasherInterfaceBase::FlushEdits() {
+  if (m_outputQueue.IsEmpty()) return;
+  PERF_TRACE_SPAN("editFlush");
+  editFlush(m_outputQueue.GetDeletes(), m_outputQueue.GetOutput());
+  m_outputQueue.Clear();
+}
+
 void CDasherInterfaceBase::WriteTrainFileFull() {
   m_pNCManager->GetAlphabetManager()->WriteTrainFileFull(this);
 }
@@ -398,6 +448,9 @@ void CDasherInterfaceBase::CreateNCManager() {
 
   //can't delete the old manager yet until we've deleted all its nodes...
   CNodeCreationManager *pOldMgr = m_pNCManager;
+  //...but the new one will read what the old has written (and may compact the
+  // journal), so that must be on disk first
+  if (pOldMgr) WriteTrainFileFull(); //can't/don't before creating first NCManager
 
   //now create the new manager...
   m_pNCManager = new CNodeCreationManager(this, this, m_AlphIO, m_ControlBoxIO);
@@ -480,8 +533,8 @@ void CDasherInterfaceBase::CreateInput() {
 
 void CDasherInterfaceBase::NewFrame(unsigned long iTime, bool bForceRedraw) {
   // Prevent NewFrame from being reentered. This can happen occasionally and
-  // cause crashes.
-  static bool bReentered=false;
+  // cause crashes. (Per thread, as other threads may be running other interfaces.)
+  static thread_local bool bReentered=false;
   if (bReentered) {
 #ifdef DEBUG
     std::cout << "CDasherInterfaceBase::NewFrame was re-entered" << std::endl;
@@ -489,6 +542,11 @@ void CDasherInterfaceBase::NewFrame(unsigned long iTime, bool bForceRedraw) {
     return;
   }
   bReentered=true;
+  m_bInFrame=true;
+  PERF_TRACE_SPAN("NewFrame");
+  //Anything requested so far is satisfied by this frame; anything requested
+  // during it (e.g. by ScheduleRedraw) needs another.
+  m_frameScheduler.FrameStarted(CFrameScheduler::Now());
 
   if(m_DasherScreen) {
     //ok, can draw _something_. Try and see what we can :).
@@ -514,6 +572,7 @@ void CDasherInterfaceBase::NewFrame(unsigned long iTime, bool bForceRedraw) {
   
       //1. Schedule any per-frame movement in the model...
       if(m_pInputFilter) {
+        PERF_TRACE_SPAN("InputFilter::Timer");
         m_pInputFilter->Timer(iTime, m_pDasherView, m_pInput, m_pDasherModel, &pol);
       }
       //2. Render...
@@ -545,14 +604,74 @@ void CDasherInterfaceBase::NewFrame(unsigned long iTime, bool bForceRedraw) {
         // (previously DashIntf gathered the info, and then passed it to the logger here).
         m_pUserLog->FrameEnded();
       }
+      //Keep rendering while moving (or asked to redraw), or while the input filter
+      // is doing something without waiting for input events (e.g. running, or timing a dwell)
+      if (m_bRedrawScheduled || (m_pInputFilter && m_pInputFilter->NeedsFrames()))
+        m_frameScheduler.RequestFrame();
+      PERF_TRACE_COUNTER("Nodes", currentNumNodeObjects());
     }
     if (FinishRender(iTime)) bBlit = true;
     if (bBlit) m_DasherScreen->Display();
   }
+  //Send the frame's edits on in one go, if batching
+  FlushEdits();
 
+  m_bInFrame=false;
   bReentered=false;
 }
 
+void CDasherInterfaceBase::RequestFrame(unsigned long ulDelayMs) {
+  const long long iDue(ulDelayMs ? CFrameScheduler::Now() + ulDelayMs*1000LL : 0);
+  if (m_frameScheduler.RequestFrameAt(iDue) && !m_bInFrame) FrameRequested();
+}
+
+std::string CDasherInterfaceBase::WritePerfTrace() {
+  char szName[64];
+  const time_t t(time(NULL));
+  strftime(szName, sizeof(szName), "dasher-trace-%Y%m%d-%H%M%S.json", localtime(&t));
+  const string strPath(GetUserDataFilePath(szName));
+  if (strPath.empty()) return "";
+  ofstream out(strPath.c_str());
+  CPerfTrace::WriteJSON(out);
+  out.close();
+  if (!out) {
+    FormatMessageWithString(_("Could not write performance trace to %s"), strPath.c_str());
+    return "";
+  }
+  FormatMessageWithString(_("Performance trace written to %s"), strPath.c_str());
+  return strPath;
+}
+
+void CDasherInterfaceBase::GetMemoryReport(CMemoryReport &report) {
+  m_pDasherModel->ReportMemory(report);
+  if (m_pNCManager) m_pNCManager->GetAlphabetManager()->ReportMemory(report);
+  if (m_pDasherView) m_pDasherView->ReportMemory(report);
+  if (m_pUserLog) m_pUserLog->ReportMemory(report);
+}
+
+std::string CDasherInterfaceBase::WriteMemoryReport() {
+  char szName[64];
+  const time_t t(time(NULL));
+  strftime(szName, sizeof(szName), "dasher-memory-%Y%m%d-%H%M%S.json", localtime(&t));
+  const string strPath(GetUserDataFilePath(szName));
+  if (strPath.empty()) return "";
+  CMemoryReport report;
+  GetMemoryReport(report);
+  ofstream out(strPath.c_str());
+  report.WriteJSON(out);
+  out.close();
+  if (!out) {
+    FormatMessageWithString(_("Could not write memory report to %s"), strPath.c_str());
+    return "";
+  }
+  FormatMessageWithString(_("Memory report written to %s"), strPath.c_str());
+  return strPath;
+}
+
+long CDasherInterfaceBase::GetFrameDelay() const {
+  return m_frameScheduler.GetDelay(CFrameScheduler::Now(), GetLongParameter(LP_MAX_FRAMERATE));
+}
+
 void CDasherInterfaceBase::onUnpause(unsigned long lTime) {
   //TODO When Game+UserLog modules are combined => reduce to just one call here
   if (m_pGameModule)
@@ -568,11 +687,24 @@ bool CDasherInterfaceBase::Redraw(unsigned long ulTime, bool bRedrawNodes, CExpa
   if(bRedrawNodes) {
     m_pDasherView->Screen()->SendMarker(0);
     if (m_pDasherModel) {
+      const long long iStart(CFrameScheduler::Now());
       m_pDasherModel->RenderToView(m_pDasherView,policy);
+      const long long iRendered(CFrameScheduler::Now());
       // if anything was expanded or collapsed render at least one more
       // frame after this
-      if (policy.apply())
+      bool bChanged;
+      {
+        PERF_TRACE_SPAN("ExpansionPolicy::apply");
+        bChanged = policy.apply();
+      }
+      if (bChanged)
         ScheduleRedraw();
+      if (m_pBudgetController && &policy == m_defaultPolicy)
+        m_pBudgetController->FrameRendered(static_cast<long>(iRendered - iStart),
+                                           static_cast<long>(CFrameScheduler::Now() - iRendered));
+      //now the frame's work is done, prepare labels for those nodes just expanded
+      m_pDasherModel->FlushEvents();
+      m_pDasherView->PrewarmLabels(CFrameScheduler::Now() + PREWARM_TIME);
     }
     if(m_pGameModule) {
       m_pGameModule->DecorateView(ulTime, m_pDasherView, m_pDasherModel);
@@ -600,8 +732,6 @@ void CDasherInterfaceBase::ChangeAlphabet() {
     return;
   }
 
-  if (m_pNCManager) WriteTrainFileFull(); //can't/don't before creating first NCManager
-
   // Send a lock event
 
   // Lock Dasher to prevent changes from happening while we're training.
@@ -732,6 +862,8 @@ void CDasherInterfaceBase::KeyDown(unsigned long iTime, int iId) {
   if(m_pInput) {
     m_pInput->KeyDown(iTime, iId);
   }
+  //the filter may have started moving, scheduled a zoom, etc.
+  RequestFrame();
 }
 
 void CDasherInterfaceBase::KeyUp(unsigned long iTime, int iId) {
@@ -745,6 +877,7 @@ void CDasherInterfaceBase::KeyUp(unsigned long iTime, int iId) {
   if(m_pInput) {
     m_pInput->KeyUp(iTime, iId);
   }
+  RequestFrame();
 }
 
 void CDasherInterfaceBase::CreateInputFilter() {
@@ -41,6 +41,9 @@
 #include "ModuleManager.h"
 #include "ControlManager.h"
 #include "FrameRate.h"
+#include "FrameScheduler.h"
+#include "OutputQueue.h"
+#include "NodeBudgetController.h"
 #include <set>
 #include <algorithm>
 
@@ -86,6 +89,13 @@ public:
 	// Writes file to user data directory. 
 	virtual bool WriteUserDataFile(const std::string &filename, const std::string &strNewText, bool append) = 0;
 
+	///Full path to a file in the user data directory (the one written by WriteUserDataFile),
+	/// for core code which needs to manage files itself (e.g. sync or replace them atomically).
+	/// Default is empty string, meaning user data is not kept in ordinary files.
+	virtual std::string GetUserDataFilePath(const std::string &filename) {
+		return "";
+	}
+
 };
 
 /// The central class in the core of Dasher. Ties together the rest of
@@ -211,6 +221,29 @@ public:
   virtual void editConvert(CDasherNode *pCause);
   virtual void editProtect(CDasherNode *pCause);
 
+  ///Sets whether text output and deleted (by editOutput and editDelete) is
+  /// queued, and passed to editFlush once per frame; text output and deleted
+  /// again within the frame is cancelled out, never reaching editFlush. For
+  /// platforms whose editor is costly to edit piecemeal, e.g. another
+  /// application reached by faking key events; while this is set, such a
+  /// platform's editOutput/editDelete should pass nothing on to the editor.
+  /// Turning batching off flushes anything queued.
+  void SetBatchEdits(bool bBatch);
+  bool GetBatchEdits() const {return m_bBatchEdits;}
+
+  ///Called, if batching edits, with all the edits queued since the last call,
+  /// at the end of each frame in which there were any (or of the edit, if made
+  /// outside NewFrame). Default does nothing.
+  /// \param iDeletes number of characters (not bytes) to delete from just
+  /// before the cursor, first
+  /// \param strOutput UTF-8 text to then output at the cursor
+  virtual void editFlush(unsigned int iDeletes, const std::string &strOutput) {}
+
+  ///Passes any queued edits to editFlush now. Platforms batching edits should
+  /// call this before changing or reading the editor by any other means, e.g.
+  /// for control-mode moves and deletes.
+  void FlushEdits();
+
   class TextAction {
   public:
     TextAction(CDasherInterfaceBase *pMgr);
@@ -368,8 +401,42 @@ public:
 
   void ScheduleRedraw() {
     m_bRedrawScheduled = true;
+    RequestFrame();
   };
 
+  /// @name Frame scheduling
+  /// Platforms need not call NewFrame continuously: after each frame, and after
+  /// FrameRequested(), GetFrameDelay() says when the next is actually needed.
+  /// @{
+
+  ///Asks for a frame to be rendered (subject to LP_MAX_FRAMERATE) after the
+  /// specified delay, e.g. as something onscreen will then change. If this is
+  /// sooner than any frame already due, and we're not in the middle of NewFrame,
+  /// calls FrameRequested.
+  void RequestFrame(unsigned long ulDelayMs=0);
+
+  ///Time until NewFrame should next be called.
+  /// \return microseconds (0 = immediately), or CFrameScheduler::NEVER if
+  /// nothing will change until FrameRequested() is next called (e.g. when paused,
+  /// with the input filter waiting for a button press).
+  long GetFrameDelay() const;
+
+  ///Called (outside NewFrame) when RequestFrame (or ScheduleRedraw) makes a
+  /// frame due sooner than before, e.g. on a key press or a change of settings;
+  /// platforms not calling NewFrame on a fixed timer should override to
+  /// re-arm their timer for GetFrameDelay(). Default does nothing.
+  virtual void FrameRequested() {}
+  /// @}
+
+  ///Language model, already trained, to be shared with other interfaces in the
+  /// same process (e.g. sessions of a server); if non-NULL, the alphabet manager
+  /// predicts using a COverlayLanguageModel over it, learning only in the overlay.
+  /// Only used for alphabets without conversion (the Mandarin and routing managers
+  /// need models of their own). Default is NULL, i.e. create and train a model as usual.
+  /// \param pAlphabet alphabet which the model must predict
+  /// \return a model supporting concurrent readers, which must outlive this interface
+  virtual CLanguageModel *GetSharedLanguageModel(const CAlphInfo *pAlphabet) {return NULL;}
+
   ///Subclasses should return the contents of (the specified subrange of) the edit buffer
   virtual std::string GetContext(unsigned int iStart, unsigned int iLength)=0;
 
@@ -426,6 +493,29 @@ public:
   void ScanFiles(AbstractParser *parser, const std::string &strPattern)  {
 	  m_fileUtils->ScanFiles(parser, strPattern);
   }
+
+  ///Full path to a file in the user data directory, or empty string if the
+  /// platform does not keep user data in ordinary files.
+  std::string GetUserDataFilePath(const std::string &filename) {
+	  return m_fileUtils->GetUserDataFilePath(filename);
+  }
+
+  ///Writes the timings recorded while BP_PERF_TRACE is set (see CPerfTrace) to a
+  /// new file in the user data directory, in Chrome trace-event format, and tells
+  /// the user where.
+  /// \return the full path of the file written, or "" if it could not be.
+  std::string WritePerfTrace();
+
+  ///Adds everything this interface keeps in memory to a report (see
+  /// CMemoryReport): the node tree, language model and probability cache,
+  /// view and screen (inc. labels), and user log. Subclasses keeping anything
+  /// sizeable themselves may override to add it (calling this).
+  virtual void GetMemoryReport(CMemoryReport &report);
+
+  ///Writes GetMemoryReport to a new file in the user data directory, as JSON,
+  /// and tells the user where.
+  /// \return the full path of the file written, or "" if it could not be.
+  std::string WriteMemoryReport();
   
   // @}
   
@@ -535,10 +625,24 @@ protected:
   };
 
   CPreSetObserver m_preSetObserver;
+
+  ///Tells the view about each node expanded, so it can prewarm the labels of its children
+  class CLabelPrewarmer : public BatchObserver<CDasherNode *> {
+    CDasherInterfaceBase * const m_pIntf;
+  public:
+    CLabelPrewarmer(CDasherInterfaceBase *pIntf) : m_pIntf(pIntf) {};
+    void HandleEvents(const std::vector<CDasherNode *> &vNodes) override;
+  };
+
+  CLabelPrewarmer m_labelPrewarmer;
+  ///Microseconds per frame we allow the view to spend prewarming labels
+  static const long PREWARM_TIME = 2000;
   CFileUtils* m_fileUtils;
 
   //The default expansion policy to use - an amortized policy depending on the LP_NODE_BUDGET parameter.
-  CExpansionPolicy *m_defaultPolicy;
+  AmortizedPolicy *m_defaultPolicy;
+  ///Adjusts the limits of m_defaultPolicy to meet LP_TARGET_FRAME_TIME; NULL if that is 0.
+  CNodeBudgetController *m_pBudgetController;
 
   /// Provide a new CDasherInput input device object.
 
@@ -598,6 +702,16 @@ protected:
   ///Whether we moved anywhere in the last call to NewFrame.
   bool m_bLastMoved;
 
+  ///When the next frame is needed, per RequestFrame
+  CFrameScheduler m_frameScheduler;
+  ///Whether we are inside NewFrame (so FrameRequested need not be called)
+  bool m_bInFrame;
+
+  ///Whether edits are batched, per SetBatchEdits; and if so, those made since
+  /// the last call to editFlush
+  bool m_bBatchEdits;
+  COutputQueue m_outputQueue;
+
   /// @}
 
   std::set<TextAction *> m_vTextActions;
@@ -31,10 +31,13 @@
 #include "Event.h"
 #include "NodeCreationManager.h"
 #include "AlphabetManager.h"
+#include "PerfTrace.h"
 
 using namespace Dasher;
 using namespace std;
 
+const int CDasherModel::STEP_TIME;
+
 // Track memory leaks on Windows to the line that new'd the memory
 #ifdef _WIN32
 #ifdef _DEBUG_MEMLEAKS
@@ -74,6 +77,7 @@ CDasherModel::CDasherModel() {
 }
 
 CDasherModel::~CDasherModel() {
+  DiscardEvents();
   if(oldroots.size() > 0) {
     delete oldroots[0];
     oldroots.clear();
@@ -91,6 +95,8 @@ void CDasherModel::Make_root(CDasherNode *pNewRoot) {
   DASHER_ASSERT(pNewRoot != NULL);
   DASHER_ASSERT(pNewRoot->Parent() == m_Root);
 
+  //deliver any nodes expanded so far, before we delete any of them
+  FlushEvents();
   m_Root->DeleteNephews(pNewRoot);
   m_Root->SetFlag(NF_COMMITTED, true);
 
@@ -183,6 +189,7 @@ bool CDasherModel::Reparent_root() {
 }
 
 void CDasherModel::ClearRootQueue() {
+  FlushEvents();
   while(oldroots.size() > 0) {
     if(oldroots.size() > 1) {
       oldroots[0]->OrphanChild(oldroots[1]);
@@ -198,7 +205,7 @@ void CDasherModel::ClearRootQueue() {
 void CDasherModel::SetNode(CDasherNode *pNewRoot) {
 
   AbortOffset();
-  ClearRootQueue();
+  ClearRootQueue(); //also flushes events
   delete m_Root;
 
   m_Root = pNewRoot;
@@ -231,9 +238,23 @@ CDasherNode *CDasherModel::Get_node_under_crosshair() {
   return m_pLastOutput;
 }
 
+bool CDasherModel::GetNodeRange(CDasherNode *pNode, dasherint &y1, dasherint &y2) {
+  if (pNode == m_Root) {
+    y1 = m_Rootmin; y2 = m_Rootmax;
+    return true;
+  }
+  if (!pNode->Parent() || !GetNodeRange(pNode->Parent(), y1, y2)) return false;
+  //same calculation as the view's, when rendering
+  const dasherint iRange(y2-y1);
+  y2 = y1 + (iRange * pNode->Hbnd()) / NORMALIZATION;
+  y1 = y1 + (iRange * pNode->Lbnd()) / NORMALIZATION;
+  return true;
+}
+
 bool CDasherModel::NextScheduledStep()
 {
   if (m_deGotoQueue.size() == 0) return false;
+  PERF_TRACE_SPAN("NextScheduledStep");
   myint newRootmin(m_deGotoQueue.front().first), newRootmax(m_deGotoQueue.front().second);
   m_deGotoQueue.pop_front();
 
@@ -327,17 +348,11 @@ inline dasherint mysqrt(dasherint in) {
   //However, reversing is less good - it can go twice as fast at extreme x...
 }
 
-void CDasherModel::ScheduleOneStep(dasherint y1, dasherint y2, int nSteps, int limX, bool bExact) {
-  
-  m_deGotoQueue.clear();
-  
-  // Rename for readability.
-  const dasherint R1 = m_Rootmin;
-  const dasherint R2 = m_Rootmax;
+void CDasherModel::StepTowards(dasherint &R1, dasherint &R2, dasherint y1, dasherint y2, double dSteps, int limX, bool bExact) {
   
   // Calculate the bounds of the root node when the target range y1-y2
   // fills the viewport.
-  // This is where we want to be in iSteps updates
+  // This is where we want to be in dSteps updates
   dasherint targetRange=y2-y1;
 
   const dasherint r1 = MAX_Y*(R1-y1)/targetRange;
@@ -349,13 +364,13 @@ void CDasherModel::ScheduleOneStep(dasherint y1, dasherint y2, int nSteps, int l
   // Just have to decide how far, i.e. what alpha.
   
   //Possible schemes (using rw=r2-r1, Rw=R2-R1)
-  // (Note: if y2-y1 == MAX_Y, alpha=1/nSteps is correct, and in some schemes must be a special case)
-  // alpha = (pow(rw/Rw,1/nSteps)-1)*rW / (rw-Rw) : correct/ideal, but uses pow
-  // alpha = 1/nSteps : moves forwards too fast, reverses too slow (correct for translation)
-  // alpha = MAX_Y / (MAX_Y + (nSteps-1)*(y2-y1)) : (same eqn as old Dasher) more so! reversing ~~ 1/3 ideal speed, and maxes out at moderate dasherX.
-  // alpha = (y2-y1) / (MAX_Y*(nSteps-1) + y2-y1) : too slow forwards, reverses too quick
+  // (Note: if y2-y1 == MAX_Y, alpha=1/dSteps is correct, and in some schemes must be a special case)
+  // alpha = (pow(rw/Rw,1/dSteps)-1)*rW / (rw-Rw) : correct/ideal, but uses pow
+  // alpha = 1/dSteps : moves forwards too fast, reverses too slow (correct for translation)
+  // alpha = MAX_Y / (MAX_Y + (dSteps-1)*(y2-y1)) : (same eqn as old Dasher) more so! reversing ~~ 1/3 ideal speed, and maxes out at moderate dasherX.
+  // alpha = (y2-y1) / (MAX_Y*(dSteps-1) + y2-y1) : too slow forwards, reverses too quick
   //We are using:
-  // alpha = sqrt(y2-y1) / (sqrt(MAX_Y)*(nSteps-1) + sqrt(y2-y1))
+  // alpha = sqrt(y2-y1) / (sqrt(MAX_Y)*(dSteps-1) + sqrt(y2-y1))
   //      with approx sqrt on y2-y1
   //this is pretty good going forwards, but reverses faster than the ideal, on the order of 2*
   
@@ -364,10 +379,10 @@ void CDasherModel::ScheduleOneStep(dasherint y1, dasherint y2, int nSteps, int l
     {
       const dasherint Rw=R2-R1, rw=r2-r1;
       dasherint apsq = mysqrt(y2-y1);
-      dasherint denom = 64*(nSteps-1) + apsq;
-      dasherint nw = (rw*apsq + Rw*64*(nSteps-1))/denom;
+      double denom = 64*(dSteps-1) + apsq;
+      double nw = (rw*apsq + Rw*64*(dSteps-1))/denom;
       double bits = (log(nw) - log(Rw))/log(2);
-      std::cout << "Too fast at X " << (y2-y1)/2 << ": would enter " << bits << "b = " << (bits*nSteps) << " in " << nSteps << "steps; will now enter ";
+      std::cout << "Too fast at X " << (y2-y1)/2 << ": would enter " << bits << "b = " << (bits*dSteps) << " in " << dSteps << "steps; will now enter ";
     }
 #endif
     //atm we have Rw=R2-R1, rw=r2-r1 = Rw*MAX_Y/targetRange, (m1,m2) to take us there
@@ -404,11 +419,11 @@ void CDasherModel::ScheduleOneStep(dasherint y1, dasherint y2, int nSteps, int l
 #endif
     double frac;
     if (targetRange == MAX_Y) {
-      frac=1.0/nSteps;
+      frac=1.0/dSteps;
     } else {
       double tr(targetRange);
       //expansion factor (of root node) for one step, post-speed-limit
-      double eFac = pow(MAX_Y/tr,1.0/nSteps);
+      double eFac = pow(MAX_Y/tr,1.0/dSteps);
       //fraction of way along linear interpolation Rw->rw that yields that width:
       // = (Rw*eFac - Rw) / (rw-Rw)
       // = Rw * (eFac-1.0) / (Rw*MAX_Y/tr-Rw)
@@ -424,26 +439,45 @@ void CDasherModel::ScheduleOneStep(dasherint y1, dasherint y2, int nSteps, int l
   { //begin block A (regardless of #ifdef)
     
     //approximate dynamics: interpolate
-    // apsq parts rw to 64*(nSteps-1) parts Rw
+    // apsq parts rw to 64*(dSteps-1) parts Rw
     // (no need to compute target width)
     dasherint apsq = mysqrt(targetRange);
-    dasherint denom = 64*(nSteps-1) + apsq;
+    double denom = 64*(dSteps-1) + apsq;
     
-    // so new width nw = (64*(nSteps-1)*Rw + apsq*rw)/denom
-    // = Rw*(64*(nSteps-1) + apsq*MAX_Y/targetRange)/denom
-    m1 = (m1*apsq)/denom, m2=(m2*apsq)/denom;
+    // so new width nw = (64*(dSteps-1)*Rw + apsq*rw)/denom
+    // = Rw*(64*(dSteps-1) + apsq*MAX_Y/targetRange)/denom
+    m1 = static_cast<dasherint>(m1*apsq/denom), m2 = static_cast<dasherint>(m2*apsq/denom);
 #ifdef DEBUG_DYNAMICS
     std::cout << "Move " << m1 << "," << m2 << " should be " << m1t << "," << m2t;
     double dActualBits = (log((R2+m2)-(R1+m1))-log(R2-R1))/log(2);
     double dDesiredBits = (log((R2+m2t)-(R1+m1t))-log(R2-R1))/log(2);
-    std::cout << " enters " << dActualBits << "b = " << (dActualBits*nSteps) << " in " << nSteps << "steps, should be "
-    << dDesiredBits << "=>" << (dDesiredBits*nSteps) << ", error " << int(abs(dDesiredBits-dActualBits)*100/dDesiredBits) << "%" << std::endl;
+    std::cout << " enters " << dActualBits << "b = " << (dActualBits*dSteps) << " in " << dSteps << "steps, should be "
+    << dDesiredBits << "=>" << (dDesiredBits*dSteps) << ", error " << int(abs(dDesiredBits-dActualBits)*100/dDesiredBits) << "%" << std::endl;
     if (bExact)
       m1=m1t, m2=m2t; //overwrite approx values (we needed them somewhere!)
 #endif
   } //end block A (regardless of #ifdef)
   
-  m_deGotoQueue.push_back(pair<myint,myint>(R1+m1, R2+m2));
+  R1+=m1; R2+=m2;
+}
+
+void CDasherModel::ScheduleOneStep(dasherint y1, dasherint y2, unsigned long iElapsed, double dZoomTime, int limX, bool bExact) {
+  
+  m_deGotoQueue.clear();
+  
+  dasherint R1 = m_Rootmin, R2 = m_Rootmax;
+  //Fixed-length substeps, so that however the time is divided into frames,
+  // the same steps are taken (the approximate dynamics, in particular, depend
+  // on the step length; the exact dynamics compose, so are independent of it).
+  const double dSteps(max(1.0, dZoomTime / STEP_TIME));
+  unsigned long iTime(iElapsed);
+  for (; iTime >= static_cast<unsigned long>(STEP_TIME); iTime -= STEP_TIME)
+    StepTowards(R1, R2, y1, y2, dSteps, limX, bExact);
+  //then interpolate, by a partial step, for the remainder of the frame
+  if (iTime)
+    StepTowards(R1, R2, y1, y2, max(1.0, dZoomTime / iTime), limX, bExact);
+  
+  m_deGotoQueue.push_back(pair<myint,myint>(R1, R2));
 }
 
 void CDasherModel::OutputTo(CDasherNode *pNewNode) {
@@ -470,6 +504,17 @@ void CDasherModel::OutputTo(CDasherNode *pNewNode) {
   }
 }
 
+void CDasherModel::ReportMemory(CMemoryReport &report) const {
+  if (!m_Root) return;
+  vector<const CDasherNode *> vStack(1, oldroots.empty() ? m_Root : oldroots[0]);
+  while (!vStack.empty()) {
+    const CDasherNode *pNode = vStack.back();
+    vStack.pop_back();
+    pNode->ReportMemory(report);
+    vStack.insert(vStack.end(), pNode->GetChildren().begin(), pNode->GetChildren().end());
+  }
+}
+
 void CDasherModel::ExpandNode(CDasherNode *pNode) {
   DASHER_ASSERT(pNode != NULL);
 
@@ -481,12 +526,16 @@ void CDasherModel::ExpandNode(CDasherNode *pNode) {
   }
 
   // TODO: Do we really need to delete all of the children at this point?
+  if (!pNode->GetChildren().empty()) FlushEvents();
   pNode->Delete_children(); // trial commented out - pconlon
 
 #ifdef DEBUG
   unsigned int iExpect = pNode->ExpectedNumChildren();
 #endif
-  pNode->PopulateChildren();
+  {
+    PERF_TRACE_SPAN("PopulateChildren");
+    pNode->PopulateChildren();
+  }
 #ifdef DEBUG
   if (iExpect != pNode->GetChildren().size()) {
     std::cout << "(Note: expected " << iExpect << " children, actually created " << pNode->GetChildren().size() << ")" << std::endl;
@@ -499,10 +548,14 @@ void CDasherModel::ExpandNode(CDasherNode *pNode) {
 }
 
 void CDasherModel::RenderToView(CDasherView *pView, CExpansionPolicy &policy) {
+  PERF_TRACE_SPAN("RenderToView");
 
   DASHER_ASSERT(pView != NULL);
   DASHER_ASSERT(m_Root != NULL);
 
+  //the view collapses nodes too small or offscreen
+  FlushEvents();
+
   while(pView->IsSpaceAroundNode(m_Rootmin,m_Rootmax)) {
     if (!Reparent_root()) break;
   }
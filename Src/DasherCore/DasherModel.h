@@ -58,8 +58,10 @@ namespace Dasher {
 /// (However, determining which nodes are under the crosshair, is done by the CDasherView).
 ///
 /// The class is Observable in that it broadcasts a pointer to a CDasherNode when the node's
-/// children are created.
-class Dasher::CDasherModel: public Observable<CDasherNode*>, private NoClones
+/// children are created. Listeners that can wait (e.g. to prepare for rendering) should
+/// register as BatchObservers, and receive all nodes expanded since the last FlushEvents()
+/// at once; the model (or expansion policy) flushes them before deleting any nodes.
+class Dasher::CDasherModel: public BatchedObservable<CDasherNode*>, private NoClones
 {
  public:
   static const unsigned int NORMALIZATION = 1<<16;
@@ -134,18 +136,23 @@ class Dasher::CDasherModel: public Observable<CDasherNode*>, private NoClones
   /// \param nSteps number of steps to schedule to take us all the way there
   void ScheduleZoom(dasherint y1, dasherint y2, int nSteps);
   
-  /// Schedule one frame of movement, with the property that
-  /// <nsteps> calls with the same parameter, should bring
-  /// the given range of Dasher Y-space to fill the axis.
-  /// (Roughly - we use approximations! - but more accurate
-  /// than the first step of a zoom).
+  /// Schedule one frame of movement, covering iElapsed ms, towards the given
+  /// range of Dasher Y-space, at the speed which would (if the target stayed
+  /// put) bring that range to fill the axis in dZoomTime ms. The movement is
+  /// integrated in fixed substeps of STEP_TIME ms, plus a partial step for any
+  /// remainder, so the rate of entry is the same whatever the frame rate
+  /// (or however much it fluctuates).
   /// \param y1,y2 - target range of y axis, i.e. to move to 0,MAXY
-  /// \param nSteps number of steps that would take us all the way there
+  /// \param iElapsed time (ms) since the last frame, which this step should cover
+  /// \param dZoomTime time (ms) in which we'd zoom all the way to y1,y2
   /// \param limX X coord at which max speed achieved (any X coord lower than
   /// this, will be slowed down to that speed).
   /// \param bExact whether to do "exact" calculations (slower, using floating-point
   /// pow), or approximate with integers (will move at not-ideal rate in some directions)
-  void ScheduleOneStep(dasherint y1, dasherint y2, int nSteps, int limX, bool bExact);
+  void ScheduleOneStep(dasherint y1, dasherint y2, unsigned long iElapsed, double dZoomTime, int limX, bool bExact);
+
+  ///Length (ms) of the substeps into which ScheduleOneStep divides each frame
+  static const int STEP_TIME = 5;
 
   ///Cancel any steps previously scheduled (most likely by ScheduleZoom)
   void ClearScheduledSteps();
@@ -165,6 +172,11 @@ class Dasher::CDasherModel: public Observable<CDasherNode*>, private NoClones
   /// last frame that was rendered. (I.e., this is the last
   /// node output.)
   CDasherNode *Get_node_under_crosshair();
+
+  /// Computes where a node currently is, from the bounds of the root node.
+  /// \param y1,y2 set to the node's extent in Dasher Y coordinates
+  /// \return false if the node is not a descendant of (or is) the root; y1,y2 undefined
+  bool GetNodeRange(CDasherNode *pNode, dasherint &y1, dasherint &y2);
   
   ///
   /// This is pretty horrible - a rethink of the start/reset mechanism
@@ -190,6 +202,10 @@ class Dasher::CDasherModel: public Observable<CDasherNode*>, private NoClones
   /// Create the children of a Dasher node
   void ExpandNode(CDasherNode * pNode);
 
+  ///Adds every node in the tree (inc. the old roots kept above the root)
+  /// to a report; see CDasherNode::ReportMemory
+  void ReportMemory(CMemoryReport &report) const;
+
  private:
 
   // The root of the Dasher tree
@@ -235,6 +251,10 @@ class Dasher::CDasherModel: public Observable<CDasherNode*>, private NoClones
   // Information entered so far in this model
   double m_dTotalNats;
 
+  /// Moves root bounds R1,R2 one step towards the target range y1,y2, such
+  /// that dSteps such steps would bring that range to fill the axis.
+  static void StepTowards(dasherint &R1, dasherint &R2, dasherint y1, dasherint y2, double dSteps, int limX, bool bExact);
+
   ///
   /// Make a child of the root into a new root
   ///
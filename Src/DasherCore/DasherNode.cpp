@@ -38,13 +38,23 @@ static char THIS_FILE[] = __FILE__;
 #endif
 #endif
 static int iNumNodes = 0;
+///Counter for nodes created/deleted on this thread; see CNodeCountScope
+static thread_local int *s_pNumNodes = &iNumNodes;
 
-int Dasher::currentNumNodeObjects() {return iNumNodes;}
+int Dasher::currentNumNodeObjects() {return *s_pNumNodes;}
+
+CNodeCountScope::CNodeCountScope(int &iCounter) : m_pPrevious(s_pNumNodes) {
+  s_pNumNodes = &iCounter;
+}
+
+CNodeCountScope::~CNodeCountScope() {
+  s_pNumNodes = m_pPrevious;
+}
 
 //TODO this used to be inline - should we make it so again?
 CDasherNode::CDasherNode(int iOffset, int iColour, CDasherScreen::Label *pLabel)
 : onlyChildRendered(NULL),  m_iLbnd(0), m_iHbnd(CDasherModel::NORMALIZATION), m_pParent(NULL), m_iFlags(DEFAULT_FLAGS), m_iOffset(iOffset), m_iColour(iColour), m_pLabel(pLabel) {
-  iNumNodes++;
+  (*s_pNumNodes)++;
 }
 
 // TODO: put this back to being inlined
@@ -56,7 +66,7 @@ CDasherNode::~CDasherNode() {
 
   //  std::cout << "done." << std::endl;
 
-  iNumNodes--;
+  (*s_pNumNodes)--;
 }
 
 void CDasherNode::Trace() const {
@@ -275,6 +275,13 @@ class Dasher::CDasherNode:private NoClones {
     throw "Hack for pre-MandarinDasher ConversionManager::BuildTree method, needs to access CAlphabetManager-private struct";
   }
 
+  ///Adds this node (not its children) to a report, under "nodes/" and its kind.
+  /// Subclasses should override to report their own kind and size, and anything
+  /// else they hold; the default is for kinds not otherwise distinguished.
+  virtual void ReportMemory(CMemoryReport &report) const {
+    report.Add("nodes/other", 1, sizeof(CDasherNode));
+  }
+
   /// @}
 
  private:
@@ -298,8 +305,21 @@ class Dasher::CDasherNode:private NoClones {
 /// @}
 
 namespace Dasher {
-  /// Return the number of CDasherNode objects currently in existence.
+  /// Return the number of CDasherNode objects currently in existence
+  /// (or, inside a CNodeCountScope, counted by it).
   int currentNumNodeObjects();
+
+  ///While one exists, CDasherNodes created or deleted on the thread that made it
+  /// are counted in the supplied counter instead of the process-wide count; so
+  /// several trees, each with its own node budget, can share a process. Every
+  /// node of such a tree must be created and deleted inside a scope for its counter.
+  class CNodeCountScope : private NoClones {
+  public:
+    CNodeCountScope(int &iCounter);
+    ~CNodeCountScope();
+  private:
+    int * const m_pPrevious;
+  };
 }
 
 
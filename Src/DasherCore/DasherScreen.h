@@ -7,7 +7,9 @@
 
 #include "DasherTypes.h"
 #include "../DasherCore/ColourIO.h"
+#include "MemoryReport.h"
 #include <set>
+#include <atomic>
 
 // DJW20050505 - renamed DrawText to DrawString - windows defines DrawText as a macro and it's 
 // really hard to work around
@@ -73,7 +75,7 @@ public:
     friend class CDasherScreen;
   protected:
     Label(const std::string &strText, unsigned int iWrapSize)
-    : m_strText(strText), m_iWrapSize(iWrapSize) {};
+    : m_strText(strText), m_iWrapSize(iWrapSize), m_iId(NextId()) {};
   public:
     const std::string m_strText;
     ///If 0, Label is to be rendered on a single line.
@@ -82,9 +84,18 @@ public:
     /// whether to support DrawString/TextSize at any other size but this is
     /// NOT required.)
     unsigned int m_iWrapSize;
+    ///Unique to this Label, for the life of the process (unlike its address,
+    /// which may be reused once deleted); e.g. for caches keyed by label.
+    /// Labels may be made on several threads at once (e.g. DasherServer sessions).
+    const unsigned long m_iId;
     ///Delete the label. This should free up any resources associated with
     /// drawing the string onto the screen, e.g. layouts or textures.
     virtual ~Label() {}
+  private:
+    static unsigned long NextId() {
+      static std::atomic<unsigned long> iNext(0);
+      return ++iNext;
+    }
   };
 
   ///Make a label for use with this screen.
@@ -173,6 +184,10 @@ public:
   // Returns true if cursor is over visible part of this window.
   virtual bool IsWindowUnderCursor() = 0;
 
+  ///Adds the labels made by this screen, and whatever is kept to draw them
+  /// (e.g. layouts), to a report under "screen/". The default adds nothing.
+  virtual void ReportMemory(CMemoryReport &report) const {}
+
 private:
   //! Width and height of the screen
   screenint m_iWidth, m_iHeight;
@@ -217,6 +232,12 @@ protected:
   /// created from this screen. This allows iteration through modifiable labels,
   /// but without being able to access or hence modify the set.
   std::set<Label *>::iterator LabelsEnd() {return m_sLabels.end();}
+public:
+  ///Adds every label not yet deleted, with its text
+  virtual void ReportMemory(CMemoryReport &report) const {
+    for (std::set<Label *>::const_iterator it = m_sLabels.begin(); it != m_sLabels.end(); it++)
+      report.Add("screen/labels", 1, sizeof(Label) + (*it)->m_strText.capacity());
+  }
 private:
   std::set<Label *> m_sLabels;
 };
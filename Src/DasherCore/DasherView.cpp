@@ -24,7 +24,6 @@
 #include "DasherView.h"
 
 using namespace Dasher;
-using std::vector;
 
 // Track memory leaks on Windows to the line that new'd the memory
 #ifdef _WIN32
@@ -52,14 +51,13 @@ void CDasherView::ChangeScreen(CDasherScreen *NewScreen) {
 
 void CDasherView::DasherSpaceLine(myint x1, myint y1, myint x2, myint y2, int iWidth, int iColor) {
   if (!ClipLineToVisible(x1, y1, x2, y2)) return;
-  vector<CDasherScreen::point> vPoints;
+  CFrameArena::CScope scope(m_frameArena);
+  CArenaVector<CDasherScreen::point> vPoints(m_frameArena);
   CDasherScreen::point p;
   Dasher2Screen(x1, y1, p.x, p.y);
   vPoints.push_back(p);
   DasherLine2Screen(x1,y1,x2,y2,vPoints);
-  CDasherScreen::point *pts = new CDasherScreen::point[vPoints.size()];
-  for (int i = vPoints.size(); i-->0; ) pts[i] = vPoints[i];
-  Screen()->Polyline(pts, vPoints.size(), iWidth, iColor);
+  Screen()->Polyline(vPoints.data(), vPoints.size(), iWidth, iColor);
 }
 
 bool CDasherView::ClipLineToVisible(myint &x1, myint &y1, myint &x2, myint &y2) {
@@ -99,14 +97,19 @@ bool CDasherView::ClipLineToVisible(myint &x1, myint &y1, myint &x2, myint &y2)
   return true;
 }
 
+void CDasherView::Dasher2Screen(const myint *pDasherX, const myint *pDasherY, CDasherScreen::point *pPoints, int n) {
+  for (int i=0; i<n; i++)
+    Dasher2Screen(pDasherX[i], pDasherY[i], pPoints[i].x, pPoints[i].y);
+}
+
 /// Draw a polyline specified in Dasher co-ordinates
 
 void CDasherView::DasherPolyline(myint *x, myint *y, int n, int iWidth, int iColour) {
 
-  CDasherScreen::point * ScreenPoints = new CDasherScreen::point[n];
+  CFrameArena::CScope scope(m_frameArena);
+  CDasherScreen::point * ScreenPoints = m_frameArena.AllocArray<CDasherScreen::point>(n);
 
-  for(int i(0); i < n; ++i)
-    Dasher2Screen(x[i], y[i], ScreenPoints[i].x, ScreenPoints[i].y);
+  Dasher2Screen(x, y, ScreenPoints, n);
 
   if(iColour != -1) {
     Screen()->Polyline(ScreenPoints, n, iWidth, iColour);
@@ -114,16 +117,15 @@ void CDasherView::DasherPolyline(myint *x, myint *y, int n, int iWidth, int iCol
   else {
     Screen()->Polyline(ScreenPoints, n, iWidth,0);//no color given
   }
-  delete[]ScreenPoints;
 }
 
 // Draw a polyline with an arrow on the end
 void CDasherView::DasherPolyarrow(myint *x, myint *y, int n, int iWidth, int iColour, double dArrowSizeFactor) {
 
-  CDasherScreen::point * ScreenPoints = new CDasherScreen::point[n+3];
+  CFrameArena::CScope scope(m_frameArena);
+  CDasherScreen::point * ScreenPoints = m_frameArena.AllocArray<CDasherScreen::point>(n+3);
 
-  for(int i(0); i < n; ++i)
-    Dasher2Screen(x[i], y[i], ScreenPoints[i].x, ScreenPoints[i].y);
+  Dasher2Screen(x, y, ScreenPoints, n);
 
   int iXvec = (int)((ScreenPoints[n-2].x - ScreenPoints[n-1].x)*dArrowSizeFactor);
   int iYvec = (int)((ScreenPoints[n-2].y - ScreenPoints[n-1].y)*dArrowSizeFactor);
@@ -136,8 +138,6 @@ void CDasherView::DasherPolyarrow(myint *x, myint *y, int n, int iWidth, int iCo
   ScreenPoints[n+2].y = ScreenPoints[n-1].y + iXvec + iYvec;
 
   Screen()->Polyline(ScreenPoints, n+3, iWidth, (iColour==-1) ? 0 : iColour);
-
-  delete[]ScreenPoints;
 }
 
 // Draw a box specified in Dasher co-ordinates
@@ -15,6 +15,7 @@ namespace Dasher {
 #include "DasherScreen.h"
 #include "Observable.h"
 #include "Event.h"
+#include "FrameArena.h"
 
 /// \defgroup View Visualisation of the model
 /// @{
@@ -79,6 +80,12 @@ public:
 
   virtual void Dasher2Screen(myint iDasherX, myint iDasherY, screenint & iScreenX, screenint & iScreenY) = 0;
 
+  ///
+  /// Convert an array of n points in Dasher co-ordinates to screen co-ordinates.
+  /// Default implementation just calls the above for each point.
+  ///
+  virtual void Dasher2Screen(const myint *pDasherX, const myint *pDasherY, CDasherScreen::point *pPoints, int n);
+
   ///
   /// Convert Dasher co-ordinates to polar co-ordinates (r,theta), with 0<r<1, 0<theta<2*pi
   ///
@@ -116,8 +123,26 @@ public:
   /// @return the innermost node covering the crosshair
   virtual CDasherNode *Render(CDasherNode *pRoot, myint iRootMin, myint iRootMax, CExpansionPolicy &policy)=0;
 
+  /// Called when a node's children have been created, so the view can prepare
+  /// (e.g. lay out labels) for drawing those likely to appear soon, ahead of
+  /// the frame in which they do. Default does nothing.
+  /// @param iRange current extent of pNode (in Dasher Y coordinates)
+  virtual void PrewarmChildLabels(CDasherNode *pNode, myint iRange) {}
+
+  /// Do the preparation requested by PrewarmChildLabels since the last Render,
+  /// or as much as can be done by the deadline. Default does nothing.
+  /// @param iDeadline per CFrameScheduler::Now()
+  virtual void PrewarmLabels(long long iDeadline) {}
+
   /// @}
 
+  ///Adds the view's scratch memory (and any caches subclasses keep) to a
+  /// report, under "view/", then everything the screen reports.
+  virtual void ReportMemory(CMemoryReport &report) const {
+    report.Add("view/frame-arena", 1, m_frameArena.Capacity());
+    m_pScreen->ReportMemory(report);
+  }
+
   ////// Return a reference to the screen - can't be protected due to circlestarthandler
   
   CDasherScreen *Screen() {
@@ -189,7 +214,12 @@ protected:
   /// \param vPoints vector to which to add screen points. Note that at the point that DasherLine2Screen is called,
   /// the screen coordinates of the first point should already have been added to this vector; DasherLine2Screen
   /// will then add exactly one CDasherScreen::point for each line segment required.
-  virtual void DasherLine2Screen(myint x1, myint y1, myint x2, myint y2, std::vector<CDasherScreen::point> &vPoints)=0;
+  virtual void DasherLine2Screen(myint x1, myint y1, myint x2, myint y2, CArenaVector<CDasherScreen::point> &vPoints)=0;
+
+  ///Scratch memory for drawing: points, polygons, etc. Reset at the start of each
+  /// Render; drawing primitives called at other times (e.g. to decorate the view)
+  /// should allocate within a CFrameArena::CScope.
+  CFrameArena m_frameArena;
   
   ///Number of nodes actually rendered. Updated only by subclasses; TODO does
   /// this belong here? (perhaps for subclass-agnostic clients to inspect...)
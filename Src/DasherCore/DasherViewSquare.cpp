@@ -29,6 +29,7 @@
 #include "DasherTypes.h"
 #include "Event.h"
 #include "Observable.h"
+#include "PerfTrace.h"
 
 #include <algorithm>
 #include <iostream>
@@ -57,7 +58,9 @@ static char THIS_FILE[] = __FILE__;
 // FIXME - duplicated 'mode' code throught - needs to be fixed (actually, mode related stuff, Input2Dasher etc should probably be at least partially in some other class)
 
 CDasherViewSquare::CDasherViewSquare(CSettingsUser *pCreateFrom, CDasherScreen *DasherScreen, Opts::ScreenOrientations orient)
-: CDasherView(DasherScreen,orient), CSettingsUserObserver(pCreateFrom), m_Y1(4), m_Y2(0.95 * CDasherModel::MAX_Y), m_Y3(0.05 * CDasherModel::MAX_Y), m_bVisibleRegionValid(false) {
+: CDasherView(DasherScreen,orient), CSettingsUserObserver(pCreateFrom, {SP_DASHER_FONT, LP_MARGIN_WIDTH, BP_NONLINEAR_Y, LP_NONLINEAR_X, LP_GEOMETRY}),
+  m_pDelayedTexts(NULL), m_ppDelayedTextsEnd(&m_pDelayedTexts),
+  m_Y1(4), m_Y2(0.95 * CDasherModel::MAX_Y), m_Y3(0.05 * CDasherModel::MAX_Y), m_bVisibleRegionValid(false) {
 
   //Note, nonlinearity parameters set in SetScaleFactor
   ScreenResized(DasherScreen);
@@ -74,6 +77,9 @@ void CDasherViewSquare::SetOrientation(Opts::ScreenOrientations newOrient) {
 
 void CDasherViewSquare::HandleEvent(int iParameter) {
   switch (iParameter) {
+    case SP_DASHER_FONT:
+      m_labelCache.Clear();
+      break;
     case LP_MARGIN_WIDTH:
     case BP_NONLINEAR_Y:
     case LP_NONLINEAR_X:
@@ -94,6 +100,10 @@ CDasherNode *CDasherViewSquare::Render(CDasherNode *pRoot, myint iRootMin, myint
   //
 
   m_iRenderCount = 0;
+  //nothing from the previous frame is needed any more
+  m_frameArena.Reset();
+  //labels queued for prewarming may have been deleted since
+  m_labelCache.ClearPrewarm();
 
   CDasherNode *pOutput = pRoot->Parent();
 
@@ -113,6 +123,7 @@ CDasherNode *CDasherViewSquare::Render(CDasherNode *pRoot, myint iRootMin, myint
     DasherDrawRectangle(0, iDasherMinY, iDasherMinX, iDasherMaxY, 0, -1, 0);
 
     //and render root.
+    PERF_TRACE_SPAN("DisjointRender");
     DisjointRender(pRoot, iRootMin, iRootMax, NULL, policy, std::numeric_limits<double>::infinity(), pOutput);
   } else {
     //overlapping rects/shapes
@@ -125,13 +136,27 @@ CDasherNode *CDasherViewSquare::Render(CDasherNode *pRoot, myint iRootMin, myint
       DasherDrawRectangle(0, iDasherMinY, iDasherMinX, iDasherMaxY, 0, -1, 0);
     } else //easy case, whole screen is white (outside root node, e.g. when starting)
       Screen()->DrawRectangle(0, 0, Screen()->GetWidth(), Screen()->GetHeight(), 0, -1, 0);
-    NewRender(pRoot, iRootMin, iRootMax, NULL, policy, std::numeric_limits<double>::infinity(), pOutput);
+    PERF_TRACE_SPAN("NewRender");
+    //choose the renderer for the shape once per frame, rather than per node
+    const double dMaxCost(std::numeric_limits<double>::infinity());
+    switch (GetLongParameter(LP_SHAPE_TYPE)) {
+      case 1: NewRender<1>(pRoot, iRootMin, iRootMax, NULL, policy, dMaxCost, pOutput); break;
+      case 2: NewRender<2>(pRoot, iRootMin, iRootMax, NULL, policy, dMaxCost, pOutput); break;
+      case 3: NewRender<3>(pRoot, iRootMin, iRootMax, NULL, policy, dMaxCost, pOutput); break;
+      case 4: NewRender<4>(pRoot, iRootMin, iRootMax, NULL, policy, dMaxCost, pOutput); break;
+      case 5: NewRender<5>(pRoot, iRootMin, iRootMax, NULL, policy, dMaxCost, pOutput); break;
+      default: NewRender<-1>(pRoot, iRootMin, iRootMax, NULL, policy, dMaxCost, pOutput); break; //draws no shapes
+    }
   }
 
   // Labels are drawn in a second parse to get the overlapping right
-  for (vector<CTextString *>::iterator it=m_DelayedTexts.begin(), E=m_DelayedTexts.end(); it!=E; it++)
-    DoDelayedText(*it);
-  m_DelayedTexts.clear();
+  {
+    PERF_TRACE_SPAN("LabelLayout");
+    for (CTextString *pText = m_pDelayedTexts; pText; pText = pText->m_pNext)
+      DoDelayedText(pText);
+  }
+  m_pDelayedTexts = NULL;
+  m_ppDelayedTextsEnd = &m_pDelayedTexts;
 
   // Finally decorate the view
   Crosshair();
@@ -147,30 +172,52 @@ CDasherViewSquare::CTextString *CDasherViewSquare::DasherDrawText(myint iDasherM
   screenint x,y;
   Dasher2Screen(iDasherMaxX, iDasherMidY, x, y);
 
-  //compute font size...
+  CTextString *pRet = m_frameArena.New<CTextString>(pLabel, x, y, LabelSize(iDasherMaxX), iColor);
+  CTextString **&ppEnd(pParent ? pParent->m_ppChildrenEnd : m_ppDelayedTextsEnd);
+  *ppEnd = pRet;
+  ppEnd = &pRet->m_pNext;
+  return pRet;
+}
+
+unsigned int CDasherViewSquare::LabelSize(myint iDasherMaxX) {
   int iSize = GetLongParameter(LP_DASHER_FONTSIZE);
-  {
-    const myint iMaxY(CDasherModel::MAX_Y);
-    if (Screen()->MultiSizeFonts() && iSize>4) {
-      //font size maxes out at ((iMaxY*3)/2)+iMaxY)/iMaxY = 3/2*smallest
-      // which is reached when iDasherMaxX == iMaxY/2, i.e. the crosshair
-      iSize = ((min(iDasherMaxX*3,(iMaxY*3)/2) + iMaxY) * iSize) / iMaxY;
-    } else {
-      //old style fonts; ignore iSize passed-in.
-      myint iLeftTimesFontSize = (iMaxY - iDasherMaxX )*iSize;
-      if(iLeftTimesFontSize < iMaxY * 19/ 20)
-        iSize *= 20;
-      else if(iLeftTimesFontSize < iMaxY * 159 / 160)
-        iSize *= 14;
-      else
-        iSize *= 11;
-    }
+  const myint iMaxY(CDasherModel::MAX_Y);
+  if (Screen()->MultiSizeFonts() && iSize>4) {
+    //font size maxes out at ((iMaxY*3)/2)+iMaxY)/iMaxY = 3/2*smallest
+    // which is reached when iDasherMaxX == iMaxY/2, i.e. the crosshair
+    iSize = ((min(iDasherMaxX*3,(iMaxY*3)/2) + iMaxY) * iSize) / iMaxY;
+    //continuously-varying sizes would mean laying out labels afresh most frames
+    return CLabelCache::SizeBucket(iSize);
   }
+  //old style fonts; ignore iSize passed-in.
+  myint iLeftTimesFontSize = (iMaxY - iDasherMaxX )*iSize;
+  if(iLeftTimesFontSize < iMaxY * 19/ 20)
+    return iSize * 20;
+  else if(iLeftTimesFontSize < iMaxY * 159 / 160)
+    return iSize * 14;
+  return iSize * 11;
+}
 
-  CTextString *pRet = new CTextString(pLabel, x, y, iSize, iColor);
-  vector<CTextString *> &dest(pParent ? pParent->m_children : m_DelayedTexts);
-  dest.push_back(pRet);
-  return pRet;
+void CDasherViewSquare::PrewarmChildLabels(CDasherNode *pNode, myint iRange) {
+  //find the most probable children (their labels will be the biggest, and
+  // among the first to appear), keeping them in descending order of probability
+  CDasherNode *aBest[PREWARM_CHILDREN];
+  unsigned int iBest(0);
+  for (CDasherNode::ChildMap::const_iterator it = pNode->GetChildren().begin(); it != pNode->GetChildren().end(); it++) {
+    CDasherNode *pChild(*it);
+    if (!pChild->getLabel()) continue;
+    const unsigned int iProb(pChild->Range());
+    if (iBest == PREWARM_CHILDREN && iProb <= aBest[iBest-1]->Range()) continue;
+    unsigned int i(iBest < PREWARM_CHILDREN ? iBest++ : iBest-1);
+    for (; i>0 && aBest[i-1]->Range() < iProb; i--) aBest[i] = aBest[i-1];
+    aBest[i] = pChild;
+  }
+  for (unsigned int i=0; i<iBest; i++)
+    m_labelCache.QueuePrewarm(aBest[i]->getLabel(), LabelSize((iRange * aBest[i]->Range()) / CDasherModel::NORMALIZATION));
+}
+
+void CDasherViewSquare::PrewarmLabels(long long iDeadline) {
+  m_labelCache.Prewarm(Screen(), iDeadline);
 }
 
 void CDasherViewSquare::DoDelayedText(CTextString *pText) {
@@ -180,18 +227,16 @@ void CDasherViewSquare::DoDelayedText(CTextString *pText) {
   // more easily available at CTextString creation time. If it really doesn't look as good,
   // can put in extra calls to Screen2Dasher....
   screenint x(pText->m_ix), y(pText->m_iy);
-  pair<screenint,screenint> textDims=Screen()->TextSize(pText->m_pLabel, pText->m_iSize);
+  pair<screenint,screenint> textDims=m_labelCache.TextSize(Screen(), pText->m_pLabel, pText->m_iSize);
   switch (GetOrientation()) {
     case Dasher::Opts::LeftToRight: {
       screenint iRight = x + textDims.first;
       if (iRight < Screen()->GetWidth()) {
         Screen()->DrawString(pText->m_pLabel, x, y-textDims.second/2, pText->m_iSize, pText->m_iColor);
-        for (vector<CTextString *>::iterator it = pText->m_children.begin(); it!=pText->m_children.end(); it++) {
-          CTextString *pChild=*it;
+        for (CTextString *pChild = pText->m_pChildren; pChild; pChild = pChild->m_pNext) {
           pChild->m_ix = max(pChild->m_ix, iRight);
           DoDelayedText(pChild);
         }
-        pText->m_children.clear();
       }
       break;
     }
@@ -199,12 +244,10 @@ void CDasherViewSquare::DoDelayedText(CTextString *pText) {
       screenint iLeft = x-textDims.first;
       if (iLeft>=0) {
         Screen()->DrawString(pText->m_pLabel, iLeft, y-textDims.second/2, pText->m_iSize, pText->m_iColor);
-        for (vector<CTextString *>::iterator it = pText->m_children.begin(); it!=pText->m_children.end(); it++) {
-          CTextString *pChild=*it;
+        for (CTextString *pChild = pText->m_pChildren; pChild; pChild = pChild->m_pNext) {
           pChild->m_ix = min(pChild->m_ix, iLeft);
-          DoDelayedText(*it);
+          DoDelayedText(pChild);
         }
-        pText->m_children.clear();
       }
       break;
     }
@@ -212,12 +255,10 @@ void CDasherViewSquare::DoDelayedText(CTextString *pText) {
       screenint iBottom = y + textDims.second;
       if (iBottom < Screen()->GetHeight()) {
         Screen()->DrawString(pText->m_pLabel, x-textDims.first/2, y, pText->m_iSize, pText->m_iColor);
-        for (vector<CTextString *>::iterator it = pText->m_children.begin(); it!=pText->m_children.end(); it++) {
-          CTextString *pChild=*it;
+        for (CTextString *pChild = pText->m_pChildren; pChild; pChild = pChild->m_pNext) {
           pChild->m_iy = max(pChild->m_iy, iBottom);
-          DoDelayedText(*it);
+          DoDelayedText(pChild);
         }
-        pText->m_children.clear();
       }
       break;
     }
@@ -225,24 +266,16 @@ void CDasherViewSquare::DoDelayedText(CTextString *pText) {
       screenint iTop = y - textDims.second;
       if (y>=0) {
         Screen()->DrawString(pText->m_pLabel, x-textDims.first/2, iTop, pText->m_iSize, pText->m_iColor);
-        for (vector<CTextString *>::iterator it = pText->m_children.begin(); it!=pText->m_children.end(); it++) {
-          CTextString *pChild=*it;
+        for (CTextString *pChild = pText->m_pChildren; pChild; pChild = pChild->m_pNext) {
           pChild->m_iy = min(pChild->m_iy, iTop);
-          DoDelayedText(*it);
+          DoDelayedText(pChild);
         }
-        pText->m_children.clear();
       }
       break;
     }
     default:
       break;
   }
-  delete pText;
-}
-
-CDasherViewSquare::CTextString::~CTextString() {
-  for (vector<CTextString *>::iterator it = m_children.begin(); it!=m_children.end(); it++)
-    delete *it;
 }
 
 void CDasherViewSquare::TruncateTri(myint x, myint y1, myint y2, myint midy1, myint midy2, int fillColor, int outlineColor, int lineWidth) {
@@ -287,7 +320,9 @@ void CDasherViewSquare::TruncateTri(myint x, myint y1, myint y2, myint midy1, my
     }
   }
   // midy1,x1 is now start point
-  vector<CDasherScreen::point> pts(1);
+  CFrameArena::CScope scope(m_frameArena);
+  CArenaVector<CDasherScreen::point> pts(m_frameArena);
+  pts.push_back(CDasherScreen::point());
   Dasher2Screen(x1, midy1, pts[0].x, pts[0].y);
   DasherLine2Screen(x1, midy1, tempx1, y1, pts);
   if (tempx1) {
@@ -320,15 +355,13 @@ void CDasherViewSquare::TruncateTri(myint x, myint y1, myint y2, myint midy1, my
     Dasher2Screen(x1, midy1, pts.back().x, pts.back().y);
   } else DASHER_ASSERT(pts.back().x == pts[0].x && pts.back().y == pts[0].y);
 
-  CDasherScreen::point *p_array=new CDasherScreen::point[pts.size()];
-  for (unsigned int i = 0; i<pts.size(); i++) p_array[i] = pts[i];
-  Screen()->Polygon(p_array, pts.size(), fillColor, outlineColor, lineWidth);
-  delete[] p_array;
+  Screen()->Polygon(pts.data(), pts.size(), fillColor, outlineColor, lineWidth);
 }
 
 #define sq(X) ((X)*(X))
 void CDasherViewSquare::Circle(myint Range, myint y1, myint y2, int fCol, int oCol, int lWidth) {
-  std::vector<CDasherScreen::point> pts;
+  CFrameArena::CScope scope(m_frameArena);
+  CArenaVector<CDasherScreen::point> pts(m_frameArena);
   myint cy((y1+y2)/2),r(Range/2), x1, x2;
   myint iDasherMinX, iDasherMinY, iDasherMaxX, iDasherMaxY;
   VisibleRegion(iDasherMinX, iDasherMinY, iDasherMaxX, iDasherMaxY);
@@ -368,13 +401,10 @@ void CDasherViewSquare::Circle(myint Range, myint y1, myint y2, int fCol, int oC
     Dasher2Screen(0, iDasherMaxX, p.x, p.y);
     pts.push_back(p);
   }
-  CDasherScreen::point *p_array = new CDasherScreen::point[pts.size()];
-  for (unsigned int i=0; i<pts.size(); i++) p_array[i] = pts[i];
-  Screen()->Polygon(p_array, pts.size(), fCol, oCol, lWidth);
-  delete[] p_array;
+  Screen()->Polygon(pts.data(), pts.size(), fCol, oCol, lWidth);
 }
 
-void CDasherViewSquare::CircleTo(myint cy, myint r, myint y1, myint x1, myint y3, myint x3, CDasherScreen::point dest, vector<CDasherScreen::point> &pts, double dXMul) {
+void CDasherViewSquare::CircleTo(myint cy, myint r, myint y1, myint x1, myint y3, myint x3, CDasherScreen::point dest, CArenaVector<CDasherScreen::point> &pts, double dXMul) {
   myint y2((y1+y3)/2);
   myint x2(sqrt(double(sq(r)-sq(cy-y2)))*dXMul);
   CDasherScreen::point mid; //where midpoint of circle/arc should be
@@ -394,7 +424,8 @@ void CDasherViewSquare::DasherSpaceArc(myint cy, myint r, myint x1, myint y1, my
   CDasherScreen::point p;
   //start point
   Dasher2Screen(x1, y1, p.x, p.y);
-  vector<CDasherScreen::point> pts;
+  CFrameArena::CScope scope(m_frameArena);
+  CArenaVector<CDasherScreen::point> pts(m_frameArena);
   pts.push_back(p);
   //if circle goes behind crosshair and we want the point of max-x, force division into two sections with that point as boundary
   if (r>CDasherModel::ORIGIN_X && ((y1 < cy) ^ (y2 < cy))) {
@@ -404,9 +435,7 @@ void CDasherViewSquare::DasherSpaceArc(myint cy, myint r, myint x1, myint y1, my
   }
   Dasher2Screen(x2, y2, p.x, p.y);
   CircleTo(cy, r, y1, x1, y2, x2, p, pts, 1.0);
-  CDasherScreen::point *p_array = new CDasherScreen::point[pts.size()];
-  for (unsigned int i=0; i<pts.size(); i++) p_array[i] = pts[i];
-  Screen()->Polyline(p_array, pts.size(), iLineWidth, iColour);
+  Screen()->Polyline(pts.data(), pts.size(), iLineWidth, iColour);
 }
 
 void CDasherViewSquare::Quadric(myint Range, myint lowY, myint highY, int fillColor, int outlineColour, int lineWidth) {
@@ -414,28 +443,44 @@ void CDasherViewSquare::Quadric(myint Range, myint lowY, myint highY, int fillCo
   const int midY=(lowY+highY)/2;
 #define NUM_STEPS 40
   CDasherScreen::point p_array[2*NUM_STEPS+2];
+  myint x_array[2*NUM_STEPS+2], y_array[2*NUM_STEPS+2];
   myint minX,maxX,minY,maxY;
   VisibleRegion(minX, minY, maxX, maxY);
   {
     myint x1(0), y1(highY), x2(Range*RR2),y2(highY*RR2 + midY*(1.0-RR2)), x3(Range), y3(midY);
     for (int i=0; i<=NUM_STEPS; i++) {
       double f=i/(double)NUM_STEPS, of = 1.0-f;
-      Dasher2Screen(min(maxX,myint(of*of*x1 + 2.0*of*f*x2 + f*f*x3)), max(minY,min(maxY,myint(of*of*y1 + 2.0*of*f*y2 + f*f*y3))), p_array[i].x, p_array[i].y);
+      x_array[i] = min(maxX,myint(of*of*x1 + 2.0*of*f*x2 + f*f*x3));
+      y_array[i] = max(minY,min(maxY,myint(of*of*y1 + 2.0*of*f*y2 + f*f*y3)));
     }
   }
   {
     myint x1(Range), y1(midY), x2(Range*RR2), y2(lowY*RR2 + midY*(1.0-RR2)), x3(0), y3(lowY);
     for (int i=0; i<=NUM_STEPS; i++) {
       double f=i/(double)NUM_STEPS, of = 1.0-f;
-      Dasher2Screen(min(maxX,myint(of*of*x1 + 2.0*of*f*x2 + f*f*x3)),max(minY,min(maxY,myint(of*of*y1 + 2.0*of*f*y2 + f*f*y3))), p_array[i+NUM_STEPS+1].x, p_array[i+NUM_STEPS+1].y);
+      x_array[i+NUM_STEPS+1] = min(maxX,myint(of*of*x1 + 2.0*of*f*x2 + f*f*x3));
+      y_array[i+NUM_STEPS+1] = max(minY,min(maxY,myint(of*of*y1 + 2.0*of*f*y2 + f*f*y3)));
     }
   }
+  Dasher2Screen(x_array, y_array, p_array, 2*NUM_STEPS+2);
 
   Screen()->Polygon(p_array, 2*NUM_STEPS+2, fillColor, outlineColour, lineWidth);
 #undef NUM_STEPS
 }
 
 bool CDasherViewSquare::IsSpaceAroundNode(myint y1, myint y2) {
+  switch (GetLongParameter(LP_SHAPE_TYPE)) {
+    case 0: return IsSpaceAroundNode<0>(y1, y2);
+    case 1: return IsSpaceAroundNode<1>(y1, y2);
+    case 2: return IsSpaceAroundNode<2>(y1, y2);
+    case 3: return IsSpaceAroundNode<3>(y1, y2);
+    case 4: return IsSpaceAroundNode<4>(y1, y2);
+    case 5: return IsSpaceAroundNode<5>(y1, y2);
+    default: return IsSpaceAroundNode<-1>(y1, y2);
+  }
+}
+
+template <int iShape> bool CDasherViewSquare::IsSpaceAroundNode(myint y1, myint y2) {
   myint iVisibleMinX;
   myint iVisibleMinY;
   myint iVisibleMaxX;
@@ -447,9 +492,9 @@ bool CDasherViewSquare::IsSpaceAroundNode(myint y1, myint y2) {
     return true; //space around sq => space around anything smaller!
 
   //in theory, even if the crosshair is off-screen (!), anything spanning y1-y2 should cover it...
-  DASHER_ASSERT (CoversCrosshair(y2-y1, y1, y2));
+  DASHER_ASSERT (CoversCrosshair<iShape>(y2-y1, y1, y2));
 
-  switch (GetLongParameter(LP_SHAPE_TYPE)) {
+  switch (iShape) {
     case 0: //non-overlapping rects
     case 1: //overlapping rects
       return false;
@@ -620,9 +665,9 @@ void CDasherViewSquare::DisjointRender(CDasherNode *pRender, myint y1, myint y2,
   }
 }
 
-bool CDasherViewSquare::CoversCrosshair(myint Range, myint y1, myint y2) {
+template <int iShape> bool CDasherViewSquare::CoversCrosshair(myint Range, myint y1, myint y2) {
   if (Range > CDasherModel::ORIGIN_X && y1 < CDasherModel::ORIGIN_Y && y2 > CDasherModel::ORIGIN_Y) {
-    switch (GetLongParameter(LP_SHAPE_TYPE)) {
+    switch (iShape) {
       case 0: //Disjoint rectangles
       case 1: //Rectangles
         return true;
@@ -654,7 +699,7 @@ bool CDasherViewSquare::CoversCrosshair(myint Range, myint y1, myint y2) {
   return false;
 }
 
-void CDasherViewSquare::NewRender(CDasherNode *pRender, myint y1, myint y2,
+template <int iShape> void CDasherViewSquare::NewRender(CDasherNode *pRender, myint y1, myint y2,
                                   CTextString *pPrevText, CExpansionPolicy &policy, double dMaxCost,
                                   CDasherNode *&pOutput)
 {
@@ -674,7 +719,7 @@ beginning:
   myint iDasherMaxX;
   myint iDasherMaxY;
   VisibleRegion(iDasherMinX, iDasherMinY, iDasherMaxX, iDasherMaxY);
-  pRender->SetFlag(NF_SUPER, !IsSpaceAroundNode(y1, y2));
+  pRender->SetFlag(NF_SUPER, !IsSpaceAroundNode<iShape>(y1, y2));
 
   const int myColor = pRender->getColour();
 
@@ -703,7 +748,7 @@ beginning:
 	//outline width 0 = fill only; >0 = fill + outline; <0 = outline only
 	int fillColour = GetLongParameter(LP_OUTLINE_WIDTH)>=0 ? myColor : -1;
 	int lineWidth = abs(GetLongParameter(LP_OUTLINE_WIDTH));
-    switch (GetLongParameter(LP_SHAPE_TYPE)) {
+    switch (iShape) {
       case 1: //overlapping rects
         DasherDrawRectangle(std::min(Range,iDasherMaxX), std::max(y1,iDasherMinY), 0, std::min(y2,iDasherMaxY), fillColour, -1, lineWidth);
         break;
@@ -723,7 +768,7 @@ beginning:
   }
 
   //Does node cover crosshair?
-  if (pOutput == pRender->Parent() && CoversCrosshair(Range, y1, y2))
+  if (pOutput == pRender->Parent() && CoversCrosshair<iShape>(Range, y1, y2))
     pOutput = pRender;
 
   if (pRender->ChildCount() == 0) {
@@ -778,7 +823,7 @@ beginning:
     if (newy1<=iDasherMaxY && newy2 >= iDasherMinY) { //onscreen
       if (newy2-newy1 > GetLongParameter(LP_MIN_NODE_SIZE)) {
         //definitely big enough to render.
-        NewRender(pChild, newy1, newy2, pPrevText, policy, dMaxCost, pOutput);
+        NewRender<iShape>(pChild, newy1, newy2, pPrevText, policy, dMaxCost, pOutput);
       } else if (!pChild->GetFlag(NF_SEEN)) pChild->Delete_children();
       if (newy2>iDasherMaxY && !pRender->GetFlag(NF_GAME)) {
         //remaining children offscreen and no game-mode child we might skip
@@ -902,6 +947,14 @@ void CDasherViewSquare::SetScaleFactor( void )
   iScaleFactorX = myint(dScaleFactorX * SCALE_FACTOR);
   iScaleFactorY = myint(dScaleFactorY * SCALE_FACTOR);
 
+  m_iScreenWidth = iScreenWidth; m_iScreenHeight = iScreenHeight;
+  switch (GetOrientation()) {
+    case Dasher::Opts::RightToLeft: SelectDasher2Screen<Dasher::Opts::RightToLeft>(); break;
+    case Dasher::Opts::TopToBottom: SelectDasher2Screen<Dasher::Opts::TopToBottom>(); break;
+    case Dasher::Opts::BottomToTop: SelectDasher2Screen<Dasher::Opts::BottomToTop>(); break;
+    default: SelectDasher2Screen<Dasher::Opts::LeftToRight>(); break;
+  }
+
 #ifdef DEBUG
   //test...
   for (screenint x=0; x<iScreenWidth; x++) {
@@ -927,83 +980,63 @@ void CDasherViewSquare::SetScaleFactor( void )
 }
 
 
-inline myint CDasherViewSquare::CustomIDivScaleFactor(myint iNumerator) {
-  // Integer division rounding away from zero
-
-  long long int num, denom, quot, rem;
-  myint res;
-
-  num   = iNumerator;
-  denom = SCALE_FACTOR;
-
-  DASHER_ASSERT(denom != 0);
-
-#ifdef HAVE_LLDIV
-  lldiv_t ans = ::lldiv(num, denom);
-
-  quot = ans.quot;
-  rem  = ans.rem;
-#else
-  quot = num / denom;
-  rem  = num % denom;
-#endif
-
-  if (rem < 0)
-    res = quot - 1;
-  else if (rem > 0)
-    res = quot + 1;
-  else
-    res = quot;
-
-  return res;
-
-  // return (iNumerator + iDenominator - 1) / iDenominator;
-}
-
 void CDasherViewSquare::Dasher2Screen(myint iDasherX, myint iDasherY, screenint &iScreenX, screenint &iScreenY) {
+  CDasherScreen::point p;
+  (this->*m_pDasher2Screen)(&iDasherX, &iDasherY, &p, 1);
+  iScreenX = p.x; iScreenY = p.y;
+}
 
-  // Apply the nonlinearities
-
-  iDasherX = xmap(iDasherX);
-  iDasherY = ymap(iDasherY);
+void CDasherViewSquare::Dasher2Screen(const myint *pDasherX, const myint *pDasherY, CDasherScreen::point *pPoints, int n) {
+  (this->*m_pDasher2Screen)(pDasherX, pDasherY, pPoints, n);
+}
 
-  // Things we're likely to need:
+template <Opts::ScreenOrientations Orient, bool bNonlinearX, bool bNonlinearY>
+void CDasherViewSquare::Dasher2ScreenImpl(const myint *pDasherX, const myint *pDasherY, CDasherScreen::point *pPoints, int n) const {
+  for (int i=0; i<n; i++) {
+    // Apply the nonlinearities
+    const myint iDasherX(xmap<bNonlinearX>(pDasherX[i])), iDasherY(ymap<bNonlinearY>(pDasherY[i]));
 
-  screenint iScreenWidth = Screen()->GetWidth();
-  screenint iScreenHeight = Screen()->GetHeight();
-
-  // Note that integer division is rounded *away* from zero here to
-  // ensure that this really is the inverse of the map the other way
-  // around.
+    // Note that integer division is rounded *away* from zero here to
+    // ensure that this really is the inverse of the map the other way
+    // around.
+    const myint iScaledX(CustomIDivScaleFactor(iDasherX * iScaleFactorX)),
+                iScaledY(CustomIDivScaleFactor((iDasherY - CDasherModel::MAX_Y/2) * iScaleFactorY));
 
-  switch( GetOrientation() ) {
-  case Dasher::Opts::LeftToRight:
-    iScreenX = screenint(iScreenWidth -
-			 CustomIDivScaleFactor(iDasherX  * iScaleFactorX));
-    iScreenY = screenint(iScreenHeight / 2 +
-			 CustomIDivScaleFactor(( iDasherY - CDasherModel::MAX_Y / 2 ) * iScaleFactorY));
-    break;
-  case Dasher::Opts::RightToLeft:
-    iScreenX = screenint(CustomIDivScaleFactor(iDasherX * iScaleFactorX));
-    iScreenY = screenint(iScreenHeight / 2 +
-			 CustomIDivScaleFactor( (iDasherY - CDasherModel::MAX_Y/2) * iScaleFactorY));
-    break;
-  case Dasher::Opts::TopToBottom:
-    iScreenX = screenint(iScreenWidth / 2 +
-			 CustomIDivScaleFactor( (iDasherY - CDasherModel::MAX_Y/2) * iScaleFactorY));
-    iScreenY = screenint(iScreenHeight -
-			 CustomIDivScaleFactor( iDasherX * iScaleFactorX ));
-    break;
-  case Dasher::Opts::BottomToTop:
-    iScreenX = screenint(iScreenWidth / 2 +
-			 CustomIDivScaleFactor(( iDasherY - CDasherModel::MAX_Y/2 ) * iScaleFactorY));
-    iScreenY = screenint(CustomIDivScaleFactor( iDasherX  * iScaleFactorX ));
-    break;
+    //Orient is a constant, so the compiler keeps only one case
+    switch (Orient) {
+    case Dasher::Opts::LeftToRight:
+      pPoints[i].x = screenint(m_iScreenWidth - iScaledX);
+      pPoints[i].y = screenint(m_iScreenHeight / 2 + iScaledY);
+      break;
+    case Dasher::Opts::RightToLeft:
+      pPoints[i].x = screenint(iScaledX);
+      pPoints[i].y = screenint(m_iScreenHeight / 2 + iScaledY);
+      break;
+    case Dasher::Opts::TopToBottom:
+      pPoints[i].x = screenint(m_iScreenWidth / 2 + iScaledY);
+      pPoints[i].y = screenint(m_iScreenHeight - iScaledX);
+      break;
+    case Dasher::Opts::BottomToTop:
+      pPoints[i].x = screenint(m_iScreenWidth / 2 + iScaledY);
+      pPoints[i].y = screenint(iScaledX);
+      break;
     default:
       break;
+    }
   }
 }
 
+template <Opts::ScreenOrientations Orient> void CDasherViewSquare::SelectDasher2Screen() {
+  if (GetLongParameter(LP_NONLINEAR_X))
+    m_pDasher2Screen = GetBoolParameter(BP_NONLINEAR_Y)
+      ? &CDasherViewSquare::Dasher2ScreenImpl<Orient, true, true>
+      : &CDasherViewSquare::Dasher2ScreenImpl<Orient, true, false>;
+  else
+    m_pDasher2Screen = GetBoolParameter(BP_NONLINEAR_Y)
+      ? &CDasherViewSquare::Dasher2ScreenImpl<Orient, false, true>
+      : &CDasherViewSquare::Dasher2ScreenImpl<Orient, false, false>;
+}
+
 void CDasherViewSquare::Dasher2Polar(myint iDasherX, myint iDasherY, double &r, double &theta) {
 	iDasherX = xmap(iDasherX);
     iDasherY = ymap(iDasherY);
@@ -1017,7 +1050,7 @@ void CDasherViewSquare::Dasher2Polar(myint iDasherX, myint iDasherY, double &r,
     r = sqrt(x * x + y * y);
 }
 
-void CDasherViewSquare::DasherLine2Screen(myint x1, myint y1, myint x2, myint y2, vector<CDasherScreen::point> &vPoints) {
+void CDasherViewSquare::DasherLine2Screen(myint x1, myint y1, myint x2, myint y2, CArenaVector<CDasherScreen::point> &vPoints) {
   if (x1!=x2 && y1!=y2) { //only diagonal lines ever get changed...
     if (GetBoolParameter(BP_NONLINEAR_Y)) {
       if ((y1 < m_Y3 && y2 > m_Y3) ||(y2 < m_Y3 && y1 > m_Y3)) {
@@ -1141,5 +1174,7 @@ void CDasherViewSquare::VisibleRegion( myint &iDasherMinX, myint &iDasherMinY, m
 
 void CDasherViewSquare::ScreenResized(CDasherScreen *NewScreen) {
   m_bVisibleRegionValid = false;
+  //may be a different screen, or sizes may depend on its width (wrapping)
+  m_labelCache.Clear();
   SetScaleFactor();
 }
@@ -9,6 +9,7 @@
 #include <deque>
 #include "Alphabet/GroupInfo.h"
 #include "SettingsStore.h"
+#include "LabelCache.h"
 
 using namespace std;
 
@@ -69,6 +70,7 @@ public:
   /// Convert Dasher co-ordinates to screen co-ordinates
   ///
   void Dasher2Screen(myint iDasherX, myint iDasherY, screenint & iScreenX, screenint & iScreenY);
+  void Dasher2Screen(const myint *pDasherX, const myint *pDasherY, CDasherScreen::point *pPoints, int n);
 
   ///
   /// Convert Dasher co-ordinates to polar co-ordinates (r,theta), with 0<r<1, 0<theta<2*pi
@@ -92,6 +94,19 @@ public:
   ///
   virtual CDasherNode *Render(CDasherNode *pRoot, myint iRootMin, myint iRootMax, CExpansionPolicy &policy);
 
+  ///Queues labels of the (up to PREWARM_CHILDREN) most probable children to be measured
+  void PrewarmChildLabels(CDasherNode *pNode, myint iRange);
+  void PrewarmLabels(long long iDeadline);
+
+  ///Also adds the label size cache
+  void ReportMemory(CMemoryReport &report) const {
+    CDasherView::ReportMemory(report);
+    m_labelCache.ReportMemory(report);
+  }
+
+  ///Max number of children, of each node expanded, whose labels we prewarm
+  static const unsigned int PREWARM_CHILDREN = 4;
+
   /// @}
 
   void DasherSpaceArc(myint cy, myint r, myint x1, myint y1, myint x2, myint y2, int colour, int iLineWidth);
@@ -110,32 +125,43 @@ private:
   /// dest - point (x2,y2) in screen coords
   /// pts - vector into which to store points; on entry, last element should already be screen-coords of (x1,y1)
   /// dXMul - multiply x coords (in dasher space) by this (i.e. aspect ratio), for ovals
-  void CircleTo(myint cy, myint r, myint y1, myint x1, myint y3, myint x3, CDasherScreen::point dest, vector<CDasherScreen::point> &pts, double dXMul);
+  void CircleTo(myint cy, myint r, myint y1, myint x1, myint y3, myint x3, CDasherScreen::point dest, CArenaVector<CDasherScreen::point> &pts, double dXMul);
   void Circle(myint Range, myint lowY, myint highY, int fCol, int oCol, int lWidth);
   void Quadric(myint Range, myint lowY, myint highY, int fillColor, int outlineColour, int lineWidth);
   ///draw isoceles triangle, with baseline from y1-y2 along y axis (x=0), and other point at (x,(y1+y2)/2)
   /// (all in Dasher coords).
   void Triangle(myint x, myint y1, myint y2, int fillColor, int outlineColor, int lineWidth);
 
+  ///Request to draw a label, allocated in m_frameArena (so never deleted).
+  /// Labels of child nodes are kept in a singly-linked list, in the order added.
   class CTextString {
   public: //to CDasherViewSquare...
     ///Creates a request that label will be drawn.
     /// x,y are screen coords of midpoint of leading edge;
     /// iSize is desired size (already computed from requested position)
     CTextString(CDasherScreen::Label *pLabel, screenint x, screenint y, int iSize, int iColor)
-    : m_pLabel(pLabel), m_ix(x), m_iy(y), m_iSize(iSize), m_iColor(iColor) {
+    : m_pLabel(pLabel), m_ix(x), m_iy(y), m_pChildren(NULL), m_ppChildrenEnd(&m_pChildren), m_pNext(NULL), m_iSize(iSize), m_iColor(iColor) {
     }
-    ~CTextString();
     CDasherScreen::Label *m_pLabel;
     screenint m_ix,m_iy;
-    vector<CTextString *> m_children;
+    ///First child, and the link to update to append another
+    CTextString *m_pChildren, **m_ppChildrenEnd;
+    ///Next sibling
+    CTextString *m_pNext;
     int m_iSize;
     int m_iColor;
   };
 
-  std::vector<CTextString *> m_DelayedTexts;
+  ///Texts with no parent to be drawn this frame, as per CTextString::m_pChildren
+  CTextString *m_pDelayedTexts, **m_ppDelayedTextsEnd;
 
   void DoDelayedText(CTextString *pText);
+
+  ///Font size at which to draw the label of a node whose max x extent is iDasherMaxX
+  unsigned int LabelSize(myint iDasherMaxX);
+
+  ///Sizes of labels, for DoDelayedText
+  CLabelCache m_labelCache;
   ///
   /// Draw text specified in Dasher co-ordinates
   ///
@@ -150,11 +176,11 @@ private:
   void DisjointRender(CDasherNode * Render, myint y1, myint y2, CTextString *prevText, CExpansionPolicy &policy, double dMaxCost, CDasherNode *&pOutput);
 
   /// (Recursively) render a node and all contained subnodes, in overlapping shapes
-  /// (according to LP_SHAPE_TYPE: 1=rects, 2=triangles, 3=truncated triangles,
-  /// 4=quadrics, 5=semicircles)
+  /// (according to iShape, i.e. LP_SHAPE_TYPE: 1=rects, 2=triangles, 3=truncated triangles,
+  /// 4=quadrics, 5=semicircles; instantiated for each, so nothing tests the shape per node)
   /// Each call responsible for rendering exactly the area contained within the node.
   /// @param pOutput The innermost node covering the crosshair (if any)
-  void NewRender(CDasherNode * Render, myint y1, myint y2, CTextString *prevText, CExpansionPolicy &policy, double dMaxCost, CDasherNode *&pOutput);
+  template <int iShape> void NewRender(CDasherNode * Render, myint y1, myint y2, CTextString *prevText, CExpansionPolicy &policy, double dMaxCost, CDasherNode *&pOutput);
 
   /// @name Nonlinearity
   /// Implements the non-linear part of the coordinate space mapping
@@ -163,6 +189,9 @@ private:
   /// screen coordinate (linear in screen space, -ive x = offscreen) - i.e. pixel coordinate = scale({x,y}map(dasher coord)))
   inline myint ymap(myint iDasherY) const;
   inline myint xmap(myint iDasherX) const;
+  ///As above, but with the nonlinearity (BP_NONLINEAR_Y / LP_NONLINEAR_X) fixed at compile-time
+  template <bool bNonlinear> inline myint ymap(myint iDasherY) const;
+  template <bool bNonlinear> inline myint xmap(myint iDasherX) const;
 
   /// Inverse of the previous - i.e. dasher coord = iymap(scale(screen coord))
   inline myint iymap(myint y) const;
@@ -172,12 +201,27 @@ private:
   const myint m_Y1, m_Y2, m_Y3;
 
   inline void Crosshair();
-  bool CoversCrosshair(myint Range,myint y1,myint y2);
+  ///Whether a node of shape iShape (as LP_SHAPE_TYPE) covers the crosshair
+  template <int iShape> bool CoversCrosshair(myint Range,myint y1,myint y2);
+  ///IsSpaceAroundNode for a node of shape iShape
+  template <int iShape> bool IsSpaceAroundNode(myint y1, myint y2);
 
   //Divides by SCALE_FACTOR, rounding away from 0
-  inline myint CustomIDivScaleFactor(myint iNumerator);
+  static inline myint CustomIDivScaleFactor(myint iNumerator);
 
-  void DasherLine2Screen(myint x1, myint y1, myint x2, myint y2, vector<CDasherScreen::point> &vPoints);
+  ///Converts n points from Dasher to screen coordinates, for a particular
+  /// orientation and combination of nonlinearities (so without testing any
+  /// of them per point). Width and height of the screen are as cached by
+  /// SetScaleFactor.
+  template <Opts::ScreenOrientations Orient, bool bNonlinearX, bool bNonlinearY>
+  void Dasher2ScreenImpl(const myint *pDasherX, const myint *pDasherY, CDasherScreen::point *pPoints, int n) const;
+
+  ///The instantiation of Dasher2ScreenImpl for the current settings; chosen by SetScaleFactor
+  void (CDasherViewSquare::*m_pDasher2Screen)(const myint *, const myint *, CDasherScreen::point *, int) const;
+
+  template <Opts::ScreenOrientations Orient> void SelectDasher2Screen();
+
+  void DasherLine2Screen(myint x1, myint y1, myint x2, myint y2, CArenaVector<CDasherScreen::point> &vPoints);
 
   bool m_bVisibleRegionValid;
 
@@ -195,7 +239,11 @@ private:
   /// (Note the naming convention: iScaleFactorX/Y refers to X/Y in Dasher-space, which will be
   /// the other way around to real screen coordinates if using a vertical (T-B/B-T) orientation)
   myint iScaleFactorX, iScaleFactorY;
-  static const myint SCALE_FACTOR = 1<<26; //was 100,000,000; change to power of 2 => easier to multiply/divide
+  static const int SCALE_SHIFT = 26;
+  static const myint SCALE_FACTOR = 1<<SCALE_SHIFT; //was 100,000,000; change to power of 2 => easier to multiply/divide
+
+  ///Screen dimensions when SetScaleFactor was last called (i.e. since last resized)
+  screenint m_iScreenWidth, m_iScreenHeight;
 
   /// Cached extents of visible region
   myint m_iDasherMinX;
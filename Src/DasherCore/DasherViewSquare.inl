@@ -54,9 +54,9 @@ namespace Dasher {
     return x;
   }
 
-  inline myint CDasherViewSquare::xmap(myint x) const
+  template <bool bNonlinear> inline myint CDasherViewSquare::xmap(myint x) const
   {
-    if(GetLongParameter(LP_NONLINEAR_X) && x >= m_iXlogThres) {
+    if(bNonlinear && x >= m_iXlogThres) {
       double dx = log(1+ (x-m_iXlogThres)*m_dXlogCoeff/CDasherModel::MAX_Y)/m_dXlogCoeff;
       dx = (dx*CDasherModel::MAX_Y) + m_iXlogThres;
       x= myint(dx>0 ? ceil(dx) : floor(dx));
@@ -64,8 +64,13 @@ namespace Dasher {
     return x + iMarginWidth;
   }
 
-  inline myint CDasherViewSquare::ymap(myint y) const {
-    if (GetBoolParameter(BP_NONLINEAR_Y)) {
+  inline myint CDasherViewSquare::xmap(myint x) const
+  {
+    return GetLongParameter(LP_NONLINEAR_X) ? xmap<true>(x) : xmap<false>(x);
+  }
+
+  template <bool bNonlinear> inline myint CDasherViewSquare::ymap(myint y) const {
+    if (bNonlinear) {
       if(y > m_Y2)
         return m_Y2 + (y - m_Y2) / m_Y1;
       else if(y < m_Y3)
@@ -74,6 +79,17 @@ namespace Dasher {
     return y;
   }
 
+  inline myint CDasherViewSquare::ymap(myint y) const {
+    return GetBoolParameter(BP_NONLINEAR_Y) ? ymap<true>(y) : ymap<false>(y);
+  }
+
+  inline myint CDasherViewSquare::CustomIDivScaleFactor(myint iNumerator) {
+    //SCALE_FACTOR is a power of two, so dividing is a shift (of a positive
+    // number, so as not to depend on how >> treats negatives).
+    return iNumerator < 0 ? -((SCALE_FACTOR - 1 - iNumerator) >> SCALE_SHIFT)
+                          : (iNumerator + SCALE_FACTOR - 1) >> SCALE_SHIFT;
+  }
+
   inline myint CDasherViewSquare::iymap(myint ydash) const {
     if (GetBoolParameter(BP_NONLINEAR_Y)) {
       if(ydash > m_Y2)
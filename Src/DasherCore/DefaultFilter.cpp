@@ -28,7 +28,7 @@ bool CDefaultFilter::GetSettings(SModuleSettings **sets, int *iCount) {
 }
 
 CDefaultFilter::CDefaultFilter(CSettingsUser *pCreator, CDasherInterfaceBase *pInterface, CFrameRate *pFramerate, ModuleID_t iID, const char *szName)
-  : CDynamicFilter(pCreator, pInterface, pFramerate, iID, szName), CSettingsObserver(pCreator), m_bTurbo(false) {
+  : CDynamicFilter(pCreator, pInterface, pFramerate, iID, szName), CSettingsObserver(pCreator, {BP_CIRCLE_START, BP_MOUSEPOS_MODE, BP_TURBO_MODE}), m_bTurbo(false) {
   m_pStartHandler = 0;
   m_pAutoSpeedControl = new CAutoSpeedControl(this);
 
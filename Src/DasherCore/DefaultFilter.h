@@ -24,6 +24,8 @@ class CDefaultFilter : public CDynamicFilter, public CSettingsObserver {
   virtual void Deactivate();
   bool GetSettings(SModuleSettings **, int *);
   void pause();
+  ///As well as while running, frames are needed while the start handler is watching for a start
+  bool NeedsFrames() {return !isPaused() || (m_pStartHandler && m_pStartHandler->NeedsFrames());}
   //pauses, and calls the interface's Done() method
   void stop();
  protected:
@@ -13,6 +13,7 @@ using namespace Dasher;
 
 CDemoFilter::CDemoFilter(CSettingsUser *pCreator, CDasherInterfaceBase *pInterface, CFrameRate *pFramerate)
   : CDynamicFilter(pCreator, pInterface, pFramerate, 19, _("Demo Mode (no input)")),
+  CSettingsObserver(pCreator, {LP_DEMO_SPRING, LP_DEMO_NOISE_MEM, LP_MAX_BITRATE, LP_FRAMERATE}),
 m_dNoiseX(0.0), m_dNoiseY(0.0), m_iDemoX(0), m_iDemoY(0) {
 
 }
@@ -51,7 +52,8 @@ void CDemoFilter::Activate() {
 }
 
 void CDemoFilter::Deactivate() {
-  m_pInterface->LeaveGameMode();
+  //game mode may already have finished, at the end of the sentences file
+  if (m_pInterface->GetGameModule()) m_pInterface->LeaveGameMode();
 }
 
 std::pair<double,double> GaussianRand() // Is there a random number class already?
@@ -67,17 +69,29 @@ std::pair<double,double> GaussianRand() // Is there a random number class alread
 void CDemoFilter::Timer(unsigned long Time, CDasherView *m_pDasherView, CDasherInput *pInput, CDasherModel *m_pDasherModel, CExpansionPolicy **pol) {
   if (isPaused()) return;
   CGameModule *mod = (CGameModule *)m_pInterface->GetGameModule();
+  if (!mod) {
+    //no more sentences to write
+    pause();
+    return;
+  }
   const myint iTargetY(mod->m_iTargetY);
-  myint iCenterY = mod->ComputeBrachCenter();
 
   // ...and now calculate the ideal direction...
   double iIdealUnitVec[2];  
   
-  iIdealUnitVec[0] = double(CDasherModel::ORIGIN_Y<iTargetY?(iCenterY-CDasherModel::ORIGIN_Y):(CDasherModel::ORIGIN_Y-iCenterY));
-  iIdealUnitVec[1] = double(CDasherModel::ORIGIN_Y<iTargetY ? CDasherModel::ORIGIN_X : -CDasherModel::ORIGIN_X);
-  double mag = sqrt((double)(iIdealUnitVec[0]*iIdealUnitVec[0]+iIdealUnitVec[1]*iIdealUnitVec[1]));
-  iIdealUnitVec[0] = iIdealUnitVec[0]/mag;
-  iIdealUnitVec[1] = iIdealUnitVec[1]/mag;
+  if (iTargetY == CDasherModel::ORIGIN_Y) {
+    //target straight ahead: the brachistochrone is a straight line (its
+    // center is at infinity, so ComputeBrachCenter would divide by zero)
+    iIdealUnitVec[0] = -1.0;
+    iIdealUnitVec[1] = 0.0;
+  } else {
+    myint iCenterY = mod->ComputeBrachCenter();
+    iIdealUnitVec[0] = double(CDasherModel::ORIGIN_Y<iTargetY?(iCenterY-CDasherModel::ORIGIN_Y):(CDasherModel::ORIGIN_Y-iCenterY));
+    iIdealUnitVec[1] = double(CDasherModel::ORIGIN_Y<iTargetY ? CDasherModel::ORIGIN_X : -CDasherModel::ORIGIN_X);
+    double mag = sqrt((double)(iIdealUnitVec[0]*iIdealUnitVec[0]+iIdealUnitVec[1]*iIdealUnitVec[1]));
+    iIdealUnitVec[0] = iIdealUnitVec[0]/mag;
+    iIdealUnitVec[1] = iIdealUnitVec[1]/mag;
+  }
   
   // ...and then modify for realism... 
   // ...by adding noise...
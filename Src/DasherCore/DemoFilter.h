@@ -6,11 +6,12 @@
 namespace Dasher {
 /// \ingroup InputFilter
 /// @{
-class CDemoFilter : public CDynamicFilter {
+class CDemoFilter : public CDynamicFilter, public CSettingsObserver {
  public:
   CDemoFilter(CSettingsUser *pCreator, CDasherInterfaceBase *pInterface, CFrameRate *pFramerate);
   ~CDemoFilter();
 
+  ///Recomputes the spring and noise constants when speed or framerate change
   virtual void HandleEvent(int iParameter);
 
   virtual bool DecorateView(CDasherView *pView, CDasherInput *pInput);
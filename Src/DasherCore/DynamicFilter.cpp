@@ -25,24 +25,28 @@ using namespace Dasher;
 
 CDynamicFilter::CDynamicFilter(CSettingsUser *pCreator, CDasherInterfaceBase *pInterface, CFrameRate *pFramerate, ModuleID_t iID, const char *szName)
 : CInputFilter(pInterface, iID, szName), CSettingsUser(pCreator),
-  m_pFramerate(pFramerate), m_bPaused(true) {
+  m_pFramerate(pFramerate), m_iLastStepTime(0), m_bPaused(true) {
 }
 
 bool CDynamicFilter::OneStepTowards(CDasherModel *pModel, myint X, myint Y, unsigned long iTime, double dSpeedMul) {
+  //The step covers the time since the last (or since we started running), but
+  // after a long stall, don't leap: move as if the frame had been MAX_STEP_TIME.
+  const unsigned long iElapsed(iTime > m_iLastStepTime ? min(iTime - m_iLastStepTime, static_cast<unsigned long>(MAX_STEP_TIME)) : 0);
+  m_iLastStepTime = iTime;
   if (dSpeedMul<=0.0) return false; //going nowhere
   m_pFramerate->RecordFrame(iTime); //Hmmm, even if we don't do anything else?
 
-  // iSteps is the number of update steps we need to get the point
-  // under the cursor over to the cross hair. Calculated in order to
-  // keep a constant bit-rate.
-  const int iSteps(static_cast<int>(m_pFramerate->Steps() / dSpeedMul));
-  DASHER_ASSERT(iSteps > 0);
+  // dZoomTime is the time (ms) in which we'd bring the point under the
+  // cursor over to the cross hair. Calculated in order to keep a constant
+  // bit-rate.
+  const double dZoomTime(m_pFramerate->ZoomTime() / dSpeedMul);
   
   // If X is too large we risk overflow errors, so limit it
   // Not rescaling Y in this case: at that X, all Y's are nearly equivalent!
-  X = max(myint(1),min(X, myint(1<<29)/iSteps));
+  // (Limit is per substep, as those are what the model computes.)
+  X = max(myint(1), static_cast<myint>(min(double(X), double(1<<29) * CDasherModel::STEP_TIME / dZoomTime)));
   
-  pModel->ScheduleOneStep(Y-X, Y+X, iSteps, GetLongParameter(LP_X_LIMIT_SPEED), GetBoolParameter(BP_EXACT_DYNAMICS));
+  pModel->ScheduleOneStep(Y-X, Y+X, iElapsed, dZoomTime, GetLongParameter(LP_X_LIMIT_SPEED), GetBoolParameter(BP_EXACT_DYNAMICS));
   return true;
 }
 
@@ -63,5 +67,5 @@ void CDynamicFilter::run(unsigned long Time) {
   m_bPaused = false;
 
   m_pFramerate->Reset_framerate(Time);
-  m_iStartTime = Time;
+  m_iStartTime = m_iLastStepTime = Time;
 }
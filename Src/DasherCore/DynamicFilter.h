@@ -40,11 +40,14 @@ class CDynamicFilter : public CInputFilter, public CSettingsUser {
   virtual bool supportsPause() {return true;}
   
   void pause() {m_bPaused = true;}
+  bool isPaused() {return m_bPaused;}
+
+  ///Movement is continuous while running; when paused, we wait for input.
+  virtual bool NeedsFrames() {return !isPaused();}
   
  protected:
-  ///wraps Model's one-step method to compute the number of steps and minsize
-  /// (from framerate) that the Model requires, from just the frame time and a
-  /// multiplier to speed.
+  ///wraps Model's one-step method to compute the time elapsed and zoom time
+  /// that the Model requires, from just the frame time and a multiplier to speed.
   /// \param dSpeedMul multiply normal speed of movement by this; 1.0 = normal speed,
   /// 0.0 = go nowhere. This allows for slow start, turbo mode, control nodes being
   /// more "viscous", etc. Values <=0.0 will result in no movement
@@ -65,12 +68,16 @@ class CDynamicFilter : public CInputFilter, public CSettingsUser {
   /// initialize slow start.
 
   virtual void run(unsigned long iTime);
-  bool isPaused() {return m_bPaused;}
   
   CFrameRate * const m_pFramerate;
+
+  ///Longest time (ms) a single call to OneStepTowards will move for
+  static const unsigned long MAX_STEP_TIME = 200;
  private:
   //Time at which Unpause() was called, used for Slow Start.
   unsigned long m_iStartTime;
+  //Time of the last call to OneStepTowards (or run()), i.e. up to which we have moved
+  unsigned long m_iLastStepTime;
   bool m_bPaused;
 };
 }
@@ -18,10 +18,14 @@ void CExpansionPolicy::ExpandNode(CDasherNode *pNode) {
   m_pModel->ExpandNode(pNode);
 }
 
+void CExpansionPolicy::FlushEvents() {
+  m_pModel->FlushEvents();
+}
+
 bool Less(pair<double,CDasherNode *> x, pair<double, CDasherNode *> y) {return x.first < y.first;}
 bool More(pair<double,CDasherNode *> x, pair<double, CDasherNode *> y) {return x.first > y.first;}
   
-BudgettingPolicy::BudgettingPolicy(CDasherModel *pModel, unsigned int iNodeBudget) : CExpansionPolicy(pModel), m_iNodeBudget(iNodeBudget) {}
+BudgettingPolicy::BudgettingPolicy(CDasherModel *pModel, unsigned int iNodeBudget) : CExpansionPolicy(pModel), m_iNodeBudget(iNodeBudget), m_bBudgetLimited(false) {}
 
 double BudgettingPolicy::pushNode(CDasherNode *pNode, int iMin, int iMax, bool bExpand, double dParentCost) {
   double dRes = getCost(pNode, iMin, iMax);
@@ -57,6 +61,7 @@ bool BudgettingPolicy::apply() {
   
   //did we expand anything? (if so, there may be more opportunities for expansion next frame)
   bool bReturnValue = false;
+  m_bBudgetLimited = false;
 
   //maintain record of the highest cost we've incurred by collapsing a node;
   // avoid expanding anything LESS beneficial than that, as (even if we've room)
@@ -64,6 +69,11 @@ bool BudgettingPolicy::apply() {
   // collapsed node! Sadly we can't rely on trading one-for-one as different nodes
   // may have different numbers of children...)
   double collapseCost = -std::numeric_limits<double>::infinity();
+
+  //listeners to the model must see any nodes expanded earlier in the frame
+  // before we collapse anything (nodes expanded below can't be collapsed, as
+  // anything collapsed after them must be less costly than they are)
+  if (!sCollapse.empty()) FlushEvents();
   
   //first, make sure we are within our budget (probably only in case the budget's changed)
   while (!sCollapse.empty()
@@ -74,6 +84,7 @@ bool BudgettingPolicy::apply() {
     collapseCost = node.first;
     node.second->Delete_children();    
     sCollapse.pop_back();
+    m_bBudgetLimited = true;
   }
 
   //ok, we're now within budget. However, we may still wish to "trade off" nodes
@@ -97,9 +108,13 @@ bool BudgettingPolicy::apply() {
       collapseCost = node.first;
       node.second->Delete_children();
       sCollapse.pop_back();
+      m_bBudgetLimited = true;
       //...and see how much room that makes
     }
-    else break; //not enough room, nothing to collapse.
+    else {
+      m_bBudgetLimited = true;
+      break; //not enough room, nothing to collapse.
+    }
   }
   sExpand.clear();
   sCollapse.clear();
@@ -115,9 +130,9 @@ double BudgettingPolicy::getCost(CDasherNode *pNode, int iDasherMinY, int iDashe
   return getRange(iDasherMinY, iDasherMaxY, 0, 4096);
 }
 
-AmortizedPolicy::AmortizedPolicy(CDasherModel *pModel, unsigned int iNodeBudget) : BudgettingPolicy(pModel,iNodeBudget), m_iMaxExpands(std::max(1u,(500+iNodeBudget)/1000)) {}
+AmortizedPolicy::AmortizedPolicy(CDasherModel *pModel, unsigned int iNodeBudget) : BudgettingPolicy(pModel,iNodeBudget), m_iMaxExpands(std::max(1u,(500+iNodeBudget)/1000)), m_bTrimmed(false), m_bExpansionLimited(false) {}
 
-AmortizedPolicy::AmortizedPolicy(CDasherModel *pModel, unsigned int iNodeBudget, unsigned int iMaxExpands) : BudgettingPolicy(pModel, iNodeBudget), m_iMaxExpands(iMaxExpands) {}
+AmortizedPolicy::AmortizedPolicy(CDasherModel *pModel, unsigned int iNodeBudget, unsigned int iMaxExpands) : BudgettingPolicy(pModel, iNodeBudget), m_iMaxExpands(iMaxExpands), m_bTrimmed(false), m_bExpansionLimited(false) {}
 
 double AmortizedPolicy::pushNode(CDasherNode *node, int iMin, int iMax, bool bExpand, double dParentCost) {
   double dRes = BudgettingPolicy::pushNode(node,iMin,iMax,bExpand,dParentCost);
@@ -127,11 +142,15 @@ double AmortizedPolicy::pushNode(CDasherNode *node, int iMin, int iMax, bool bEx
 
 bool AmortizedPolicy::apply() {
   trim();
+  //trim may also have been called from pushNode, earlier in the frame
+  m_bExpansionLimited = m_bTrimmed;
+  m_bTrimmed = false;
   return BudgettingPolicy::apply();
 }
 
 void AmortizedPolicy::trim() {
   if (sExpand.size() <= m_iMaxExpands) return;
+  m_bTrimmed = true;
   //ok - repeatedly find a pivot element, and place it dividing all elements into
   //those more than it (in lower indices) and those less than it (in higher indices),
   // until we have separated off the <m_iMaxExpands> elements with greatest benefit
@@ -35,6 +35,9 @@ public:
   void ExpandNode(CDasherNode *pNode);
 protected:
   CExpansionPolicy(CDasherModel *pModel) : m_pModel(pModel) {}
+  ///Deliver any node events the model has queued for its BatchObservers;
+  /// subclasses must call before collapsing nodes. (Delegates to CDasherModel.)
+  void FlushEvents();
 private:
   CDasherModel *m_pModel;
 };
@@ -58,12 +61,19 @@ public:
   ///then adds to relevant queue
   double pushNode(CDasherNode *pNode, int iMin, int iMax, bool bExpand, double dParentCost) override;
   bool apply() override;
+  unsigned int GetNodeBudget() const {return m_iNodeBudget;}
+  ///Change the budget, e.g. as frames are taking too long; takes effect at the next apply().
+  void SetNodeBudget(unsigned int iNodeBudget) {m_iNodeBudget = iNodeBudget;}
+  ///Whether the last call to apply() was limited by the node budget, i.e. would
+  /// have expanded (more) nodes had there been room (or had to collapse some).
+  bool WasBudgetLimited() const {return m_bBudgetLimited;}
 protected:
   virtual double getCost(CDasherNode *pNode, int iDasherMinY, int iDasherMaxY);
   ///return the intersection of the ranges (y1-y2) and (iMin-iMax)
   int getRange(int y1, int y2, int iMin, int iMax);
   std::vector<std::pair<double,CDasherNode *> > sExpand, sCollapse;
   unsigned int m_iNodeBudget;
+  bool m_bBudgetLimited;
 };
 
 ///limits expansion to a few nodes (per instance i.e. per frame)
@@ -76,8 +86,16 @@ public:
   ~AmortizedPolicy() override = default;
   bool apply() override;
   double pushNode(CDasherNode *pNode, int iMin, int iMax, bool bExpand, double dParentCost) override;
+  unsigned int GetMaxExpands() const {return m_iMaxExpands;}
+  void SetMaxExpands(unsigned int iMaxExpands) {m_iMaxExpands = iMaxExpands;}
+  ///Whether the last call to apply() had more nodes it could have expanded than
+  /// the maximum number of expansions allowed
+  bool WasExpansionLimited() const {return m_bExpansionLimited;}
 private:
 	unsigned int m_iMaxExpands;
+  ///Whether trim() has discarded any nodes since the last apply()
+  bool m_bTrimmed;
+  bool m_bExpansionLimited;
   void trim();
 };
 }
@@ -0,0 +1,80 @@
+// FrameArena.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "FrameArena.h"
+
+#include <algorithm>
+
+using namespace Dasher;
+
+CFrameArena::CFrameArena(size_t iInitialSize) : m_iChunk(0), m_iUsed(0) {
+  SChunk c = {new char[iInitialSize], iInitialSize};
+  m_vChunks.push_back(c);
+}
+
+CFrameArena::~CFrameArena() {
+  for (std::vector<SChunk>::iterator it = m_vChunks.begin(); it != m_vChunks.end(); it++)
+    delete[] it->pData;
+}
+
+void *CFrameArena::Allocate(size_t iBytes, size_t iAlign) {
+  for (;;) {
+    SChunk &c(m_vChunks[m_iChunk]);
+    //align the address, not just the offset (operator new[] only guarantees alignof(max_align_t))
+    const size_t iAddr(reinterpret_cast<size_t>(c.pData) + m_iUsed);
+    const size_t iStart(m_iUsed + ((iAlign - iAddr % iAlign) % iAlign));
+    if (iStart + iBytes <= c.iSize) {
+      m_iUsed = iStart + iBytes;
+      return c.pData + iStart;
+    }
+    //Doesn't fit. Move onto the next chunk, replacing it with a bigger one if
+    // it's too small (it must be empty: scopes have reclaimed everything in it).
+    const size_t iSize(std::max(c.iSize * 2, iBytes + iAlign));
+    m_iChunk++; m_iUsed = 0;
+    if (m_iChunk == m_vChunks.size()) {
+      SChunk n = {new char[iSize], iSize};
+      m_vChunks.push_back(n);
+    } else if (m_vChunks[m_iChunk].iSize < iBytes + iAlign) {
+      delete[] m_vChunks[m_iChunk].pData;
+      m_vChunks[m_iChunk].pData = new char[iSize];
+      m_vChunks[m_iChunk].iSize = iSize;
+    }
+  }
+}
+
+void CFrameArena::Reset() {
+  m_iChunk = m_iUsed = 0;
+  if (m_vChunks.size() == 1) return;
+  const size_t iSize(Capacity());
+  for (std::vector<SChunk>::iterator it = m_vChunks.begin(); it != m_vChunks.end(); it++)
+    delete[] it->pData;
+  m_vChunks.resize(1);
+  m_vChunks[0].pData = new char[iSize];
+  m_vChunks[0].iSize = iSize;
+}
+
+size_t CFrameArena::Capacity() const {
+  size_t iSize(0);
+  for (std::vector<SChunk>::const_iterator it = m_vChunks.begin(); it != m_vChunks.end(); it++)
+    iSize += it->iSize;
+  return iSize;
+}
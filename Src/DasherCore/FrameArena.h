@@ -0,0 +1,137 @@
+// FrameArena.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __FrameArena_h__
+#define __FrameArena_h__
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Dasher {
+  class CFrameArena;
+  template <typename T> class CArenaVector;
+}
+
+/// \ingroup View
+/// @{
+
+/// Bump allocator for objects that live no longer than a frame (screen points,
+/// polygon buffers, delayed text), so that drawing a frame needs no calls to
+/// the heap once the arena has grown to the size a frame needs.
+///
+/// Allocation just advances a pointer within the current chunk, and memory is
+/// never freed individually: Reset() (at the start of each frame) reclaims the
+/// lot, and a CScope reclaims everything allocated during its lifetime (for
+/// primitives drawn outside the frame's node rendering, e.g. decorations).
+/// When a chunk fills, another is added; Reset() then replaces all chunks by
+/// one big enough for everything, so in steady state there is a single chunk.
+/// Only objects with trivial destructors may be put in the arena.
+class Dasher::CFrameArena {
+public:
+  CFrameArena(size_t iInitialSize = 16384);
+  ~CFrameArena();
+
+  ///Allocates uninitialized memory
+  /// \param iAlign alignment, must be a power of 2
+  void *Allocate(size_t iBytes, size_t iAlign);
+
+  ///Allocates an uninitialized array of n Ts
+  template <typename T> T *AllocArray(size_t n) {
+    static_assert(std::is_trivially_destructible<T>::value, "destructors of arena objects are never called");
+    return static_cast<T *>(Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  ///Constructs a T in the arena. (It will never be destroyed, so must not need to be.)
+  template <typename T, typename... Args> T *New(Args&&... args) {
+    static_assert(std::is_trivially_destructible<T>::value, "destructors of arena objects are never called");
+    return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  ///Reclaims everything allocated, consolidating into one chunk if more were needed.
+  void Reset();
+
+  ///Total bytes in all chunks
+  size_t Capacity() const;
+
+  ///Reclaims, on destruction, everything allocated from the arena since construction.
+  /// Scopes must be nested (i.e. destroyed in the reverse order of construction),
+  /// and must not span a Reset().
+  class CScope {
+  public:
+    CScope(CFrameArena &arena) : m_arena(arena), m_iChunk(arena.m_iChunk), m_iUsed(arena.m_iUsed) {}
+    ~CScope() {m_arena.m_iChunk = m_iChunk; m_arena.m_iUsed = m_iUsed;}
+  private:
+    CFrameArena &m_arena;
+    const size_t m_iChunk, m_iUsed;
+  };
+
+private:
+  CFrameArena(const CFrameArena &);
+  CFrameArena &operator=(const CFrameArena &);
+
+  struct SChunk {
+    char *pData;
+    size_t iSize;
+  };
+  std::vector<SChunk> m_vChunks;
+  ///Index of the chunk currently being allocated from
+  size_t m_iChunk;
+  ///Bytes used in that chunk
+  size_t m_iUsed;
+};
+
+/// A growable array in a CFrameArena, for the (few) elements of trivially
+/// copyable type that a drawing operation accumulates before handing them to
+/// the screen. When full, the elements are copied into a new array of twice the
+/// size, also in the arena; the old one is just abandoned (until the arena is
+/// Reset, or an enclosing CScope ends).
+template <typename T> class Dasher::CArenaVector {
+public:
+  CArenaVector(CFrameArena &arena, size_t iCapacity = 32)
+  : m_arena(arena), m_pData(arena.AllocArray<T>(iCapacity)), m_iSize(0), m_iCapacity(iCapacity) {
+    static_assert(std::is_trivially_copyable<T>::value, "elements are moved with memcpy");
+  }
+  void push_back(const T &t) {
+    if (m_iSize == m_iCapacity) {
+      T *pData(m_arena.AllocArray<T>(m_iCapacity *= 2));
+      memcpy(pData, m_pData, m_iSize * sizeof(T));
+      m_pData = pData;
+    }
+    m_pData[m_iSize++] = t;
+  }
+  T &back() {return m_pData[m_iSize-1];}
+  T &operator[](size_t i) {return m_pData[i];}
+  T *data() {return m_pData;}
+  size_t size() const {return m_iSize;}
+  bool empty() const {return m_iSize == 0;}
+private:
+  CArenaVector(const CArenaVector &);
+  CArenaVector &operator=(const CArenaVector &);
+  CFrameArena &m_arena;
+  T *m_pData;
+  size_t m_iSize, m_iCapacity;
+};
+/// @}
+
+#endif
@@ -3,7 +3,7 @@
 using namespace Dasher;
 
 CFrameRate::CFrameRate(CSettingsUser *pCreator) :
-  CSettingsUserObserver(pCreator) {
+  CSettingsUserObserver(pCreator, {LP_X_LIMIT_SPEED, LP_MAX_BITRATE}) {
 
   //Sampling parameters...
   m_iFrames = 0;
@@ -12,7 +12,7 @@ CFrameRate::CFrameRate(CSettingsUser *pCreator) :
 
   //try and carry on from where we left off at last run
   HandleEvent(LP_X_LIMIT_SPEED);
-  //Sets m_dBitsAtLimX and m_iSteps
+  //Sets m_dBitsAtLimX and m_dZoomTime
 }
 
 void CFrameRate::RecordFrame(unsigned long Time)
@@ -43,7 +43,7 @@ void CFrameRate::RecordFrame(unsigned long Time)
       m_iTime = m_iTime2;
       m_iFrames = 0;
 
-    DASHER_TRACEOUTPUT("Fr %f Steps %d Samples %d Time2 %d\n", dFrNow, m_iSteps, m_iSamples, m_iTime2);
+    DASHER_TRACEOUTPUT("Fr %f Samples %d Time2 %d\n", dFrNow, m_iSamples, m_iTime2);
 
     }
 
@@ -56,10 +56,8 @@ void CFrameRate::HandleEvent(int iParameter) {
       m_dBitsAtLimX = (log(static_cast<double>(CDasherModel::MAX_Y)) - log (2.*GetLongParameter(LP_X_LIMIT_SPEED)))/log(2.);
       //fallthrough
     case LP_MAX_BITRATE:
-    case LP_FRAMERATE:
-    //Calculate m_iSteps from the decaying-average framerate, as the number
-    // of steps that, at the X limit, will cause LP_MAX_BITRATE bits to be
-    // entered per second
-    m_iSteps = std::max(1,(int)(GetLongParameter(LP_FRAMERATE)*m_dBitsAtLimX/GetLongParameter(LP_MAX_BITRATE)));
+    //Calculate m_dZoomTime as the time (ms) which, at the X limit,
+    // will cause LP_MAX_BITRATE bits to be entered per second
+    m_dZoomTime = 100000.0*m_dBitsAtLimX/GetLongParameter(LP_MAX_BITRATE);
   }
 }
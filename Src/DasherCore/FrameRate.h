@@ -19,21 +19,21 @@ namespace Dasher {
 /// \{
 
 /// keeps the framerate (LP_FRAMERATE / 100.0) up-to-date,
-/// computes the Steps parameter,
-/// computes RXmax - which controls the maximum rate of zooming in
+/// computes the ZoomTime parameter, which controls the maximum rate of zooming in
 class CFrameRate : public CSettingsUserObserver  {
 public:
   CFrameRate(CSettingsUser *pCreator);
 
-  //Responds to a change to LP_FRAMERATE or LP_MAX_BITRATE
-  // by recomputing the Steps() parameter.
+  //Responds to a change to LP_X_LIMIT_SPEED or LP_MAX_BITRATE
+  // by recomputing the ZoomTime() parameter.
   virtual void HandleEvent(int iParameter);
 
-  ///The number of frames, in which we will attempt to bring
-  /// the target location (under the cursor, or in dynamic button
-  /// modes) to the crosshair. See DJW thesis.
-  int Steps() const {
-    return m_iSteps;
+  ///The time (ms) in which we will attempt to bring the target
+  /// location (under the cursor, or in dynamic button modes) to
+  /// the crosshair. See DJW thesis. (This used to be a number of
+  /// frames, making the speed depend on the frame rate.)
+  double ZoomTime() const {
+    return m_dZoomTime;
   }; 
 
   ///
@@ -56,7 +56,7 @@ private:
   ///number of frames over which we will compute average framerate
   int m_iSamples;
 
-  int m_iSteps;
+  double m_dZoomTime;
   
   double m_dBitsAtLimX;
 };
@@ -0,0 +1,57 @@
+// FrameScheduler.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "FrameScheduler.h"
+
+#include <chrono>
+
+using namespace Dasher;
+
+const long CFrameScheduler::NEVER;
+
+CFrameScheduler::CFrameScheduler() : m_iLastFrame(NEVER), m_iDue(NEVER) {
+}
+
+long long CFrameScheduler::Now() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void CFrameScheduler::FrameStarted(long long iNow) {
+  m_iLastFrame = iNow;
+  m_iDue = NEVER;
+}
+
+bool CFrameScheduler::RequestFrameAt(long long iTime) {
+  if (m_iDue != NEVER && m_iDue <= iTime) return false;
+  m_iDue = iTime;
+  return true;
+}
+
+long CFrameScheduler::GetDelay(long long iNow, long iMaxFrameRate) const {
+  if (m_iDue == NEVER) return NEVER;
+  long long iStart = m_iDue;
+  //don't start a frame until the minimum interval since the last has elapsed
+  if (iMaxFrameRate > 0 && m_iLastFrame != NEVER && iStart < m_iLastFrame + 1000000/iMaxFrameRate)
+    iStart = m_iLastFrame + 1000000/iMaxFrameRate;
+  return iStart <= iNow ? 0 : static_cast<long>(iStart - iNow);
+}
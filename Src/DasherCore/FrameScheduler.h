@@ -0,0 +1,75 @@
+// FrameScheduler.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __FrameScheduler_h__
+#define __FrameScheduler_h__
+
+namespace Dasher {
+  class CFrameScheduler;
+}
+
+/// \ingroup Core
+/// @{
+
+/// Keeps track of when the next frame is actually needed, so that platforms
+/// need not call NewFrame on a fixed timer. Requests for frames (from movement,
+/// redraws scheduled by the core, messages that time out, or input events)
+/// are coalesced into a single deadline; frames are never closer together than
+/// the frame-rate cap allows. All times are in microseconds, on the monotonic
+/// clock returned by Now() (not the millisecond timestamps passed to NewFrame,
+/// which come from whatever clock the platform chooses).
+class Dasher::CFrameScheduler {
+public:
+  ///GetDelay() value indicating no frame is needed until something requests one
+  static const long NEVER = -1;
+
+  CFrameScheduler();
+
+  ///Current time on a monotonic clock (unaffected by changes to the system
+  /// time), in microseconds since some arbitrary epoch
+  static long long Now();
+
+  ///Records that a frame is starting, and so satisfies all requests so far
+  void FrameStarted(long long iNow);
+
+  ///Requests a frame no later than the specified time (per Now())
+  /// \return true if this makes the next frame due sooner than before
+  bool RequestFrameAt(long long iTime);
+
+  ///Requests a frame as soon as the frame-rate cap allows
+  bool RequestFrame() {return RequestFrameAt(0);}
+
+  ///Whether any frame has been requested since the last one started
+  bool IsFrameRequested() const {return m_iDue != NEVER;}
+
+  ///Time until the next frame should start.
+  /// \param iMaxFrameRate frames per second; 0 for no cap
+  /// \return microseconds (0 = now), or NEVER if no frame has been requested
+  long GetDelay(long long iNow, long iMaxFrameRate) const;
+
+private:
+  ///Start time of the last frame, or NEVER before the first
+  long long m_iLastFrame;
+  ///Time by which the next frame has been requested, or NEVER
+  long long m_iDue;
+};
+/// @}
+
+#endif
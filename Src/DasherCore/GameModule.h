@@ -68,6 +68,12 @@ class CGameModule : protected CSettingsUser, protected TransientObserver<const C
   /// displayed to the user each time (s)he enters Game Mode.
   bool GetSettings(SModuleSettings **sets, int *count);
 
+  ///Statistics over all sentences completed so far: time spent writing them (ms),
+  /// information entered (nats), and number of symbols in them.
+  unsigned long GetTotalTime() const {return m_ulTotalTime;}
+  double GetTotalNats() const {return m_dTotalNats;}
+  unsigned int GetTotalSyms() const {return m_uiTotalSyms;}
+
 protected:
   ///Called after each successful call to GenerateChunk. Subclasses may override
   /// to do any necessary extra processing given the new chunk. Default does nothing.
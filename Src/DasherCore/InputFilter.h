@@ -62,6 +62,12 @@ class CInputFilter : public CDasherModule {
   /// user necessarily having finished the phrase); no if the filter will not
   /// enter bits without the user actively pushing buttons / performing input.
   virtual bool supportsPause() {return false;}
+
+  ///Whether Timer (and DecorateView) must be called every frame, even if nothing
+  /// else has changed; if false, frames are only rendered in response to input
+  /// events, movement of the model, or other requests for redraws. Default is
+  /// true, i.e. the filter may change things at any time.
+  virtual bool NeedsFrames() {return true;}
   
  protected:
   CDasherInterfaceBase * const m_pInterface;
@@ -77,6 +83,9 @@ class CInputFilter : public CDasherModule {
     : CInputFilter(pIntf, iId, szName), CSettingsUser(pCreator), m_pModel(NULL) {
     }
     void pause() {if (m_pModel) m_pModel->ClearScheduledSteps();}
+    ///Static filters only act on input events, and zooms they schedule keep
+    /// the frames coming by themselves, so by default need no other frames.
+    bool NeedsFrames() {return false;}
   protected:
     void ScheduleZoom(CDasherModel *pModel, myint y1, myint y2) {
       (m_pModel = pModel)->ScheduleZoom(y1,y2,GetLongParameter(LP_ZOOMSTEPS));
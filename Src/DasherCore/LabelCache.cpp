@@ -0,0 +1,81 @@
+// LabelCache.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "LabelCache.h"
+#include "FrameScheduler.h"
+#include "PerfTrace.h"
+
+using namespace Dasher;
+using std::pair;
+
+CLabelCache::CLabelCache(size_t iCapacity) : m_iCapacity(iCapacity) {
+}
+
+unsigned int CLabelCache::SizeBucket(unsigned int iSize) {
+  unsigned int iStep(1);
+  while (iSize >= 32*iStep) iStep *= 2;
+  return ((iSize + iStep/2) / iStep) * iStep;
+}
+
+pair<screenint,screenint> CLabelCache::TextSize(CDasherScreen *pScreen, CDasherScreen::Label *pLabel, unsigned int iFontSize) {
+  const Key key(pLabel->m_iId, iFontSize);
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>::iterator it = m_mIndex.find(key);
+  if (it != m_mIndex.end()) {
+    //hit: move to front
+    m_lEntries.splice(m_lEntries.begin(), m_lEntries, it->second);
+    return it->second->second;
+  }
+  const pair<screenint,screenint> dims(pScreen->TextSize(pLabel, iFontSize));
+  if (m_lEntries.size() < m_iCapacity)
+    m_lEntries.push_front(Entry(key, dims));
+  else {
+    //evict least recently used, reusing its list node
+    m_mIndex.erase(m_lEntries.back().first);
+    m_lEntries.splice(m_lEntries.begin(), m_lEntries, --m_lEntries.end());
+    m_lEntries.front() = Entry(key, dims);
+  }
+  m_mIndex[key] = m_lEntries.begin();
+  return dims;
+}
+
+void CLabelCache::Clear() {
+  m_lEntries.clear();
+  m_mIndex.clear();
+  m_vPrewarm.clear();
+}
+
+void CLabelCache::QueuePrewarm(CDasherScreen::Label *pLabel, unsigned int iFontSize) {
+  if (m_mIndex.find(Key(pLabel->m_iId, iFontSize)) == m_mIndex.end())
+    m_vPrewarm.push_back(pair<CDasherScreen::Label *, unsigned int>(pLabel, iFontSize));
+}
+
+unsigned int CLabelCache::Prewarm(CDasherScreen *pScreen, long long iDeadline) {
+  if (m_vPrewarm.empty()) return 0;
+  PERF_TRACE_SPAN("CLabelCache::Prewarm");
+  unsigned int i(0);
+  //always do at least one, so some progress is made however slow the frame
+  do {
+    TextSize(pScreen, m_vPrewarm[i].first, m_vPrewarm[i].second);
+  } while (++i < m_vPrewarm.size() && CFrameScheduler::Now() < iDeadline);
+  m_vPrewarm.clear();
+  return i;
+}
@@ -0,0 +1,104 @@
+// LabelCache.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __LabelCache_h__
+#define __LabelCache_h__
+
+#include "DasherScreen.h"
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Dasher {
+  class CLabelCache;
+}
+
+/// \ingroup View
+/// @{
+
+/// Caches the sizes of labels (as returned by CDasherScreen::TextSize), which
+/// may be expensive to compute (e.g. laying out the text) but are needed for
+/// every label on screen every frame.
+///
+/// Font sizes vary continuously with node size, so callers should round sizes
+/// with SizeBucket, to limit the number of distinct sizes used of any label
+/// (here and in the screen's own caches of layouts, etc.). The cache holds at
+/// most a fixed number of entries, evicting the least recently used.
+///
+/// Labels can also be queued to be measured ahead of being drawn (e.g. those
+/// of nodes just created, which will soon be onscreen), at a time when the
+/// frame has some time to spare: since computing the size on most platforms
+/// entails creating whatever is needed to draw the label, this also prepares
+/// the screen to draw it.
+class Dasher::CLabelCache {
+public:
+  ///\param iCapacity maximum number of (label,size) pairs to remember
+  CLabelCache(size_t iCapacity = 4096);
+
+  ///Rounds a font size to one of a smaller set of sizes: any size below
+  /// 32 is kept, above that sizes are rounded to within ~3%.
+  static unsigned int SizeBucket(unsigned int iSize);
+
+  ///Size of a label, from the cache if possible, else from the screen.
+  std::pair<screenint,screenint> TextSize(CDasherScreen *pScreen, CDasherScreen::Label *pLabel, unsigned int iFontSize);
+
+  ///Forget all sizes, e.g. if the font or screen has changed. Also empties the prewarm queue.
+  void Clear();
+
+  ///Queue a label to be measured by the next call to Prewarm, unless its size is known already.
+  /// The label must not be deleted before then, or ClearPrewarm must be called.
+  void QueuePrewarm(CDasherScreen::Label *pLabel, unsigned int iFontSize);
+
+  ///Measure labels queued by QueuePrewarm, in the order queued, until the deadline;
+  /// then discard any remaining.
+  /// \param iDeadline time to stop, per CFrameScheduler::Now()
+  /// \return number of labels measured
+  unsigned int Prewarm(CDasherScreen *pScreen, long long iDeadline);
+
+  ///Discards any labels queued for prewarming
+  void ClearPrewarm() {m_vPrewarm.clear();}
+
+  ///Adds the sizes cached, under "view/label-sizes", and the prewarm queue
+  void ReportMemory(CMemoryReport &report) const {
+    report.Add("view/label-sizes", m_lEntries.size(), m_lEntries.size() * (sizeof(Entry) + sizeof(std::list<Entry>::iterator)));
+    report.Add("view/label-prewarm", m_vPrewarm.size(), m_vPrewarm.capacity() * sizeof(m_vPrewarm[0]));
+  }
+
+private:
+  ///Label (by id, as labels may be deleted and others created at the same address) and font size
+  typedef std::pair<unsigned long, unsigned int> Key;
+  struct KeyHash {
+    size_t operator()(const Key &k) const {return std::hash<unsigned long>()(k.first * 64 + k.second);}
+  };
+  typedef std::pair<Key, std::pair<screenint,screenint> > Entry;
+  ///Cache entries, most recently used first
+  std::list<Entry> m_lEntries;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_mIndex;
+  const size_t m_iCapacity;
+
+  std::vector<std::pair<CDasherScreen::Label *, unsigned int> > m_vPrewarm;
+};
+/// @}
+
+#endif
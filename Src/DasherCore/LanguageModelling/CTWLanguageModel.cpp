@@ -24,6 +24,7 @@
 
 //#include "stdafx.h"
 #include "CTWLanguageModel.h"
+#include "../MemoryReport.h"
 #include <math.h> // not in use anymore? needed it for log
 #include <cstring>
 
@@ -431,6 +432,11 @@ void CCTWLanguageModel::GetProbs(Context context, std::vector<unsigned int> &Pro
 } // end function GetProbs
 
 
+void CCTWLanguageModel::ReportMemory(CMemoryReport &report) const {
+	report.Add("lm/ctw/nodes", TotalNodes, TotalNodes * sizeof(CCTWNode));
+	report.Add("lm/ctw/nodes/unused", MaxNrNodes - TotalNodes, (MaxNrNodes - TotalNodes) * sizeof(CCTWNode));
+}
+
 bool CCTWLanguageModel::WriteToFile(std::string strFilename, std::string AlphabetName){
 	SLMFileHeader GenericHeader;
 	// Magic number ("%DLF" in ASCII)
@@ -49,6 +49,7 @@ namespace Dasher {
     virtual void EnterSymbol(Context context, int Symbol); 
 	virtual void LearnSymbol(Context context, int Symbol); 	
 	virtual void GetProbs(Context context, std::vector < unsigned int >&Probs, int Norm, int iUniform) const; 
+	virtual void ReportMemory(CMemoryReport &report) const; // nodes in use, and the rest of the preallocated table
 	
 	Dasher::CHashTable HashTable; // Hashtable used for storing CCTWNodes in an array
       unsigned int MaxDepth;	// Maximum depth of the tree
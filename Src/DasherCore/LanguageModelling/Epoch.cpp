@@ -0,0 +1,140 @@
+// Epoch.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../../Common/Common.h"
+
+#include "Epoch.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+
+using namespace Dasher;
+using namespace std;
+
+std::atomic<unsigned long long> CEpoch::s_iEpoch(1);
+const unsigned int CEpoch::RECLAIM_BATCH;
+
+struct CEpoch::SSlot {
+  SSlot() : iEpoch(0), bOwned(true), iDepth(0) {}
+  ///Epoch at which the owner's outermost CReader began, or 0 if it is not reading
+  atomic<unsigned long long> iEpoch;
+  ///Whether some thread is using this slot
+  atomic<bool> bOwned;
+  ///Number of CReaders the owner is inside; only accessed by the owner
+  unsigned int iDepth;
+
+  ///All slots ever created, guarded by the mutex. Slots are never deleted,
+  /// so OldestReader can look at them while threads come and go.
+  struct SRegistry {
+    mutex m_mutex;
+    vector<SSlot *> m_vSlots;
+  };
+  static SRegistry &Registry() {
+    static SRegistry *pRegistry = new SRegistry();
+    return *pRegistry;
+  }
+
+  ///Holds a thread's slot, releasing it for reuse when the thread exits
+  class COwner {
+  public:
+    COwner() : m_pSlot(NULL) {}
+    ~COwner() {if (m_pSlot) m_pSlot->bOwned.store(false, memory_order_release);}
+    SSlot *Get() {
+      if (!m_pSlot) {
+        SRegistry &reg(Registry());
+        lock_guard<mutex> lock(reg.m_mutex);
+        for (size_t i=0; i<reg.m_vSlots.size(); i++)
+          if (!reg.m_vSlots[i]->bOwned.load(memory_order_acquire)) {
+            m_pSlot = reg.m_vSlots[i];
+            m_pSlot->bOwned.store(true, memory_order_relaxed);
+            return m_pSlot;
+          }
+        m_pSlot = new SSlot();
+        reg.m_vSlots.push_back(m_pSlot);
+      }
+      return m_pSlot;
+    }
+  private:
+    SSlot *m_pSlot;
+  };
+};
+
+CEpoch::SSlot *CEpoch::ThreadSlot() {
+  static thread_local SSlot::COwner owner;
+  return owner.Get();
+}
+
+CEpoch::CReader::CReader() : m_pSlot(ThreadSlot()) {
+  if (m_pSlot->iDepth++) return;
+  m_pSlot->iEpoch.store(s_iEpoch.load(memory_order_relaxed), memory_order_relaxed);
+  //Pairs with the fence in OldestReader: either the writer sees we are reading,
+  // or we see everything it published before it retired what it replaced.
+  atomic_thread_fence(memory_order_seq_cst);
+}
+
+CEpoch::CReader::~CReader() {
+  if (--m_pSlot->iDepth) return;
+  m_pSlot->iEpoch.store(0, memory_order_release);
+}
+
+unsigned long long CEpoch::OldestReader() {
+  atomic_thread_fence(memory_order_seq_cst);
+  SSlot::SRegistry &reg(SSlot::Registry());
+  lock_guard<mutex> lock(reg.m_mutex);
+  unsigned long long iOldest(numeric_limits<unsigned long long>::max());
+  for (size_t i=0; i<reg.m_vSlots.size(); i++) {
+    const unsigned long long iEpoch(reg.m_vSlots[i]->iEpoch.load(memory_order_acquire));
+    if (iEpoch) iOldest = min(iOldest, iEpoch);
+  }
+  return iOldest;
+}
+
+CEpoch::CRetireList::~CRetireList() {
+  for (size_t i=0; i<m_vRetired.size(); i++)
+    m_vRetired[i].pfnFree(m_vRetired[i].p);
+}
+
+void CEpoch::CRetireList::Retire(void *p, void (*pfnFree)(void *)) {
+  SRetired r;
+  //Readers beginning after this increment cannot reach p (the caller has
+  // already unlinked it), so need not hold it up.
+  r.iEpoch = s_iEpoch.fetch_add(1);
+  r.p = p;
+  r.pfnFree = pfnFree;
+  m_vRetired.push_back(r);
+  if (m_vRetired.size() >= m_iReclaimAt) {
+    Reclaim();
+    m_iReclaimAt = max(static_cast<size_t>(RECLAIM_BATCH), 2*m_vRetired.size());
+  }
+}
+
+void CEpoch::CRetireList::Reclaim() {
+  if (m_vRetired.empty()) return;
+  const unsigned long long iOldest(OldestReader());
+  size_t iKept(0);
+  for (size_t i=0; i<m_vRetired.size(); i++) {
+    if (m_vRetired[i].iEpoch < iOldest)
+      m_vRetired[i].pfnFree(m_vRetired[i].p);
+    else
+      m_vRetired[iKept++] = m_vRetired[i];
+  }
+  m_vRetired.resize(iKept);
+}
@@ -0,0 +1,102 @@
+// Epoch.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __LanguageModelling_Epoch_h__
+#define __LanguageModelling_Epoch_h__
+
+#include "../../Common/NoClones.h"
+
+#include <atomic>
+#include <vector>
+
+namespace Dasher {
+  class CEpoch;
+}
+
+/// \ingroup LM
+/// @{
+
+/// Epoch-based reclamation, letting a language model be read by many threads
+/// without locks while a single writer updates it (see CLanguageModel).
+///
+/// The writer never modifies anything a reader might be looking at, except by
+/// atomic stores; instead, it builds a replacement, publishes it (with a single
+/// release store), and retires the original to a CRetireList. Readers enclose
+/// each access in a CReader; memory retired while any reader that could have
+/// seen it remains inside its CReader is kept, and freed by a later Reclaim.
+///
+/// There is a single, process-wide, epoch counter, and each thread that has
+/// ever read has a slot recording the epoch at which its current read began
+/// (slots are reused when threads exit). Entering a CReader costs a store and
+/// a fence; nested CReaders on the same thread cost nothing more.
+class Dasher::CEpoch {
+  ///A thread's record of whether, and since which epoch, it is reading
+  struct SSlot;
+public:
+  ///Marks the calling thread as reading for the lifetime of the object.
+  class CReader : private NoClones {
+  public:
+    CReader();
+    ~CReader();
+  private:
+    SSlot *const m_pSlot;
+  };
+
+  ///Memory retired by one writer, and not yet freed. Only the writer (i.e. a
+  /// single thread at any one time) may call its methods.
+  class CRetireList : private NoClones {
+  public:
+    CRetireList() : m_iReclaimAt(RECLAIM_BATCH) {}
+    ///Frees everything retired, whether or not readers might be using it:
+    /// the owner must ensure there are none by the time it is destroyed.
+    ~CRetireList();
+    ///Arranges for pfnFree(p) to be called once no reader can be using p.
+    /// p must already be unreachable by any reader that has yet to start.
+    void Retire(void *p, void (*pfnFree)(void *));
+    ///Frees everything that no reader can still be using.
+    void Reclaim();
+  private:
+    struct SRetired {
+      ///Value of the epoch counter when retired; readers that began later cannot see it
+      unsigned long long iEpoch;
+      void *p;
+      void (*pfnFree)(void *);
+    };
+    std::vector<SRetired> m_vRetired;
+    ///Retire calls Reclaim when this many items are waiting: at least RECLAIM_BATCH,
+    /// and twice as many as a long-running reader last stopped us freeing.
+    size_t m_iReclaimAt;
+  };
+
+  static const unsigned int RECLAIM_BATCH = 64;
+
+private:
+  ///Incremented by each Retire; starts at 1, as a slot holding 0 is not reading.
+  static std::atomic<unsigned long long> s_iEpoch;
+  ///The smallest epoch at which any thread currently reading began,
+  /// or the maximum representable if none is.
+  static unsigned long long OldestReader();
+  ///The calling thread's slot, allocated or reused on first use
+  static SSlot *ThreadSlot();
+};
+
+/// @}
+
+#endif
@@ -0,0 +1,102 @@
+// LanguageModel.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../../Common/Common.h"
+
+#include "LanguageModel.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <thread>
+
+using namespace Dasher;
+using namespace std;
+
+///Calls fn(i, iBegin, iEnd) for each of up to iThreads chunks [iBegin,iEnd) of
+/// [0,iSize), all but the first on a new thread, returning when all are done.
+static void RunChunks(size_t iSize, unsigned int iThreads, const function<void(size_t, size_t)> &fn) {
+  const size_t iChunks(min<size_t>(max(1u, iThreads), iSize));
+  vector<thread> vThreads;
+  for (size_t i = 1; i < iChunks; i++)
+    vThreads.push_back(thread(fn, iSize*i/iChunks, iSize*(i+1)/iChunks));
+  if (iChunks) fn(0, iSize/iChunks);
+  for (size_t i = 0; i < vThreads.size(); i++) vThreads[i].join();
+}
+
+void CLanguageModel::GetProbsBatch(const vector<vector<symbol> > &vContexts, vector<vector<unsigned int> > &vProbs, int iNorm, int iUniform, unsigned int iThreads) {
+  vProbs.assign(vContexts.size(), vector<unsigned int>());
+  if (!SupportsConcurrentReaders()) iThreads = 1;
+  vector<size_t> vOrder(vContexts.size());
+  iota(vOrder.begin(), vOrder.end(), 0);
+  sort(vOrder.begin(), vOrder.end(), [&vContexts](size_t a, size_t b) {return vContexts[a] < vContexts[b];});
+
+  RunChunks(vOrder.size(), iThreads, [&](size_t iBegin, size_t iEnd) {
+    //vStack[i] is the context after the first i symbols of pPrev
+    vector<Context> vStack(1, CreateEmptyContext());
+    const vector<symbol> *pPrev = NULL;
+    for (size_t i = iBegin; i < iEnd; i++) {
+      const vector<symbol> &ctx(vContexts[vOrder[i]]);
+      size_t iCommon(0);
+      if (pPrev)
+        while (iCommon < ctx.size() && iCommon < pPrev->size() && ctx[iCommon] == (*pPrev)[iCommon]) iCommon++;
+      for (; vStack.size() > iCommon+1; vStack.pop_back()) ReleaseContext(vStack.back());
+      for (size_t j = iCommon; j < ctx.size(); j++) {
+        Context next = CloneContext(vStack.back());
+        EnterSymbol(next, ctx[j]);
+        vStack.push_back(next);
+      }
+      GetProbs(vStack.back(), vProbs[vOrder[i]], iNorm, iUniform);
+      pPrev = &ctx;
+    }
+    for (size_t j = 0; j < vStack.size(); j++) ReleaseContext(vStack[j]);
+  });
+}
+
+void CLanguageModel::GetSymbolProbs(const vector<symbol> &vCorpus, const vector<size_t> &vPositions, vector<unsigned int> &vProbs, int iNorm, int iUniform, unsigned int iThreads) {
+  DASHER_ASSERT(is_sorted(vPositions.begin(), vPositions.end()));
+  vProbs.resize(vPositions.size());
+  if (!SupportsConcurrentReaders()) iThreads = 1;
+  const size_t iLength(GetContextLength());
+
+  RunChunks(vPositions.size(), iThreads, [&](size_t iBegin, size_t iEnd) {
+    vector<unsigned int> vDist;
+    Context context = nullContext;
+    size_t iEntered(0); //symbols of vCorpus entered into context so far
+    for (size_t i = iBegin; i < iEnd; i++) {
+      const size_t iPos(vPositions[i]);
+      DASHER_ASSERT(iPos < vCorpus.size());
+      //the last iLength symbols before iPos that EnterSymbol doesn't ignore (i.e. not 0)
+      size_t iStart(iPos);
+      for (size_t iCount = 0; iStart > 0 && iCount < iLength; )
+        if (vCorpus[--iStart]) iCount++;
+      //start afresh if that's quicker than walking up to the position
+      if (!context || iStart > iEntered) {
+        if (context) ReleaseContext(context);
+        context = CreateEmptyContext();
+        iEntered = iStart;
+      }
+      for (; iEntered < iPos; iEntered++) EnterSymbol(context, vCorpus[iEntered]);
+      GetProbs(context, vDist, iNorm, iUniform);
+      vProbs[i] = vDist[vCorpus[iPos]];
+    }
+    if (context) ReleaseContext(context);
+  });
+}
@@ -10,14 +10,18 @@
 #define __LanguageModelling_LanguageModel_h__
 
 #include "../DasherTypes.h"
+#include "../../Common/NoClones.h"
 
 
 #include <vector>
+#include <iosfwd>
+#include <mutex>
 
 /////////////////////////////////////////////////////////////////////////////
 
 namespace Dasher {
   class CLanguageModel;
+  class CMemoryReport;
 }
 
 ///
@@ -82,7 +86,7 @@ public:
 
   ///
   /// Add character to the language model at the current context and update the context 
-  /// - modifies both the context and the LanguageModel
+  /// - modifies both the context and the LanguageModel. See CWriter.
   ///
 
   virtual void LearnSymbol(Context context, int Symbol) = 0;
@@ -101,6 +105,30 @@ public:
 
   /// @}
 
+  /// @name Batch prediction
+  /// Scoring many contexts in one call, e.g. held-out text when tuning LP_LM_ALPHA,
+  /// LP_LM_BETA or LP_LM_MAX_ORDER. The work is split between up to iThreads
+  /// threads if SupportsConcurrentReaders() (otherwise, done on the calling thread);
+  /// the model must not be learning meanwhile.
+  /// @{
+
+  ///Gets the distribution (as GetProbs) following each of several contexts, each
+  /// being the symbols to enter into an empty context. Contexts are visited in
+  /// sorted order, so that those with a common prefix share the walk along it.
+  /// \param vProbs receives one distribution per context, in the same order
+  void GetProbsBatch(const std::vector<std::vector<symbol> > &vContexts, std::vector<std::vector<unsigned int> > &vProbs, int iNorm, int iUniform, unsigned int iThreads=1);
+
+  ///Gets the probability (out of iNorm, as GetProbs) of the symbol at each of the
+  /// specified positions in a corpus, following all the symbols before it. Each
+  /// thread walks its own stretch of the corpus with a single context, starting
+  /// GetContextLength() symbols before the first position it scores (not counting
+  /// any 0s, which EnterSymbol ignores), so results match a serial walk.
+  /// \param vPositions indices into vCorpus, in ascending order
+  /// \param vProbs receives one probability per position
+  void GetSymbolProbs(const std::vector<symbol> &vCorpus, const std::vector<size_t> &vPositions, std::vector<unsigned int> &vProbs, int iNorm, int iUniform, unsigned int iThreads=1);
+
+  /// @}
+
   /// @name Persistant storage
   /// Binary representation of language model state
   /// @{
@@ -113,16 +141,70 @@ public:
     return false;
   };
 
+  ///Write the learned state of the model (not e.g. any contexts) to a stream.
+  /// \return true if the model supports this and the write succeeded.
+  virtual bool WriteToStream(std::ostream &out) {
+    return false;
+  };
+
+  ///Restore state written by WriteToStream. Only meaningful on a freshly-created
+  /// model with no contexts, which has not yet been trained.
+  /// \return true if the model supports this and the read succeeded; if false,
+  /// the model should be discarded.
+  virtual bool ReadFromStream(std::istream &in) {
+    return false;
+  };
+
   /// @}
 
   ///
-  /// Get the maximum useful context length for this language model
+  /// Get the maximum useful context length for this language model, i.e. the
+  /// number of symbols back beyond which entering more makes no difference to
+  /// predictions (GetSymbolProbs relies on this).
 
   virtual int GetContextLength() const {
     // TODO: Fix hard coded value
     return 5;
   };
 
+  ///Adds the objects making up the model, and the memory they use, to a report
+  /// (see CMemoryReport), under "lm/" and then the kind of model. Models
+  /// supporting concurrent readers may report while learning, otherwise the
+  /// caller must ensure nothing else is using the model. The default adds nothing.
+  virtual void ReportMemory(CMemoryReport &report) const {}
+
+  /// @name Concurrency
+  /// By default, callers must ensure that no two methods of a language model run
+  /// at once. Models for which SupportsConcurrentReaders() is true relax this:
+  ///  - CreateEmptyContext, CloneContext, EnterSymbol, ReleaseContext, GetProbs,
+  ///    GetContextLength and WriteToStream may be called by any number of threads
+  ///    at once, including while the model is learning. Several threads may read
+  ///    the same context, but EnterSymbol or ReleaseContext on a context requires
+  ///    that no other thread be using it. WriteToStream waits for (and then
+  ///    holds) the writer lane, so must not be called by a thread holding a CWriter.
+  ///  - LearnSymbol calls are serialised by holding a CWriter. Each change the
+  ///    writer makes is published atomically, so a concurrent GetProbs sees each
+  ///    count either before or after an update, and always returns a valid
+  ///    distribution.
+  ///  - ReadFromStream and ReadFromFile may only be called before anything else.
+  /// @{
+
+  virtual bool SupportsConcurrentReaders() const {
+    return false;
+  };
+
+  ///Holds the model's single writer lane (a mutex) for its lifetime; construct one
+  /// around calls to LearnSymbol. Training should hold one for a whole batch of
+  /// text rather than per symbol.
+  class CWriter : private NoClones {
+  public:
+    CWriter(CLanguageModel *pLM) : m_lock(pLM->m_writerMutex) {}
+  private:
+    std::lock_guard<std::mutex> m_lock;
+  };
+
+  /// @}
+
  protected:
   struct SLMFileHeader {
     // Magic number ("%DLF" in ASCII)
@@ -150,6 +232,9 @@ public:
 
   const int m_iNumSyms;
 
+ private:
+  ///Held by CWriter
+  std::mutex m_writerMutex;
 };
 
 /// @}
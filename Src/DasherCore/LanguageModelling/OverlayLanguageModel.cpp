@@ -0,0 +1,118 @@
+// OverlayLanguageModel.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../../Common/Common.h"
+
+#include "OverlayLanguageModel.h"
+#include "../MemoryReport.h"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+using namespace Dasher;
+
+const unsigned int COverlayLanguageModel::HALF_SHARE_SYMBOLS;
+
+COverlayLanguageModel::COverlayLanguageModel(CSettingsUser *pCreator, int iNumSyms, CLanguageModel *pShared)
+: CLanguageModel(iNumSyms), CSettingsUser(pCreator), m_pShared(pShared),
+  m_overlay(pCreator, iNumSyms), m_iLearnt(0), m_ContextAlloc(1024) {
+  DASHER_ASSERT(pShared->SupportsConcurrentReaders());
+}
+
+COverlayLanguageModel::~COverlayLanguageModel() {
+  //contexts should all have been released by now; the pool frees its blocks itself
+}
+
+CLanguageModel::Context COverlayLanguageModel::CreateEmptyContext() {
+  SContext *pCont = m_ContextAlloc.Alloc();
+  pCont->shared = m_pShared->CreateEmptyContext();
+  pCont->overlay = m_overlay.CreateEmptyContext();
+  return reinterpret_cast<Context>(pCont);
+}
+
+CLanguageModel::Context COverlayLanguageModel::CloneContext(Context context) {
+  const SContext *pCopy = reinterpret_cast<const SContext *>(context);
+  SContext *pCont = m_ContextAlloc.Alloc();
+  pCont->shared = m_pShared->CloneContext(pCopy->shared);
+  pCont->overlay = m_overlay.CloneContext(pCopy->overlay);
+  return reinterpret_cast<Context>(pCont);
+}
+
+void COverlayLanguageModel::ReleaseContext(Context context) {
+  SContext *pCont = reinterpret_cast<SContext *>(context);
+  m_pShared->ReleaseContext(pCont->shared);
+  m_overlay.ReleaseContext(pCont->overlay);
+  m_ContextAlloc.Free(pCont);
+}
+
+void COverlayLanguageModel::EnterSymbol(Context context, int Symbol) {
+  SContext *pCont = reinterpret_cast<SContext *>(context);
+  m_pShared->EnterSymbol(pCont->shared, Symbol);
+  m_overlay.EnterSymbol(pCont->overlay, Symbol);
+}
+
+void COverlayLanguageModel::LearnSymbol(Context context, int Symbol) {
+  SContext *pCont = reinterpret_cast<SContext *>(context);
+  m_pShared->EnterSymbol(pCont->shared, Symbol);
+  m_overlay.LearnSymbol(pCont->overlay, Symbol);
+  m_iLearnt++;
+}
+
+void COverlayLanguageModel::GetProbs(Context context, std::vector<unsigned int> &Probs, int iNorm, int iUniform) const {
+  const SContext *pCont = reinterpret_cast<const SContext *>(context);
+  //overlay gets a share of LP_LM_MIXTURE% * n/(n+HALF_SHARE_SYMBOLS), i.e. none until it has learnt something
+  const double dShare(std::min(std::max(GetLongParameter(LP_LM_MIXTURE), 0L), 100L) / 100.0
+                      * m_iLearnt / (m_iLearnt + static_cast<double>(HALF_SHARE_SYMBOLS)));
+  const int iOverlayNorm(static_cast<int>(iNorm * dShare));
+  if (iOverlayNorm == 0) {
+    m_pShared->GetProbs(pCont->shared, Probs, iNorm, iUniform);
+    return;
+  }
+  const int iOverlayUniform(static_cast<int>(iUniform * dShare));
+  std::vector<unsigned int> vOverlay;
+  m_pShared->GetProbs(pCont->shared, Probs, iNorm - iOverlayNorm, iUniform - iOverlayUniform);
+  m_overlay.GetProbs(pCont->overlay, vOverlay, iOverlayNorm, iOverlayUniform);
+  for (size_t i = 1; i < Probs.size(); i++)
+    Probs[i] += vOverlay[i];
+}
+
+bool COverlayLanguageModel::WriteToStream(std::ostream &out) {
+  const unsigned int iLearnt(m_iLearnt);
+  out.write(reinterpret_cast<const char *>(&iLearnt), sizeof(iLearnt));
+  return m_overlay.WriteToStream(out);
+}
+
+bool COverlayLanguageModel::ReadFromStream(std::istream &in) {
+  unsigned int iLearnt;
+  if (!in.read(reinterpret_cast<char *>(&iLearnt), sizeof(iLearnt))) return false;
+  if (!m_overlay.ReadFromStream(in)) return false;
+  m_iLearnt = iLearnt;
+  return true;
+}
+
+int COverlayLanguageModel::GetContextLength() const {
+  return std::max(m_pShared->GetContextLength(), m_overlay.GetContextLength());
+}
+
+void COverlayLanguageModel::ReportMemory(CMemoryReport &report) const {
+  CMemoryReport::CScope scope(report, "overlay/");
+  m_overlay.ReportMemory(report);
+}
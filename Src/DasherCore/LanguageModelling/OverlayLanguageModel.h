@@ -0,0 +1,80 @@
+// OverlayLanguageModel.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __LanguageModelling_OverlayLanguageModel_h__
+#define __LanguageModelling_OverlayLanguageModel_h__
+
+#include "../../Common/Allocators/PooledAlloc.h"
+
+#include "PPMLanguageModel.h"
+
+namespace Dasher {
+
+  /// \ingroup LM
+  /// @{
+
+  ///Private, adaptive, view of a shared language model: predicts by mixing the
+  /// shared model with a (small) PPM model of its own, which learns everything
+  /// passed to LearnSymbol. The shared model is only ever read, via EnterSymbol
+  /// and GetProbs, so many overlays (e.g. one per session of a server) may use
+  /// it at once from different threads; it must SupportsConcurrentReaders() and
+  /// outlive them all.
+  ///
+  /// The overlay's share of the probability mass grows with the number of
+  /// symbols it has learnt, up to LP_LM_MIXTURE percent. WriteToStream and
+  /// ReadFromStream save and restore only the overlay.
+  class COverlayLanguageModel : public CLanguageModel, protected CSettingsUser, private NoClones {
+  public:
+    ///\param iNumSyms number of symbols, which must be the same as for pShared
+    COverlayLanguageModel(CSettingsUser *pCreator, int iNumSyms, CLanguageModel *pShared);
+    virtual ~COverlayLanguageModel();
+
+    virtual Context CreateEmptyContext();
+    virtual Context CloneContext(Context context);
+    virtual void ReleaseContext(Context context);
+    virtual void EnterSymbol(Context context, int Symbol);
+    ///Learns in the overlay only; the shared model's context just moves on.
+    virtual void LearnSymbol(Context context, int Symbol);
+    virtual void GetProbs(Context context, std::vector<unsigned int> &Probs, int iNorm, int iUniform) const;
+    virtual bool WriteToStream(std::ostream &out);
+    virtual bool ReadFromStream(std::istream &in);
+    virtual int GetContextLength() const;
+    ///Reports the overlay's own model, under "overlay/", but not the shared one
+    /// (which its owner should report, once however many overlays use it)
+    virtual void ReportMemory(CMemoryReport &report) const;
+
+    ///Number of symbols learnt after which the overlay has half its maximum share
+    static const unsigned int HALF_SHARE_SYMBOLS = 2000;
+
+  private:
+    struct SContext {
+      Context shared, overlay;
+    };
+    CLanguageModel * const m_pShared;
+    CPPMLanguageModel m_overlay;
+    ///Symbols learnt by m_overlay, including any read by ReadFromStream
+    unsigned int m_iLearnt;
+    CPooledAlloc<SContext> m_ContextAlloc;
+  };
+
+  /// @}
+}
+
+#endif
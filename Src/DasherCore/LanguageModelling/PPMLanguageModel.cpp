@@ -8,9 +8,11 @@
 
 #include "../../Common/Common.h"
 #include "PPMLanguageModel.h"
+#include "../MemoryReport.h"
 
 #include <math.h>
 #include <string.h>
+#include <new>
 #include <stack>
 #include <sstream>
 #include <iostream>
@@ -38,6 +40,7 @@ CAbstractPPM::CAbstractPPM(CSettingsUser *pCreator, int iNumSyms, CPPMnode *pRoo
 }
 
 bool CAbstractPPM::isValidContext(const Context context) const {
+  lock_guard<mutex> lock(m_ContextMutex);
   return m_setContexts.count((const CPPMContext *)context) > 0;
 }
 
@@ -45,6 +48,7 @@ bool CAbstractPPM::isValidContext(const Context context) const {
 // Get the probability distribution at the context
 
 void CPPMLanguageModel::GetProbs(Context context, std::vector<unsigned int> &probs, int norm, int iUniform) const {
+  CEpoch::CReader reader;
   const CPPMContext *ppmcontext = (const CPPMContext *)(context);
 
   DASHER_ASSERT(isValidContext(context));
@@ -77,24 +81,31 @@ void CPPMLanguageModel::GetProbs(Context context, std::vector<unsigned int> &pro
   int alpha = GetLongParameter( LP_LM_ALPHA );
   int beta = GetLongParameter( LP_LM_BETA );
 
+  //(symbol, count) of each child at the current level. The writer may be adding
+  // children or counts while we read, so we read each once, and use only those.
+  std::vector<std::pair<symbol, unsigned int> > vChildren;
+  vChildren.reserve(iNumSymbols);
+
   for (CPPMnode *pTemp = ppmcontext->head; pTemp; pTemp=pTemp->vine) {
     int iTotal = 0;
 
+    vChildren.clear();
     for (ChildIterator pSymbol = pTemp->children(); pSymbol != pTemp->end(); pSymbol++) {
       symbol sym = (*pSymbol)->sym;
+      vChildren.push_back(std::make_pair(sym, static_cast<unsigned int>((*pSymbol)->count())));
       if(!(exclusions[sym] && doExclusion))
-        iTotal += (*pSymbol)->count;
+        iTotal += vChildren.back().second;
     }
 
     if(iTotal) {
       unsigned int size_of_slice = iToSpend;
-      for (ChildIterator pSymbol = pTemp->children(); pSymbol != pTemp->end(); pSymbol++) {
-        if(!(exclusions[(*pSymbol)->sym] && doExclusion)) {
-          exclusions[(*pSymbol)->sym] = 1;
+      for (std::vector<std::pair<symbol, unsigned int> >::const_iterator it = vChildren.begin(); it != vChildren.end(); it++) {
+        if(!(exclusions[it->first] && doExclusion)) {
+          exclusions[it->first] = 1;
 
-          unsigned int p = static_cast < myint > (size_of_slice) * (100 * (*pSymbol)->count - beta) / (100 * iTotal + alpha);
+          unsigned int p = static_cast < myint > (size_of_slice) * (100 * it->second - beta) / (100 * iTotal + alpha);
 
-          probs[(*pSymbol)->sym] += p;
+          probs[it->first] += p;
           iToSpend -= p;
         }
         //                              Usprintf(debug,TEXT("sym %u counts %d p %u tospend %u \n"),sym,s->count,p,tospend);      
@@ -151,6 +162,7 @@ void CAbstractPPM::EnterSymbol(Context c, int Symbol) {
 
   DASHER_ASSERT(Symbol >= 0 && Symbol < GetSize());
 
+  CEpoch::CReader reader;
   CPPMContext & context = *(CPPMContext *) (c);
 
   while(context.head) {
@@ -313,7 +325,7 @@ bool CAbstractPPM::eq(CAbstractPPM *other) {
 bool CAbstractPPM::CPPMnode::eq(CAbstractPPM::CPPMnode *other, std::map<CPPMnode *,CPPMnode *> &equivs) {
   if (sym != other->sym)
     return false;
-  if (count != other->count)
+  if (count() != other->count())
     return false;
   //check children....but allow for different orders by sorting into symbol order
   std::map<symbol, CPPMnode *> thisCh, otherCh;
@@ -333,22 +345,27 @@ bool CAbstractPPM::CPPMnode::eq(CAbstractPPM::CPPMnode *other, std::map<CPPMnode
 CAbstractPPM::CPPMnode * CAbstractPPM::CPPMnode::find_symbol(symbol sym) const
 // see if symbol is a child of node
 {
-  if (m_iNumChildSlots < 0) //negative to mean "full alphabet", use direct indexing
-    return m_ppChildren[sym];
-  if (m_iNumChildSlots == 1) {
-    if (m_pChild->sym == sym)
-      return m_pChild;
-    return 0;
+  const uintptr_t children = m_children.load(memory_order_acquire);
+  if (!(children & 1)) { //no children, or a single child
+    CPPMnode *pChild = reinterpret_cast<CPPMnode *>(children);
+    return (pChild && pChild->sym == sym) ? pChild : 0;
   }
-  if (m_iNumChildSlots <= MAX_RUN) {
-    for (int i = 0; i < m_iNumChildSlots && m_ppChildren[i]; i++)
-      if (m_ppChildren[i]->sym == sym) return m_ppChildren[i];
+  const SChildArray *pArray = reinterpret_cast<const SChildArray *>(children & ~uintptr_t(1));
+  const int iNumSlots = pArray->iNumSlots;
+  if (iNumSlots < 0) //negative to mean "full alphabet", use direct indexing
+    return pArray->aChildren[sym].load(memory_order_acquire);
+  if (iNumSlots <= MAX_RUN) {
+    for (int i = 0; i < iNumSlots; i++) {
+      CPPMnode *found = pArray->aChildren[i].load(memory_order_acquire);
+      if (!found) return 0;
+      if (found->sym == sym) return found;
+    }
     return 0;
   }
   //  printf("finding symbol %d at node %d\n",sym,node->id);
 
   for (int i = sym; ; i++) { //search through elements which have overflowed into subsequent slots
-    CPPMnode *found = this->m_ppChildren[i % m_iNumChildSlots]; //wrap round
+    CPPMnode *found = pArray->aChildren[i % iNumSlots].load(memory_order_acquire); //wrap round
     if (!found) return 0; //null element
     if(found->sym == sym) {
       return found;
@@ -357,66 +374,118 @@ CAbstractPPM::CPPMnode * CAbstractPPM::CPPMnode::find_symbol(symbol sym) const
   return 0;
 }
 
-void CAbstractPPM::CPPMnode::AddChild(CPPMnode *pNewChild, int numSymbols) {
-  if (m_iNumChildSlots < 0) {
-    m_ppChildren[pNewChild->sym] = pNewChild;
+CAbstractPPM::SChildArray *CAbstractPPM::SChildArray::Make(int iNumSlots) {
+  const int iElems = abs(iNumSlots);
+  void *pMem = ::operator new(sizeof(SChildArray) + (iElems - 1) * sizeof(std::atomic<CPPMnode *>));
+  SChildArray *pArray = new (pMem) SChildArray();
+  pArray->iNumSlots = iNumSlots;
+  for (int i = 0; i < iElems; i++) new (&pArray->aChildren[i]) std::atomic<CPPMnode *>(NULL);
+  return pArray;
+}
+
+void CAbstractPPM::SChildArray::Free(void *pArray) {
+  //the elements (atomic pointers) need no destruction
+  ::operator delete(pArray);
+}
+
+bool CAbstractPPM::SChildArray::Insert(CPPMnode *pNewChild) {
+  if (iNumSlots < 0) {
+    aChildren[pNewChild->sym].store(pNewChild, memory_order_release);
+    return true;
   }
-  else 
-  {
-    if (m_iNumChildSlots == 0) {
-      m_iNumChildSlots = 1;
-      m_pChild = pNewChild;
-      return;
-    } else if (m_iNumChildSlots == 1) {
-      //no room, have to resize...
-    } else if (m_iNumChildSlots<=MAX_RUN) {
-      for (int i = 0; i < m_iNumChildSlots; i++)
-        if (!m_ppChildren[i]) {
-          m_ppChildren[i] = pNewChild;
-          return;
-        }
-    } else {
-      
-
-      int start = pNewChild->sym;
-      //find length of run (including to-be-inserted element)....
-      while (m_ppChildren[start = (start + m_iNumChildSlots - 1) % m_iNumChildSlots]);
-
-      int idx = pNewChild->sym;
-      while (m_ppChildren[idx %= m_iNumChildSlots]) ++idx;
-      //found NULL
-      int stop = idx;
-      while (m_ppChildren[stop = (stop + 1) % m_iNumChildSlots]);
-      //start and idx point to NULLs (with inserted element somewhere inbetween)
-      
-      int runLen = (m_iNumChildSlots + stop - (start+1)) % m_iNumChildSlots;
-      if (runLen <= MAX_RUN) {
-        //ok, maintain size
-        m_ppChildren[idx] = pNewChild;
-        return;
+  if (iNumSlots <= MAX_RUN) {
+    for (int i = 0; i < iNumSlots; i++)
+      if (!aChildren[i].load(memory_order_relaxed)) {
+        aChildren[i].store(pNewChild, memory_order_release);
+        return true;
       }
+    return false;
+  }
+  //Only the writer calls this, so it sees its own stores without ordering
+  auto slot = [this](int i) {return aChildren[i].load(memory_order_relaxed);};
+  int start = pNewChild->sym;
+  //find length of run (including to-be-inserted element)....
+  while (slot(start = (start + iNumSlots - 1) % iNumSlots));
+
+  int idx = pNewChild->sym;
+  while (slot(idx %= iNumSlots)) ++idx;
+  //found NULL
+  int stop = idx;
+  while (slot(stop = (stop + 1) % iNumSlots));
+  //start and idx point to NULLs (with inserted element somewhere inbetween)
+
+  int runLen = (iNumSlots + stop - (start+1)) % iNumSlots;
+  if (runLen > MAX_RUN) return false;
+  //ok, maintain size. Readers probing the run either see the new child, or
+  // stop at the NULL it replaces; either way, consistently.
+  aChildren[idx].store(pNewChild, memory_order_release);
+  return true;
+}
+
+void CAbstractPPM::CPPMnode::AddChild(CPPMnode *pNewChild, int numSymbols, CEpoch::CRetireList &retired) {
+  const uintptr_t children = m_children.load(memory_order_relaxed);
+  if (!children) {
+    m_children.store(reinterpret_cast<uintptr_t>(pNewChild), memory_order_release);
+    return;
+  }
+  SChildArray *pOld = (children & 1) ? reinterpret_cast<SChildArray *>(children & ~uintptr_t(1)) : NULL;
+  if (pOld && pOld->Insert(pNewChild)) return;
+  //no room, have to resize. Build the new array where readers cannot see it,
+  // growing further if any run (in a hash) turns out too long.
+  int oldSlots = pOld ? pOld->iNumSlots : 1;
+  for (int iNumSlots = oldSlots; ; ) {
+    if (iNumSlots >= numSymbols/4)
+      iNumSlots = -numSymbols; // negative = "use direct indexing"
+    else
+      iNumSlots += iNumSlots+1;
+    SChildArray *pNew = SChildArray::Make(iNumSlots);
+    bool bFits = true;
+    if (!pOld)
+      bFits = pNew->Insert(reinterpret_cast<CPPMnode *>(children));
+    else
+      for (int i = abs(oldSlots); bFits && i-- > 0; )
+        if (CPPMnode *pChild = pOld->aChildren[i].load(memory_order_relaxed)) bFits = pNew->Insert(pChild);
+    if (bFits && pNew->Insert(pNewChild)) {
+      m_children.store(reinterpret_cast<uintptr_t>(pNew) | 1, memory_order_release);
+      if (pOld) retired.Retire(pOld, &SChildArray::Free);
+      return;
     }
-    //resize!
-    CPPMnode **oldChildren = m_ppChildren;
-    int oldSlots = m_iNumChildSlots;
-    int newNumElems;
-    if (m_iNumChildSlots >= numSymbols/4) {
-      m_iNumChildSlots = -numSymbols; // negative = "use direct indexing"
-      newNumElems = numSymbols;
-    } else {
-      m_iNumChildSlots+=m_iNumChildSlots+1;
-      newNumElems = m_iNumChildSlots;
-    }
-    m_ppChildren = new CPPMnode *[newNumElems]; //null terminator
-    memset (m_ppChildren, 0, sizeof(CPPMnode *)*newNumElems);
-    if (oldSlots == 1)
-      AddChild((CPPMnode *)oldChildren, numSymbols);
-    else {
-      while (oldSlots-- > 0) if (oldChildren[oldSlots]) AddChild(oldChildren[oldSlots], numSymbols);
-      delete[] oldChildren;
+    SChildArray::Free(pNew);
+  }
+}
+
+void CAbstractPPM::CPPMnode::ReportMemory(CMemoryReport &report, size_t iBytes) const {
+  const uintptr_t children = m_children.load(memory_order_acquire);
+  if (!(children & 1)) {
+    report.Add(children ? "lm/ppm/nodes/single" : "lm/ppm/nodes/leaf", 1, iBytes);
+    return;
+  }
+  const SChildArray *pArray = reinterpret_cast<const SChildArray *>(children & ~uintptr_t(1));
+  const int iElems = abs(pArray->iNumSlots);
+  const char *szKind = pArray->iNumSlots < 0 ? "direct" : pArray->iNumSlots <= MAX_RUN ? "run" : "hash";
+  const size_t iSlotBytes = sizeof(std::atomic<CPPMnode *>);
+  int iUnused = 0;
+  for (int i = 0; i < iElems; i++)
+    if (!pArray->aChildren[i].load(memory_order_relaxed)) iUnused++;
+  report.Add(string("lm/ppm/nodes/") + szKind, 1, iBytes);
+  //the array, less its empty slots (the array always holds at least one child)
+  report.Add(string("lm/ppm/children/") + szKind, 1, sizeof(SChildArray) + (iElems - iUnused - 1) * iSlotBytes);
+  report.Add(string("lm/ppm/children/") + szKind + "/unused", iUnused, iUnused * iSlotBytes);
+}
+
+void CAbstractPPM::ReportMemory(CMemoryReport &report) const {
+  {
+    CEpoch::CReader reader;
+    vector<const CPPMnode *> vStack(1, m_pRoot);
+    while (!vStack.empty()) {
+      const CPPMnode *pNode = vStack.back();
+      vStack.pop_back();
+      pNode->ReportMemory(report, NodeBytes(pNode));
+      for (ChildIterator it = pNode->children(); it != pNode->end(); it++) vStack.push_back(*it);
     }
-    AddChild(pNewChild, numSymbols);
   }
+  lock_guard<mutex> lock(m_ContextMutex);
+  report.Add("lm/ppm/contexts", m_setContexts.size(), m_setContexts.size() * sizeof(CPPMContext));
 }
 
 CAbstractPPM::CPPMnode * CAbstractPPM::AddSymbolToNode(CPPMnode *pNode, symbol sym) {
@@ -426,19 +495,20 @@ CAbstractPPM::CPPMnode * CAbstractPPM::AddSymbolToNode(CPPMnode *pNode, symbol s
   //      std::cout << sym << ",";
 
   if(pReturn != NULL) {
-    pReturn->count++;
+    pReturn->IncCount();
     if (!bUpdateExclusion) {
       //update vine contexts too. Guaranteed to exist if child does!
       for (CPPMnode *v = pReturn->vine; v; v=v->vine) {
         DASHER_ASSERT(v == m_pRoot || v->sym == sym);
-        v->count++;
+        v->IncCount();
       }
     }
   } else {
     //symbol does not exist at this level
     pReturn = makeNode(sym); //count initialized to 1 but no vine pointer
-    pNode->AddChild(pReturn, GetSize());
+    //set the vine before adding the child, as readers may follow it at once
     pReturn->vine = (pNode==m_pRoot) ? m_pRoot : AddSymbolToNode(pNode->vine,sym);
+    pNode->AddChild(pReturn, GetSize(), m_Retired);
   }
   
   return pReturn;
@@ -455,44 +525,41 @@ CAbstractPPM::CPPMnode *CPPMLanguageModel::makeNode(int sym) {
   return res;
 }
 
-struct BinaryRecord {
-  int m_iIndex;
-  int m_iChild;
-  int m_iNext;
-  int m_iVine;
-  unsigned short int m_iCount;
-  short int m_iSymbol;
-};
-
 bool CPPMLanguageModel::WriteToFile(std::string strFilename) {
+  std::ofstream oOutputFile(strFilename.c_str(), ios::binary);
+  bool bRes = WriteToStream(oOutputFile);
+  oOutputFile.close();
+  return bRes;
+}
 
-  std::map<CPPMnode *, int> mapIdx;
-  int iNextIdx(1); // Index of 0 means NULL;
+bool CPPMLanguageModel::WriteToStream(std::ostream &out) {
+  //Stop learning for the whole walk, so the snapshot is of a single state of the
+  // model (no node refers to one added after it was written); and keep readers'
+  // view of child arrays, in case anything retired before we began is still pending.
+  CWriter writer(this);
+  CEpoch::CReader reader;
 
-  std::ofstream oOutputFile(strFilename.c_str());
+  std::unordered_map<CPPMnode *, int> mapIdx;
+  mapIdx.reserve(NodesAllocated + 1);
+  int iNextIdx(1); // Index of 0 means NULL;
 
-  RecursiveWrite(m_pRoot, NULL, &mapIdx, &iNextIdx, &oOutputFile);
+  RecursiveWrite(m_pRoot, NULL, &mapIdx, &iNextIdx, &out);
 
-  oOutputFile.close();
-
-  return false;
+  return out.good();
 }
 
-bool CPPMLanguageModel::RecursiveWrite(CPPMnode *pNode, CPPMnode *pNextSibling, std::map<CPPMnode *, int> *pmapIdx, int *pNextIdx, std::ofstream *pOutputFile) {
+bool CPPMLanguageModel::RecursiveWrite(CPPMnode *pNode, CPPMnode *pNextSibling, std::unordered_map<CPPMnode *, int> *pmapIdx, int *pNextIdx, std::ostream *pOutputFile) {
 
   // Dump node here
 
   BinaryRecord sBR;
 
-  sBR.m_iIndex = GetIndex(pNode, pmapIdx, pNextIdx); 
-  sBR.m_iNext = GetIndex(pNextSibling, pmapIdx, pNextIdx); 
-  sBR.m_iVine = GetIndex(pNode->vine, pmapIdx, pNextIdx);
-  sBR.m_iCount = pNode->count;
-  sBR.m_iSymbol = pNode->sym;
-
   ChildIterator it =pNode->children();
   CPPMnode *pCurrentChild = (it == pNode->end()) ? NULL : *it++;
-  sBR.m_iChild = GetIndex(pCurrentChild, pmapIdx, pNextIdx); 
+  sBR.SetIndices([&](CPPMnode *p) {return GetIndex(p, pmapIdx, pNextIdx);},
+                 pNode, pNextSibling, pNode->vine, pCurrentChild);
+  sBR.m_iCount = pNode->count();
+  sBR.m_iSymbol = pNode->sym;
   
   pOutputFile->write(reinterpret_cast<char*>(&sBR), sizeof(BinaryRecord));
 
@@ -507,13 +574,13 @@ bool CPPMLanguageModel::RecursiveWrite(CPPMnode *pNode, CPPMnode *pNextSibling,
   return true;
 }
 
-int CPPMLanguageModel::GetIndex(CPPMnode *pAddr, std::map<CPPMnode *, int> *pmapIdx, int *pNextIdx) {
+int CPPMLanguageModel::GetIndex(CPPMnode *pAddr, std::unordered_map<CPPMnode *, int> *pmapIdx, int *pNextIdx) {
 
   int iIndex;
   if(pAddr == NULL)
     iIndex = 0;
   else {
-    std::map<CPPMnode *, int>::iterator it(pmapIdx->find(pAddr));
+    std::unordered_map<CPPMnode *, int>::iterator it(pmapIdx->find(pAddr));
     
     if(it == pmapIdx->end()) {
       iIndex = *pNextIdx;
@@ -528,63 +595,73 @@ int CPPMLanguageModel::GetIndex(CPPMnode *pAddr, std::map<CPPMnode *, int> *pmap
 }
 
 bool CPPMLanguageModel::ReadFromFile(std::string strFilename) {
-  
-  std::ifstream oInputFile(strFilename.c_str());
-  //map from file index, to address of node object with that index
-  std::map<int, CPPMnode*> oMap;
-  //map from file index, to address of *parent* for that node
+  std::ifstream oInputFile(strFilename.c_str(), ios::binary);
+  bool bRes = ReadFromStream(oInputFile);
+  oInputFile.close();
+  return bRes;
+}
+
+bool CPPMLanguageModel::ReadFromStream(std::istream &in) {
+  //must not have learnt anything yet, as we replace the whole tree
+  DASHER_ASSERT(m_pRoot->children() == m_pRoot->end());
+  //file index -> address of node object with that index (0 = NULL). Indices are
+  // allocated consecutively by WriteToStream, so a vector suffices.
+  // The tree is read under a new root, so a bad file leaves the model unchanged
+  // (nodes read are only reclaimed with the model, but they are few if so).
+  std::vector<CPPMnode *> vNodes(2, static_cast<CPPMnode *>(NULL));
+  vNodes[1] = m_NodeAlloc.Alloc();
+  //file index -> address of *parent* for that node
   // - only stored for the child that will *next* be read.
-  std::map<int, CPPMnode *> parentMap;
+  std::vector<CPPMnode *> vParents;
   BinaryRecord sBR;
-  bool bStarted(false);
-
-  while(!oInputFile.eof()) {
-    oInputFile.read(reinterpret_cast<char *>(&sBR), sizeof(BinaryRecord));
-
-    CPPMnode *pCurrent(GetAddress(sBR.m_iIndex, &oMap));
-
-    pCurrent->vine = GetAddress(sBR.m_iVine, &oMap);
-    pCurrent->count = sBR.m_iCount;
+  int iRead(0);
+
+  while(in.read(reinterpret_cast<char *>(&sBR), sizeof(BinaryRecord))) {
+    //WriteToStream allocates at most four new indices per record (and the first
+    // record is the root); reject anything else before it makes us allocate silly
+    // amounts of memory or index off the end of a child array
+    const int iMaxIdx(4*iRead + 4);
+    if (sBR.m_iIndex <= 0 || sBR.m_iIndex > iMaxIdx || sBR.m_iNext < 0 || sBR.m_iNext > iMaxIdx
+        || sBR.m_iVine < 0 || sBR.m_iVine > iMaxIdx || sBR.m_iChild < 0 || sBR.m_iChild > iMaxIdx
+        || sBR.m_iSymbol >= GetSize() || sBR.m_iSymbol < (iRead ? 0 : -1)
+        || (iRead++ == 0 && sBR.m_iIndex != 1)) return false;
+    CPPMnode *pCurrent(GetAddress(sBR.m_iIndex, vNodes));
+
+    pCurrent->vine = GetAddress(sBR.m_iVine, vNodes);
+    pCurrent->SetCount(sBR.m_iCount);
     pCurrent->sym = sBR.m_iSymbol;
 
     //if this node has a parent...
-    std::map<int,CPPMnode *>::iterator it(parentMap.find(sBR.m_iIndex));
-    if (it != parentMap.end()) {
-      CPPMnode *parent = it->second;
-      parent->AddChild(pCurrent,GetSize());
+    if (sBR.m_iIndex < static_cast<int>(vParents.size()) && vParents[sBR.m_iIndex]) {
+      CPPMnode *parent = vParents[sBR.m_iIndex];
+      parent->AddChild(pCurrent,GetSize(),m_Retired);
       //erase the record of parent hood, now we've realized it
-      parentMap.erase(it);
+      vParents[sBR.m_iIndex] = NULL;
       //add mapping for the _next_ sibling; since siblings will be read in the order
       // they were written out, when the next sibling is read it will find the mapping.
-      if (sBR.m_iNext) parentMap.insert(pair<int,CPPMnode *>(sBR.m_iNext,parent));
+      if (sBR.m_iNext) {
+        if (sBR.m_iNext >= static_cast<int>(vParents.size())) vParents.resize(sBR.m_iNext + 1);
+        vParents[sBR.m_iNext] = parent;
+      }
     }
     
     //if the node has children, record for the benefit of the first child
     // this node's address...(said child will be the first one read)
-    if (sBR.m_iChild) parentMap.insert(pair<int,CPPMnode *>(sBR.m_iChild, pCurrent));
-    
-    if(!bStarted) {
-      m_pRoot = pCurrent;
-      bStarted = true;
+    if (sBR.m_iChild) {
+      if (sBR.m_iChild >= static_cast<int>(vParents.size())) vParents.resize(sBR.m_iChild + 1);
+      vParents[sBR.m_iChild] = pCurrent;
     }
   }
-
-  oInputFile.close();
-
-  return false;
+  //every node referred to (as a vine, child or sibling) must have been read
+  if (iRead == 0 || iRead != static_cast<int>(vNodes.size()) - 1) return false;
+  m_pRoot = m_pRootContext->head = vNodes[1];
+  NodesAllocated = iRead;
+  return true;
 }
 
-CPPMLanguageModel::CPPMnode *CPPMLanguageModel::GetAddress(int iIndex, std::map<int, CPPMnode*> *pMap) {
-  if (iIndex==0) return NULL;
-  std::map<int, CPPMnode*>::iterator it(pMap->find(iIndex));
-
-  if(it == pMap->end()) {
-    CPPMnode *pNewNode;
-    pNewNode = m_NodeAlloc.Alloc();
-    pMap->insert(std::pair<int, CPPMnode*>(iIndex, pNewNode));
-    return pNewNode;
-  }
-  else {
-    return it->second;
-  }
+CPPMLanguageModel::CPPMnode *CPPMLanguageModel::GetAddress(int iIndex, std::vector<CPPMnode *> &vNodes) {
+  if (iIndex >= static_cast<int>(vNodes.size())) vNodes.resize(iIndex + 1, static_cast<CPPMnode *>(NULL));
+  CPPMnode *&pNode(vNodes[iIndex]);
+  if (iIndex && !pNode) pNode = m_NodeAlloc.Alloc();
+  return pNode;
 }
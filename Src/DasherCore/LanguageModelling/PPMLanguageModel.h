@@ -13,12 +13,16 @@
 #include "../../Common/Allocators/PooledAlloc.h"
 
 #include "LanguageModel.h"
+#include "Epoch.h"
 #include "../SettingsStore.h"
 #include "stdlib.h"
 #include <vector>
 #include <fstream>
 #include <set>
 #include <map>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
 
 namespace Dasher {
 
@@ -39,48 +43,72 @@ namespace Dasher {
     class ChildIterator;
     class CPPMnode {
     private:
-      union {
-        CPPMnode **m_ppChildren;
-        CPPMnode *m_pChild;
-      };
-      ///Elements in above array, including nulls, as follows:
-      /// (a) negative -> absolute value is number of elems in m_ppChildren, but use direct indexing
-      /// (b) 1 -> use m_pChild as direct pointer to CPPMnode (no array)
-      /// (c) 2-MAX_RUN -> m_ppChildren is unordered array of that many elems
-      /// (d) >MAX_RUN ->  m_ppChildren is an inline hash (overflow to next elem) with that many slots
-      int m_iNumChildSlots;
-      friend class CPPMLanguageModel;
+      ///Children of this node, as a single word so that readers always see a
+      /// consistent set: NULL if there are none; if the low bit is clear, the only
+      /// child; otherwise (with the low bit cleared), an SChildArray. Only the
+      /// writer changes it, and once an array has been replaced it is retired,
+      /// as readers may still be looking at it.
+      std::atomic<uintptr_t> m_children;
+      ///Number of times seen. Only the writer changes it; atomic (but accessed
+      /// relaxed) so that concurrent readers are well-defined.
+      std::atomic<unsigned short> m_iCount;
 	  public:
       ChildIterator children() const;
       const ChildIterator end() const;
-      void AddChild(CPPMnode *pNewChild, int numSymbols);
+      ///Adds a child (which must be fully initialised, as this publishes it).
+      /// \param retired receives any child array that has had to be replaced
+      void AddChild(CPPMnode *pNewChild, int numSymbols, CEpoch::CRetireList &retired);
+      ///Adds this node (using iBytes) to a report, by how its children are held
+      /// (nodes/leaf, single, run, hash or direct), and its child array if any
+      void ReportMemory(CMemoryReport &report, size_t iBytes) const;
       CPPMnode * find_symbol(symbol sym)const;
+      unsigned short count() const {return m_iCount.load(std::memory_order_relaxed);}
+      void SetCount(unsigned short iCount) {m_iCount.store(iCount, std::memory_order_relaxed);}
+      ///Only for the writer, which is the only thread that may change the count
+      void IncCount() {SetCount(count()+1);}
       CPPMnode *vine;
-      unsigned short int count;
       symbol sym;
       CPPMnode(symbol sym);
       CPPMnode();
       virtual ~CPPMnode();
       virtual bool eq(CPPMnode *other, std::map<CPPMnode *,CPPMnode *> &equivs);
 	  };
+    ///Array of children, allocated with space for iNumSlots elements in aChildren:
+    /// (a) negative -> absolute value is number of elems, but use direct indexing
+    /// (b) 2-MAX_RUN -> unordered array of that many elems
+    /// (c) >MAX_RUN -> an inline hash (overflow to next elem) with that many slots
+    /// The number of slots never changes; elements only ever change from NULL to a child.
+    struct SChildArray {
+      int iNumSlots;
+      std::atomic<CPPMnode *> aChildren[1];
+      static SChildArray *Make(int iNumSlots);
+      static void Free(void *pArray);
+      ///Adds a child, unless (for a hash) that would make a run longer than MAX_RUN
+      /// \return false if the child was not added, as the array needs to be bigger
+      bool Insert(CPPMnode *pNewChild);
+    };
+    ///Iterates over a snapshot of a node's children; comparing equal to end()
+    /// once there are no more.
     class ChildIterator {
     private:
       void nxt() {
-        if (m_ppChild == m_ppStop) return;
-        while ((--m_ppChild) != m_ppStop)
-          if (*m_ppChild) break;
+        m_pChild = NULL;
+        while (m_ppNext != m_ppStop)
+          if ((m_pChild = (--m_ppNext)->load(std::memory_order_acquire))) break;
       }
     public:
-      bool operator==(const ChildIterator &other) const {return m_ppChild==other.m_ppChild && m_ppStop == other.m_ppStop;}
-      bool operator!=(const ChildIterator &other) const {return m_ppChild!=other.m_ppChild || m_ppStop!=other.m_ppStop;}
-      CPPMnode *operator*() const {return (m_ppChild == m_ppStop) ? NULL : *m_ppChild;}
+      bool operator==(const ChildIterator &other) const {return m_pChild==other.m_pChild;}
+      bool operator!=(const ChildIterator &other) const {return m_pChild!=other.m_pChild;}
+      CPPMnode *operator*() const {return m_pChild;}
       ChildIterator &operator++() {nxt(); return *this;} //prefix
       ChildIterator operator++(int) {ChildIterator temp(*this); nxt(); return temp;}
-      //operator CPPMnode *() {return node;} //implicit conversion
-      //operator bool();                     //implicit conversion 2
-      ChildIterator(CPPMnode *const *ppChild, CPPMnode *const *ppStop) : m_ppChild(ppChild), m_ppStop(ppStop) {nxt();}
+      ///Iterates over the single child specified, or none if NULL
+      ChildIterator(CPPMnode *pOnly=NULL) : m_pChild(pOnly), m_ppNext(NULL), m_ppStop(NULL) {}
+      ///Iterates backwards from ppEnd-1 to ppStop inclusive
+      ChildIterator(const std::atomic<CPPMnode *> *ppEnd, const std::atomic<CPPMnode *> *ppStop) : m_ppNext(ppEnd), m_ppStop(ppStop) {nxt();}
     private:
-      CPPMnode *const *m_ppChild, *const *m_ppStop;
+      CPPMnode *m_pChild;
+      const std::atomic<CPPMnode *> *m_ppNext, *m_ppStop;
     };
 
     class CPPMContext {
@@ -100,6 +128,8 @@ namespace Dasher {
     ///Makes a new node, of whatever kind (subclass of CPPMnode, perhaps with extra info)
     /// is required by the subclass, for the specified symbol. (Initial count will be 1.)
     virtual CPPMnode *makeNode(int sym)=0;
+    ///Memory used by a node made by makeNode (the default, by a plain CPPMnode)
+    virtual size_t NodeBytes(const CPPMnode *pNode) const {return sizeof(CPPMnode);}
     /// \param iMaxOrder max order of model; anything <0 means to use LP_LM_MAX_ORDER.
     CAbstractPPM(CSettingsUser *pCreator, int iNumSyms, CPPMnode *pRoot, int iMaxOrder=-1);
     
@@ -113,6 +143,9 @@ namespace Dasher {
     /// Cache parameters that don't make sense to adjust during the life of a language model...
     const int m_iMaxOrder; 
     const bool bUpdateExclusion;
+
+    ///Child arrays replaced by the writer, which readers may still be using
+    CEpoch::CRetireList m_Retired;
     
   public:
     virtual bool eq(CAbstractPPM *other);
@@ -125,11 +158,23 @@ namespace Dasher {
     virtual void EnterSymbol(Context context, int Symbol);
     virtual void LearnSymbol(Context context, int Symbol);
 
+    ///Contexts never extend further back than the max order
+    virtual int GetContextLength() const {return m_iMaxOrder;}
+
+    ///Reports every node under "lm/ppm/nodes/", by how its children are held,
+    /// each child array under "lm/ppm/children/" (except its empty slots, which
+    /// are under ".../unused"), and the contexts in use.
+    virtual void ReportMemory(CMemoryReport &report) const;
+
     void dump();
     bool isValidContext(const Context c) const ;
   private:
     CPPMnode *AddSymbolToNode(CPPMnode * pNode, symbol sym);
 
+    ///Guards the two below, so that contexts can be created and released
+    /// by several threads at once
+    mutable std::mutex m_ContextMutex;
+
     CPooledAlloc < CPPMContext > m_ContextAlloc;
     
     std::set<const CPPMContext *> m_setContexts;
@@ -142,56 +187,80 @@ namespace Dasher {
   public:
     CPPMLanguageModel(CSettingsUser *pCreator, int iNumSyms);
     virtual void GetProbs(Context context, std::vector < unsigned int >&Probs, int norm, int iUniform) const;
+    ///Yes, see CLanguageModel (CRoutingPPMLanguageModel's routes are not yet safe to read concurrently)
+    virtual bool SupportsConcurrentReaders() const {return true;}
   protected:
     /// Makes a standard CPPMnode, but using a pooled allocator (m_NodeAlloc) - faster!
     virtual CPPMnode *makeNode(int sym);
     
     virtual bool WriteToFile(std::string strFilename);
     virtual bool ReadFromFile(std::string strFilename);
+  public:
+    virtual bool WriteToStream(std::ostream &out);
+    virtual bool ReadFromStream(std::istream &in);
+
+    ///The files written by WriteToStream (and read by ReadFromStream) are a sequence
+    /// of these, one per node in preorder, starting with the root. Nodes are
+    /// referred to by index, 0 meaning none; indices are allocated consecutively
+    /// from 1, as SetIndices does, and ReadFromStream relies on this. Tools
+    /// writing model files (PPMCompile, PPMPrune) must use this too.
+    struct BinaryRecord {
+      int m_iIndex;
+      int m_iChild;
+      int m_iNext;
+      int m_iVine;
+      unsigned short int m_iCount;
+      short int m_iSymbol;
+
+      ///Sets the index fields, calling Index(n) (which must return 0 for no node,
+      /// else the index allocated to n, allocating the next if it has none yet)
+      /// for the node, then its next sibling, its vine, and its first child.
+      template<typename Node, typename IndexFn> void SetIndices(IndexFn Index, Node node, Node next, Node vine, Node child) {
+        m_iIndex = Index(node);
+        m_iNext = Index(next);
+        m_iVine = Index(vine);
+        m_iChild = Index(child);
+      }
+    };
   private:
     int NodesAllocated;
 
-    bool RecursiveWrite(CPPMnode *pNode, CPPMnode *pNextSibling, std::map<CPPMnode *, int> *pmapIdx, int *pNextIdx, std::ofstream *pOutputFile);
-    int GetIndex(CPPMnode *pAddr, std::map<CPPMnode *, int> *pmapIdx, int *pNextIdx);
-    CPPMnode *GetAddress(int iIndex, std::map<int, CPPMnode*> *pMap);
+    bool RecursiveWrite(CPPMnode *pNode, CPPMnode *pNextSibling, std::unordered_map<CPPMnode *, int> *pmapIdx, int *pNextIdx, std::ostream *pOutputFile);
+    int GetIndex(CPPMnode *pAddr, std::unordered_map<CPPMnode *, int> *pmapIdx, int *pNextIdx);
+    CPPMnode *GetAddress(int iIndex, std::vector<CPPMnode *> &vNodes);
 
-    mutable CSimplePooledAlloc < CPPMnode > m_NodeAlloc;
+    CSimplePooledAlloc < CPPMnode > m_NodeAlloc;
   };
 
   /// @}
   inline CAbstractPPM::ChildIterator CPPMLanguageModel::CPPMnode::children() const {
-    //if m_iNumChildSlots = 0 / 1, m_ppChildren is direct pointer, else ptr to array (of pointers)
-    CPPMnode *const *ppChild = (m_iNumChildSlots == 0 || m_iNumChildSlots == 1) ? &m_pChild : m_ppChildren;
-    return ChildIterator(ppChild + abs(m_iNumChildSlots), ppChild - 1);
+    const uintptr_t children = m_children.load(std::memory_order_acquire);
+    if (!(children & 1)) return ChildIterator(reinterpret_cast<CPPMnode *>(children));
+    const SChildArray *pArray = reinterpret_cast<const SChildArray *>(children & ~uintptr_t(1));
+    return ChildIterator(pArray->aChildren + abs(pArray->iNumSlots), pArray->aChildren);
   }
   
   inline const CAbstractPPM::ChildIterator CPPMLanguageModel::CPPMnode::end() const {
-    //if m_iNumChildSlots = 0 / 1, m_ppChildren is direct pointer, else ptr to array (of pointers)
-    CPPMnode *const *ppChild = (m_iNumChildSlots == 0 || m_iNumChildSlots == 1) ? &m_pChild : m_ppChildren;
-    return ChildIterator(ppChild, ppChild - 1);
+    return ChildIterator();
   }
 
-  inline Dasher::CAbstractPPM::CPPMnode::CPPMnode(symbol _sym): sym(_sym) {
+  inline Dasher::CAbstractPPM::CPPMnode::CPPMnode(symbol _sym): m_children(0), m_iCount(1), sym(_sym) {
     vine = 0;
-    m_iNumChildSlots = 0;
-    m_ppChildren = NULL;
-    count = 1;
   }
 
-  inline CAbstractPPM::CPPMnode::CPPMnode() {
+  inline CAbstractPPM::CPPMnode::CPPMnode() : m_children(0), m_iCount(1) {
     vine = 0;
-    m_iNumChildSlots = 0;
-    m_ppChildren = NULL;
-    count = 1;
   }
   
   inline CAbstractPPM::CPPMnode::~CPPMnode() {
-    //single child = is direct pointer to node, not array...
-    if (m_iNumChildSlots != 1)
-      delete[] m_ppChildren;
+    //a single child is held directly; only an array belongs to us
+    const uintptr_t children = m_children.load(std::memory_order_relaxed);
+    if (children & 1)
+      SChildArray::Free(reinterpret_cast<void *>(children & ~uintptr_t(1)));
   }
 
   inline CLanguageModel::Context CAbstractPPM::CreateEmptyContext() {
+    std::lock_guard<std::mutex> lock(m_ContextMutex);
     CPPMContext *pCont = m_ContextAlloc.Alloc();
     *pCont = *m_pRootContext;
 
@@ -201,6 +270,7 @@ namespace Dasher {
   }
 
   inline CLanguageModel::Context CAbstractPPM::CloneContext(Context Copy) {
+    std::lock_guard<std::mutex> lock(m_ContextMutex);
     CPPMContext *pCont = m_ContextAlloc.Alloc();
     CPPMContext *pCopy = (CPPMContext *) Copy;
     *pCont = *pCopy;
@@ -211,6 +281,7 @@ namespace Dasher {
   }
 
   inline void CAbstractPPM::ReleaseContext(Context release) {
+    std::lock_guard<std::mutex> lock(m_ContextMutex);
 
     m_setContexts.erase(m_setContexts.find((CPPMContext *) release));
 
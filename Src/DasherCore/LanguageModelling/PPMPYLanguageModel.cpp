@@ -212,7 +212,7 @@ void CPPMPYLanguageModel::GetPartProbs(Context context, std::vector<pair<symbol,
     int iTotal=0, i=0;
     for (std::vector<pair<symbol, unsigned int> >::const_iterator it = vChildren.begin(); it!=vChildren.end(); it++,i++) {
       if (CPPMnode *pFound = pTemp->find_symbol(it->first)) {
-        iTotal += vCounts[i] = pFound->count; //double assignment
+        iTotal += vCounts[i] = pFound->count(); //double assignment
       } else
         vCounts[i] = 0;
     }
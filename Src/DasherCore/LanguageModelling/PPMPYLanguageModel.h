@@ -75,6 +75,10 @@ namespace Dasher {
       inline CPPMPYnode() : CPPMnode() {}
     };
     CPPMPYnode *makeNode(int sym);
+    ///Includes the entries in the node's pychild
+    virtual size_t NodeBytes(const CPPMnode *pNode) const {
+      return sizeof(CPPMPYnode) + static_cast<const CPPMPYnode *>(pNode)->pychild.size() * sizeof(std::pair<const symbol,unsigned short int>);
+    }
     
   private:
     int NodesAllocated;
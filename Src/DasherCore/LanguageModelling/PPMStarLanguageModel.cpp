@@ -0,0 +1,243 @@
+// PPMStarLanguageModel.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../../Common/Common.h"
+#include "PPMStarLanguageModel.h"
+#include "../MemoryReport.h"
+
+using namespace Dasher;
+using namespace std;
+
+// Track memory leaks on Windows to the line that new'd the memory
+#ifdef _WIN32
+#ifdef _DEBUG
+#define DEBUG_NEW new( _NORMAL_BLOCK, THIS_FILE, __LINE__ )
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+#endif
+
+CPPMStarLanguageModel::CPPMStarLanguageModel(CSettingsUser *pCreator, int iNumSyms)
+: CLanguageModel(iNumSyms), CSettingsUser(pCreator), m_ContextAlloc(1024) {
+  SState root = {0, -1, -1, 0, -1};
+  m_vStates.push_back(root);
+}
+
+CLanguageModel::Context CPPMStarLanguageModel::CreateEmptyContext() {
+  SContext *pCont = m_ContextAlloc.Alloc();
+  pCont->iState = pCont->iLen = pCont->iLast = 0;
+  return (Context)pCont;
+}
+
+CLanguageModel::Context CPPMStarLanguageModel::CloneContext(Context context) {
+  SContext *pCont = m_ContextAlloc.Alloc();
+  *pCont = *(SContext *)context;
+  return (Context)pCont;
+}
+
+void CPPMStarLanguageModel::ReleaseContext(Context context) {
+  m_ContextAlloc.Free((SContext *)context);
+}
+
+int CPPMStarLanguageModel::FindEdge(int iState, symbol sym) const {
+  for (int e = m_vStates[iState].iFirstEdge; e != -1; e = m_vEdges[e].iNext)
+    if (m_vEdges[e].sym == sym) return e;
+  return -1;
+}
+
+void CPPMStarLanguageModel::AddEdge(int iState, symbol sym, int iTarget) {
+  SEdge edge = {sym, iTarget, m_vStates[iState].iFirstEdge};
+  m_vStates[iState].iFirstEdge = m_vEdges.size();
+  m_vEdges.push_back(edge);
+}
+
+int CPPMStarLanguageModel::Clone(int iState, int iLen) {
+  SState clone = m_vStates[iState];
+  clone.iLen = iLen;
+  clone.iFirstEdge = -1;
+  const int iClone(m_vStates.size());
+  m_vStates.push_back(clone);
+  for (int e = m_vStates[iState].iFirstEdge; e != -1; e = m_vEdges[e].iNext)
+    AddEdge(iClone, m_vEdges[e].sym, m_vEdges[e].iTarget);
+  return iClone;
+}
+
+int CPPMStarLanguageModel::Extend(int iLast, symbol sym, int iPos) {
+  int e = FindEdge(iLast, sym);
+  if (e != -1) {
+    //string already present; make sure it's the longest in its state
+    const int q(m_vEdges[e].iTarget);
+    if (m_vStates[q].iLen == m_vStates[iLast].iLen + 1) return q;
+    const int iClone(Clone(q, m_vStates[iLast].iLen + 1));
+    for (int p = iLast; p != -1 && (e = FindEdge(p, sym)) != -1 && m_vEdges[e].iTarget == q; p = m_vStates[p].iLink)
+      m_vEdges[e].iTarget = iClone;
+    m_vStates[q].iLink = iClone;
+    return iClone;
+  }
+  const int iCur(m_vStates.size());
+  SState cur = {m_vStates[iLast].iLen + 1, 0, -1, 0, iPos};
+  m_vStates.push_back(cur);
+  int p = iLast;
+  for (; p != -1 && (e = FindEdge(p, sym)) == -1; p = m_vStates[p].iLink)
+    AddEdge(p, sym, iCur);
+  if (p == -1) return iCur; //link stays at the root
+  const int q(m_vEdges[e].iTarget);
+  if (m_vStates[q].iLen == m_vStates[p].iLen + 1) {
+    m_vStates[iCur].iLink = q;
+    return iCur;
+  }
+  const int iClone(Clone(q, m_vStates[p].iLen + 1));
+  for (; p != -1 && (e = FindEdge(p, sym)) != -1 && m_vEdges[e].iTarget == q; p = m_vStates[p].iLink)
+    m_vEdges[e].iTarget = iClone;
+  m_vStates[q].iLink = m_vStates[iCur].iLink = iClone;
+  return iCur;
+}
+
+void CPPMStarLanguageModel::Resolve(SContext &context) const {
+  //splitting a state moves its shorter strings to the new suffix link
+  for (int iLink; (iLink = m_vStates[context.iState].iLink) != -1 && context.iLen <= m_vStates[iLink].iLen;)
+    context.iState = iLink;
+}
+
+void CPPMStarLanguageModel::EnterSymbol(Context c, int Symbol) {
+  if (Symbol == 0) return;
+  SContext &context(*(SContext *)c);
+  Resolve(context);
+  context.iLast = -1;
+  //longest suffix of the context that has been followed by Symbol
+  int e;
+  while ((e = FindEdge(context.iState, Symbol)) == -1) {
+    if (context.iState == 0) return; //Symbol never learnt; empty context
+    context.iState = m_vStates[context.iState].iLink;
+    context.iLen = m_vStates[context.iState].iLen;
+  }
+  context.iState = m_vEdges[e].iTarget;
+  if (++context.iLen > MAX_CONTEXT) {
+    context.iLen = MAX_CONTEXT;
+    Resolve(context);
+  }
+}
+
+void CPPMStarLanguageModel::LearnSymbol(Context c, int Symbol) {
+  if (Symbol == 0) return;
+  DASHER_ASSERT(Symbol < GetSize());
+  SContext &context(*(SContext *)c);
+  Resolve(context);
+  if (context.iLast == -1) {
+    //context was entered rather than learnt: add its string (which has
+    // occurred, so creates no new positions) to extend from
+    const int iEnd(m_vStates[context.iState].iFirstPos);
+    int iLast(0);
+    for (int i = context.iLen; i > 0; i--)
+      iLast = Extend(iLast, m_vText[iEnd - i + 1], iEnd - i + 1);
+    context.iLast = iLast;
+    Resolve(context);
+  }
+  m_vText.push_back(Symbol);
+  context.iLast = Extend(context.iLast, Symbol, m_vText.size() - 1);
+  Resolve(context);
+  //Count the new position for every suffix of the context followed by Symbol
+  const int t(m_vEdges[FindEdge(context.iState, Symbol)].iTarget);
+  for (int s = t; s != -1; s = m_vStates[s].iLink)
+    m_vStates[s].iOcc++;
+  context.iState = t;
+  if (++context.iLen > MAX_CONTEXT) {
+    context.iLen = MAX_CONTEXT;
+    Resolve(context);
+  }
+}
+
+void CPPMStarLanguageModel::GetProbs(Context c, vector<unsigned int> &probs, int norm, int iUniform) const {
+  SContext context(*(SContext *)c);
+  Resolve(context);
+
+  const int iNumSymbols = GetSize();
+  probs.resize(iNumSymbols);
+
+  unsigned int iToSpend = norm;
+  unsigned int iUniformLeft = iUniform;
+
+  probs[0] = 0;
+  for (int i = 1; i < iNumSymbols; i++) {
+    probs[i] = iUniformLeft / (iNumSymbols - i);
+    iUniformLeft -= probs[i];
+    iToSpend -= probs[i];
+  }
+  DASHER_ASSERT(iUniformLeft == 0);
+
+  //Start from the shortest deterministic context, if any; else the longest
+  // which has been followed by anything. Shortening a context can only add
+  // successors, so once there are two, there's no deterministic one shorter.
+  int iStart(-1), iDeterministic(-1);
+  for (int s = context.iState; s != -1; s = m_vStates[s].iLink) {
+    int iSuccessors(0);
+    for (int e = m_vStates[s].iFirstEdge; e != -1 && iSuccessors < 2; e = m_vEdges[e].iNext)
+      if (m_vStates[m_vEdges[e].iTarget].iOcc) iSuccessors++;
+    if (iSuccessors == 1) iDeterministic = s;
+    else if (iSuccessors > 1) {
+      iStart = s;
+      break;
+    }
+  }
+  if (iDeterministic != -1) iStart = iDeterministic;
+
+  const int alpha = GetLongParameter(LP_LM_ALPHA);
+  const int beta = GetLongParameter(LP_LM_BETA);
+
+  //Then blend with every shorter context, as CPPMLanguageModel (no exclusion)
+  for (int s = iStart; s != -1; s = m_vStates[s].iLink) {
+    myint iTotal = 0;
+    for (int e = m_vStates[s].iFirstEdge; e != -1; e = m_vEdges[e].iNext)
+      iTotal += m_vStates[m_vEdges[e].iTarget].iOcc;
+    if (!iTotal) continue;
+    const unsigned int size_of_slice = iToSpend;
+    for (int e = m_vStates[s].iFirstEdge; e != -1; e = m_vEdges[e].iNext) {
+      const myint iCount(m_vStates[m_vEdges[e].iTarget].iOcc);
+      if (!iCount) continue;
+      const unsigned int p = static_cast<myint>(size_of_slice) * (100 * iCount - beta) / (100 * iTotal + alpha);
+      probs[m_vEdges[e].sym] += p;
+      iToSpend -= p;
+    }
+  }
+
+  const unsigned int size_of_slice = iToSpend;
+  for (int i = 1; i < iNumSymbols; i++) {
+    const unsigned int p = size_of_slice / (iNumSymbols - 1);
+    probs[i] += p;
+    iToSpend -= p;
+  }
+
+  int iLeft = iNumSymbols - 1;
+  for (int i = 1; i < iNumSymbols; i++) {
+    const unsigned int p = iToSpend / iLeft;
+    probs[i] += p;
+    --iLeft;
+    iToSpend -= p;
+  }
+
+  DASHER_ASSERT(iToSpend == 0);
+}
+
+void CPPMStarLanguageModel::ReportMemory(CMemoryReport &report) const {
+  report.Add("lm/ppmstar/states", m_vStates.size(), m_vStates.capacity() * sizeof(SState));
+  report.Add("lm/ppmstar/edges", m_vEdges.size(), m_vEdges.capacity() * sizeof(SEdge));
+  report.Add("lm/ppmstar/text", m_vText.size(), m_vText.capacity() * sizeof(symbol));
+}
@@ -0,0 +1,126 @@
+// PPMStarLanguageModel.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __LanguageModelling_PPMStarLanguageModel_h__
+#define __LanguageModelling_PPMStarLanguageModel_h__
+
+#include "../../Common/NoClones.h"
+#include "../../Common/Allocators/PooledAlloc.h"
+
+#include "LanguageModel.h"
+#include "../SettingsStore.h"
+
+#include <vector>
+
+namespace Dasher {
+
+  /// \ingroup LM
+  /// @{
+
+  ///PPM* (Cleary & Teahan, 1997): PPM with contexts of unbounded order. Rather
+  /// than the longest context, predicts from the shortest *deterministic* one,
+  /// i.e. which has only ever been followed by a single symbol, if there is
+  /// one; otherwise from the longest that has been followed by anything. Then
+  /// blends with successively shorter contexts, just as CPPMLanguageModel
+  /// (using LP_LM_ALPHA and LP_LM_BETA). So text which repeats earlier text -
+  /// addresses, names, boilerplate - is predicted almost certainly, however
+  /// long the repeat.
+  ///
+  /// Everything learnt is stored in a suffix automaton (DAWG), whose states
+  /// are the classes of strings occurring at the same positions, so memory is
+  /// linear in the length of text learnt, whatever the order: at most two
+  /// states and three transitions per symbol. A state's suffix link is the
+  /// equivalent of a PPM node's vine. Contexts are limited to MAX_CONTEXT
+  /// symbols, only so that learning a symbol takes bounded time even inside
+  /// long runs of a single symbol.
+  class CPPMStarLanguageModel : public CLanguageModel, protected CSettingsUser, private NoClones {
+  public:
+    CPPMStarLanguageModel(CSettingsUser *pCreator, int iNumSyms);
+
+    virtual Context CreateEmptyContext();
+    virtual Context CloneContext(Context context);
+    virtual void ReleaseContext(Context context);
+    virtual void EnterSymbol(Context context, int Symbol);
+    virtual void LearnSymbol(Context context, int Symbol);
+    virtual void GetProbs(Context context, std::vector<unsigned int> &Probs, int iNorm, int iUniform) const;
+    virtual int GetContextLength() const {return MAX_CONTEXT;}
+    ///Reports the states and transitions of the automaton, and the text learnt
+    virtual void ReportMemory(CMemoryReport &report) const;
+
+    ///Longest context, in symbols, used for prediction
+    static const int MAX_CONTEXT = 64;
+
+  private:
+    struct SState {
+      ///Length of the longest string in the class; the shortest is one longer
+      /// than the longest of the suffix link's
+      int iLen;
+      ///Suffix link, i.e. state of the longest suffix in a different class;
+      /// -1 for the root (the empty string)
+      int iLink;
+      ///First of the list of transitions out (into m_vEdges), or -1
+      int iFirstEdge;
+      ///Number of positions in the learnt text at which the class's strings
+      /// end (kept up to date only for classes containing a string of at most
+      /// MAX_CONTEXT+1 symbols)
+      unsigned int iOcc;
+      ///Index into m_vText at which the class's strings first end
+      int iFirstPos;
+    };
+    struct SEdge {
+      symbol sym;
+      int iTarget;
+      int iNext;
+    };
+    ///A context is the state of the longest suffix of the text entered which
+    /// has occurred in the learnt text (and its length); plus, if the whole
+    /// of the text learnt in this context is a state's longest string, that
+    /// state, from which to extend the automaton when learning.
+    struct SContext {
+      int iState, iLen;
+      ///-1 if the context was moved on by EnterSymbol
+      int iLast;
+    };
+
+    int FindEdge(int iState, symbol sym) const;
+    void AddEdge(int iState, symbol sym, int iTarget);
+    ///Copy of a state, for its strings up to iLen symbols long
+    int Clone(int iState, int iLen);
+    ///Adds (the longest string of) iLast followed by sym to the automaton
+    /// (as in a generalised suffix automaton, so iLast may be any state whose
+    /// longest string has been added), returning the state whose longest
+    /// string that is.
+    /// \param iPos index of sym in m_vText, if it's new
+    int Extend(int iLast, symbol sym, int iPos);
+    ///Moves the context to the state now containing its string, in case
+    /// that state has been split since.
+    void Resolve(SContext &context) const;
+
+    std::vector<SState> m_vStates;
+    std::vector<SEdge> m_vEdges;
+    ///Every symbol learnt
+    std::vector<symbol> m_vText;
+    CPooledAlloc<SContext> m_ContextAlloc;
+  };
+
+  /// @}
+}
+
+#endif
@@ -58,13 +58,13 @@ void CRoutingPPMLanguageModel::GetProbs(Context context, std::vector<unsigned in
   for (CPPMnode *pTemp = ppmcontext->head; pTemp; pTemp = pTemp->vine) {
     int iTotal = 0;
     for (ChildIterator it=pTemp->children(); it!=pTemp->end(); it++)
-      iTotal += (*it)->count;
+      iTotal += (*it)->count();
     
     if(iTotal) {
       unsigned int size_of_slice = iToSpend;
       
       for (ChildIterator it=pTemp->children(); it!=pTemp->end(); it++) {
-        unsigned int p = static_cast < myint > (size_of_slice) * (100 * (*it)->count - beta) / (100 * iTotal + alpha);
+        unsigned int p = static_cast < myint > (size_of_slice) * (100 * (*it)->count() - beta) / (100 * iTotal + alpha);
           
         baseProbs[(*it)->sym] += p;
         iToSpend -= p;
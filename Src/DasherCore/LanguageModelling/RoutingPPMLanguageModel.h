@@ -78,6 +78,10 @@ namespace Dasher {
     ///Always returns a CRoutingPPMnode. TODO, work through class and use standard
     /// map-less PPMnodes for unambiguous base syms (which have only one route) ?
     CRoutingPPMnode *makeNode(int sym);
+    ///Includes the entries in the node's m_routes
+    virtual size_t NodeBytes(const CPPMnode *pNode) const {
+      return sizeof(CRoutingPPMnode) + static_cast<const CRoutingPPMnode *>(pNode)->m_routes.size() * sizeof(std::pair<const symbol,unsigned short int>);
+    }
     
   private:
     int NodesAllocated;
@@ -0,0 +1,491 @@
+#include "LearningJournal.h"
+#include "DasherInterfaceBase.h"
+#include "Trainer.h"
+#include "TrainingInput.h"
+#include "PerfTrace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Dasher;
+using namespace std;
+
+namespace {
+  ///Journal files begin with these, then a 32-bit generation number
+  const char JOURNAL_MAGIC[] = {'D','J','N','L',1};
+  ///Snapshot files begin with these, then the generation, then the fingerprint (length-prefixed)
+  const char SNAPSHOT_MAGIC[] = {'D','S','N','P',1};
+  ///Each block of records is preceded by this, the length of the records, and their checksum
+  const unsigned char BLOCK_MARK = 0xB1;
+  const size_t BLOCK_HEADER = 9;
+
+  ///32-bit FNV-1a: cheap, and plenty to detect a torn write
+  unsigned int Checksum(const char *pData, size_t iLen) {
+    unsigned int h = 2166136261u;
+    for (size_t i=0; i<iLen; i++) h = (h ^ static_cast<unsigned char>(pData[i])) * 16777619u;
+    return h;
+  }
+
+  void PutU32(string &str, unsigned int i) {
+    for (int b=0; b<4; b++) str += static_cast<char>((i >> (8*b)) & 0xFF);
+  }
+  unsigned int GetU32(const char *p) {
+    const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+    return u[0] | (u[1]<<8) | (u[2]<<16) | (static_cast<unsigned int>(u[3])<<24);
+  }
+
+  void PutVarint(string &str, unsigned long long i) {
+    for (; i >= 0x80; i >>= 7) str += static_cast<char>(0x80 | (i & 0x7F));
+    str += static_cast<char>(i);
+  }
+  bool GetVarint(const string &str, size_t &pos, unsigned long long &i) {
+    i = 0;
+    for (int shift=0; pos < str.length() && shift < 64; shift+=7) {
+      const unsigned char c = str[pos++];
+      i |= static_cast<unsigned long long>(c & 0x7F) << shift;
+      if (!(c & 0x80)) return true;
+    }
+    return false;
+  }
+
+  string EncodeRecord(char cType, const string &strData) {
+    string str(1, cType);
+    PutVarint(str, strData.length());
+    return str + strData;
+  }
+  ///Reads the record at pos, advancing pos past it
+  bool NextRecord(const string &str, size_t &pos, char &cType, string &strData) {
+    if (pos >= str.length()) return false;
+    cType = str[pos++];
+    unsigned long long iLen;
+    if (!GetVarint(str, pos, iLen) || iLen > str.length() - pos) return false;
+    strData = str.substr(pos, iLen);
+    pos += iLen;
+    return true;
+  }
+
+  ///Size of a file, or -1 if it does not exist
+  long long FileSize(const string &strPath) {
+    struct stat sStatInfo;
+    return stat(strPath.c_str(), &sStatInfo) ? -1 : sStatInfo.st_size;
+  }
+
+  bool ReadWholeFile(const string &strPath, string &strData) {
+    ifstream in(strPath.c_str(), ios::binary);
+    if (!in) return false;
+    ostringstream ss;
+    ss << in.rdbuf();
+    strData = ss.str();
+    return true;
+  }
+
+  ///Flushes stdio's buffer and then the OS's, so the data survives a crash or power cut
+  bool SyncFile(FILE *f) {
+    if (fflush(f)) return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+  }
+
+  ///As SyncFile, for a file already written and closed (e.g. via an ofstream)
+  bool SyncPath(const string &strPath) {
+    FILE *f = fopen(strPath.c_str(), "ab");
+    if (!f) return false;
+    bool bRes = SyncFile(f);
+    return (fclose(f) == 0) && bRes;
+  }
+
+  ///Atomically replaces strPath with strTmp (which must have been synced)
+  bool ReplaceFile(const string &strTmp, const string &strPath) {
+#ifdef _WIN32
+    return MoveFileExA(strTmp.c_str(), strPath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (rename(strTmp.c_str(), strPath.c_str())) return false;
+    //the rename is only durable once the directory is synced
+    const string::size_type iSlash = strPath.rfind('/');
+    const string strDir(iSlash == string::npos ? "." : strPath.substr(0, iSlash + 1));
+    int fd = open(strDir.c_str(), O_RDONLY);
+    if (fd != -1) {
+      fsync(fd);
+      close(fd);
+    }
+    return true;
+#endif
+  }
+
+  bool TruncateFile(const string &strPath, long long iSize) {
+#ifdef _WIN32
+    int fd = _open(strPath.c_str(), _O_RDWR | _O_BINARY);
+    if (fd == -1) return false;
+    bool bRes = _chsize_s(fd, iSize) == 0 && _commit(fd) == 0;
+    _close(fd);
+    return bRes;
+#else
+    return truncate(strPath.c_str(), iSize) == 0;
+#endif
+  }
+
+  ///Appends one checksummed block containing the specified records to the file, and syncs it
+  bool WriteBlock(FILE *f, const string &strRecords) {
+    string strHeader(1, static_cast<char>(BLOCK_MARK));
+    PutU32(strHeader, strRecords.length());
+    PutU32(strHeader, Checksum(strRecords.data(), strRecords.length()));
+    return fwrite(strHeader.data(), 1, strHeader.length(), f) == strHeader.length()
+      && fwrite(strRecords.data(), 1, strRecords.length(), f) == strRecords.length()
+      && SyncFile(f);
+  }
+
+  ///Alphabets sharing a training file share the journal, but need their own snapshots
+  string SnapshotPath(const string &strTextPath, const string &strModelKey) {
+    char szKey[9];
+    sprintf(szKey, "%08x", Checksum(strModelKey.data(), strModelKey.length()));
+    return strTextPath + "." + szKey + ".model";
+  }
+
+  ///Records the names and sizes of all files scanned, rather than parsing them
+  class CFileLister : public AbstractParser {
+  public:
+    CFileLister(CDasherInterfaceBase *pInterface) : AbstractParser(pInterface), m_bUnknown(false), m_pInterface(pInterface) {}
+    bool ParseFile(const string &strPath, bool bUser) {
+      ostringstream ss;
+      ss << (bUser ? 'U' : 'S') << m_pInterface->GetFileSize(strPath) << ' ' << strPath;
+      m_vFiles.push_back(ss.str());
+      return true;
+    }
+    bool Parse(const string &strDesc, istream &in, bool bUser) {
+      //not a file, so no way to tell whether it changes
+      m_bUnknown = true;
+      return false;
+    }
+    vector<string> m_vFiles;
+    bool m_bUnknown;
+  private:
+    CDasherInterfaceBase * const m_pInterface;
+  };
+}
+
+const int CLearningJournal::MAX_LATENCY_MS;
+const size_t CLearningJournal::MAX_PENDING;
+const size_t CLearningJournal::COMPACT_THRESHOLD;
+
+CLearningJournal *CLearningJournal::Create(CDasherInterfaceBase *pInterface, const string &strTrainingFile, const string &strModelKey) {
+  const string strTextPath(pInterface->GetUserDataFilePath(strTrainingFile));
+  if (strTextPath.empty()) return NULL;
+  CLearningJournal *pJournal = new CLearningJournal(pInterface, strTrainingFile, strModelKey, strTextPath);
+  pJournal->ReadJournal();
+  return pJournal;
+}
+
+CLearningJournal::CLearningJournal(CDasherInterfaceBase *pInterface, const string &strTrainingFile, const string &strModelKey, const string &strTextPath)
+: m_pInterface(pInterface), m_strTrainingFile(strTrainingFile), m_strModelKey(strModelKey), m_strTextPath(strTextPath),
+  m_strJournalPath(strTextPath + ".journal"), m_strSnapshotPath(SnapshotPath(strTextPath, strModelKey)), m_iGeneration(0), m_iJournalSize(0), m_bNeedsRewrite(false), m_bFolded(false),
+  m_bSnapshotLoaded(false), m_pFile(NULL), m_bWriting(false), m_bFlushRequested(false), m_bStop(false), m_bWriteFailed(false) {
+}
+
+CLearningJournal::~CLearningJournal() {
+  if (m_thread.joinable()) {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_bStop = true;
+    }
+    m_cond.notify_all();
+    //writes out anything still pending
+    m_thread.join();
+  }
+  if (m_pFile) fclose(m_pFile);
+}
+
+void CLearningJournal::ReadJournal() {
+  string strData;
+  if (!ReadWholeFile(m_strJournalPath, strData)) {
+    //no journal yet; create one when we start
+    m_bNeedsRewrite = true;
+    return;
+  }
+  m_iJournalSize = strData.length();
+  if (strData.length() < sizeof(JOURNAL_MAGIC) + 4 || memcmp(strData.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC))) {
+    //unreadable, so start afresh (the user text file is unaffected)
+    m_bNeedsRewrite = true;
+    return;
+  }
+  m_iGeneration = GetU32(strData.data() + sizeof(JOURNAL_MAGIC));
+  size_t pos = sizeof(JOURNAL_MAGIC) + 4;
+  while (pos < strData.length()) {
+    //a block that doesn't check out must have been torn by a crash while writing;
+    // nothing after it can have been written
+    if (strData.length() - pos < BLOCK_HEADER || static_cast<unsigned char>(strData[pos]) != BLOCK_MARK) break;
+    const size_t iLen = GetU32(strData.data() + pos + 1);
+    if (iLen > strData.length() - pos - BLOCK_HEADER
+        || Checksum(strData.data() + pos + BLOCK_HEADER, iLen) != GetU32(strData.data() + pos + 5)) break;
+    const string strBlock(strData, pos + BLOCK_HEADER, iLen);
+    pos += BLOCK_HEADER + iLen;
+
+    char cType;
+    string strRecord;
+    for (size_t iRec = 0; NextRecord(strBlock, iRec, cType, strRecord);) {
+      if (cType != REC_FOLD) {
+        m_strRecords += EncodeRecord(cType, strRecord);
+        continue;
+      }
+      //A compaction appended everything before this to the user text file, at the offset
+      // recorded; see whether that completed (then those records can be dropped).
+      m_bNeedsRewrite = true;
+      unsigned long long iOffset;
+      size_t iPos = 0;
+      if (!GetVarint(strRecord, iPos, iOffset)) continue;
+      const string strFolded(RecordsToText(m_strRecords));
+      string strText;
+      if (ReadWholeFile(m_strTextPath, strText) && strText.length() >= iOffset
+          && strText.compare(iOffset, strFolded.length(), strFolded) == 0) {
+        m_strRecords.clear();
+        m_bFolded = true;
+      } else if (strText.length() > iOffset) {
+        //got part way; remove the partial text, and keep the records to fold again
+        TruncateFile(m_strTextPath, iOffset);
+      }
+    }
+  }
+  if (pos < strData.length()) m_bNeedsRewrite = true;
+}
+
+string CLearningJournal::RecordsToText(const string &strRecords) {
+  string strText, strContext;
+  //offsets in strText of symbols written since the last context switch, which may be undone
+  vector<size_t> vSymbols;
+  bool bContextPending(false);
+  char cType;
+  string strData;
+  for (size_t pos = 0; NextRecord(strRecords, pos, cType, strData);) {
+    switch (cType) {
+      case REC_CONTEXT:
+        //only written out if anything is written in it
+        strContext = strData;
+        bContextPending = true;
+        vSymbols.clear();
+        break;
+      case REC_SYMBOL:
+        if (bContextPending) {
+          strText += strContext;
+          bContextPending = false;
+        }
+        vSymbols.push_back(strText.length());
+        strText += strData;
+        break;
+      case REC_UNDO:
+        if (!vSymbols.empty() && strText.compare(vSymbols.back(), string::npos, strData) == 0) {
+          strText.resize(vSymbols.back());
+          vSymbols.pop_back();
+        }
+        break;
+    }
+  }
+  return strText;
+}
+
+string CLearningJournal::Fingerprint() {
+  CFileLister lister(m_pInterface);
+  for (const char * const *szSuffix = CTrainingInput::SUFFIXES; *szSuffix; szSuffix++)
+    m_pInterface->ScanFiles(&lister, m_strTrainingFile + *szSuffix);
+  if (lister.m_bUnknown) return "";
+  //order of scanning is up to the platform
+  sort(lister.m_vFiles.begin(), lister.m_vFiles.end());
+  string strFingerprint(m_strModelKey);
+  for (vector<string>::const_iterator it = lister.m_vFiles.begin(); it != lister.m_vFiles.end(); it++)
+    strFingerprint += "\n" + *it;
+  return strFingerprint;
+}
+
+bool CLearningJournal::LoadSnapshot(CLanguageModel *pLM) {
+  const string strFingerprint(Fingerprint());
+  if (strFingerprint.empty()) return false;
+  ifstream in(m_strSnapshotPath.c_str(), ios::binary);
+  char header[sizeof(SNAPSHOT_MAGIC) + 8];
+  if (!in.read(header, sizeof(header)) || memcmp(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC))) return false;
+  const unsigned int iGeneration = GetU32(header + sizeof(SNAPSHOT_MAGIC));
+  const unsigned int iLen = GetU32(header + sizeof(SNAPSHOT_MAGIC) + 4);
+  if (iLen != strFingerprint.length()) return false;
+  string strSnapFingerprint(iLen, '\0');
+  if (!in.read(&strSnapFingerprint[0], iLen) || strSnapFingerprint != strFingerprint) return false;
+  //The snapshot includes everything in the training files (as per the fingerprint) but nothing
+  // in the journal - either a journal of the same generation, or the previous one if the
+  // compaction which wrote the snapshot got as far as folding that but not replacing it.
+  if (iGeneration != m_iGeneration && !(iGeneration == m_iGeneration + 1 && m_bFolded)) return false;
+  if (!pLM->ReadFromStream(in)) return false;
+  if (iGeneration != m_iGeneration) {
+    m_iGeneration = iGeneration;
+    m_bNeedsRewrite = true;
+  }
+  return m_bSnapshotLoaded = true;
+}
+
+void CLearningJournal::Replay(CTrainer *pTrainer) {
+  const string strText(RecordsToText(m_strRecords));
+  if (strText.empty()) return;
+  istringstream in(strText);
+  pTrainer->SetProgressIndicator(NULL);
+  pTrainer->Parse("file://" + m_strJournalPath, in, true);
+}
+
+void CLearningJournal::CompactIfNeeded(CLanguageModel *pLM) {
+  if (m_bSnapshotLoaded && m_iJournalSize <= COMPACT_THRESHOLD) return;
+  const string strText(RecordsToText(m_strRecords));
+  if (!strText.empty()) {
+    //1. Record where the text is going, so if we crash part way through appending it,
+    // we can tell how much was written next time
+    long long iOffset = FileSize(m_strTextPath);
+    string strFold;
+    PutVarint(strFold, iOffset < 0 ? 0 : iOffset);
+    if (!WriteJournal(m_iGeneration, m_strRecords + EncodeRecord(REC_FOLD, strFold))) return;
+    //2. Append it
+    FILE *f = fopen(m_strTextPath.c_str(), "ab");
+    bool bOk = f && fwrite(strText.data(), 1, strText.length(), f) == strText.length() && SyncFile(f);
+    if (f && fclose(f)) bOk = false;
+    if (!bOk) {
+      m_pInterface->FormatMessageWithString(_("Unable to open file \"%s\" for writing"), m_strTextPath.c_str());
+      return;
+    }
+    //the journal file now has valid records of the fold
+    m_strRecords.clear();
+    m_bNeedsRewrite = false;
+  }
+  //3. Snapshot the model, as trained on what are now the contents of the training files...
+  WriteSnapshot(pLM, m_iGeneration + 1);
+  //4. ...and start the matching generation of journal
+  if (WriteJournal(m_iGeneration + 1, "")) {
+    m_iGeneration++;
+    m_bNeedsRewrite = false;
+    m_iJournalSize = 0;
+  }
+}
+
+bool CLearningJournal::WriteJournal(unsigned int iGeneration, const string &strRecords) {
+  const string strTmp(m_strJournalPath + ".tmp");
+  FILE *f = fopen(strTmp.c_str(), "wb");
+  if (!f) return false;
+  string strHeader(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+  PutU32(strHeader, iGeneration);
+  bool bOk = fwrite(strHeader.data(), 1, strHeader.length(), f) == strHeader.length()
+    && (strRecords.empty() || WriteBlock(f, strRecords)) && SyncFile(f);
+  if (fclose(f)) bOk = false;
+  if (bOk && ReplaceFile(strTmp, m_strJournalPath)) return true;
+  remove(strTmp.c_str());
+  return false;
+}
+
+bool CLearningJournal::WriteSnapshot(CLanguageModel *pLM, unsigned int iGeneration) {
+  const string strFingerprint(Fingerprint());
+  if (strFingerprint.empty()) return false;
+  const string strTmp(m_strSnapshotPath + ".tmp");
+  bool bOk;
+  {
+    ofstream out(strTmp.c_str(), ios::binary);
+    string strHeader(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    PutU32(strHeader, iGeneration);
+    PutU32(strHeader, strFingerprint.length());
+    out << strHeader << strFingerprint;
+    //models which can't be snapshotted just retrain from the files each time
+    bOk = out && pLM->WriteToStream(out);
+    out.close();
+    bOk = bOk && !out.fail();
+  }
+  if (bOk && SyncPath(strTmp) && ReplaceFile(strTmp, m_strSnapshotPath)) return true;
+  remove(strTmp.c_str());
+  return false;
+}
+
+bool CLearningJournal::Start() {
+  DASHER_ASSERT(!m_pFile);
+  if ((m_bNeedsRewrite && !WriteJournal(m_iGeneration, m_strRecords))
+      || !(m_pFile = fopen(m_strJournalPath.c_str(), "ab"))) {
+    m_pInterface->FormatMessageWithString(_("Unable to open file \"%s\" for writing"), m_strJournalPath.c_str());
+    return false;
+  }
+  //all in the file now, and replayed
+  m_strRecords.clear();
+  m_thread = thread(&CLearningJournal::Run, this);
+  return true;
+}
+
+void CLearningJournal::Append(char cType, const string &strData) {
+  const bool bWasEmpty(m_strPending.empty());
+  if (bWasEmpty) m_tOldestPending = chrono::steady_clock::now();
+  m_strPending += EncodeRecord(cType, strData);
+  //writer needs to know the deadline, or that there's enough to write now
+  if (bWasEmpty || m_strPending.length() >= MAX_PENDING) m_cond.notify_all();
+}
+
+void CLearningJournal::Context(const string &strSwitch) {
+  lock_guard<mutex> lock(m_mutex);
+  m_vPendingSymbols.clear();
+  Append(REC_CONTEXT, strSwitch);
+}
+
+void CLearningJournal::Symbol(const string &strText) {
+  lock_guard<mutex> lock(m_mutex);
+  m_vPendingSymbols.push_back(m_strPending.length());
+  Append(REC_SYMBOL, strText);
+}
+
+void CLearningJournal::Undo(const string &strText) {
+  lock_guard<mutex> lock(m_mutex);
+  //if the symbol hasn't been written yet, no need to write it at all
+  if (!m_vPendingSymbols.empty() && m_strPending.compare(m_vPendingSymbols.back(), string::npos, EncodeRecord(REC_SYMBOL, strText)) == 0) {
+    m_strPending.resize(m_vPendingSymbols.back());
+    m_vPendingSymbols.pop_back();
+  } else Append(REC_UNDO, strText);
+}
+
+void CLearningJournal::Flush() {
+  if (!m_thread.joinable()) return;
+  unique_lock<mutex> lock(m_mutex);
+  m_bFlushRequested = true;
+  m_cond.notify_all();
+  while (!m_strPending.empty() || m_bWriting) m_cond.wait(lock);
+  if (m_bWriteFailed) {
+    m_bWriteFailed = false;
+    lock.unlock();
+    m_pInterface->FormatMessageWithString(_("Unable to open file \"%s\" for writing"), m_strJournalPath.c_str());
+  }
+}
+
+void CLearningJournal::Run() {
+  CPerfTrace::SetThreadName("journal");
+  unique_lock<mutex> lock(m_mutex);
+  while (true) {
+    if (m_strPending.empty()) {
+      if (m_bStop) break;
+      m_bFlushRequested = false;
+      m_cond.wait(lock);
+      continue;
+    }
+    //wait until the oldest record reaches the latency bound, unless told to write sooner
+    if (!m_bStop && !m_bFlushRequested && m_strPending.length() < MAX_PENDING
+        && m_cond.wait_until(lock, m_tOldestPending + chrono::milliseconds(MAX_LATENCY_MS)) == cv_status::no_timeout)
+      continue;
+    string strRecords;
+    strRecords.swap(m_strPending);
+    m_vPendingSymbols.clear();
+    m_bFlushRequested = false;
+    m_bWriting = true;
+    lock.unlock();
+    const bool bOk = WriteBlock(m_pFile, strRecords);
+    lock.lock();
+    m_bWriting = false;
+    if (!bOk) m_bWriteFailed = true;
+    m_cond.notify_all();
+  }
+}
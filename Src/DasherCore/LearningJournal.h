@@ -0,0 +1,165 @@
+#ifndef __LearningJournal_h__
+#define __LearningJournal_h__
+
+#include "../Common/Common.h"
+#include "../Common/NoClones.h"
+#include "LanguageModelling/LanguageModel.h"
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace Dasher {
+  class CDasherInterfaceBase;
+  class CTrainer;
+  class CLearningJournal;
+}
+
+/// \ingroup LM
+/// @{
+
+/// Append-only, crash-safe record of text written with BP_LM_ADAPTIVE, replacing
+/// appending to the user's training file on every context switch.
+///
+/// The CAlphabetManager reports each symbol written (as the text it would have
+/// put into the training file), each undo, and each context switch. These are
+/// encoded as binary records and written by a background thread in checksummed
+/// blocks, one fsync per block; a block is written when its oldest record is
+/// MAX_LATENCY_MS old (or on Flush()), so nothing is lost to a crash beyond the
+/// last MAX_LATENCY_MS of text entry, and no file I/O happens on the output path.
+///
+/// Both files live next to the user's training file (per CDasherInterfaceBase::GetUserDataFilePath):
+///  - <training file>.journal: the records. Shared by all alphabets using that training file,
+///    just as the training file is.
+///  - <training file>.<alphabet-hash>.model: snapshot of a trained CLanguageModel, tagged with a
+///    fingerprint of everything that went into it (alphabet, LM settings, training files and
+///    their sizes) and the generation of the journal started when it was written.
+/// At startup, a valid snapshot is loaded (rather than retraining on all the training text),
+/// and only the journal is replayed on top. Compaction - when the journal gets large, or
+/// if there was no valid snapshot - appends the journal to the user's (text) training file,
+/// snapshots the model, and starts a new, empty, generation of the journal; each step is
+/// ordered so that a crash part-way through neither loses nor duplicates any text.
+class Dasher::CLearningJournal : private NoClones {
+public:
+  ///Create a journal for the specified training file, and read whatever is already in it.
+  /// \param strModelKey identifies the alphabet and language model parameters: any snapshot
+  /// made with a different key will be ignored.
+  /// \return NULL if the platform does not keep user data in files we can write ourselves;
+  /// the user training file should then be appended to, as before.
+  static CLearningJournal *Create(CDasherInterfaceBase *pInterface, const std::string &strTrainingFile,
+                                  const std::string &strModelKey);
+  ~CLearningJournal();
+
+  /// @name Startup
+  /// Call in this order, before any of the Recording methods.
+  /// @{
+
+  ///Try to restore a language model from the snapshot.
+  /// \param pLM freshly created, untrained, model
+  /// \return true if pLM now has the state snapshotted, which was valid for the current
+  /// training files; if false, pLM is unchanged, and should be trained as normal.
+  bool LoadSnapshot(CLanguageModel *pLM);
+
+  ///Whether the journal contains any text not yet in the user training file
+  bool HasRecords() const {return !m_strRecords.empty();}
+
+  ///Trains on the text in the journal (that the training files do not already include).
+  void Replay(CTrainer *pTrainer);
+
+  ///Compacts the journal (folding it into the user training file, and snapshotting pLM,
+  /// which must have been trained on everything) if that's worthwhile: if there was no
+  /// valid snapshot, the journal has got large, or it needs repairing after a crash.
+  void CompactIfNeeded(CLanguageModel *pLM);
+
+  ///Opens the journal for appending and starts the background writer.
+  /// \return false if the journal could not be opened (the user has been told);
+  /// the journal should then be deleted, and the training file appended to as before.
+  bool Start();
+  /// @}
+
+  /// @name Recording
+  /// Called as text is written; these do not block on I/O.
+  /// @{
+
+  ///Text following will be written in a new context
+  /// \param strSwitch context-switch command, exactly as it would appear in a training file
+  void Context(const std::string &strSwitch);
+  ///Text has been written in the current context
+  /// \param strText as it would appear in a training file (i.e. escaped)
+  void Symbol(const std::string &strText);
+  ///The last text written (which must match that specified) has been undone.
+  void Undo(const std::string &strText);
+  ///Blocks until everything recorded so far is on disk.
+  void Flush();
+  /// @}
+
+  ///Maximum time for which recorded text may be held in memory before it is written
+  static const int MAX_LATENCY_MS = 1000;
+  ///Recorded text is written sooner if there is at least this much (in bytes)
+  static const size_t MAX_PENDING = 64*1024;
+  ///Journals bigger than this (in bytes) are compacted at the next startup
+  static const size_t COMPACT_THRESHOLD = 256*1024;
+
+private:
+  CLearningJournal(CDasherInterfaceBase *pInterface, const std::string &strTrainingFile,
+                   const std::string &strModelKey, const std::string &strTextPath);
+
+  ///Record types
+  enum {REC_CONTEXT='C', REC_SYMBOL='S', REC_UNDO='U', REC_FOLD='F'};
+
+  ///Reads the journal file, validating blocks and checking (and if need be, undoing)
+  /// any partial fold into the user training file.
+  void ReadJournal();
+  ///Converts records (as stored in the journal) to the text format used in training files.
+  static std::string RecordsToText(const std::string &strRecords);
+  ///Fingerprint of the training files, as found by ScanFiles, with m_strModelKey
+  std::string Fingerprint();
+
+  ///Atomically replaces the journal with one of the specified generation, containing
+  /// the specified records (as a single block, if any).
+  bool WriteJournal(unsigned int iGeneration, const std::string &strRecords);
+  ///Writes a snapshot of the model, tagged with the specified generation
+  bool WriteSnapshot(CLanguageModel *pLM, unsigned int iGeneration);
+
+  ///Appends a record to m_strPending (caller must hold m_mutex)
+  void Append(char cType, const std::string &strData);
+  ///Body of the background writer thread
+  void Run();
+
+  CDasherInterfaceBase * const m_pInterface;
+  const std::string m_strTrainingFile, m_strModelKey, m_strTextPath, m_strJournalPath, m_strSnapshotPath;
+
+  ///Generation of the journal file, incremented by each compaction
+  unsigned int m_iGeneration;
+  ///Records (from valid blocks of the journal file) not yet folded into the user training file
+  std::string m_strRecords;
+  ///Size of the journal file
+  size_t m_iJournalSize;
+  ///Whether the journal file had a bad header or tail, or (valid) records of a fold
+  bool m_bNeedsRewrite;
+  ///Whether the journal file recorded a fold that had completed
+  bool m_bFolded;
+  bool m_bSnapshotLoaded;
+
+  FILE *m_pFile;
+
+  ///Guards everything below here, which is shared with the writer thread
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::thread m_thread;
+  ///Encoded records not yet passed to the writer
+  std::string m_strPending;
+  ///Offsets in m_strPending of symbol records since the last context record,
+  /// which can be undone by simply removing them
+  std::vector<size_t> m_vPendingSymbols;
+  ///When the oldest record in m_strPending was recorded
+  std::chrono::steady_clock::time_point m_tOldestPending;
+  bool m_bWriting, m_bFlushRequested, m_bStop, m_bWriteFailed;
+};
+/// @}
+
+#endif
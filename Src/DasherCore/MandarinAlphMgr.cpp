@@ -27,10 +27,12 @@
 #include "Event.h"
 #include "Observable.h"
 #include "NodeCreationManager.h"
+#include "PerfTrace.h"
 
 #include <string.h>
 
 #include <vector>
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 
@@ -154,7 +156,7 @@ const string &CMandarinAlphMgr::GetLabelText(symbol i) const {
 CMandarinAlphMgr::~CMandarinAlphMgr() {
   for (vector<CDasherScreen::Label *>::iterator it=m_vCHLabels.begin(); it!=m_vCHLabels.end(); it++)
     delete *it;
-  m_pPYgroups->RecursiveDelete();
+  SGroupInfo::RecursiveDelete(m_pPYgroups);
 }
 
 void CMandarinAlphMgr::CreateLanguageModel() {
@@ -205,6 +207,8 @@ symbol CMandarinAlphMgr::CMandarinTrainer::getPYsym(bool bHavePy, const string &
 }
 
 void CMandarinAlphMgr::CMandarinTrainer::Train(CAlphabetMap::SymbolStream &syms) {
+  PERF_TRACE_SPAN("CTrainer::Train");
+  CLanguageModel::CWriter writer(m_pLanguageModel);
   CLanguageModel::Context trainContext = m_pLanguageModel->CreateEmptyContext();
   //store a set of CH symbols which need annotations but have appeared without them
   // in this training file. We do this to cut down on the number of error messages
@@ -377,20 +381,36 @@ void CMandarinAlphMgr::CConvRoot::SetFlag(int iFlag, bool bValue) {
       && !GetFlag(NF_GAME) && mgr()->GetBoolParameter(BP_LM_ADAPTIVE)) {
     //CConvRoot's context is the same as parent's context (no symbol yet!),
     // i.e. is the context in which the pinyin was predicted.
+    CLanguageModel::CWriter writer(mgr()->m_pLanguageModel);
     static_cast<CPPMPYLanguageModel *>(mgr()->m_pLanguageModel)->LearnPYSymbol(iContext, m_pySym);
   }
   CDasherNode::SetFlag(iFlag,bValue);
 }
 
-// For sorting pair<symbol, probability>s into descending order
-// (most probable first, hence sense of >)
-bool CompSecond(const pair<symbol,unsigned int> &a, const pair<symbol,unsigned int> &b) {
-  return a.second>b.second;
+namespace {
+  // For ordering indices into a list of pair<symbol, probability>s by descending
+  // probability (most probable first, hence sense of >), ties broken by index, i.e.
+  // alphabet order: the same order as a stable_sort, but usable by nth_element.
+  class CompProb {
+  public:
+    CompProb(const vector<pair<symbol,unsigned int> > &vProbs) : m_vProbs(vProbs) {}
+    bool operator()(unsigned int a, unsigned int b) const {
+      return m_vProbs[a].second > m_vProbs[b].second
+        || (m_vProbs[a].second == m_vProbs[b].second && a<b);
+    }
+  private:
+    const vector<pair<symbol,unsigned int> > &m_vProbs;
+  };
 }
 
+const unsigned int CMandarinAlphMgr::CONV_SORT_BLOCK;
+
 void CMandarinAlphMgr::GetConversions(std::vector<pair<symbol,unsigned int> > &vChildren, symbol pySym, Dasher::CLanguageModel::Context context) {
 
   const vector<symbol> &convs(m_vConversionsByGroup[pySym]);
+  const size_t iNum(convs.size());
+  vChildren.clear();
+  vChildren.reserve(iNum);
 
   //Symbols which we are including with the probabilities predicted by the LM.
   // We do this for the most probable symbols first, up to at least BY_PY_PROB_SORT_THRES
@@ -399,7 +419,10 @@ void CMandarinAlphMgr::GetConversions(std::vector<pair<symbol,unsigned int> > &v
   // more probable ones).
   //Two degenerate cases: PROB_SORT_THRES=0 => all (legal) ch symbols predicted uniformly
   // PROB_SORT_THRES=100 => all symbols put into probability order
-  set<symbol> haveProbs;
+  //Only as many symbols as are needed to reach the threshold are put in order:
+  // we select (nth_element) and sort the most probable CONV_SORT_BLOCK, then if
+  // need be the next 2*CONV_SORT_BLOCK after those, and so on.
+  size_t iHaveProbs(0);
   uint64 iRemaining(CDasherModel::NORMALIZATION);
   
   if (long percent=GetLongParameter(LP_PY_PROB_SORT_THRES)) {
@@ -407,53 +430,75 @@ void CMandarinAlphMgr::GetConversions(std::vector<pair<symbol,unsigned int> > &v
     const unsigned int uniform((GetLongParameter(LP_UNIFORM)*iNorm)/1000);
     
     //Set up list of symbols with blank probability entries...
+    m_vConvProbs.clear();
     for(vector<symbol>::const_iterator it = convs.begin(); it != convs.end(); ++it) {
-      vChildren.push_back(std::pair<symbol, unsigned int>(*it,0));
+      m_vConvProbs.push_back(std::pair<symbol, unsigned int>(*it,0));
     }
     
     //Then call LM to fill in the probs, passing iNorm and uniform directly -
-    // GetPartProbs distributes the last param between however elements there are in vChildren...
-    static_cast<CPPMPYLanguageModel *>(m_pLanguageModel)->GetPartProbs(context, vChildren, iNorm, uniform);
-  
-    //std::cout<<"after get probs "<<std::endl;
+    // GetPartProbs distributes the last param between however elements there are in m_vConvProbs...
+    static_cast<CPPMPYLanguageModel *>(m_pLanguageModel)->GetPartProbs(context, m_vConvProbs, iNorm, uniform);
   
+#ifdef DEBUG
     uint64 sumProb=0;  
-    for (std::vector<pair<symbol,unsigned int> >::const_iterator it = vChildren.begin(); it!=vChildren.end(); it++) {
+    for (std::vector<pair<symbol,unsigned int> >::const_iterator it = m_vConvProbs.begin(); it!=m_vConvProbs.end(); it++) {
       sumProb += it->second;
     }
     DASHER_ASSERT(sumProb==iNorm);
-    
-    //Sort all symbols into probability order (highest first)
-    stable_sort(vChildren.begin(), vChildren.end(), CompSecond);
-    if (percent>=100) return; //and that's what's required.
+#endif
+
+    m_vConvOrder.resize(iNum);
+    for (unsigned int i=0; i<iNum; i++) m_vConvOrder[i]=i;
+    const CompProb comp(m_vConvProbs);
+
+    if (percent>=100) {
+      //Sort all symbols into probability order (highest first), and that's what's required.
+      sort(m_vConvOrder.begin(), m_vConvOrder.end(), comp);
+      for (vector<unsigned int>::const_iterator it=m_vConvOrder.begin(); it!=m_vConvOrder.end(); it++)
+        vChildren.push_back(m_vConvProbs[*it]);
+      return;
+    }
     
     //ok, some symbols as predicted by LM, others not...
-    vector<pair<symbol,unsigned int> > probOrder;
-    swap(vChildren, probOrder);
     const unsigned int stop(iNorm - (iNorm*percent)/100);//intermediate values are uint64
-    for (vector<pair<symbol, unsigned int> >::iterator it=probOrder.begin(); iRemaining>stop; it++) {
+    size_t iSorted(0), iBlock(CONV_SORT_BLOCK);
+    while (iRemaining>stop) {
+      if (iHaveProbs == iSorted) {
+        //Bring the next most probable block to the front of what's left, in order
+        const vector<unsigned int>::iterator itStart(m_vConvOrder.begin()+iSorted);
+        iSorted = min(iNum, iSorted+iBlock);
+        if (iSorted<iNum) nth_element(itStart, m_vConvOrder.begin()+iSorted, m_vConvOrder.end(), comp);
+        sort(itStart, m_vConvOrder.begin()+iSorted, comp);
+        iBlock*=2;
+      }
+      const pair<symbol,unsigned int> &next(m_vConvProbs[m_vConvOrder[iHaveProbs]]);
       //assert: the remaining probability mass, divided by the remaining symbols,
       // (i.e. the probability mass each symbol would receive if we uniformed the rest)
       // must be less than the probability predicted by the LM (as we're processing
       // symbols in decreasing order)
-      DASHER_ASSERT(iRemaining <= it->second*(convs.size()-vChildren.size()));
-      vChildren.push_back(*it);
-      haveProbs.insert(it->first);
-      iRemaining-=it->second;
+      DASHER_ASSERT(iRemaining <= next.second*(iNum-iHaveProbs));
+      vChildren.push_back(next);
+      iRemaining-=next.second;
+      iHaveProbs++;
     }
   }
   //Now distribute iRemaining uniformly between all remaining symbols,
   // keeping them in alphabet order
   if (iRemaining) {
-    unsigned int iEach(iRemaining / (convs.size() - haveProbs.size()));
-    for (vector<symbol>::const_iterator it=convs.begin(); it!=convs.end(); it++) {
-      if (haveProbs.count(*it)==0)
+    const unsigned int iEach(iRemaining / (iNum - iHaveProbs));
+    if (iHaveProbs) {
+      m_vConvTaken.assign(iNum, false);
+      for (size_t i=0; i<iHaveProbs; i++) m_vConvTaken[m_vConvOrder[i]] = true;
+      for (size_t i=0; i<iNum; i++)
+        if (!m_vConvTaken[i]) vChildren.push_back(pair<symbol,unsigned int>(convs[i],iEach));
+    } else {
+      for (vector<symbol>::const_iterator it=convs.begin(); it!=convs.end(); it++)
         vChildren.push_back(pair<symbol,unsigned int>(*it,iEach));
     }
     
     //account for rounding error by topping up
-    DASHER_ASSERT(vChildren.size() == convs.size());
-    iRemaining -= iEach * (convs.size() - haveProbs.size());
+    DASHER_ASSERT(vChildren.size() == iNum);
+    iRemaining -= iEach * (iNum - iHaveProbs);
     unsigned int iLeft = vChildren.size();
     for (vector<pair<symbol, unsigned int> >::iterator it=vChildren.end(); iRemaining && it-- != vChildren.begin();) {
       const unsigned int p(iRemaining / iLeft);
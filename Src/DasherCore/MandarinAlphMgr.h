@@ -141,6 +141,10 @@ namespace Dasher {
       CMandSym(int iOffset, CMandarinAlphMgr *pMgr, symbol iSymbol, symbol pyParent);
       CDasherNode *RebuildSymbol(CAlphNode *pParent, symbol iSymbol);
       CMandSym *RebuildCHSymbol(CConvRoot *pParent, symbol iNewSym);
+      void ReportMemory(CMemoryReport &report) const {
+        report.Add("nodes/mandarin-symbol", 1, sizeof(CMandSym));
+        ReportProbs(report);
+      }
     protected:
       ///Override to compute which pinyin symbol to make our parent...
       void RebuildForwardsFromAncestor(CAlphNode *pNewNode);
@@ -169,6 +173,9 @@ namespace Dasher {
       const symbol m_pySym;
       ///A "symbol" to be rebuilt, is a PY sound, i.e. potentially this
       CDasherNode *RebuildSymbol(CAlphNode *pParent, symbol iSymbol);
+      void ReportMemory(CMemoryReport &report) const {
+        report.Add("nodes/conversion-root", 1, sizeof(CConvRoot) + m_vChInfo.capacity() * sizeof(m_vChInfo[0]));
+      }
     protected:
       bool isInGroup(const SGroupInfo *pGroup);
     private:
@@ -196,7 +203,9 @@ namespace Dasher {
 
     ///Gets the possible chinese symbols for a pinyin one, along with their probabilities in the specified context.
     ///Probabilities are computed by CPPMPYLanguageModel::GetPartProbs, then renormalized here. (TODO unnecessary?)
-    /// \param vChildren initially empty vector which procedure fills with pairs: first element chinese symbol number,
+    /// Only the most probable symbols, up to LP_PY_PROB_SORT_THRES, are sorted; the rest
+    /// follow in alphabet order, sharing the remaining probability uniformly.
+    /// \param vChildren vector which procedure clears and fills with pairs: first element chinese symbol number,
     /// second element probability (/NORMALIZATION).    
     void GetConversions(std::vector<std::pair<symbol,unsigned int> > &vChildren, symbol pySym, Dasher::CLanguageModel::Context context);
 
@@ -244,6 +253,15 @@ namespace Dasher {
     /// under the new pinyin #.
     std::vector<std::string> m_vGroupNames;
 
+    ///Scratch space for GetConversions, kept between calls to avoid reallocating:
+    /// LM probabilities of all conversions (in alphabet order); indices into that,
+    /// most probable first (as far as sorted); and which indices are so ordered.
+    std::vector<std::pair<symbol,unsigned int> > m_vConvProbs;
+    std::vector<unsigned int> m_vConvOrder;
+    std::vector<bool> m_vConvTaken;
+    ///Number of most-probable conversions GetConversions sorts first (then twice as many, etc.)
+    static const unsigned int CONV_SORT_BLOCK = 16;
+
     //Used to create labels lazily
     CDasherScreen *m_pScreen;
     CDasherScreen::Label *GetCHLabel(int iCHsym);
@@ -0,0 +1,52 @@
+// MemoryReport.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "MemoryReport.h"
+
+using namespace Dasher;
+using namespace std;
+
+void CMemoryReport::Add(const string &strCategory, size_t iCount, size_t iBytes) {
+  SEntry &entry(m_mEntries[m_strPrefix + strCategory]);
+  entry.iCount += iCount;
+  entry.iBytes += iBytes;
+}
+
+void CMemoryReport::AddShared(const string &strCategory, const void *pObject, size_t iBytes) {
+  if (m_sShared.insert(pObject).second) Add(strCategory, 1, iBytes);
+}
+
+size_t CMemoryReport::TotalBytes() const {
+  size_t iTotal(0);
+  for (map<string, SEntry>::const_iterator it = m_mEntries.begin(); it != m_mEntries.end(); it++)
+    iTotal += it->second.iBytes;
+  return iTotal;
+}
+
+void CMemoryReport::WriteJSON(ostream &out) const {
+  //categories are our own names, so need no escaping
+  out << "{\"totalBytes\":" << TotalBytes() << ",\"categories\":{";
+  for (map<string, SEntry>::const_iterator it = m_mEntries.begin(); it != m_mEntries.end(); it++)
+    out << (it == m_mEntries.begin() ? "\n" : ",\n") << '"' << it->first << "\":{\"count\":"
+        << it->second.iCount << ",\"bytes\":" << it->second.iBytes << '}';
+  out << "\n}}\n";
+}
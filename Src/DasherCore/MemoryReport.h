@@ -0,0 +1,94 @@
+// MemoryReport.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __MemoryReport_h__
+#define __MemoryReport_h__
+
+#include "../Common/NoClones.h"
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+
+namespace Dasher {
+  class CMemoryReport;
+}
+
+/// \ingroup Logging
+/// @{
+
+/// Snapshot of the objects alive in a running Dasher, and the memory they use,
+/// by category: each subsystem (language model, node tree, caches, screen,
+/// user log...) adds its own via a ReportMemory method, and
+/// CDasherInterfaceBase::GetMemoryReport collects them all. Categories are
+/// paths separated by '/', e.g. "lm/ppm/nodes/hash", most general first.
+///
+/// Byte counts are of the objects' own storage (what sizeof and the sizes of
+/// any arrays they own add up to), not of any allocator overhead or of pools
+/// allocated but not in use; they are for seeing where memory goes, and what
+/// is growing, rather than for accounting to the byte.
+class Dasher::CMemoryReport : private NoClones {
+public:
+  struct SEntry {
+    size_t iCount, iBytes;
+  };
+
+  CMemoryReport() {}
+
+  ///Adds iCount objects, together using iBytes, to a category (created if needed)
+  void Add(const std::string &strCategory, size_t iCount, size_t iBytes);
+
+  ///Adds an object which may be reachable from several places (e.g. a probability
+  /// table shared between nodes and a cache), unless already added (to any category)
+  void AddShared(const std::string &strCategory, const void *pObject, size_t iBytes);
+
+  const std::map<std::string, SEntry> &GetEntries() const {return m_mEntries;}
+
+  ///Sum of the bytes in every category
+  size_t TotalBytes() const;
+
+  ///Writes the report as a JSON object: the total bytes, and the count and
+  /// bytes in each category.
+  void WriteJSON(std::ostream &out) const;
+
+  ///Prefixes the categories of everything added during its lifetime, e.g. to
+  /// distinguish two language models of the same kind. Scopes must be nested.
+  class CScope : private NoClones {
+  public:
+    ///\param strPrefix should end with '/'
+    CScope(CMemoryReport &report, const std::string &strPrefix)
+      : m_report(report), m_iLength(report.m_strPrefix.length()) {report.m_strPrefix += strPrefix;}
+    ~CScope() {m_report.m_strPrefix.resize(m_iLength);}
+  private:
+    CMemoryReport &m_report;
+    const size_t m_iLength;
+  };
+
+private:
+  std::map<std::string, SEntry> m_mEntries;
+  std::set<const void *> m_sShared;
+  std::string m_strPrefix;
+};
+
+/// @}
+
+#endif
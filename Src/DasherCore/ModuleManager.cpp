@@ -27,6 +27,9 @@
 
 using namespace Dasher;
 
+CModuleManager::CModuleManager() : m_pDefaultInputDevice(NULL), m_pDefaultInputMethod(NULL) {
+}
+
 CDasherModule *CModuleManager::RegisterModule(CDasherModule *pModule) {
     m_vModules.push_back(pModule);
     ModuleID_t id = m_vModules.size() - 1;
@@ -37,6 +37,7 @@ enum ModuleType {InputDevice = 0, InputMethod = 1};
 /// \{
 class CModuleManager {
  public:
+  CModuleManager();
   ~CModuleManager();
   CDasherModule *RegisterModule(CDasherModule *pModule);
   CDasherModule *GetModule(ModuleID_t iID);
@@ -0,0 +1,103 @@
+// NodeBudgetController.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "NodeBudgetController.h"
+#include "FileLogger.h"
+#include "PerfTrace.h"
+
+#include <algorithm>
+
+using namespace Dasher;
+using std::min;
+using std::max;
+
+extern CFileLogger* g_pLogger;
+
+const unsigned int CNodeBudgetController::MIN_BUDGET;
+const unsigned int CNodeBudgetController::MAX_BUDGET;
+const unsigned int CNodeBudgetController::MIN_EXPANDS;
+const unsigned int CNodeBudgetController::MAX_EXPANDS;
+const int CNodeBudgetController::COOLDOWN_FRAMES;
+const double CNodeBudgetController::HYSTERESIS = 0.15;
+const double CNodeBudgetController::SMOOTHING = 0.2;
+
+CNodeBudgetController::CNodeBudgetController(AmortizedPolicy *pPolicy, long iTargetTime)
+: m_pPolicy(pPolicy), m_iTargetTime(iTargetTime), m_dRenderTime(-1.0), m_dExpandTime(-1.0),
+  m_iFrames(0), m_iBudgetLimited(0), m_iExpansionLimited(0) {
+  //start from wherever the user's LP_NODE_BUDGET put us, but within our bounds
+  m_pPolicy->SetNodeBudget(min(MAX_BUDGET, max(MIN_BUDGET, m_pPolicy->GetNodeBudget())));
+  m_pPolicy->SetMaxExpands(min(MAX_EXPANDS, max(MIN_EXPANDS, m_pPolicy->GetMaxExpands())));
+}
+
+bool CNodeBudgetController::FrameRendered(long iRenderTime, long iExpandTime) {
+  if (m_dRenderTime < 0) {
+    m_dRenderTime = iRenderTime;
+    m_dExpandTime = iExpandTime;
+  } else {
+    m_dRenderTime += SMOOTHING * (iRenderTime - m_dRenderTime);
+    m_dExpandTime += SMOOTHING * (iExpandTime - m_dExpandTime);
+  }
+  if (m_pPolicy->WasBudgetLimited()) m_iBudgetLimited++;
+  if (m_pPolicy->WasExpansionLimited()) m_iExpansionLimited++;
+  if (++m_iFrames < COOLDOWN_FRAMES) return false;
+
+  const double dTotal(m_dRenderTime + m_dExpandTime);
+  const unsigned int iOldBudget(m_pPolicy->GetNodeBudget()), iOldExpands(m_pPolicy->GetMaxExpands());
+  unsigned int iBudget(iOldBudget), iExpands(iOldExpands);
+  const char *szReason;
+
+  if (dTotal > m_iTargetTime * (1.0 + HYSTERESIS)) {
+    //Too slow.
+    if (m_dExpandTime > m_dRenderTime && iExpands > MIN_EXPANDS) {
+      szReason = "expansion too slow";
+      iExpands = max(MIN_EXPANDS, iExpands/2);
+    } else {
+      szReason = "rendering too slow";
+      //cut in proportion to the overrun, but by no more than a quarter at a time
+      iBudget = max(MIN_BUDGET, static_cast<unsigned int>(iBudget * max(0.75, m_iTargetTime / dTotal)));
+    }
+  } else if (dTotal < m_iTargetTime * (1.0 - HYSTERESIS)) {
+    //Time to spare. Relax whichever limit has been holding the policy back.
+    if (m_iExpansionLimited*2 > m_iFrames && iExpands < MAX_EXPANDS) {
+      szReason = "expansions limited";
+      iExpands++;
+    } else if (m_iBudgetLimited*2 > m_iFrames) {
+      szReason = "budget limited";
+      iBudget = min(MAX_BUDGET, static_cast<unsigned int>(iBudget * 1.1));
+    } else szReason = NULL;
+  } else szReason = NULL;
+
+  if (iBudget == iOldBudget && iExpands == iOldExpands) {
+    //no change needed (or possible). Keep measuring, but forget old frames' limits.
+    m_iFrames = m_iBudgetLimited = m_iExpansionLimited = 0;
+    return false;
+  }
+  LOG(("Node budget: %.1fms/frame (render %.1fms, expand %.1fms; target %.1fms), %s: budget %u -> %u, max expansions %u -> %u",
+       logNORMAL, dTotal/1000.0, m_dRenderTime/1000.0, m_dExpandTime/1000.0, m_iTargetTime/1000.0, szReason,
+       iOldBudget, iBudget, iOldExpands, iExpands));
+  m_pPolicy->SetNodeBudget(iBudget);
+  m_pPolicy->SetMaxExpands(iExpands);
+  PERF_TRACE_COUNTER("Node budget", iBudget);
+  PERF_TRACE_COUNTER("Max expansions", iExpands);
+  m_iFrames = m_iBudgetLimited = m_iExpansionLimited = 0;
+  return true;
+}
@@ -0,0 +1,81 @@
+// NodeBudgetController.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __NodeBudgetController_h__
+#define __NodeBudgetController_h__
+
+#include "ExpansionPolicy.h"
+
+namespace Dasher {
+  class CNodeBudgetController;
+}
+
+/// \ingroup Model
+/// \{
+
+/// Closed-loop control of an AmortizedPolicy's node budget and maximum
+/// expansions per frame, to keep the time taken to render the nodes (and
+/// expand/collapse them) close to a target, whatever the speed of the machine.
+///
+/// Times are smoothed over several frames, and nothing changes while they are
+/// within a band of HYSTERESIS either side of the target, or for COOLDOWN_FRAMES
+/// after the last change (so the effect of that change can be measured). When
+/// too slow, we reduce the maximum expansions per frame if expansion accounts
+/// for most of the time, otherwise the budget (in proportion to the overrun);
+/// when too fast, we increase whichever limit has actually been constraining the
+/// policy (if neither, a bigger budget would just be unused). Each decision is
+/// written to the log (g_pLogger).
+class Dasher::CNodeBudgetController {
+public:
+  ///\param pPolicy policy whose limits to adjust; its current limits are the starting point
+  ///\param iTargetTime target time per frame, in microseconds
+  CNodeBudgetController(AmortizedPolicy *pPolicy, long iTargetTime);
+
+  ///Report the time taken to render a frame of nodes using the policy (i.e. with
+  /// pPolicy->apply() having just been called), and adjust the policy if need be.
+  /// \param iRenderTime time taken rendering the nodes, in microseconds
+  /// \param iExpandTime time taken in apply() (expanding+collapsing), in microseconds
+  /// \return true if the policy's limits were changed
+  bool FrameRendered(long iRenderTime, long iExpandTime);
+
+  ///Bounds on the node budget
+  static const unsigned int MIN_BUDGET = 250, MAX_BUDGET = 40000;
+  ///Bounds on expansions per frame
+  static const unsigned int MIN_EXPANDS = 1, MAX_EXPANDS = 32;
+  ///Frames after any change during which we only measure
+  static const int COOLDOWN_FRAMES = 15;
+  ///Fraction of the target by which (smoothed) times may differ without any change
+  static const double HYSTERESIS;
+  ///Weight of each new frame in the smoothed times
+  static const double SMOOTHING;
+
+private:
+  AmortizedPolicy * const m_pPolicy;
+  const long m_iTargetTime;
+  ///Smoothed times, in microseconds (-1 = no frames yet)
+  double m_dRenderTime, m_dExpandTime;
+  ///Frames since last change
+  int m_iFrames;
+  ///Of those frames, how many the budget, or maximum expansions, limited the policy
+  int m_iBudgetLimited, m_iExpansionLimited;
+};
+/// \}
+
+#endif
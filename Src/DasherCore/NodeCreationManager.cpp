@@ -5,18 +5,22 @@
 #include "RoutingAlphMgr.h"
 #include "ConvertingAlphMgr.h"
 #include "ControlManager.h"
+#include "LanguageModelling/OverlayLanguageModel.h"
 #include "Observable.h"
 
 #include <string.h>
+#include <sstream>
 
 using namespace Dasher;
 
 //Wraps the ParseFile of a provided Trainer, to setup progress notification
 // - and then passes self, as a ProgressIndicator, to the Trainer's ParseFile method.
+// If bUserOnly, system files are skipped (as if already read), e.g. as the model
+// is an overlay on a shared one which has already been trained on them.
 class ProgressNotifier : public AbstractParser, private CTrainer::ProgressIndicator {
 public:
-  ProgressNotifier(CDasherInterfaceBase *pInterface, CTrainer *pTrainer)
-  : AbstractParser(pInterface), m_bSystem(false), m_bUser(false), m_pInterface(pInterface), m_pTrainer(pTrainer) { }
+  ProgressNotifier(CDasherInterfaceBase *pInterface, CTrainer *pTrainer, bool bUserOnly=false)
+  : AbstractParser(pInterface), m_bSystem(bUserOnly), m_bUser(false), m_pInterface(pInterface), m_pTrainer(pTrainer), m_bUserOnly(bUserOnly) { }
   void bytesRead(off_t n) {
     int iNewPercent = ((m_iStart + n)*100)/m_iStop;
     if (iNewPercent != m_iPercent) {
@@ -24,26 +28,37 @@ public:
     }
   }
   bool ParseFile(const string &strFilename, bool bUser) {
+    if (m_bUserOnly && !bUser) return false;
     m_iStart = 0;
     m_iStop = m_pInterface->GetFileSize(strFilename);
     if (m_iStop==0) return false;
-    return AbstractParser::ParseFile(strFilename, bUser);
+    //let the trainer open the file itself, so it can map/decompress it
+    Start(bUser);
+    return Finished(m_pTrainer->ParseFile(strFilename, bUser), bUser);
   }
   bool Parse(const string &strUrl, istream &in, bool bUser) {
-    m_strDisplay = bUser ? _("Training on User Text") : _("Training on System Text");
-    m_pInterface->SetLockStatus(m_strDisplay, m_iPercent=0);
-    m_pTrainer->SetProgressIndicator(this);
-    if (!m_pTrainer->Parse(strUrl, in, bUser)) return false;
-    if (bUser) m_bUser=true; else m_bSystem=true;
-    return true;
+    if (m_bUserOnly && !bUser) return false;
+    Start(bUser);
+    return Finished(m_pTrainer->Parse(strUrl, in, bUser), bUser);
   }
   bool m_bSystem, m_bUser;
 private:
   CDasherInterfaceBase *m_pInterface;
   CTrainer *m_pTrainer;
+  const bool m_bUserOnly;
   off_t m_iStart, m_iStop;
   int m_iPercent;
   string m_strDisplay;
+  void Start(bool bUser) {
+    m_strDisplay = bUser ? _("Training on User Text") : _("Training on System Text");
+    m_pInterface->SetLockStatus(m_strDisplay, m_iPercent=0);
+    m_pTrainer->SetProgressIndicator(this);
+  }
+  bool Finished(bool bRes, bool bUser) {
+    if (!bRes) return false;
+    if (bUser) m_bUser=true; else m_bSystem=true;
+    return true;
+  }
 };
 
 CNodeCreationManager::CNodeCreationManager(
@@ -51,8 +66,8 @@ CNodeCreationManager::CNodeCreationManager(
   Dasher::CDasherInterfaceBase *pInterface,
   const Dasher::CAlphIO *pAlphIO,
   const Dasher::CControlBoxIO *pControlBoxIO
-  ) : CSettingsUserObserver(pCreateFrom),
-  m_pInterface(pInterface), m_pControlManager(NULL), m_pScreen(NULL) {
+  ) : CSettingsUser(pCreateFrom),
+  m_pInterface(pInterface), m_pControlManager(NULL), m_pScreen(NULL), m_pJournal(NULL) {
 
   const Dasher::CAlphInfo *pAlphInfo(pAlphIO->GetInfo(GetStringParameter(SP_ALPHABET_ID)));
 
@@ -82,14 +97,37 @@ CNodeCreationManager::CNodeCreationManager(
   m_pAlphabetManager->Setup();
   m_pTrainer = m_pAlphabetManager->GetTrainer();
     
+  //A shared model has been trained on the system files already; we learn only user text
+  const bool bSharedLM(dynamic_cast<COverlayLanguageModel *>(m_pAlphabetManager->GetLanguageModel()) != NULL);
+
   if (!pAlphInfo->GetTrainingFile().empty()) {
-    ProgressNotifier pn(pInterface, m_pTrainer);
-    pInterface->ScanFiles(&pn,pAlphInfo->GetTrainingFile());
-    if (!pn.m_bUser) {
-      ///TRANSLATORS: These 3 messages will be displayed when the user has just chosen a new alphabet. The %s parameter will be the name of the alphabet.
-      const char *msg = pn.m_bSystem ? _("No user training text found - if you have written in \"%s\" before, this means Dasher may not be learning from previous sessions")
-      : _("No training text (user or system) found for \"%s\". Dasher will still work but entry will be slower. We suggest downloading a training text file from the Dasher website, or constructing your own.");
-      pInterface->FormatMessageWithString(msg, pAlphInfo->GetID().c_str());
+    //Anything which would make a snapshot of the model trained on the same files, unusable.
+    ostringstream modelKey;
+    modelKey << pAlphInfo->GetID() << '\n' << pAlphInfo->m_iConversionID << ' ' << pAlphInfo->iEnd << ' '
+             << GetLongParameter(LP_LANGUAGE_MODEL_ID) << ' ' << GetLongParameter(LP_LM_MAX_ORDER) << ' '
+             << GetLongParameter(LP_LM_UPDATE_EXCLUSION) << (bSharedLM ? " overlay" : "");
+    m_pJournal = CLearningJournal::Create(pInterface, pAlphInfo->GetTrainingFile(), modelKey.str());
+    if (!m_pJournal || !m_pJournal->LoadSnapshot(m_pAlphabetManager->GetLanguageModel())) {
+      ProgressNotifier pn(pInterface, m_pTrainer, bSharedLM);
+      for (const char * const *szSuffix = CTrainingInput::SUFFIXES; *szSuffix; szSuffix++)
+        pInterface->ScanFiles(&pn,pAlphInfo->GetTrainingFile() + *szSuffix);
+      if (!pn.m_bUser && !(m_pJournal && m_pJournal->HasRecords())) {
+        ///TRANSLATORS: These 3 messages will be displayed when the user has just chosen a new alphabet. The %s parameter will be the name of the alphabet.
+        const char *msg = pn.m_bSystem ? _("No user training text found - if you have written in \"%s\" before, this means Dasher may not be learning from previous sessions")
+        : _("No training text (user or system) found for \"%s\". Dasher will still work but entry will be slower. We suggest downloading a training text file from the Dasher website, or constructing your own.");
+        pInterface->FormatMessageWithString(msg, pAlphInfo->GetID().c_str());
+      }
+    }
+    if (m_pJournal) {
+      //text written since the training files were last updated
+      m_pJournal->Replay(m_pTrainer);
+      m_pJournal->CompactIfNeeded(m_pAlphabetManager->GetLanguageModel());
+      if (m_pJournal->Start())
+        m_pAlphabetManager->SetJournal(m_pJournal);
+      else {
+        delete m_pJournal;
+        m_pJournal = NULL;
+      }
     }
     //3. Finished, so unlock.
     m_pInterface->SetLockStatus("", -1);
@@ -111,13 +149,14 @@ CNodeCreationManager::CNodeCreationManager(
   }
 #endif
 
-  HandleEvent(LP_ORIENTATION);
   CreateControlBox(pControlBoxIO);
 }
 
 CNodeCreationManager::~CNodeCreationManager() {
   delete m_pAlphabetManager;
   delete m_pTrainer;
+  //writes out anything the AlphMgr recorded
+  delete m_pJournal;
   
   delete m_pControlManager;
 }
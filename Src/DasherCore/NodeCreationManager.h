@@ -24,7 +24,7 @@ namespace Dasher {
 //TODO why is CNodeCreationManager _not_ in namespace Dasher?!?!
 /// \ingroup Model
 /// @{
-class CNodeCreationManager : public Dasher::CSettingsUserObserver {
+class CNodeCreationManager : public Dasher::CSettingsUser {
  public:
   CNodeCreationManager(Dasher::CSettingsUser *pCreateFrom,
                        Dasher::CDasherInterfaceBase *pInterface,
@@ -39,7 +39,6 @@ class CNodeCreationManager : public Dasher::CSettingsUserObserver {
   /// BP_CONTROL_MODE and game mode status)
   void CreateControlBox(const Dasher::CControlBoxIO* pControlIO);
 
-  void HandleEvent(int iParameter) {}
   ///
   /// Get a root node of a particular type
   ///
@@ -77,6 +76,9 @@ class CNodeCreationManager : public Dasher::CSettingsUserObserver {
   
   ///Screen to use to create node labels
   Dasher::CDasherScreen *m_pScreen;
+
+  ///Records text written (if the platform supports it); owned by us, not the AlphMgr
+  Dasher::CLearningJournal *m_pJournal;
 };
 /// @}
 
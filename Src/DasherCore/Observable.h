@@ -1,7 +1,7 @@
 #ifndef __eventhandler_h__
 #define __eventhandler_h__
 
-#include <list>
+#include <vector>
 #include <algorithm>
 
 template <typename  T> class Observable;
@@ -16,7 +16,8 @@ public:
 
 ///An Event handler for a single type of event: maintains a list of listeners,
 /// allows listeners to (un/)register, and allows dispatching of events to all
-/// listeners.
+/// listeners. Listeners are kept in a vector, as events (e.g. node expansions)
+/// may be dispatched hundreds of times a second, usually to very few listeners.
 template <typename T> class Observable {
 public:
   Observable();
@@ -24,8 +25,7 @@ public:
   void Unregister(Observer<T> *pLstnr);
   void DispatchEvent(T t);
 private:
-  typedef typename std::list< Observer<T>* > ListenerList;
-  typedef typename ListenerList::iterator L_it;
+  typedef typename std::vector< Observer<T>* > ListenerList;
   ListenerList m_vListeners;
   ListenerList m_vListenersToAdd;
   int m_iInHandler;
@@ -41,17 +41,22 @@ template <typename T> Observable<T>::Observable()
 /// Observable they listen to!)
 template <typename T> class TransientObserver : public Observer<T> {
 public:
+  ///\param pObservable to register with, or NULL (e.g. in offline tools) for none
   TransientObserver(Observable<T> *pObservable) : m_pEventHandler(pObservable) {
-    m_pEventHandler->Register(this);
+    if (m_pEventHandler) m_pEventHandler->Register(this);
   }
   virtual ~TransientObserver() {
-    m_pEventHandler->Unregister(this);
+    if (m_pEventHandler) m_pEventHandler->Unregister(this);
   }
 protected:
   Observable<T> *m_pEventHandler;
 };
 
 template <typename T> void Observable<T>::Register(Observer<T> *pListener) {
+  // Ignore duplicate registrations (rare: cheaper to check here than on every dispatch)
+  if (std::find(m_vListeners.begin(), m_vListeners.end(), pListener) != m_vListeners.end()
+      || std::find(m_vListenersToAdd.begin(), m_vListenersToAdd.end(), pListener) != m_vListenersToAdd.end())
+    return;
   if (m_iInHandler == 0)
     m_vListeners.push_back(pListener);
   else
@@ -59,13 +64,14 @@ template <typename T> void Observable<T>::Register(Observer<T> *pListener) {
 }
 
 template <typename T> void Observable<T>::Unregister(Observer<T> *pListener) {
-  if (m_iInHandler == 0)
-    m_vListeners.remove(pListener);
-  else {
-    L_it it = std::find(m_vListeners.begin(), m_vListeners.end(), pListener);
-    if (it != m_vListeners.end())
-	  *it = NULL;
+  typename ListenerList::iterator it = std::find(m_vListeners.begin(), m_vListeners.end(), pListener);
+  if (it != m_vListeners.end()) {
+    if (m_iInHandler == 0)
+      m_vListeners.erase(it);
+    else
+      *it = NULL;
   }
+  m_vListenersToAdd.erase(std::remove(m_vListenersToAdd.begin(), m_vListenersToAdd.end(), pListener), m_vListenersToAdd.end());
 }
 
 template <typename T> void Observable<T>::DispatchEvent(T evt) {
@@ -73,29 +79,103 @@ template <typename T> void Observable<T>::DispatchEvent(T evt) {
   // Speed up start-up before any listeners are registered
   if (m_vListeners.empty()) return;
 
-  // Just in case the same event handler was registered twice.
-  if (m_iInHandler == 0)
-    m_vListeners.unique();
-
   // We may end up here recursively, so keep track of how far down we
   // are, and only permit new handlers to be registered after all
-  // messages are processed.
+  // messages are processed. (So the vector is not reallocated under us.)
 
   // An alternative approach would be a message queue - this might actually be a bit more sensible
   ++m_iInHandler;
 
   // Loop through components and notify them of the event
-  for(L_it I=m_vListeners.begin(), E=m_vListeners.end(); I!=E; I++) {
-    if (*I != NULL) { // Listener not removed during iteration
-      (*I)->HandleEvent(evt);
+  for (typename ListenerList::size_type i=0; i<m_vListeners.size(); i++) {
+    if (m_vListeners[i] != NULL) { // Listener not removed during iteration
+      m_vListeners[i]->HandleEvent(evt);
     }
   }
 
   --m_iInHandler;
 
   if (m_iInHandler == 0) {
-    m_vListeners.remove(NULL);
-    m_vListeners.splice(m_vListeners.end(), m_vListenersToAdd);
+    m_vListeners.erase(std::remove(m_vListeners.begin(), m_vListeners.end(), static_cast<Observer<T> *>(NULL)), m_vListeners.end());
+    m_vListeners.insert(m_vListeners.end(), m_vListenersToAdd.begin(), m_vListenersToAdd.end());
+    m_vListenersToAdd.clear();
   }
 }
+
+///Thing that listens to events a batch at a time (see BatchedObservable)
+template <typename T> class BatchObserver {
+public:
+  virtual ~BatchObserver() {};
+  ///Called with all the events since the last batch, in the order they occurred.
+  virtual void HandleEvents(const std::vector<T> &vEvents)=0;
+};
+
+///An Observable whose events can also be delivered in batches: Observers still
+/// receive each event immediately (as for any Observable), while for the benefit
+/// of any BatchObservers, events are also queued until the owner calls
+/// FlushEvents() (e.g. once per frame). Thus listeners that don't need to act
+/// on each event straightaway, can avoid a virtual call per event.
+/// Note the owner must flush (or discard) queued events before any become
+/// invalid, e.g. before deleting the objects they point to.
+template <typename T> class BatchedObservable : public Observable<T> {
+public:
+  BatchedObservable() : m_iInFlush(0) {}
+  void RegisterBatched(BatchObserver<T> *pListener) {
+    if (std::find(m_vBatchListeners.begin(), m_vBatchListeners.end(), pListener) != m_vBatchListeners.end()
+        || std::find(m_vBatchListenersToAdd.begin(), m_vBatchListenersToAdd.end(), pListener) != m_vBatchListenersToAdd.end())
+      return;
+    if (m_iInFlush == 0)
+      m_vBatchListeners.push_back(pListener);
+    else
+      m_vBatchListenersToAdd.push_back(pListener);
+  }
+  void UnregisterBatched(BatchObserver<T> *pListener) {
+    typename std::vector<BatchObserver<T> *>::iterator it = std::find(m_vBatchListeners.begin(), m_vBatchListeners.end(), pListener);
+    if (it != m_vBatchListeners.end()) {
+      if (m_iInFlush == 0)
+        m_vBatchListeners.erase(it);
+      else
+        *it = NULL;
+    }
+    m_vBatchListenersToAdd.erase(std::remove(m_vBatchListenersToAdd.begin(), m_vBatchListenersToAdd.end(), pListener), m_vBatchListenersToAdd.end());
+  }
+  void DispatchEvent(T evt) {
+    Observable<T>::DispatchEvent(evt);
+    if (!m_vBatchListeners.empty()) m_vPending.push_back(evt);
+  }
+  ///Deliver all queued events to the BatchObservers. Any events dispatched
+  /// meanwhile (by the BatchObservers) are queued for the next flush. As for
+  /// DispatchEvent, BatchObservers unregistered during the flush are not called
+  /// after that, and those registered during it only receive later batches.
+  void FlushEvents() {
+    if (m_vPending.empty()) return;
+    std::vector<T> vEvents;
+    vEvents.swap(m_vPending);
+    ++m_iInFlush;
+    for (typename std::vector<BatchObserver<T> *>::size_type i=0; i<m_vBatchListeners.size(); i++) {
+      if (m_vBatchListeners[i] != NULL) // Listener not removed during iteration
+        m_vBatchListeners[i]->HandleEvents(vEvents);
+    }
+    --m_iInFlush;
+    if (m_iInFlush == 0) {
+      m_vBatchListeners.erase(std::remove(m_vBatchListeners.begin(), m_vBatchListeners.end(), static_cast<BatchObserver<T> *>(NULL)), m_vBatchListeners.end());
+      m_vBatchListeners.insert(m_vBatchListeners.end(), m_vBatchListenersToAdd.begin(), m_vBatchListenersToAdd.end());
+      m_vBatchListenersToAdd.clear();
+    }
+    //reuse the storage next time, if nothing was queued meanwhile
+    if (m_vPending.empty()) {
+      vEvents.clear();
+      m_vPending.swap(vEvents);
+    }
+  }
+  ///Forget any queued events without delivering them
+  void DiscardEvents() {m_vPending.clear();}
+private:
+  std::vector<BatchObserver<T> *> m_vBatchListeners;
+  std::vector<BatchObserver<T> *> m_vBatchListenersToAdd;
+  std::vector<T> m_vPending;
+  ///Depth of (possibly recursive) FlushEvents calls in progress
+  int m_iInFlush;
+};
+
 #endif
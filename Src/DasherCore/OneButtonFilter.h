@@ -14,6 +14,8 @@ class COneButtonFilter : public CStaticFilter {
   virtual void Timer(unsigned long Time, CDasherView *pView, CDasherInput *pInput, CDasherModel *m_pDasherModel, CExpansionPolicy **pol);
   virtual void KeyDown(unsigned long iTime, int iId, CDasherView *pView, CDasherInput *pInput, CDasherModel *pModel);
   bool GetSettings(SModuleSettings **pSettings, int *iCount);
+  ///The scan line moves by itself once started
+  bool NeedsFrames() {return bStarted;}
  private:
   ///true iff the scan line is moving down/up, or is in the 'reverse' stage
   bool bStarted;
@@ -0,0 +1,40 @@
+// OutputQueue.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "OutputQueue.h"
+
+#include <algorithm>
+
+using namespace Dasher;
+using namespace std;
+
+void COutputQueue::Delete(const string &strText) {
+  //Nodes delete exactly what they output, most recent first; so the end of
+  // strText is the end of the queued output, if there is any
+  const string::size_type iQueued(min(m_strOutput.length(), strText.length()));
+  DASHER_ASSERT(m_strOutput.compare(m_strOutput.length() - iQueued, iQueued,
+                                    strText, strText.length() - iQueued, iQueued) == 0);
+  m_strOutput.resize(m_strOutput.length() - iQueued);
+  //Whatever remains was output before the queue began; count its characters
+  for (string::size_type i = 0; i < strText.length() - iQueued; i++)
+    if ((strText[i] & 0xC0) != 0x80) m_iDeletes++;
+}
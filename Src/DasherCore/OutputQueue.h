@@ -0,0 +1,68 @@
+// OutputQueue.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __OutputQueue_h__
+#define __OutputQueue_h__
+
+#include <string>
+
+namespace Dasher {
+  class COutputQueue;
+}
+
+/// \ingroup Core
+/// @{
+
+/// Coalesces a sequence of edits (text output at, and deleted from before, the
+/// cursor) into a single equivalent edit: delete some number of characters
+/// from before the cursor, then output some text. Deleting text that is still
+/// queued just removes it from the queue, so text output and then deleted
+/// again (e.g. as the user reverses over it, within a frame) is never sent
+/// at all.
+class Dasher::COutputQueue {
+public:
+  COutputQueue() : m_iDeletes(0) {}
+
+  ///Queues text to be output after everything already queued
+  void Output(const std::string &strText) {m_strOutput += strText;}
+
+  ///Queues the deletion of text from just before the cursor, i.e. the end of
+  /// whatever output is queued, then whatever preceded it
+  /// \param strText UTF-8 text being deleted
+  void Delete(const std::string &strText);
+
+  bool IsEmpty() const {return m_iDeletes == 0 && m_strOutput.empty();}
+
+  ///Number of characters (not bytes) to delete before the cursor, first
+  unsigned int GetDeletes() const {return m_iDeletes;}
+
+  ///Text to output after the deletion
+  const std::string &GetOutput() const {return m_strOutput;}
+
+  void Clear() {m_iDeletes = 0; m_strOutput.clear();}
+
+private:
+  unsigned int m_iDeletes;
+  std::string m_strOutput;
+};
+
+/// @}
+
+#endif
@@ -43,6 +43,7 @@ const bp_table boolparamtable[] = {
   {BP_GAME_HELP_DRAW_PATH, "GameDrawPath", Persistence::PERSISTENT, true, "When we give help, show the shortest path to the target sentence"},
   {BP_TWO_PUSH_RELEASE_TIME, "TwoPushReleaseTime", Persistence::PERSISTENT, false, "Use push and release times of single press rather than push times of two presses"},
   {BP_SLOW_CONTROL_BOX, "SlowControlBox", Persistence::PERSISTENT, true, "Slow down when going through control box" },
+  {BP_PERF_TRACE, "PerfTrace", Persistence::PERSISTENT, false, "Record timings of each frame, for writing out as a performance trace"},
 };
 
 const lp_table longparamtable[] = {
@@ -96,6 +97,7 @@ const lp_table longparamtable[] = {
   {LP_SOCKET_INPUT_X_MAX, "SocketInputXMaxTimes1000", Persistence::PERSISTENT, 1000, "Top of range of X values expected from network input"},
   {LP_SOCKET_INPUT_Y_MIN, "SocketInputYMinTimes1000", Persistence::PERSISTENT, 0, "Bottom of range of Y values expected from network input"},
   {LP_SOCKET_INPUT_Y_MAX, "SocketInputYMaxTimes1000", Persistence::PERSISTENT, 1000, "Top of range of Y values expected from network input"},
+  {LP_SOCKET_INPUT_SMOOTHING, "SocketInputSmoothing", Persistence::PERSISTENT, 0, "Time constant (in ms) of low-pass filter applied to network input values (0 = use latest value)"},
   {LP_CIRCLE_PERCENT, "CirclePercent", Persistence::PERSISTENT, 10, "Percentage of nominal vertical range to use for radius of start circle"},
   {LP_TWO_BUTTON_OFFSET, "TwoButtonOffset", Persistence::PERSISTENT, 1638, "Offset for two button dynamic mode"},
   {LP_HOLD_TIME, "HoldTime", Persistence::PERSISTENT, 1000, "Time for which buttons must be held to count as long presses, in ms"},
@@ -125,6 +127,8 @@ const lp_table longparamtable[] = {
   {LP_X_LIMIT_SPEED, "XLimitSpeed", Persistence::PERSISTENT, 800, "X Co-ordinate at which maximum speed is reached (&lt;2048=xhair)"},
   {LP_GAME_HELP_DIST, "GameHelpDistance", Persistence::PERSISTENT, 1920, "Distance of sentence from center to decide user needs help"},
   {LP_GAME_HELP_TIME, "GameHelpTime", Persistence::PERSISTENT, 0, "Time for which user must need help before help drawn"},
+  {LP_MAX_FRAMERATE, "MaxFrameRate", Persistence::PERSISTENT, 40, "Maximum number of frames to render per second (0 = no limit)"},
+  {LP_TARGET_FRAME_TIME, "TargetFrameTime", Persistence::PERSISTENT, 0, "Time (in ms) in which to render the nodes each frame, adapting the node budget to meet it (0 = fixed NodeBudget)"},
 };
 
 const sp_table stringparamtable[] = {
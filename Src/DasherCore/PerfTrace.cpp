@@ -0,0 +1,238 @@
+// PerfTrace.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "PerfTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace Dasher;
+using namespace std;
+
+std::atomic<bool> CPerfTrace::s_bEnabled(false);
+const unsigned int CPerfTrace::BUFFER_EVENTS;
+
+namespace {
+  ///One span or counter value. Written only by the thread owning the buffer,
+  /// but may be read concurrently by WriteJSON, which uses the sequence number
+  /// (as a seqlock) to detect and skip events overwritten while it reads them.
+  /// All fields are atomics (accessed relaxed) so such races are well-defined.
+  struct SEvent {
+    ///2*index+1 while being written, 2*index+2 once complete (for the index-th
+    /// event recorded in this buffer; slots are reused every BUFFER_EVENTS)
+    atomic<unsigned long long> iSeq;
+    ///Name, or NULL for an unused slot
+    atomic<const char *> szName;
+    atomic<long long> iTime;
+    ///Duration of a span, or value of a counter
+    atomic<long long> iValue;
+    atomic<bool> bCounter;
+  };
+
+  ///Ring of events. Allocated only when a thread first records while tracing
+  /// is enabled; once that thread has exited, reused by the next thread to
+  /// need one (so there are never more than the most threads ever recording
+  /// at once), and never deleted, so WriteJSON can read it at any time.
+  struct SThreadBuffer {
+    SThreadBuffer() : m_iFirst(0), m_iHead(0) {
+      for (unsigned int i=0; i<CPerfTrace::BUFFER_EVENTS; i++) m_aEvents[i].iSeq.store(0, memory_order_relaxed);
+    }
+    ///Number of events recorded before the current thread took the buffer over
+    atomic<unsigned long long> m_iFirst;
+    ///Number of events ever recorded; the next goes in slot m_iHead % BUFFER_EVENTS
+    atomic<unsigned long long> m_iHead;
+    SEvent m_aEvents[CPerfTrace::BUFFER_EVENTS];
+  };
+
+  ///A thread which has been named or has recorded events
+  struct SThread {
+    SThread(int iTid) : m_iTid(iTid), m_pBuffer(NULL), m_bExited(false) {}
+    const int m_iTid;
+    string m_strName;
+    ///NULL unless the thread has recorded anything while tracing was enabled
+    SThreadBuffer *m_pBuffer;
+    bool m_bExited;
+  };
+
+  ///All threads alive, or which have exited but whose events are still
+  /// buffered (e.g. training), so will be written out; guarded by the mutex.
+  struct SRegistry {
+    SRegistry() : m_iLastTid(0) {}
+    mutex m_mutex;
+    vector<SThread *> m_vThreads;
+    int m_iLastTid;
+  };
+  SRegistry &Registry() {
+    static SRegistry *pRegistry = new SRegistry();
+    return *pRegistry;
+  }
+
+  ///Calling thread's entry in the registry, if any; marks it exited when the
+  /// thread finishes, removing it unless it has events to write out.
+  struct SThreadHandle {
+    SThreadHandle() : m_pThread(NULL) {}
+    ~SThreadHandle() {
+      if (!m_pThread) return;
+      SRegistry &reg(Registry());
+      lock_guard<mutex> lock(reg.m_mutex);
+      m_pThread->m_bExited = true;
+      if (!m_pThread->m_pBuffer) {
+        reg.m_vThreads.erase(find(reg.m_vThreads.begin(), reg.m_vThreads.end(), m_pThread));
+        delete m_pThread;
+      }
+    }
+    SThread *m_pThread;
+  };
+  thread_local SThreadHandle t_thread;
+  ///Cache of t_thread.m_pThread->m_pBuffer, to avoid locking for every event
+  thread_local SThreadBuffer *t_pBuffer = NULL;
+
+  ///Calling thread's entry, created if necessary. Registry mutex must be held.
+  SThread *ThreadEntry(SRegistry &reg) {
+    if (!t_thread.m_pThread) {
+      t_thread.m_pThread = new SThread(++reg.m_iLastTid);
+      reg.m_vThreads.push_back(t_thread.m_pThread);
+    }
+    return t_thread.m_pThread;
+  }
+
+  SThreadBuffer *ThreadBuffer() {
+    if (!t_pBuffer) {
+      SRegistry &reg(Registry());
+      lock_guard<mutex> lock(reg.m_mutex);
+      SThread *pThread(ThreadEntry(reg));
+      //Take over the buffer of a thread that has exited, if any (discarding
+      // its events); else allocate a new one
+      for (vector<SThread *>::iterator it=reg.m_vThreads.begin(); it!=reg.m_vThreads.end(); it++) {
+        if (!(*it)->m_bExited) continue;
+        t_pBuffer = (*it)->m_pBuffer;
+        t_pBuffer->m_iFirst.store(t_pBuffer->m_iHead.load(memory_order_relaxed), memory_order_release);
+        delete *it;
+        reg.m_vThreads.erase(it);
+        break;
+      }
+      if (!t_pBuffer) t_pBuffer = new SThreadBuffer();
+      pThread->m_pBuffer = t_pBuffer;
+    }
+    return t_pBuffer;
+  }
+
+  void Record(const char *szName, long long iTime, long long iValue, bool bCounter) {
+    if (!CPerfTrace::IsEnabled()) return;
+    SThreadBuffer *pBuf(ThreadBuffer());
+    const unsigned long long i(pBuf->m_iHead.load(memory_order_relaxed));
+    SEvent &e(pBuf->m_aEvents[i % CPerfTrace::BUFFER_EVENTS]);
+    e.iSeq.store(2*i+1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    e.szName.store(szName, memory_order_relaxed);
+    e.iTime.store(iTime, memory_order_relaxed);
+    e.iValue.store(iValue, memory_order_relaxed);
+    e.bCounter.store(bCounter, memory_order_relaxed);
+    e.iSeq.store(2*i+2, memory_order_release);
+    pBuf->m_iHead.store(i+1, memory_order_release);
+  }
+
+  void WriteString(ostream &out, const string &str) {
+    out << '"';
+    for (string::const_iterator it=str.begin(); it!=str.end(); it++) {
+      if (*it=='"' || *it=='\\') out << '\\' << *it;
+      else if (static_cast<unsigned char>(*it) < 0x20) out << ' ';
+      else out << *it;
+    }
+    out << '"';
+  }
+}
+
+void CPerfTrace::Enable(bool bEnabled) {
+  s_bEnabled.store(bEnabled, memory_order_relaxed);
+}
+
+long long CPerfTrace::Now() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void CPerfTrace::Span(const char *szName, long long iStart, long long iEnd) {
+  Record(szName, iStart, iEnd - iStart, false);
+}
+
+void CPerfTrace::Counter(const char *szName, long long iValue) {
+  Record(szName, Now(), iValue, true);
+}
+
+void CPerfTrace::SetThreadName(const char *szName) {
+  SRegistry &reg(Registry());
+  lock_guard<mutex> lock(reg.m_mutex);
+  ThreadEntry(reg)->m_strName = szName;
+}
+
+void CPerfTrace::WriteJSON(ostream &out) {
+  SRegistry &reg(Registry());
+  vector<int> vTids;
+  vector<string> vNames;
+  vector<const SThreadBuffer *> vBuffers;
+  {
+    lock_guard<mutex> lock(reg.m_mutex);
+    for (vector<SThread *>::const_iterator it=reg.m_vThreads.begin(); it!=reg.m_vThreads.end(); it++) {
+      vTids.push_back((*it)->m_iTid);
+      vNames.push_back((*it)->m_strName);
+      vBuffers.push_back((*it)->m_pBuffer);
+    }
+  }
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool bFirst(true);
+  for (size_t t=0; t<vBuffers.size(); t++) {
+    const SThreadBuffer *pBuf(vBuffers[t]);
+    if (!pBuf) continue; //nothing recorded
+    const int iTid(vTids[t]);
+    if (!vNames[t].empty()) {
+      out << (bFirst ? "\n" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << iTid << ",\"args\":{\"name\":";
+      WriteString(out, vNames[t]);
+      out << "}}";
+      bFirst = false;
+    }
+    //(events before m_iFirst were recorded by a previous owner of the buffer)
+    const unsigned long long iFirst(pBuf->m_iFirst.load(memory_order_acquire));
+    const unsigned long long iHead(pBuf->m_iHead.load(memory_order_acquire));
+    for (unsigned long long i = max(iFirst, iHead > BUFFER_EVENTS ? iHead - BUFFER_EVENTS : 0); i < iHead; i++) {
+      const SEvent &e(pBuf->m_aEvents[i % BUFFER_EVENTS]);
+      const unsigned long long iSeq(e.iSeq.load(memory_order_acquire));
+      if (iSeq != 2*i+2) continue; //being overwritten (by a later event)
+      const char *szName(e.szName.load(memory_order_relaxed));
+      const long long iTime(e.iTime.load(memory_order_relaxed)), iValue(e.iValue.load(memory_order_relaxed));
+      const bool bCounter(e.bCounter.load(memory_order_relaxed));
+      atomic_thread_fence(memory_order_acquire);
+      if (e.iSeq.load(memory_order_relaxed) != iSeq) continue; //overwritten while we read it
+      out << (bFirst ? "\n" : ",\n") << "{\"name\":";
+      WriteString(out, szName);
+      if (bCounter)
+        out << ",\"ph\":\"C\",\"ts\":" << iTime << ",\"pid\":1,\"tid\":" << iTid << ",\"args\":{\"value\":" << iValue << "}}";
+      else
+        out << ",\"ph\":\"X\",\"ts\":" << iTime << ",\"dur\":" << iValue << ",\"pid\":1,\"tid\":" << iTid << "}";
+      bFirst = false;
+    }
+  }
+  out << "\n]}\n";
+}
@@ -0,0 +1,105 @@
+// PerfTrace.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __PerfTrace_h__
+#define __PerfTrace_h__
+
+#include <atomic>
+#include <ostream>
+
+namespace Dasher {
+  class CPerfTrace;
+}
+
+/// \ingroup Logging
+/// @{
+
+/// Low-overhead timing of the frame loop, language model, etc., for diagnosing
+/// stutter in the field. Unlike CFileLogger (which opens the log file for every
+/// message) or DASHER_TRACEOUTPUT (compiled out of release builds), this is
+/// always compiled in and switched on at runtime (BP_PERF_TRACE); when off,
+/// each PERF_TRACE_SPAN costs a single relaxed load.
+///
+/// When on, each thread records spans (named, timed, regions of code) and
+/// counters into its own fixed-size ring buffer, without locking: when full,
+/// the oldest events are overwritten, so the buffers always hold the most recent
+/// BUFFER_EVENTS events per thread. A buffer is only allocated for a thread
+/// once it records something while tracing is on; when that thread exits, its
+/// events are kept until another thread needs a buffer and takes it over.
+/// WriteJSON() can be called at any time, from any thread, and writes the
+/// buffers in the Chrome trace-event format, for viewing in chrome://tracing
+/// or Perfetto.
+class Dasher::CPerfTrace {
+public:
+  ///Start or stop recording. Events already recorded are kept (until overwritten).
+  static void Enable(bool bEnabled);
+  static bool IsEnabled() {return s_bEnabled.load(std::memory_order_relaxed);}
+
+  ///Timestamp for spans: microseconds on a monotonic clock
+  static long long Now();
+
+  ///Records a span on the calling thread. (Usually via PERF_TRACE_SPAN.)
+  /// \param szName must remain valid for the lifetime of the program
+  /// (i.e. be a string literal), as only the pointer is stored.
+  static void Span(const char *szName, long long iStart, long long iEnd);
+
+  ///Records the value of a counter. (Usually via PERF_TRACE_COUNTER.)
+  /// \param szName as for Span
+  static void Counter(const char *szName, long long iValue);
+
+  ///Names the calling thread in the output (e.g. "main", "journal"). Cheap,
+  /// and allocates no buffer, so may be called whether or not tracing is on.
+  static void SetThreadName(const char *szName);
+
+  ///Writes all events currently buffered, as a Chrome trace-event JSON object.
+  static void WriteJSON(std::ostream &out);
+
+  ///Capacity of each thread's buffer
+  static const unsigned int BUFFER_EVENTS = 1 << 16;
+
+  ///Records a span from construction to destruction, if tracing was enabled at construction.
+  class CScope {
+  public:
+    CScope(const char *szName) : m_szName(IsEnabled() ? szName : NULL), m_iStart(m_szName ? Now() : 0) {}
+    ~CScope() {if (m_szName) Span(m_szName, m_iStart, Now());}
+  private:
+    const char * const m_szName;
+    const long long m_iStart;
+  };
+
+private:
+  static std::atomic<bool> s_bEnabled;
+};
+
+#define PERF_TRACE_CONCAT2(a,b) a##b
+#define PERF_TRACE_CONCAT(a,b) PERF_TRACE_CONCAT2(a,b)
+
+///Times the rest of the enclosing block, e.g. PERF_TRACE_SPAN("NewFrame");
+#define PERF_TRACE_SPAN(szName) \
+  Dasher::CPerfTrace::CScope PERF_TRACE_CONCAT(perfTraceScope_, __LINE__)(szName)
+
+///Records the current value of some quantity, e.g. PERF_TRACE_COUNTER("Nodes", iNumNodes);
+/// the value is not evaluated unless tracing is enabled.
+#define PERF_TRACE_COUNTER(szName, iValue) \
+  do { if (Dasher::CPerfTrace::IsEnabled()) Dasher::CPerfTrace::Counter(szName, iValue); } while (0)
+
+/// @}
+
+#endif
@@ -0,0 +1,76 @@
+// ProbCache.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "ProbCache.h"
+
+using namespace Dasher;
+using std::vector;
+
+CProbCache::CProbCache(size_t iCapacity) : m_iCapacity(iCapacity) {
+}
+
+size_t CProbCache::KeyHash::operator()(const Key &k) const {
+  //FNV-1a over the offset and symbols
+  size_t h = 2166136261u;
+  h = (h ^ static_cast<unsigned int>(k.first)) * 16777619u;
+  for (vector<symbol>::const_iterator it=k.second.begin(); it!=k.second.end(); it++)
+    h = (h ^ static_cast<unsigned int>(*it)) * 16777619u;
+  return h;
+}
+
+CProbCache::Probs CProbCache::Find(int iOffset, const vector<symbol> &vContext) {
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>::iterator it = m_mIndex.find(Key(iOffset, vContext));
+  if (it == m_mIndex.end()) return Probs();
+  //hit: move to front
+  m_lEntries.splice(m_lEntries.begin(), m_lEntries, it->second);
+  return it->second->second;
+}
+
+void CProbCache::Add(int iOffset, const vector<symbol> &vContext, const Probs &pProbs) {
+  const Key key(iOffset, vContext);
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>::iterator it = m_mIndex.find(key);
+  if (it != m_mIndex.end()) {
+    it->second->second = pProbs;
+    m_lEntries.splice(m_lEntries.begin(), m_lEntries, it->second);
+    return;
+  }
+  if (m_lEntries.size() >= m_iCapacity) {
+    //evict least recently used (nodes still using its table keep it alive)
+    m_mIndex.erase(m_lEntries.back().first);
+    m_lEntries.pop_back();
+  }
+  m_lEntries.push_front(Entry(key, pProbs));
+  m_mIndex[key] = m_lEntries.begin();
+}
+
+void CProbCache::Clear() {
+  m_lEntries.clear();
+  m_mIndex.clear();
+}
+
+void CProbCache::ReportMemory(CMemoryReport &report) const {
+  for (std::list<Entry>::const_iterator it=m_lEntries.begin(); it!=m_lEntries.end(); it++) {
+    //each entry is in the list, and (by iterator) in the index
+    report.Add("probs/cache", 1, sizeof(Entry) + it->first.second.capacity() * sizeof(symbol) + sizeof(std::list<Entry>::iterator));
+    report.AddShared("probs", it->second.get(), sizeof(*it->second) + it->second->capacity() * sizeof(unsigned int));
+  }
+}
@@ -0,0 +1,87 @@
+// ProbCache.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __ProbCache_h__
+#define __ProbCache_h__
+
+#include "DasherTypes.h"
+#include "MemoryReport.h"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Dasher {
+  class CProbCache;
+}
+
+/// \ingroup Model
+/// @{
+
+/// A bounded "ghost" cache of probability tables computed by the language
+/// model, which outlive the nodes that computed them. Nodes are often deleted
+/// and then recreated in the same context: the siblings of each new root are
+/// deleted, then rebuilt if the user reverses; a node collapsed by the
+/// expansion policy loses its children, which are recreated (and must compute
+/// their own probabilities again) if it is reexpanded. With this cache, such
+/// reversal and oscillation - very common with e.g. head-mouse users - reuses
+/// the earlier tables rather than querying the language model again.
+///
+/// Tables are keyed by offset and the context symbols from which the language
+/// model would (re)construct the context at that offset (see
+/// CAlphabetManager::GetProbKey), and shared with the nodes using them;
+/// the least recently used are discarded beyond a fixed number.
+class Dasher::CProbCache {
+public:
+  typedef std::shared_ptr<const std::vector<unsigned int> > Probs;
+
+  ///\param iCapacity maximum number of tables to remember
+  CProbCache(size_t iCapacity = 1024);
+
+  ///Table previously added for the given offset and context, if any, else NULL
+  Probs Find(int iOffset, const std::vector<symbol> &vContext);
+
+  ///Remember a table for the given offset and context (replacing any existing)
+  void Add(int iOffset, const std::vector<symbol> &vContext, const Probs &pProbs);
+
+  ///Forget all tables, e.g. if they would now be computed differently
+  void Clear();
+
+  ///Adds the cache's entries (with their keys) under "probs/cache", and the
+  /// tables under "probs" (unless already added for a node using them)
+  void ReportMemory(CMemoryReport &report) const;
+
+private:
+  typedef std::pair<int, std::vector<symbol> > Key;
+  struct KeyHash {
+    size_t operator()(const Key &k) const;
+  };
+  typedef std::pair<Key, Probs> Entry;
+  ///Cache entries, most recently used first
+  std::list<Entry> m_lEntries;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_mIndex;
+  const size_t m_iCapacity;
+};
+/// @}
+
+#endif
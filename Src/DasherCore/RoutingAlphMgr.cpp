@@ -154,6 +154,7 @@ symbol CRoutingAlphMgr::CRoutingTrainer::getRoute(bool bHaveRoute, const string
 }
 
 void CRoutingAlphMgr::CRoutingTrainer::Train(CAlphabetMap::SymbolStream &syms) {
+  CLanguageModel::CWriter writer(m_pLanguageModel);
   CLanguageModel::Context trainContext = m_pLanguageModel->CreateEmptyContext();
   
   string strRoute; bool bHaveRoute(false);
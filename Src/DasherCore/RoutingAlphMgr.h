@@ -70,11 +70,19 @@ namespace Dasher {
     /// base symbol and route
     virtual CDasherNode *CreateSymbolNode(CAlphNode *pParent, symbol iSymbol);
 
+    ///Override: don't cache probabilities. Unseen nodes' symbols include routes, but
+    /// the edit buffer gives only base symbols, so contexts read from both could collide.
+    bool GetProbKey(CAlphNode *pNode, std::vector<symbol> &vKey) {return false;}
+
     ///Subclass to override trainText
     class CRoutedSym : public CSymbolNode {
     public:
       string trainText();
       CRoutedSym(int iOffset, CDasherScreen::Label *pLabel, CRoutingAlphMgr *pMgr, symbol iSymbol);
+      void ReportMemory(CMemoryReport &report) const {
+        report.Add("nodes/routed-symbol", 1, sizeof(CRoutedSym));
+        ReportProbs(report);
+      }
     protected:
       CRoutingAlphMgr *mgr() const {return static_cast<CRoutingAlphMgr*>(m_pMgr);}
     };
@@ -0,0 +1,90 @@
+// SampleQueue.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __SampleQueue_h__
+#define __SampleQueue_h__
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+namespace Dasher {
+  template <typename T> class CSampleQueue;
+}
+
+/// \ingroup Input
+/// \{
+
+/// Bounded, lock-free, single-producer single-consumer queue, for passing samples
+/// from an input device's reader thread to the thread rendering frames (which
+/// drains it once per frame). Push() and Pop() never block or allocate: if the
+/// consumer falls behind and the queue fills, new samples are dropped (and
+/// counted) rather than overwriting ones the consumer may be reading.
+///
+/// Exactly one thread may call Push(), and exactly one (other) thread Pop().
+template <typename T> class Dasher::CSampleQueue {
+public:
+  ///\param iCapacity maximum number of samples held; rounded up to a power of two
+  explicit CSampleQueue(size_t iCapacity) : m_iHead(0), m_iTail(0), m_iDropped(0) {
+    size_t iSize(1);
+    while (iSize < iCapacity) iSize<<=1;
+    m_vSlots.resize(iSize);
+    m_iMask = iSize-1;
+  }
+
+  ///Producer only. \return false (and the sample is dropped) if the queue was full
+  bool Push(const T &sample) {
+    const size_t iHead(m_iHead.load(std::memory_order_relaxed));
+    if (iHead - m_iTail.load(std::memory_order_acquire) > m_iMask) {
+      m_iDropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    m_vSlots[iHead & m_iMask] = sample;
+    m_iHead.store(iHead+1, std::memory_order_release);
+    return true;
+  }
+
+  ///Consumer only. \return false if the queue was empty (sample unchanged)
+  bool Pop(T &sample) {
+    const size_t iTail(m_iTail.load(std::memory_order_relaxed));
+    if (iTail == m_iHead.load(std::memory_order_acquire)) return false;
+    sample = m_vSlots[iTail & m_iMask];
+    m_iTail.store(iTail+1, std::memory_order_release);
+    return true;
+  }
+
+  ///Number of samples dropped because the queue was full, since last called
+  /// (so may be called by either thread, but only one).
+  unsigned long TakeDropped() {
+    return m_iDropped.exchange(0, std::memory_order_relaxed);
+  }
+
+private:
+  std::vector<T> m_vSlots;
+  size_t m_iMask;
+  ///Counts of samples ever pushed / popped. Each is written by only one
+  /// thread; kept on separate cache lines so the two don't contend.
+  alignas(64) std::atomic<size_t> m_iHead;
+  alignas(64) std::atomic<size_t> m_iTail;
+  std::atomic<unsigned long> m_iDropped;
+};
+/// \}
+
+#endif
@@ -30,9 +30,7 @@ static char THIS_FILE[] = __FILE__;
 #endif
 #endif
 
-static CSettingsStore *s_pSettingsStore = NULL;
-
-CSettingsStore::CSettingsStore() {
+CSettingsStore::CSettingsStore() : dispatch_depth_(0), subscribers_removed_(false) {
 }
 
 void CSettingsStore::LoadPersistent() {
@@ -147,7 +145,7 @@ void CSettingsStore::SetBoolParameter(int iParameter, bool bValue) {
   p->second.bool_value = bValue;
 
   // Initiate events for changed parameter
-  DispatchEvent(iParameter);
+  NotifyChange(iParameter);
   if (p->second.persistence == Persistence::PERSISTENT) {
     // Write out to permanent storage
     SaveSetting(p->second.name, bValue);
@@ -168,7 +166,7 @@ void CSettingsStore::SetLongParameter(int iParameter, long lValue) {
   p->second.long_value = lValue;
 
   // Initiate events for changed parameter
-  DispatchEvent(iParameter);
+  NotifyChange(iParameter);
   if (p->second.persistence == Persistence::PERSISTENT) {
     // Write out to permanent storage
     SaveSetting(p->second.name, lValue);
@@ -189,7 +187,7 @@ void CSettingsStore::SetStringParameter(int iParameter, const std::string sValue
   p->second.string_value = sValue;
 
   // Initiate events for changed parameter
-  DispatchEvent(iParameter);
+  NotifyChange(iParameter);
   if (p->second.persistence == Persistence::PERSISTENT) {
     // Write out to permanent storage
     SaveSetting(p->second.name, sValue);
@@ -260,43 +258,113 @@ void CSettingsStore::SaveSetting(const std::string &, long ) {
 void CSettingsStore::SaveSetting(const std::string &, const std::string &) {
 }
 
+void CSettingsStore::Subscribe(int iParameter, Observer<int> *pObserver) {
+  DASHER_ASSERT(iParameter >= 0);
+  const pair<int, Observer<int> *> sub(iParameter, pObserver);
+  // As Observable::Register, ignore duplicates
+  if (find(pending_subscribers_.begin(), pending_subscribers_.end(), sub) != pending_subscribers_.end()
+      || (iParameter < static_cast<int>(subscribers_.size())
+          && find(subscribers_[iParameter].begin(), subscribers_[iParameter].end(), pObserver) != subscribers_[iParameter].end()))
+    return;
+  if (dispatch_depth_) {
+    pending_subscribers_.push_back(sub);
+    return;
+  }
+  if (iParameter >= static_cast<int>(subscribers_.size()))
+    subscribers_.resize(iParameter + 1);
+  subscribers_[iParameter].push_back(pObserver);
+}
+
+void CSettingsStore::Unsubscribe(int iParameter, Observer<int> *pObserver) {
+  pending_subscribers_.erase(remove(pending_subscribers_.begin(), pending_subscribers_.end(),
+                                    pair<int, Observer<int> *>(iParameter, pObserver)),
+                             pending_subscribers_.end());
+  if (iParameter >= static_cast<int>(subscribers_.size())) return;
+  vector<Observer<int> *> &subs(subscribers_[iParameter]);
+  vector<Observer<int> *>::iterator it = find(subs.begin(), subs.end(), pObserver);
+  if (it == subs.end()) return;
+  if (dispatch_depth_) {
+    //can't change the vector (its elements may be being iterated over)
+    *it = NULL;
+    subscribers_removed_ = true;
+  } else
+    subs.erase(it);
+}
+
+void CSettingsStore::NotifyChange(int iParameter) {
+  // Observers of all changes
+  DispatchEvent(iParameter);
+
+  if (iParameter >= static_cast<int>(subscribers_.size())) return;
+  ++dispatch_depth_;
+  // Index, rather than iterate, to be robust to (recursive) dispatch; no entries
+  // are added or erased until the outermost dispatch finishes, only NULLed
+  const vector<Observer<int> *> &subs(subscribers_[iParameter]);
+  for (size_t i=0; i<subs.size(); i++)
+    if (subs[i]) subs[i]->HandleEvent(iParameter);
+  if (--dispatch_depth_) return;
+
+  if (subscribers_removed_) {
+    for (vector<vector<Observer<int> *> >::iterator it=subscribers_.begin(); it!=subscribers_.end(); it++)
+      it->erase(remove(it->begin(), it->end(), static_cast<Observer<int> *>(NULL)), it->end());
+    subscribers_removed_ = false;
+  }
+  if (!pending_subscribers_.empty()) {
+    vector<pair<int, Observer<int> *> > pending;
+    pending.swap(pending_subscribers_);
+    for (vector<pair<int, Observer<int> *> >::iterator it=pending.begin(); it!=pending.end(); it++)
+      Subscribe(it->first, it->second);
+  }
+}
+
 /* SettingsUser and SettingsObserver definitions... */
 
-CSettingsUser::CSettingsUser(CSettingsStore *pSettingsStore) {
-  //ATM, we only allow one settings store, total...
-  DASHER_ASSERT(s_pSettingsStore==NULL);
-  //but in future, remove that if we're allowing multiple settings stores to exist
-  // concurrently.
-  s_pSettingsStore = pSettingsStore;
+CSettingsUser::CSettingsUser(CSettingsStore *pSettingsStore) : m_pSettingsStore(pSettingsStore) {
 }
 
-CSettingsUser::CSettingsUser(CSettingsUser *pCreateFrom) {
-  //No need to do anything atm; but in future, copy CSettingsStore pointer
-  // from argument.
-  DASHER_ASSERT(pCreateFrom);
+CSettingsUser::CSettingsUser(CSettingsUser *pCreateFrom)
+: m_pSettingsStore(pCreateFrom ? pCreateFrom->m_pSettingsStore : NULL) {
+  //(NULL is allowed, by offline tools that read no settings.)
 }
 
 CSettingsUser::~CSettingsUser() {
 }
 
-bool CSettingsUser::GetBoolParameter(int iParameter) const {return s_pSettingsStore->GetBoolParameter(iParameter);}
-long CSettingsUser::GetLongParameter(int iParameter) const {return s_pSettingsStore->GetLongParameter(iParameter);}
-const std::string &CSettingsUser::GetStringParameter(int iParameter) const {return s_pSettingsStore->GetStringParameter(iParameter);}
-void CSettingsUser::SetBoolParameter(int iParameter, bool bValue) {s_pSettingsStore->SetBoolParameter(iParameter, bValue);}
-void CSettingsUser::SetLongParameter(int iParameter, long lValue) {s_pSettingsStore->SetLongParameter(iParameter, lValue);}
-void CSettingsUser::SetStringParameter(int iParameter, const std::string &strValue) {s_pSettingsStore->SetStringParameter(iParameter, strValue);}
+bool CSettingsUser::GetBoolParameter(int iParameter) const {return m_pSettingsStore->GetBoolParameter(iParameter);}
+long CSettingsUser::GetLongParameter(int iParameter) const {return m_pSettingsStore->GetLongParameter(iParameter);}
+const std::string &CSettingsUser::GetStringParameter(int iParameter) const {return m_pSettingsStore->GetStringParameter(iParameter);}
+void CSettingsUser::SetBoolParameter(int iParameter, bool bValue) {m_pSettingsStore->SetBoolParameter(iParameter, bValue);}
+void CSettingsUser::SetLongParameter(int iParameter, long lValue) {m_pSettingsStore->SetLongParameter(iParameter, lValue);}
+void CSettingsUser::SetStringParameter(int iParameter, const std::string &strValue) {m_pSettingsStore->SetStringParameter(iParameter, strValue);}
+
+bool CSettingsUser::IsParameterSaved(const std::string &Key) { return m_pSettingsStore->IsParameterSaved(Key); }
 
-bool CSettingsUser::IsParameterSaved(const std::string &Key) { return s_pSettingsStore->IsParameterSaved(Key); }
+CSettingsObserver::CSettingsObserver(CSettingsUser *pCreateFrom)
+: m_pSettingsStore(pCreateFrom ? pCreateFrom->m_pSettingsStore : NULL) {
+  //NULL (offline tools) means observe nothing
+  if (m_pSettingsStore) m_pSettingsStore->Register(this);
+}
 
-CSettingsObserver::CSettingsObserver(CSettingsUser *pCreateFrom) {
-  DASHER_ASSERT(pCreateFrom);
-  s_pSettingsStore->Register(this);
+CSettingsObserver::CSettingsObserver(CSettingsUser *pCreateFrom, const vector<int> &vParameters)
+: m_pSettingsStore(pCreateFrom ? pCreateFrom->m_pSettingsStore : NULL), m_vParameters(vParameters) {
+  DASHER_ASSERT(!m_vParameters.empty());
+  if (!m_pSettingsStore) return;
+  for (vector<int>::const_iterator it=m_vParameters.begin(); it!=m_vParameters.end(); it++)
+    m_pSettingsStore->Subscribe(*it, this);
 }
 
 CSettingsObserver::~CSettingsObserver() {
-  s_pSettingsStore->Unregister(this);
+  if (!m_pSettingsStore) return; //offline tool; never registered
+  if (m_vParameters.empty())
+    m_pSettingsStore->Unregister(this);
+  else for (vector<int>::const_iterator it=m_vParameters.begin(); it!=m_vParameters.end(); it++)
+    m_pSettingsStore->Unsubscribe(*it, this);
 }
 
 CSettingsUserObserver::CSettingsUserObserver(CSettingsUser *pCreateFrom)
 : CSettingsUser(pCreateFrom), CSettingsObserver(pCreateFrom) {
 }
+
+CSettingsUserObserver::CSettingsUserObserver(CSettingsUser *pCreateFrom, const vector<int> &vParameters)
+: CSettingsUser(pCreateFrom), CSettingsObserver(pCreateFrom, vParameters) {
+}
@@ -11,6 +11,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "Observable.h"
 #include "Parameters.h"
@@ -33,6 +35,10 @@ namespace Dasher {
 /// to arbitrary locations, or (b) make the actual pref-value data static i.e. shared
 /// between instances.)
 ///
+/// Observers registered (via Register) are told of every change, so most should
+/// instead Subscribe to just the parameters they care about: each change then
+/// costs only as many calls as there are observers interested in it.
+///
 /// The public interface uses UTF-8 strings. All Keys should be
 /// in American English and encodable in ASCII. However,
 /// string Values may contain special characters where appropriate.
@@ -62,6 +68,15 @@ public:
   void AddParameters(const Settings::lp_table* table, size_t count);
   void AddParameters(const Settings::sp_table* table, size_t count);
   Observable<CParameterChange>& PreSetObservable() { return pre_set_observable_; }
+
+  ///Subscribe an observer to changes of a single parameter: its HandleEvent will be
+  /// called (with that parameter) after each change, after any observers Registered
+  /// for all changes. May be called during dispatch (i.e. from a HandleEvent),
+  /// in which case it takes effect when the outermost dispatch finishes.
+  void Subscribe(int iParameter, Observer<int> *pObserver);
+  ///Cancel a subscription. May be called during dispatch, after which the
+  /// observer will not be called again (for that parameter).
+  void Unsubscribe(int iParameter, Observer<int> *pObserver);
     
   virtual bool IsParameterSaved(const std::string & Key) { return false; }; // avoid undef sub-classes error
 
@@ -126,26 +141,39 @@ private:
     const char* string_default;  // Doesn't own the string.
   };
 
+  ///Tell observers, registered for all changes and subscribed to this parameter, that it has changed.
+  void NotifyChange(int iParameter);
+
   std::unordered_map<int, Parameter> parameters_;
   Observable<CParameterChange> pre_set_observable_;
+
+  ///Subscribers to each parameter, indexed by parameter ID. NULL entries are
+  /// subscribers removed during dispatch, not yet erased.
+  std::vector<std::vector<Observer<int> *> > subscribers_;
+  ///Subscriptions made during dispatch, to be added when it finishes
+  std::vector<std::pair<int, Observer<int> *> > pending_subscribers_;
+  ///Depth of (possibly recursive) dispatch to subscribers
+  int dispatch_depth_;
+  ///Whether any NULL entries need erasing from subscribers_ when dispatch finishes
+  bool subscribers_removed_;
 };
   /// Superclass for anything that wants to use/access/store persistent settings.
   /// (The nearest thing remaining to the old CDasherComponent,
   /// but more of a mixin rather than a universal superclass.)
-  /// At the moment, _all_ clients share a single SettingsStore (static),
-  /// but for future-proofing in case we ever want more than one SettingsStore
-  /// (this has been suggested), SettingsUsers can only be created from other
-  /// SettingsUsers (i.e. in a tree), so _could_ be modified to copy a SettingsStore
-  /// pointer from the creator to inherit settings.
+  /// SettingsUsers can only be created from other SettingsUsers (i.e. in a tree),
+  /// and copy the SettingsStore pointer from their creator; so several trees,
+  /// each rooted at a different SettingsStore, can exist at once (e.g. one per
+  /// session of a server hosting several users).
   class CSettingsUser {
   private:
-    friend class CDasherInterfaceBase;
-    ///Create the root of the SettingsUser hierarchy from a SettingsStore.
-    /// ATM we allow only one SettingsStore, so this c'tor is private and 
-    /// used only by the DasherInterface; if/when multiple SettingsStores
-    /// are used, could be made public.
-    CSettingsUser(CSettingsStore *pSettingsStore);
+    friend class CSettingsObserver;
+    ///Store from which all settings are read; NULL for offline tools reading none.
+    CSettingsStore * const m_pSettingsStore;
   public:
+    ///Create the root of a SettingsUser hierarchy from a SettingsStore; usually
+    /// the DasherInterface, but e.g. a language model shared between several
+    /// interfaces may be created from a root of its own.
+    CSettingsUser(CSettingsStore *pSettingsStore);
     virtual ~CSettingsUser();
     bool IsParameterSaved(const std::string & Key);
   protected:
@@ -159,24 +187,32 @@ private:
     void SetStringParameter(int iParameter, const std::string &strValue);
   };
   ///Superclass for anything that wants to be notified when settings change.
-  /// (Note inherited pure virtual HandleEvent(int) method, called when any pref changes).
+  /// (Note inherited pure virtual HandleEvent(int) method, called when any pref changes,
+  /// or only those passed to the constructor, if any).
   ///Exists as a distinct class from CSettingsUserObserver (below) to get round C++'s
   /// multiple inheritance problems, i.e. for indirect subclasses of CSettingsUser
   /// wanting to introduce settings-listener capabilities.
-  ///Note we don't inherit from TransientObserver as it saves storing the SettingsStore ptr
-  /// in every instance; if we move to multiple settings stores, we could so inherit.
   class CSettingsObserver : public Observer<int> {
   public:
     ///Create a CSettingsObserver listening to changes to the settings values
     /// used by a particular CSettingsUser.
     CSettingsObserver(CSettingsUser *pCreateFrom);
+    ///Create a CSettingsObserver notified only of changes to the specified parameters
+    /// (which should be those its HandleEvent acts upon); must not be empty.
+    CSettingsObserver(CSettingsUser *pCreateFrom, const std::vector<int> &vParameters);
     ~CSettingsObserver() override;
+  private:
+    ///Store observed; NULL if none (offline tools)
+    CSettingsStore * const m_pSettingsStore;
+    ///Parameters subscribed to; empty if notified of all changes
+    const std::vector<int> m_vParameters;
   };
   ///Utility class, for (majority of) cases where a class wants to be both
   /// a CSettingsUser and CSettingsObserver.
   class CSettingsUserObserver : public CSettingsUser, public CSettingsObserver {
   public:
     CSettingsUserObserver(CSettingsUser *pCreateFrom);
+    CSettingsUserObserver(CSettingsUser *pCreateFrom, const std::vector<int> &vParameters);
   };
 /// @}
 }
@@ -19,25 +19,11 @@ static char THIS_FILE[] = __FILE__;
 #endif
 #endif
 
+long long CSimpleTimer::s_iFixedTime = -1;
+
 CSimpleTimer::CSimpleTimer()
 {
-#ifdef _WIN32
-  struct timeb sTimeBuffer;
-#else
-  struct timeval sTimeBuffer;
-  struct timezone sTimezoneBuffer;
-#endif
-
-#ifdef _WIN32
-    ftime(&sTimeBuffer);
-    m_iStartMs       = sTimeBuffer.millitm;
-    m_iStartSecond   = sTimeBuffer.time;
-#else
-    gettimeofday(&sTimeBuffer, &sTimezoneBuffer);
-    m_iStartMs       = (int)sTimeBuffer.tv_usec / 1000;
-    m_iStartSecond   = (int)sTimeBuffer.tv_sec;
-#endif
-
+  m_iStart = GetTime();
 }
 
 CSimpleTimer::~CSimpleTimer()
@@ -46,26 +32,27 @@ CSimpleTimer::~CSimpleTimer()
 
 double CSimpleTimer::GetElapsed()
 {
+  return (GetTime() - m_iStart) / 1000.0;
+}
+
+long long CSimpleTimer::GetTime()
+{
+  if (s_iFixedTime >= 0)
+    return s_iFixedTime;
+
 #ifdef _WIN32
   struct timeb sTimeBuffer;
+  ftime(&sTimeBuffer);
+  return (long long) sTimeBuffer.time * 1000 + sTimeBuffer.millitm;
 #else
   struct timeval sTimeBuffer;
   struct timezone sTimezoneBuffer;
-#endif
-
-#ifdef _WIN32
-  ftime(&sTimeBuffer);
-  int     iEndMs       = sTimeBuffer.millitm;
-  int     iEndSecond   = sTimeBuffer.time;
-#else
   gettimeofday(&sTimeBuffer, &sTimezoneBuffer);
-  int     iEndMs       = (int)sTimeBuffer.tv_usec / 1000;
-  int     iEndSecond   = (int)sTimeBuffer.tv_sec;
+  return (long long) sTimeBuffer.tv_sec * 1000 + sTimeBuffer.tv_usec / 1000;
 #endif
-
-
-  return  ((double) iEndMs     / 1000.0 + (double) iEndSecond) - 
-          ((double) m_iStartMs / 1000.0 + (double) m_iStartSecond);
-
 }
 
+void CSimpleTimer::SetFixedTime(long long iTime)
+{
+  s_iFixedTime = iTime;
+}
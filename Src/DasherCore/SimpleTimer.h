@@ -18,9 +18,18 @@ public:
 
   double GetElapsed();
 
+  ///Current (wall-clock) time in ms since the epoch, as used by all user-logging
+  /// timers and time stamps; or the time set by SetFixedTime.
+  static long long GetTime();
+
+  ///Makes GetTime() return the given time (e.g. that recorded with an event
+  /// being replayed from a log), rather than the real time; -1 to go back to
+  /// the real time. Not thread-safe: only for use when nothing else is logging.
+  static void SetFixedTime(long long iTime);
+
 private:
-  int     m_iStartSecond;
-  int     m_iStartMs;
+  long long m_iStart;
+  static long long s_iFixedTime;
 
 };
 /// \}
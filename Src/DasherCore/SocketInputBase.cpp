@@ -11,6 +11,8 @@
 #include <string.h>
 #include <errno.h>
 #include <stdarg.h>
+#include <math.h>
+#include <chrono>
 #ifdef _WIN32
 #include <winsock2.h>
 #define DASHER_SOCKET_CLOSE_FUNCTION closesocket
@@ -31,11 +33,14 @@ static SModuleSettings sSettings[] = {
   {SP_SOCKET_INPUT_Y_LABEL, T_STRING, -1, -1, -1, -1, _("Y label:")},
   {LP_SOCKET_INPUT_Y_MIN, T_LONGSPIN, -2147480000, 2147480000, 1000, 10000, _("Y minimum:")},
   {LP_SOCKET_INPUT_Y_MAX, T_LONGSPIN, -2147480000, 2147480000, 1000, 10000, _("Y maximum:")},
+  {LP_SOCKET_INPUT_SMOOTHING, T_LONGSPIN, 0, 1000, 1, 10, _("Smoothing time constant (ms):")},
   {BP_SOCKET_DEBUG, T_BOOL, -1, -1, -1, -1, _("Print socket-related debugging information to console:")}
 };
 
 Dasher::CSocketInputBase::CSocketInputBase(CSettingsUser *pCreator, CMessageDisplay *pMsgs)
-  : CScreenCoordInput(1, _("Socket Input")), CSettingsUserObserver(pCreator), m_pMsgs(pMsgs) {
+  : CScreenCoordInput(1, _("Socket Input")), CSettingsUserObserver(pCreator, {LP_SOCKET_PORT, SP_SOCKET_INPUT_X_LABEL, SP_SOCKET_INPUT_Y_LABEL,
+    LP_SOCKET_INPUT_X_MIN, LP_SOCKET_INPUT_X_MAX, LP_SOCKET_INPUT_Y_MIN, LP_SOCKET_INPUT_Y_MAX, LP_SOCKET_INPUT_SMOOTHING, BP_SOCKET_DEBUG}),
+  m_pMsgs(pMsgs), m_samples(SAMPLE_QUEUE_SIZE) {
   port = -1;
   debug_socket_input = false;
   readerRunning = false;
@@ -47,6 +52,7 @@ Dasher::CSocketInputBase::CSocketInputBase(CSettingsUser *pCreator, CMessageDisp
     rawMaxValues[i] = 512.0;
     memset(coordinateNames[i], '\0', DASHER_SOCKET_INPUT_MAX_COORDINATE_LABEL_LENGTH + 1);
     dasherCoordinates[i] = 2048; // initialise to mid-range value
+    m_bHaveSample[i] = m_bWarnedClip[i] = false;
   }
 
   // initialise using parameter settings:
@@ -56,6 +62,7 @@ Dasher::CSocketInputBase::CSocketInputBase(CSettingsUser *pCreator, CMessageDisp
   SetRawRange(1, ((double)GetLongParameter(LP_SOCKET_INPUT_Y_MIN)) / 1000.0, ((double)GetLongParameter(LP_SOCKET_INPUT_Y_MAX)) / 1000.0);
   SetCoordinateLabel(0, GetStringParameter(SP_SOCKET_INPUT_X_LABEL).c_str());
   SetCoordinateLabel(1, GetStringParameter(SP_SOCKET_INPUT_Y_LABEL).c_str());
+  SetSmoothing(GetLongParameter(LP_SOCKET_INPUT_SMOOTHING));
   SocketDebugMsg("Socket input is initialised but not yet enabled");
 }
 
@@ -84,6 +91,9 @@ void Dasher::CSocketInputBase::HandleEvent(int iParameter) {
   case LP_SOCKET_INPUT_Y_MAX:
     SetRawRange(1, ((double)GetLongParameter(LP_SOCKET_INPUT_Y_MIN)) / 1000.0, ((double)GetLongParameter(LP_SOCKET_INPUT_Y_MAX)) / 1000.0);
     break;
+  case LP_SOCKET_INPUT_SMOOTHING:
+    SetSmoothing(GetLongParameter(LP_SOCKET_INPUT_SMOOTHING));
+    break;
   case BP_SOCKET_DEBUG:
     SetDebug(GetBoolParameter(BP_SOCKET_DEBUG));
     break;
@@ -180,37 +190,222 @@ void CSocketInputBase::SetRawRange(int iWhich, double dMin, double dMax) {
   rawMinValues[iWhich] = dMin;
   rawMaxValues[iWhich] = dMax;
   SocketDebugMsg("Socket input: set coordinate %d input range to: min: %lf, max: %lf.", iWhich, dMin, dMax);
+  m_bWarnedClip[iWhich] = false;
+}
+
+void CSocketInputBase::SetSmoothing(long iSmoothing) {
+  m_iSmoothing = static_cast<long long>(iSmoothing) * 1000;
+  SocketDebugMsg("Socket input: set smoothing time constant to %ld ms.", iSmoothing);
+}
+
+bool CSocketInputBase::GetScreenCoords(screenint &iScreenX, screenint &iScreenY, CDasherView *pView) {
+  //update max values (used only on this thread, so take effect immediately)
+  dasherMaxCoordinateValues[0] = pView->Screen()->GetWidth();
+  dasherMaxCoordinateValues[1] = pView->Screen()->GetHeight();
+
+  DrainSamples();
+  const long long iNow(Now());
+  for (int i = 0; i < coordinateCount; i++) {
+    if (!m_bHaveSample[i]) continue; //keep initial (mid-range) value
+    double rawdouble(m_dLatest[i]);
+    if (m_iSmoothing) {
+      //advance the filter from the latest sample to now, holding that sample's value
+      rawdouble = m_dFiltered[i] + (m_dLatest[i] - m_dFiltered[i]) * (1.0 - exp(-double(iNow - m_iLatestTime[i]) / m_iSmoothing));
+    }
+    // straightforward linear mapping to dasher coordinates:
+    // Treat X coordinate specially: reverse sense so it has the more intuitive left-to-right direction
+    double min = (i==0) ? rawMaxValues[i] : rawMinValues[i];
+    double max = (i==0) ? rawMinValues[i] : rawMaxValues[i];
+    if(max != min) { // prevent nasty explosion
+      dasherCoordinates[i] = (myint) ((rawdouble - min) / (max - min) * (double)dasherMaxCoordinateValues[i]);
+    }
+  }
+
+  if (coordinateCount==1) {
+    iScreenX = 0;
+    iScreenY = dasherCoordinates[0];
+  } else if (coordinateCount==2) {
+    iScreenX = dasherCoordinates[0];
+    iScreenY = dasherCoordinates[1];
+  } else {
+    //Aiieee, we're receiving >2 coords? Don't know what to do...
+    return false;
+  }
+  return true;
+}
+
+void CSocketInputBase::DrainSamples() {
+  SSample sample;
+  while (m_samples.Pop(sample)) {
+    for (int i = 0; i < DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT; i++) {
+      if (!(sample.iMask & (1<<i))) continue;
+      const double dValue(Clip(i, sample.dValues[i]));
+      if (!m_bHaveSample[i]) {
+        m_dFiltered[i] = dValue;
+        m_bHaveSample[i] = true;
+      } else if (m_iSmoothing) {
+        //First-order low-pass, exact for a signal held at each value until the next
+        // (so correct however irregularly samples arrive)
+        m_dFiltered[i] += (m_dLatest[i] - m_dFiltered[i]) * (1.0 - exp(-double(sample.iTime - m_iLatestTime[i]) / m_iSmoothing));
+      }
+      m_dLatest[i] = dValue;
+      m_iLatestTime[i] = sample.iTime;
+    }
+  }
+  if (unsigned long iDropped = m_samples.TakeDropped())
+    SocketDebugMsg("Socket input: dropped %lu samples (not read quickly enough).", iDropped);
+}
+
+double CSocketInputBase::Clip(int i, double rawdouble) {
+  // for clipping purposes, we want to ignore whether Max < Min (which indicates that
+  // we need to flip the sense of the input)
+  double actualMax = (rawMaxValues[i] > rawMinValues[i]) ? rawMaxValues[i] : rawMinValues[i];
+  double actualMin = (rawMaxValues[i] > rawMinValues[i]) ? rawMinValues[i] : rawMaxValues[i];
+  if (rawdouble >= actualMin && rawdouble <= actualMax) return rawdouble;
+  //Warn only the first time (per range), as at high sample rates this would flood the console
+  if (!m_bWarnedClip[i]) {
+    cerr << "Socket input: clipped " << coordinateNames[i] << " value of " << rawdouble << " to configured range of "
+         << actualMin << " to " << actualMax << " (further clipping will not be reported)" << endl;
+    m_bWarnedClip[i] = true;
+  }
+  SocketDebugMsg("Socket input: clipped %s value of %lf.", coordinateNames[i], rawdouble);
+  return rawdouble < actualMin ? actualMin : actualMax;
 }
 
 
 // private methods:
 
+const unsigned char CSocketInputBase::BINARY_MAGIC[4] = {0xDA, 0x5E, 'B', 0x01};
+
+long long CSocketInputBase::Now() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
 void CSocketInputBase::ReadForever() {
-  // this gets called in its own thread. It reads datagrams and updates the coordinate variables
+  // this gets called in its own thread. It reads datagrams and queues their values
+  // for the thread rendering frames, which calls GetScreenCoords.
 
-  int numbytes;
   while(sock >= 0) {
     SocketDebugMsg("Reading from socket...");
-    if((numbytes = recv(sock, buffer, sizeof(buffer) - 1, 0)) == -1) {
+    const int iCount(ReceiveBatch());
+    if(iCount == -1) {
       m_pMsgs->Message(_("Socket input: Error reading from socket"),false);
       continue;
     }
-    buffer[numbytes] = '\0';
+    //all datagrams in the batch arrived by now (as best we can tell)
+    const long long iNow(Now());
+    for (int i = 0; i < iCount; i++) {
+      SSample sample;
+      sample.iTime = iNow;
+      sample.iMask = 0;
+      if (ParseDatagram(buffers[i], bufferLengths[i], sample))
+        m_samples.Push(sample);
+    }
+  }
+}
 
-    SocketDebugMsg(" received string: '%s'.", buffer);
+int CSocketInputBase::ReceiveBatch() {
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+  //Receive everything waiting in one system call
+  struct iovec aIov[RECV_BATCH];
+  struct mmsghdr aMsgs[RECV_BATCH];
+  memset(aMsgs, 0, sizeof(aMsgs));
+  for (int i = 0; i < RECV_BATCH; i++) {
+    aIov[i].iov_base = buffers[i];
+    aIov[i].iov_len = RECV_BUFFER - 1;
+    aMsgs[i].msg_hdr.msg_iov = &aIov[i];
+    aMsgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  const int iCount(recvmmsg(sock, aMsgs, RECV_BATCH, MSG_WAITFORONE, NULL));
+  for (int i = 0; i < iCount; i++) {
+    bufferLengths[i] = aMsgs[i].msg_len;
+    buffers[i][bufferLengths[i]] = '\0';
+  }
+  return iCount;
+#else
+  const int numbytes(recv(sock, buffers[0], RECV_BUFFER - 1, 0));
+  if (numbytes == -1) return -1;
+  bufferLengths[0] = numbytes;
+  buffers[0][numbytes] = '\0';
+  return 1;
+#endif
+}
 
-    ParseMessage(buffer);
+bool CSocketInputBase::ParseDatagram(char *message, int iLength, SSample &sample) {
+  if (iLength >= 6 && memcmp(message, BINARY_MAGIC, 4) == 0) {
+    const unsigned char *p(reinterpret_cast<const unsigned char *>(message) + 6);
+    int iNum(static_cast<unsigned char>(message[4]));
+    if (iNum * 8 > iLength - 6) {
+      SocketDebugMsg("Socket input: binary datagram of %d octets too short for %d values.", iLength, iNum);
+      return false;
+    }
+    if (iNum > DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT) iNum = DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT;
+    for (int i = 0; i < iNum; i++, p += 8) {
+      unsigned long long iBits(0);
+      for (int b = 7; b >= 0; b--) iBits = (iBits << 8) | p[b];
+      memcpy(&sample.dValues[i], &iBits, sizeof(double));
+      sample.iMask |= 1 << i;
+    }
+    SocketDebugMsg("Socket input: received binary datagram with %d values.", iNum);
+  } else {
+    SocketDebugMsg(" received string: '%s'.", message);
+    ParseMessage(message, sample);
+  }
+  return sample.iMask != 0;
+}
 
+bool CSocketInputBase::ParseNumber(const char *&p, double &dValue) {
+  //powers of ten exactly representable as doubles
+  static const double aPowers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *q(p);
+  while (*q == ' ' || *q == '\t') q++;
+  const bool bNeg(*q == '-');
+  if (*q == '-' || *q == '+') q++;
+  //accumulate up to 19 significant digits exactly; further ones only scale
+  unsigned long long iMantissa(0);
+  int iDigits(0), iExp(0);
+  bool bAny(false);
+  for (; *q >= '0' && *q <= '9'; q++, bAny = true) {
+    if (iDigits < 19) {
+      iMantissa = iMantissa*10 + (*q - '0');
+      if (iMantissa) iDigits++;
+    } else iExp++;
+  }
+  if (*q == '.') {
+    for (q++; *q >= '0' && *q <= '9'; q++, bAny = true) {
+      if (iDigits < 19) {
+        iMantissa = iMantissa*10 + (*q - '0');
+        if (iMantissa) iDigits++;
+        iExp--;
+      }
+    }
+  }
+  if (!bAny) return false;
+  if (*q == 'e' || *q == 'E') {
+    const char *e(q+1);
+    const bool bNegExp(*e == '-');
+    if (*e == '-' || *e == '+') e++;
+    if (*e >= '0' && *e <= '9') {
+      int iE(0);
+      for (; *e >= '0' && *e <= '9'; e++) if (iE < 10000) iE = iE*10 + (*e - '0');
+      iExp += bNegExp ? -iE : iE;
+      q = e;
+    }
   }
+  double d(static_cast<double>(iMantissa));
+  if (iExp < 0) d = (iExp >= -22) ? d / aPowers[-iExp] : d * pow(10.0, iExp);
+  else if (iExp > 0) d = (iExp <= 22) ? d * aPowers[iExp] : d * pow(10.0, iExp);
+  dValue = bNeg ? -d : d;
+  p = q;
+  return true;
 }
 
-// Parse and act on a message received from the socket
-// Allowed to modify contents of memory pointed to by message, up to its final '\0'.
-void CSocketInputBase::ParseMessage(char *message) {
+void CSocketInputBase::ParseMessage(char *message, SSample &sample) {
 
   char *p;
   double rawdouble;
- // myint dasherCoordinateTemp;
   // parse line by line
   while((p = strchr(message, '\n')) != NULL) {
     *p = '\0';
@@ -221,7 +416,8 @@ void CSocketInputBase::ParseMessage(char *message) {
       if(strncmp(coordinateNames[i], message, len) == 0) {
         SocketDebugMsg("Matched label '%s'...", coordinateNames[i]);
         // First len chars match the label of this coordinate. Value should be at the next non-space char.
-        if(sscanf(message + len, "%lf", &rawdouble) == 1) {
+        const char *value(message + len);
+        if(ParseNumber(value, rawdouble)) {
           SocketDebugMsg("...parsed value as %lf.", rawdouble);
 
 #ifdef DASHER_SOCKET_INPUT_BCI2000_OVERFLOW_WORKAROUND
@@ -233,43 +429,10 @@ void CSocketInputBase::ParseMessage(char *message) {
             rawdouble = 768;
           }
 #endif
-
-          // Clipping:
-          // for clipping purposes, we want to ignore whether Max < Min (which indicates that
-          // we need to flip the sense of the input)
-          double actualMax = (rawMaxValues[i] > rawMinValues[i]) ? rawMaxValues[i] : rawMinValues[i];
-          double actualMin = (rawMaxValues[i] > rawMinValues[i]) ? rawMinValues[i] : rawMaxValues[i];
-          if(rawdouble < actualMin) {
-            //TODO: Should these be converted to calls to Message() ? On first occurrence only???
-            cerr << "Socket input: clipped " << coordinateNames[i] << " value of " << rawdouble << "to configured minimum of " << actualMin << endl;
-            rawdouble = actualMin;
-          }
-          if(rawdouble > actualMax) {
-            //TODO: Should these be converted to calls to Message() ? On first occurrence only???
-            cerr << "Socket input: clipped " << message << " value of " << rawdouble << "to configured maximum of " << actualMax << endl;
-            rawdouble = actualMax;
-          }
-
-          // convert to dasher coordinates:
-          
-          const bool do_lowpass = false;
-          if(do_lowpass) {
-            // initial attempt at putting a low-pass filter in. Not well tested; disabled for now.
-            double timeconst = 100.0;   // no of updates
-            double newcoord = ((rawdouble - rawMinValues[i]) / (rawMaxValues[i] - rawMinValues[i]) * dasherMaxCoordinateValues[i]);
-            dasherCoordinates[i] = (myint) ((1 - 1 / timeconst) * (double)dasherCoordinates[i] + (1 / timeconst) * newcoord);
-          }
-          else {
-            // straightforward linear mapping to dasher coordinates:
-	    // Treat X coordinate specially: reverse sense so it has the more intuitive left-to-right direction
-	    double min = (i==0) ? rawMaxValues[i] : rawMinValues[i];
-	    double max = (i==0) ? rawMinValues[i] : rawMaxValues[i];
-            if(max != min) { // prevent nasty explosion
-              dasherCoordinates[i] = (myint) ((rawdouble - min) / (max - min) * (double)dasherMaxCoordinateValues[i]);
-            }
-          }
-
-          SocketDebugMsg("Socket input: new value for coordinate %d rescales to %u in Dasher's internal coordinates (range 0-%d).", i, (unsigned int) dasherCoordinates[i], (int) dasherMaxCoordinateValues[i]);
+          //clipped and scaled when the sample is used (by GetScreenCoords); a later line
+          // for the same coordinate, in the same datagram, replaces this one.
+          sample.dValues[i] = rawdouble;
+          sample.iMask |= 1 << i;
 
           // don't break out of the for loop in case we get asked to drive two coordinates from same label
         } else {
@@ -10,6 +10,7 @@
 #include "DasherInput.h"
 #include "SettingsStore.h"
 #include "Messages.h"
+#include "SampleQueue.h"
 
 #include <iostream>
 
@@ -53,27 +54,11 @@ public:
     coordinateCount = _coordinateCount;
   }
 
-  /// Gets the last coordinates received; if only one coordinate is being read, this is put
+  /// Gets the coordinates at the current time, from the samples received so far:
+  /// either the latest, or if LP_SOCKET_INPUT_SMOOTHING is set, a low-pass
+  /// filter of them. If only one coordinate is being read, this is put
   /// into iDasherY (and iDasherX set to 0).
-  bool GetScreenCoords(screenint &iScreenX, screenint &iScreenY, CDasherView *pView) {
-
-    //update max values for reader thread...(note any changes here won't be incorporated
-    // until values are next received over socket, but never mind)
-    dasherMaxCoordinateValues[0] = pView->Screen()->GetWidth();
-    dasherMaxCoordinateValues[1] = pView->Screen()->GetHeight();
-
-    if (coordinateCount==1) {
-      iScreenX = 0;
-      iScreenY = dasherCoordinates[0];
-    } else if (coordinateCount==2) {
-      iScreenX = dasherCoordinates[0];
-      iScreenY = dasherCoordinates[1];
-    } else {
-      //Aiieee, we're receiving >2 coords? Don't know what to do...
-      return false;
-    }
-    return true;
-  };
+  bool GetScreenCoords(screenint &iScreenX, screenint &iScreenY, CDasherView *pView);
 
   void Activate() {
     StartListening();
@@ -92,10 +77,27 @@ public:
 
   virtual void SetRawRange(int iWhich, double dMin, double dMax);
 
+  ///Sets the time constant of the low-pass filter applied to values received
+  /// \param iSmoothing in ms; 0 = no filtering, just use the latest value
+  void SetSmoothing(long iSmoothing);
+
   bool GetSettings(SModuleSettings **pSettings, int *iCount);
 
 protected:
 
+  ///Values received in one datagram, timestamped on arrival
+  struct SSample {
+    ///microseconds, on the same clock as Now()
+    long long iTime;
+    ///raw (unscaled, unclipped) value of each coordinate
+    double dValues[DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT];
+    ///bit i set iff dValues[i] was received
+    unsigned int iMask;
+  };
+
+  ///Monotonic clock for timestamping samples, in microseconds
+  static long long Now();
+
   myint dasherCoordinates[DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT];
   myint dasherMaxCoordinateValues[DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT];
   double rawMinValues[DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT];
@@ -108,7 +110,12 @@ protected:
 
   int sock;
 
-  char buffer[4096];
+  ///Maximum number of datagrams read by one call to ReceiveBatch
+  static const int RECV_BATCH = 32;
+  ///Maximum size of a datagram (longer ones are truncated)
+  static const int RECV_BUFFER = 4096;
+  char buffers[RECV_BATCH][RECV_BUFFER];
+  int bufferLengths[RECV_BATCH];
 
   bool readerRunning;
 
@@ -116,9 +123,33 @@ protected:
 
   virtual void CancelReaderThread() =0;
 
+  ///Runs on the reader thread: receives datagrams, and pushes a sample for each
+  /// onto m_samples, until the socket is closed.
   virtual void ReadForever();
 
-  virtual void ParseMessage(char *message);
+  ///Receives (blocking until there is at least one) as many datagrams as are
+  /// waiting, up to RECV_BATCH, into buffers/bufferLengths.
+  /// \return number of datagrams received, or -1 on error
+  virtual int ReceiveBatch();
+
+  ///Parses a datagram, either binary (starting with BINARY_MAGIC) or text.
+  /// \param message datagram contents, followed by a '\0' (at message[iLength])
+  /// \param sample into which to put values found
+  /// \return true if any values were found
+  bool ParseDatagram(char *message, int iLength, SSample &sample);
+
+  ///Parses text of the form "Label value" (one per line) into sample.
+  /// Allowed to modify contents of memory pointed to by message, up to its final '\0'.
+  virtual void ParseMessage(char *message, SSample &sample);
+
+  ///Binary datagrams start with these four octets, then one octet giving the number
+  /// of values n, one reserved octet, then n IEEE754 doubles (little-endian), which are
+  /// the values of coordinates 0..n-1.
+  static const unsigned char BINARY_MAGIC[4];
+
+  ///Parses a decimal floating-point number (without locale), skipping leading
+  /// spaces/tabs. \return true if a number was found, with p moved past it
+  static bool ParseNumber(const char *&p, double &dValue);
 
   //Reports an error by appending an error message obtained from strerror(errno) onto the provided prefix
   void ReportErrnoError(const std::string &prefix);
@@ -127,6 +158,28 @@ protected:
   
   CMessageDisplay *const m_pMsgs;
 
+private:
+  ///Pops all samples received and updates the filter state
+  void DrainSamples();
+  ///Clips a raw value to the configured range for coordinate i
+  double Clip(int i, double dValue);
+
+  ///Samples from the reader thread, popped by the thread rendering frames
+  CSampleQueue<SSample> m_samples;
+  static const size_t SAMPLE_QUEUE_SIZE = 4096;
+
+  ///State of each coordinate (only accessed by the thread rendering frames):
+  /// value of the latest sample, and its time
+  double m_dLatest[DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT];
+  long long m_iLatestTime[DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT];
+  /// output of the low-pass filter as of m_iLatestTime
+  double m_dFiltered[DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT];
+  /// whether any sample has been received
+  bool m_bHaveSample[DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT];
+  /// whether we've warned about values being clipped
+  bool m_bWarnedClip[DASHER_SOCKET_INPUT_MAX_COORDINATE_COUNT];
+  ///Time constant of low-pass filter, in microseconds; 0 = off
+  long long m_iSmoothing;
 };
 }
 /// \}
@@ -19,6 +19,10 @@ public:
   virtual void Timer(unsigned long iTime, dasherint iX, dasherint iY, CDasherView *pView) = 0;
   virtual void onRun(unsigned long iTime) {}
   virtual void onPause() {}
+  ///Whether Timer needs calling every frame even while the filter is paused
+  /// (e.g. to time how long the user has been in some area), rather than only
+  /// when there has been some input event.
+  virtual bool NeedsFrames() {return false;}
 protected:
   CDefaultFilter * const m_pFilter;
 };
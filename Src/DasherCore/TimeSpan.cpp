@@ -110,23 +110,9 @@ string CTimeSpan::GetXML(const string& strPrefix, bool bSinglePointInTime)
 string CTimeSpan::GetTimeStamp()
 {
   string strTimeStamp = "";
-#ifdef _WIN32
-    struct timeb sTimeBuffer;
-#else
-    struct timeval sTimeBuffer;
-    struct timezone sTimezoneBuffer;
-    time_t t;
-#endif
-    char* szTimeLine = NULL;
-
-#ifdef _WIN32
-    ftime(&sTimeBuffer);
-    szTimeLine = ctime(&(sTimeBuffer.time));
-#else
-    gettimeofday(&sTimeBuffer, &sTimezoneBuffer);
-    t = sTimeBuffer.tv_sec;
-    szTimeLine = ctime(&t);
-#endif
+  const long long iTime = CSimpleTimer::GetTime();
+  time_t t = (time_t) (iTime / 1000);
+  char* szTimeLine = ctime(&t);
   
   if ((szTimeLine != NULL) && (strlen(szTimeLine) > 18))
   {
@@ -134,11 +120,7 @@ string CTimeSpan::GetTimeStamp()
       strTimeStamp += szTimeLine[i];
     strTimeStamp += ".";
     char szMs[16];
-#ifdef _WIN32
-    sprintf(szMs, "%d", sTimeBuffer.millitm);
-#else
-    sprintf(szMs, "%d", static_cast<int>(sTimeBuffer.tv_usec / 1000));
-#endif
+    sprintf(szMs, "%d", static_cast<int>(iTime % 1000));
     if (strlen(szMs) == 1)
       strTimeStamp += "00";
     else if (strlen(szMs) == 2)
@@ -188,7 +170,7 @@ string CTimeSpan::GetDateStamp()
   char* szTimeLine = NULL;
   time_t t;
 
-  t = time(NULL);
+  t = (time_t) (CSimpleTimer::GetTime() / 1000);
   szTimeLine = ctime(&t);
 
   // Format is:
@@ -47,6 +47,8 @@ public:
   static string       GetDateStamp();
 
 private:
+  friend class CUserLogReader;
+
   string              m_strName;
   string              m_strStartTime;
   string              m_strEndTime;
@@ -3,6 +3,7 @@
 
 #include "Trainer.h"
 #include "LanguageModelling/PPMPYLanguageModel.h"
+#include "PerfTrace.h"
 #include <vector>
 #include <cstring>
 #include <sstream>
@@ -41,6 +42,8 @@ CTrainer::~CTrainer() {
 }
 
 void CTrainer::Train(CAlphabetMap::SymbolStream &syms) {
+  PERF_TRACE_SPAN("CTrainer::Train");
+  CLanguageModel::CWriter writer(m_pLanguageModel);
   CLanguageModel::Context sContext = m_pLanguageModel->CreateEmptyContext();
 
   for(symbol sym; (sym=syms.next(m_pAlphabet))!=-1;) {
@@ -85,27 +88,47 @@ bool CTrainer::readEscape(CLanguageModel::Context &sContext, symbol sym, CAlphab
 
 class ProgressStream : public CAlphabetMap::SymbolStream {
 public:
-  ProgressStream(std::istream &_in, CTrainer::ProgressIndicator *pProg, CMessageDisplay *pMsgs, off_t iStart=0) : SymbolStream(_in,pMsgs), m_iLastPos(iStart), m_pProg(pProg) {
+  ProgressStream(std::istream &_in, CTrainer::ProgressIndicator *pProg, CMessageDisplay *pMsgs, const CTrainingInput *pInput) : SymbolStream(_in,pMsgs), m_iLastPos(0), m_pProg(pProg), m_pInput(pInput) {
   }
   void bytesRead(off_t num) {
-    if (m_pProg) m_pProg->bytesRead(m_iLastPos += num);
+    //octets read from the symbolstream are only those of the file if it's not compressed
+    if (m_pProg) m_pProg->bytesRead(m_pInput ? m_pInput->BytesConsumed() : m_iLastPos += num);
   }
   off_t m_iLastPos;
 private:
   CTrainer::ProgressIndicator *m_pProg;
+  const CTrainingInput *m_pInput;
 };
 
+bool
+Dasher::CTrainer::ParseFile(const string &strPath, bool bUser) {
+  CTrainingInput *pInput = CTrainingInput::Open(strPath, m_pMsgs);
+  if (!pInput) return false;
+  bool bRes;
+  {
+    std::istream in(pInput);
+    bRes = ParseStream("file://"+strPath, in, pInput);
+  }
+  delete pInput;
+  return bRes;
+}
+
 bool 
 Dasher::CTrainer::Parse(const string &strDesc, istream &in, bool bUser) {
   if (in.fail()) {
     m_pMsgs->FormatMessageWithString(_("Unable to open file \"%s\" for reading"),strDesc.c_str());
     return false;
   }
+  return ParseStream(strDesc, in, NULL);
+}
+
+bool
+Dasher::CTrainer::ParseStream(const string &strDesc, istream &in, const CTrainingInput *pInput) {
   ///easy enough to be re-entrant, so might as well
   string oldDesc=m_strDesc;
   m_strDesc = strDesc;
-  ProgressStream syms(in,m_pProg,m_pMsgs);
+  ProgressStream syms(in,m_pProg,m_pMsgs,pInput);
   Train(syms);
   m_strDesc=oldDesc;
   return true;
-}
\ No newline at end of file
+}
@@ -4,6 +4,7 @@
 #include "LanguageModelling/PPMPYLanguageModel.h"
 #include "Alphabet/AlphInfo.h"
 #include "AbstractXMLParser.h"
+#include "TrainingInput.h"
 
 namespace Dasher {
   class CTrainer : public AbstractParser {
@@ -18,6 +19,11 @@ namespace Dasher {
     
     void SetProgressIndicator(ProgressIndicator *pProg) {m_pProg = pProg;}
 
+    ///Trains on a file, which is memory-mapped (and decompressed, if it is gzip
+    /// or zstd compressed) via a CTrainingInput; progress is reported in octets
+    /// of the file on disk, i.e. comparable to its size. bUser ignored.
+    bool ParseFile(const std::string &strPath, bool bUser);
+
     ///Parses a text file; bUser ignored.
     bool Parse(const std::string &strDesc, std::istream &in, bool bUser);
   
@@ -48,6 +54,9 @@ namespace Dasher {
     // symbol number in alphabet of the context-switch character (maybe 0 if not in alphabet!)
     int m_iCtxEsc;
   private:
+    ///Common implementation of Parse and ParseFile
+    /// \param pInput if non-null, the streambuf underlying 'in', used to measure progress
+    bool ParseStream(const std::string &strDesc, std::istream &in, const CTrainingInput *pInput);
     ProgressIndicator *m_pProg;
     std::string m_strDesc;
   };
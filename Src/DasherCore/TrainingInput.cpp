@@ -0,0 +1,267 @@
+#include "TrainingInput.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
+using namespace Dasher;
+using namespace std;
+
+///Read-only mapping of the whole of a file. Empty files are not mapped at all
+/// (mmap would reject a zero length) but still "succeed", with no data.
+class CTrainingInput::CMapping {
+public:
+  CMapping() : m_pData(NULL), m_iSize(0) {
+#ifdef _WIN32
+    m_hFile = m_hMapping = NULL;
+#else
+    m_iFd = -1;
+#endif
+  }
+
+  bool Map(const string &strPath) {
+#ifdef _WIN32
+    m_hFile = CreateFileA(strPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_hFile == INVALID_HANDLE_VALUE) {
+      m_hFile = NULL;
+      return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_hFile, &size)) return false;
+    m_iSize = static_cast<off_t>(size.QuadPart);
+    if (m_iSize == 0) return true;
+    m_hMapping = CreateFileMapping(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m_hMapping) return false;
+    m_pData = static_cast<const char *>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+    return m_pData != NULL;
+#else
+    if ((m_iFd = open(strPath.c_str(), O_RDONLY)) == -1) return false;
+    struct stat sInfo;
+    if (fstat(m_iFd, &sInfo) || !S_ISREG(sInfo.st_mode)) return false;
+    m_iSize = sInfo.st_size;
+    if (m_iSize == 0) return true;
+    void *pData = mmap(NULL, m_iSize, PROT_READ, MAP_PRIVATE, m_iFd, 0);
+    if (pData == MAP_FAILED) return false;
+    m_pData = static_cast<const char *>(pData);
+#ifdef MADV_SEQUENTIAL
+    //read-ahead aggressively, and free pages once they've been read
+    madvise(pData, m_iSize, MADV_SEQUENTIAL);
+#endif
+    return true;
+#endif
+  }
+
+  ~CMapping() {
+#ifdef _WIN32
+    if (m_pData) UnmapViewOfFile(m_pData);
+    if (m_hMapping) CloseHandle(m_hMapping);
+    if (m_hFile) CloseHandle(m_hFile);
+#else
+    if (m_pData) munmap(const_cast<char *>(m_pData), m_iSize);
+    if (m_iFd != -1) {
+#ifdef POSIX_FADV_DONTNEED
+      //Nothing else is going to read the file before the next alphabet change,
+      // so don't let it push more useful data out of the page cache.
+      posix_fadvise(m_iFd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+      close(m_iFd);
+    }
+#endif
+  }
+
+  const char *m_pData;
+  off_t m_iSize;
+private:
+#ifdef _WIN32
+  HANDLE m_hFile, m_hMapping;
+#else
+  int m_iFd;
+#endif
+};
+
+namespace {
+  ///Uncompressed file: the get area is simply the whole mapping.
+  class CPlainInput : public CTrainingInput {
+  public:
+    CPlainInput(CMapping *pMapping, const string &strPath, CMessageDisplay *pMsgs)
+    : CTrainingInput(pMapping, strPath, pMsgs) {
+      char *pData = const_cast<char *>(Data());
+      setg(pData, pData, pData + Size());
+    }
+    off_t BytesConsumed() const {
+      return gptr() - eback();
+    }
+  };
+
+  ///Output buffer for decompressing inputs: big enough that the per-call
+  /// overhead of the decompressor is negligible, small enough to stay in cache.
+  const size_t DECOMPRESS_BUFSIZE = 1<<16;
+
+#ifdef HAVE_LIBZ
+  ///gzip-compressed file, including files of several concatenated members (as
+  /// produced by e.g. appending to a file with "gzip -c >>").
+  class CGzipInput : public CTrainingInput {
+  public:
+    CGzipInput(CMapping *pMapping, const string &strPath, CMessageDisplay *pMsgs)
+    : CTrainingInput(pMapping, strPath, pMsgs) {
+      memset(&m_stream, 0, sizeof(m_stream));
+      m_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(Data()));
+      //15 = max window size, +16 = expect gzip header (not zlib)
+      m_bDone = (inflateInit2(&m_stream, 15 + 16) != Z_OK);
+      if (m_bDone) Corrupt();
+    }
+    ~CGzipInput() {
+      inflateEnd(&m_stream);
+    }
+    off_t BytesConsumed() const {
+      return reinterpret_cast<const char *>(m_stream.next_in) - Data();
+    }
+  protected:
+    int_type underflow() {
+      if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+      while (!m_bDone) {
+        if (m_stream.avail_in == 0) {
+          //avail_in is only a uInt, so feed very large files in pieces
+          const off_t iRemaining(Size() - BytesConsumed());
+          m_stream.avail_in = static_cast<uInt>(iRemaining < (1<<30) ? iRemaining : (1<<30));
+        }
+        m_stream.next_out = reinterpret_cast<Bytef *>(m_buf);
+        m_stream.avail_out = DECOMPRESS_BUFSIZE;
+        const int iRes = inflate(&m_stream, Z_NO_FLUSH);
+        const size_t iProduced = DECOMPRESS_BUFSIZE - m_stream.avail_out;
+        if (iRes == Z_STREAM_END) {
+          //end of a member; more may follow
+          if (BytesConsumed() < Size()) inflateReset(&m_stream);
+          else m_bDone = true;
+        } else if (iRes != Z_OK && (iRes != Z_BUF_ERROR || BytesConsumed() == Size())) {
+          //corrupt data, or (buffer error with no input left) file ends mid-stream
+          m_bDone = true;
+          Corrupt();
+        }
+        if (iProduced) {
+          setg(m_buf, m_buf, m_buf + iProduced);
+          return traits_type::to_int_type(*m_buf);
+        }
+      }
+      return traits_type::eof();
+    }
+  private:
+    z_stream m_stream;
+    bool m_bDone;
+    char m_buf[DECOMPRESS_BUFSIZE];
+  };
+#endif
+
+#ifdef HAVE_LIBZSTD
+  ///zstd-compressed file, possibly of several frames.
+  class CZstdInput : public CTrainingInput {
+  public:
+    CZstdInput(CMapping *pMapping, const string &strPath, CMessageDisplay *pMsgs)
+    : CTrainingInput(pMapping, strPath, pMsgs), m_pStream(ZSTD_createDStream()) {
+      m_in.src = Data();
+      m_in.size = Size();
+      m_in.pos = 0;
+      m_bDone = !m_pStream || ZSTD_isError(ZSTD_initDStream(m_pStream));
+      if (m_bDone) Corrupt();
+    }
+    ~CZstdInput() {
+      if (m_pStream) ZSTD_freeDStream(m_pStream);
+    }
+    off_t BytesConsumed() const {
+      return m_in.pos;
+    }
+  protected:
+    int_type underflow() {
+      if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+      while (!m_bDone) {
+        ZSTD_outBuffer out = {m_buf, DECOMPRESS_BUFSIZE, 0};
+        //returns 0 iff a frame has been completely decoded and flushed
+        const size_t iRes = ZSTD_decompressStream(m_pStream, &out, &m_in);
+        if (ZSTD_isError(iRes)) {
+          m_bDone = true;
+          Corrupt();
+        } else if (m_in.pos == m_in.size && out.pos < out.size) {
+          //decoder has had all the input and flushed all it can
+          m_bDone = true;
+          if (iRes) Corrupt(); //file ends mid-frame
+        }
+        if (out.pos) {
+          setg(m_buf, m_buf, m_buf + out.pos);
+          return traits_type::to_int_type(*m_buf);
+        }
+      }
+      return traits_type::eof();
+    }
+  private:
+    ZSTD_DStream * const m_pStream;
+    ZSTD_inBuffer m_in;
+    bool m_bDone;
+    char m_buf[DECOMPRESS_BUFSIZE];
+  };
+#endif
+}
+
+const char * const CTrainingInput::SUFFIXES[] = {"", ".gz", ".zst", NULL};
+
+CTrainingInput *CTrainingInput::Open(const string &strPath, CMessageDisplay *pMsgs) {
+  CMapping *pMapping = new CMapping();
+  if (!pMapping->Map(strPath)) {
+    delete pMapping;
+    if (pMsgs) pMsgs->FormatMessageWithString(_("Unable to open file \"%s\" for reading"), strPath.c_str());
+    return NULL;
+  }
+  const unsigned char *pMagic = reinterpret_cast<const unsigned char *>(pMapping->m_pData);
+  const char *szFormat = NULL;
+  if (pMapping->m_iSize >= 2 && pMagic[0] == 0x1f && pMagic[1] == 0x8b) {
+#ifdef HAVE_LIBZ
+    return new CGzipInput(pMapping, strPath, pMsgs);
+#endif
+    szFormat = "gzip";
+  } else if (pMapping->m_iSize >= 4 && pMagic[0] == 0x28 && pMagic[1] == 0xb5 && pMagic[2] == 0x2f && pMagic[3] == 0xfd) {
+#ifdef HAVE_LIBZSTD
+    return new CZstdInput(pMapping, strPath, pMsgs);
+#endif
+    szFormat = "zstd";
+  } else {
+    return new CPlainInput(pMapping, strPath, pMsgs);
+  }
+  delete pMapping;
+  if (pMsgs) pMsgs->FormatMessageWith2Strings(_("File \"%s\" is %s-compressed, which this version of Dasher cannot read"), strPath.c_str(), szFormat);
+  return NULL;
+}
+
+CTrainingInput::CTrainingInput(CMapping *pMapping, const string &strPath, CMessageDisplay *pMsgs)
+: m_pMapping(pMapping), m_strPath(strPath), m_pMsgs(pMsgs), m_bReported(false) {
+}
+
+CTrainingInput::~CTrainingInput() {
+  delete m_pMapping;
+}
+
+void CTrainingInput::Corrupt() {
+  if (m_bReported || !m_pMsgs) return;
+  m_bReported = true;
+  m_pMsgs->FormatMessageWithString(_("File \"%s\" is truncated or corrupt; Dasher will only learn from the part before the error"), m_strPath.c_str());
+}
+
+const char *CTrainingInput::Data() const {
+  return m_pMapping->m_pData;
+}
+
+off_t CTrainingInput::Size() const {
+  return m_pMapping->m_iSize;
+}
@@ -0,0 +1,69 @@
+#ifndef __TrainingInput_h__
+#define __TrainingInput_h__
+
+#include "../Common/Common.h"
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "Messages.h"
+
+#include <streambuf>
+#include <string>
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+namespace Dasher {
+  class CTrainingInput;
+}
+
+/// \ingroup LM
+/// \{
+
+/// Source of training text, for use as the streambuf of the istream passed
+/// to CTrainer. Plain files are memory-mapped and read in place, rather than
+/// being copied through an ifstream's buffer; gzip- and zstd-compressed files
+/// are decompressed out of the mapping as the text is consumed. Compression is
+/// recognised by the file's magic number (neither can begin a valid UTF-8 text
+/// file), not its name. Whichever the format, the kernel is told the mapping
+/// will be read once sequentially, and the file's pages are dropped from the
+/// page cache when the input is deleted, as training data is only read once.
+class Dasher::CTrainingInput : public std::streambuf {
+public:
+  ///Open and map the specified file.
+  /// \param pMsgs used to report files which cannot be opened, are compressed
+  /// in a format this build does not support, or turn out to be truncated or corrupt.
+  /// \return new input positioned at the beginning of the (uncompressed) text,
+  /// or NULL if the file could not be read.
+  static CTrainingInput *Open(const std::string &strPath, CMessageDisplay *pMsgs);
+
+  virtual ~CTrainingInput();
+
+  ///Number of octets of the file itself (i.e. before decompression, if the
+  /// file is compressed) consumed so far; reaches the file size when all the
+  /// text has been read. Comparable to a file size, so suitable for progress.
+  virtual off_t BytesConsumed() const = 0;
+
+  ///Suffixes of compressed versions of a training file that can be read (NULL-terminated,
+  /// beginning with ""), which should be scanned for as well as the file itself - so a
+  /// distribution may ship e.g. training_english_GB.txt.gz while the user's file remains plain.
+  static const char * const SUFFIXES[];
+
+  class CMapping;
+protected:
+  ///Takes ownership of the mapping
+  CTrainingInput(CMapping *pMapping, const std::string &strPath, CMessageDisplay *pMsgs);
+  ///Call on discovering the file is truncated or corrupt; tells the user (once).
+  void Corrupt();
+  const char *Data() const;
+  off_t Size() const;
+private:
+  CMapping * const m_pMapping;
+  const std::string m_strPath;
+  CMessageDisplay * const m_pMsgs;
+  bool m_bReported;
+};
+/// \}
+
+#endif
@@ -4,6 +4,8 @@
 #include "StartHandler.h"
 #include "SettingsStore.h"
 
+#include <limits>
+
 namespace Dasher {
 /// \ingroup Start
 /// @{
@@ -14,6 +16,9 @@ public:
   virtual bool DecorateView(CDasherView *pView);
   virtual void Timer(unsigned long iTime, dasherint iX, dasherint iY, CDasherView *pView);
   virtual void onPause();
+  ///Always true, as CCircleStartHandler: only pointer devices request frames
+  /// when they move, so we must poll for the user entering a box.
+  virtual bool NeedsFrames() {return true;}
 
  private:
   ///Box currently being displayed, _iff_ BP_DASHER_PAUSED is set
@@ -50,6 +50,8 @@ public:
   void                GetMouseGridLocation(int iGridSize, int* pRow, int* pCol);
 
 private:
+  friend class CUserLogReader;
+
   string              m_strTime;
   int                 m_iLocationX;
   int                 m_iLocationY;
@@ -1,6 +1,8 @@
 #include "../Common/Common.h"
 
 #include "UserLog.h"
+#include "UserLogReader.h"
+#include "MemoryReport.h"
 #include <fstream>
 #include <cstring>
 
@@ -45,9 +47,17 @@ static UserLogParamMask s_UserLogParamMaskTable [] = {
   {-1, -1}  // Flag value that should always be at the end
 };
 
+///The parameters in s_UserLogParamMaskTable, i.e. those we listen to
+static std::vector<int> UserLogParams() {
+  std::vector<int> vParams;
+  for (int i=0; s_UserLogParamMaskTable[i].key != -1; i++)
+    vParams.push_back(s_UserLogParamMaskTable[i].key);
+  return vParams;
+}
+
 CUserLog::CUserLog(CSettingsUser *pCreateFrom,
                    Observable<const CEditEvent *> *pObsv, int iLogTypeMask)
-: CUserLogBase(pObsv), CSettingsUserObserver(pCreateFrom) {
+: CUserLogBase(pObsv), CSettingsUserObserver(pCreateFrom, UserLogParams()) {
   //CFunctionLogger f1("CUserLog::CUserLog", g_pLogger);
 
   InitMemberVars();
@@ -78,6 +88,13 @@ CUserLog::~CUserLog()
   if ((m_bSimple) && (m_pSimpleLogger != NULL))
     m_pSimpleLogger->Log("stop", logDEBUG);
 
+  // Writes out any events still buffered
+  if (m_pStream != NULL)
+  {
+    delete m_pStream;
+    m_pStream = NULL;
+  }
+
   if (m_pApplicationSpan != NULL)
   {
     delete m_pApplicationSpan;
@@ -158,7 +175,14 @@ void CUserLog::OutputFile()
 {
   //CFunctionLogger f1("CUserLog::OutputFile", g_pLogger);
 
-  if (m_bDetailed)
+  if (m_pStream != NULL)
+  {
+    // The XML is produced from the stream by ExportXML(), when wanted
+    m_pStream->Begin(CUserLogStream::recOutputFile);
+    m_pStream->End();
+    m_pStream->Flush();
+  }
+  else if (m_bDetailed)
   {
     // Let the last pTrial object know we are done with it, this lets it do
     // any final calculations.
@@ -199,7 +223,12 @@ void CUserLog::StartWriting()
     ResetCycle();
   }
 
-  if (m_bDetailed)
+  if (m_pStream != NULL)
+  {
+    m_pStream->Begin(CUserLogStream::recStartWriting);
+    m_pStream->End();
+  }
+  else if (m_bDetailed)
   {
     CUserLogTrial* pTrial = GetCurrentTrial();
 
@@ -243,7 +272,15 @@ void CUserLog::StopWriting()
     if ((m_bSimple) && (m_pSimpleLogger != NULL))
       m_pSimpleLogger->Log("%s", logDEBUG, GetStartStopCycleStats().c_str());
 
-    if (m_bDetailed)
+    if (m_pStream != NULL)
+    {
+      // The trial records the current trial info each time navigation stops
+      m_pStream->Begin(CUserLogStream::recStopWriting);
+      m_pStream->PutDouble(m_dCycleNats);
+      m_pStream->PutString(CUserLogTrial::ReadUserTrialInfo(m_strCurrentTrialFilename));
+      m_pStream->End();
+    }
+    else if (m_bDetailed)
     {
       CUserLogTrial* pTrial = GetCurrentTrial();
 
@@ -282,7 +319,20 @@ void CUserLog::AddSymbols(Dasher::VECTOR_SYMBOL_PROB* vpNewSymbols, eUserLogEven
     m_vCycleHistory.insert(m_vCycleHistory.end(), vpNewSymbols->begin(), vpNewSymbols->end());
   }
 
-  if (m_bDetailed)
+  if (m_pStream != NULL)
+  {
+    m_pStream->Begin(CUserLogStream::recAddSymbols);
+    m_pStream->PutInt(iEvent);
+    m_pStream->PutInt(vpNewSymbols->size());
+    for (unsigned int i = 0; i < vpNewSymbols->size(); i++)
+    {
+      m_pStream->PutInt((*vpNewSymbols)[i].sym);
+      m_pStream->PutString((*vpNewSymbols)[i].strDisplay);
+      m_pStream->PutDouble((*vpNewSymbols)[i].prob);
+    }
+    m_pStream->End();
+  }
+  else if (m_bDetailed)
   {
     CUserLogTrial* pTrial = GetCurrentTrial();
 
@@ -322,7 +372,14 @@ void CUserLog::DeleteSymbols(int iNumToDelete, eUserLogEventType iEvent)
       m_vCycleHistory.pop_back();
   }   
 
-  if (m_bDetailed)
+  if (m_pStream != NULL)
+  {
+    m_pStream->Begin(CUserLogStream::recDeleteSymbols);
+    m_pStream->PutInt(iNumToDelete);
+    m_pStream->PutInt(iEvent);
+    m_pStream->End();
+  }
+  else if (m_bDetailed)
   {
     CUserLogTrial* pTrial = GetCurrentTrial();
 
@@ -351,10 +408,18 @@ void CUserLog::NewTrial()
   // For safety we can dump the XML to file after each pTrial is done.  This
   // might be a good idea for long user pTrial sessions just in case Dasher
   // were to do something completely crazy like crash.
-  if (USER_LOG_DUMP_AFTER_TRIAL)
+  // (If streaming, the events so far are made safe instead.)
+  if (m_pStream != NULL)
+    m_pStream->Flush();
+  else if ((USER_LOG_DUMP_AFTER_TRIAL) && (!m_bReplaying))
     WriteXML();
 
-  if (m_bDetailed)
+  if (m_pStream != NULL)
+  {
+    m_pStream->Begin(CUserLogStream::recNewTrial);
+    m_pStream->End();
+  }
+  else if (m_bDetailed)
   {
     CUserLogTrial* pTrial = GetCurrentTrial();
 
@@ -394,6 +459,15 @@ void CUserLog::AddParam(const string& strName, const string& strValue, int iOpti
 {
   //CFunctionLogger f1("CUserLog::AddParam", g_pLogger);
 
+  if (m_pStream != NULL)
+  {
+    m_pStream->Begin(CUserLogStream::recParam);
+    m_pStream->PutString(strName);
+    m_pStream->PutString(strValue);
+    m_pStream->PutInt(iOptionMask);
+    m_pStream->End();
+  }
+
   bool bOutputToSimple    = false;
   bool bTrackMultiple     = false;
   bool bTrackInTrial      = false;
@@ -481,7 +555,18 @@ void CUserLog::AddMouseLocation(int iX, int iY, float dNats)
   // Check to see if it is time to actually push a mouse location update
   if (UpdateMouseLocation())
   {
-    if (m_bDetailed)
+    if (m_pStream != NULL)
+    {
+      // Only record mouse locations during navigation
+      if (m_bIsWriting)
+      {
+        m_pStream->Begin(CUserLogStream::recMouse);
+        m_pStream->PutMouse(iX, iY);
+        m_pStream->PutDouble(dNats);
+        m_pStream->End();
+      }
+    }
+    else if (m_bDetailed)
     {
       CUserLogTrial* pTrial = GetCurrentTrial();
 
@@ -512,7 +597,16 @@ void CUserLog::AddWindowSize(int iTop, int iLeft, int iBottom, int iRight)
   m_sWindowCoordinates.bottom  = iBottom;
   m_sWindowCoordinates.right   = iRight;
 
-  if (m_bDetailed)
+  if (m_pStream != NULL)
+  {
+    m_pStream->Begin(CUserLogStream::recWindowSize);
+    m_pStream->PutInt(iTop);
+    m_pStream->PutInt(iLeft);
+    m_pStream->PutInt(iBottom);
+    m_pStream->PutInt(iRight);
+    m_pStream->End();
+  }
+  else if (m_bDetailed)
   {
     CUserLogTrial* pTrial = GetCurrentTrial();
 
@@ -548,7 +642,16 @@ void CUserLog::AddCanvasSize(int iTop, int iLeft, int iBottom, int iRight)
   m_sCanvasCoordinates.bottom  = iBottom;
   m_sCanvasCoordinates.right   = iRight;
 
-  if (m_bDetailed)
+  if (m_pStream != NULL)
+  {
+    m_pStream->Begin(CUserLogStream::recCanvasSize);
+    m_pStream->PutInt(iTop);
+    m_pStream->PutInt(iLeft);
+    m_pStream->PutInt(iBottom);
+    m_pStream->PutInt(iRight);
+    m_pStream->End();
+  }
+  else if (m_bDetailed)
   {
     CUserLogTrial* pTrial = GetCurrentTrial();
 
@@ -583,7 +686,19 @@ void CUserLog::AddMouseLocationNormalized(int iX, int iY, bool bStoreIntegerRep,
 
     ComputeSimpleMousePos(iX, iY);
 
-    if (m_bDetailed)
+    if (m_pStream != NULL)
+    {
+      // Only record mouse locations during navigation
+      if (m_bIsWriting)
+      {
+        m_pStream->Begin(CUserLogStream::recMouseNormalized);
+        m_pStream->PutMouse(iX, iY);
+        m_pStream->PutInt(bStoreIntegerRep);
+        m_pStream->PutDouble(dNats);
+        m_pStream->End();
+      }
+    }
+    else if (m_bDetailed)
     {
       CUserLogTrial* pTrial = GetCurrentTrial();
 
@@ -653,6 +768,9 @@ void CUserLog::SetOuputFilename(const string& strFilename)
   // Make sure we store a fully qualified form, to prevent movent
   // if the working directory changes
   m_strFilename = CFileLogger::GetFullFilenamePath(m_strFilename);
+
+  if ((m_bDetailed) && (USER_LOG_STREAMING) && (!m_bReplaying))
+    OpenStream();
 }
 
 // Find out what level mask this object was created with
@@ -664,11 +782,29 @@ int CUserLog::GetLogLevelMask()
 }
 
 void CUserLog::KeyDown(int iId, int iType, int iEffect) {
+  if (m_pStream != NULL) {
+    m_pStream->Begin(CUserLogStream::recKeyDown);
+    m_pStream->PutInt(iId);
+    m_pStream->PutInt(iType);
+    m_pStream->PutInt(iEffect);
+    m_pStream->End();
+    return;
+  }
+
   CUserLogTrial* pTrial = GetCurrentTrial();
   
   if(pTrial)
     pTrial->AddKeyDown(iId, iType, iEffect);
 }
+
+void CUserLog::ReportMemory(CMemoryReport &report) const {
+  CUserLogBase::ReportMemory(report);
+  for (VECTOR_USER_LOG_TRIAL_PTR::const_iterator it = m_vpTrials.begin(); it != m_vpTrials.end(); ++it)
+    (*it)->ReportMemory(report);
+  report.Add("userlog/params", m_vParams.size(), m_vParams.size() * sizeof(CUserLogParam));
+  report.Add("userlog/cycle-history", m_vCycleHistory.size(), m_vCycleHistory.capacity() * sizeof(Dasher::SymbolProb));
+  if (m_pStream) m_pStream->ReportMemory(report);
+}
   
 // This gets called whenever parameters get changed that we are tracking
 void CUserLog::HandleEvent(int iParameter)
@@ -709,6 +845,8 @@ void CUserLog::InitMemberVars()
   m_bIsWriting            = false;
   m_bInitIsDone           = false;
   m_bNeedToWriteCanvas    = false;
+  m_pStream               = NULL;
+  m_bReplaying            = false;
 
   m_pCycleTimer           = NULL;
   m_iCycleNumDeletes      = 0;
@@ -821,22 +959,8 @@ bool CUserLog::UpdateMouseLocation()
 {
   //CFunctionLogger f1("CUserLog::UpdateMouseLocation", g_pLogger);
 
-#ifdef _WIN32
-  struct timeb sTimeBuffer;
-#else
-  struct timeval sTimeBuffer;
-  struct timezone sTimezoneBuffer;
-#endif
-
-#ifdef _WIN32
-  ftime(&sTimeBuffer);
-  double dTime = (sTimeBuffer.time * 1000.0) + sTimeBuffer.millitm;
-#else
-  gettimeofday(&sTimeBuffer, &sTimezoneBuffer);
-  double dTime = (sTimeBuffer.tv_sec * 1000.0) + (int)(sTimeBuffer.tv_usec / 1000);
-#endif
+  double dTime = (double) CSimpleTimer::GetTime();
 
-  
   if ((dTime - m_dLastMouseUpdate) > LOG_MOUSE_EVERY_MS)
   {
     m_dLastMouseUpdate = dTime;
@@ -1065,6 +1189,45 @@ string CUserLog::GetVersionInfo()
   return strResult;
 }
 
+// Opens the stream for the detailed log, alongside where the XML would go
+void CUserLog::OpenStream()
+{
+  //CFunctionLogger f1("CUserLog::OpenStream", g_pLogger);
+
+  string strStreamFilename = m_strFilename;
+  if ((strStreamFilename.length() > 4) &&
+    (strStreamFilename.compare(strStreamFilename.length() - 4, 4, ".xml") == 0))
+    strStreamFilename.erase(strStreamFilename.length() - 4);
+  strStreamFilename += USER_LOG_STREAM_EXTENSION;
+
+  if (m_pStream != NULL)
+    delete m_pStream;
+
+  m_pStream = new CUserLogStream(strStreamFilename);
+  if (!m_pStream->IsOpen())
+  {
+    // Fall back to keeping the log in memory
+    delete m_pStream;
+    m_pStream = NULL;
+    return;
+  }
+
+  // If we were already logging, the new file needs the parameters so far
+  for (unsigned int i = 0; i < m_vParams.size(); i++)
+  {
+    CUserLogParam* pParam = (CUserLogParam*) m_vParams[i];
+
+    if (pParam != NULL)
+    {
+      m_pStream->Begin(CUserLogStream::recParam);
+      m_pStream->PutString(pParam->strName);
+      m_pStream->PutString(pParam->strValue);
+      m_pStream->PutInt(pParam->options);
+      m_pStream->End();
+    }
+  }
+}
+
 // Forces all the parameters we are tracking to be intially set, used when the
 // object is first starting up.
 void CUserLog::AddInitialParam()
@@ -1128,32 +1291,170 @@ CUserLog::CUserLog(string strXMLFilename)
 : CUserLogBase(NULL), CSettingsUserObserver(NULL) {
   //CFunctionLogger f1("CUserLog::CUserLog(XML)", g_pLogger);
 
+  LoadXML(strXMLFilename, NULL);
+}
+
+// Load the object from an XML file, except that each trial is passed to
+// the handler as soon as it is read (and then deleted), rather than being
+// kept; so logs of any length can be analysed a trial at a time.
+CUserLog::CUserLog(const string& strXMLFilename, Observer<CUserLogTrial*>* pTrialHandler)
+: CUserLogBase(NULL), CSettingsUserObserver(NULL) {
+  //CFunctionLogger f1("CUserLog::CUserLog(XML, handler)", g_pLogger);
+
+  LoadXML(strXMLFilename, pTrialHandler);
+}
+
+void CUserLog::LoadXML(const string& strXMLFilename, Observer<CUserLogTrial*>* pTrialHandler)
+{
   InitMemberVars();
 
   // We are representing detailed logging when we create from XML
   m_bDetailed = true;
 
-  VECTOR_STRING vectorTrials;
+  CUserLogReader reader(this, pTrialHandler);
+  if (!reader.Read(strXMLFilename))
+    g_pLogger->Log("CUserLog::LoadXML, failed to read all of %s", logNORMAL, strXMLFilename.c_str());
+}
+
+// Constructs an object to replay a stream into, as if it had been created
+// at the given time; the stream's events are then passed to the same methods
+// that recorded them.
+CUserLog::CUserLog(long long iStartTime)
+: CUserLogBase(NULL), CSettingsUserObserver(NULL) {
+  //CFunctionLogger f1("CUserLog::CUserLog(stream)", g_pLogger);
+
+  InitMemberVars();
+
+  m_bDetailed                 = true;
+  m_bReplaying                = true;
+  // Replaces the info that was read from the file at the time
+  m_strCurrentTrialFilename   = "";
+
+  CSimpleTimer::SetFixedTime(iStartTime);
+  m_pApplicationSpan = new CTimeSpan("Application", true);
+}
 
-  // First split up various parts of the XML
-  string strXML           = XMLUtil::LoadFile(strXMLFilename);        
-  string strApp           = XMLUtil::GetElementString("Application", strXML, true);    
-  string strParams        = XMLUtil::GetElementString("Params", strXML, true);           
-  string strTrials        = XMLUtil::GetElementString("Trials", strXML, true);
-  vectorTrials            = XMLUtil::GetElementStrings("Trial", strTrials, true);
+// Writes the XML a detailed log would have had, from the events streamed
+// to the specified file (which may have been cut short by a crash).
+bool CUserLog::ExportXML(const string& strStreamFilename, const string& strXMLFilename)
+{
+  //CFunctionLogger f1("CUserLog::ExportXML", g_pLogger);
 
-  m_pApplicationSpan      = new CTimeSpan("Application", strApp);
-  m_vParams               = CUserLogTrial::ParseParamsXML(strParams);
+  CUserLogStreamReader reader(strStreamFilename);
+  if (!reader.IsOpen())
+  {
+    g_pLogger->Log("CUserLog::ExportXML, failed to read %s", logNORMAL, strStreamFilename.c_str());
+    return false;
+  }
 
-  // Now construct each of the Trial objects based on its section of XML
-  for (VECTOR_STRING_ITER iter = vectorTrials.begin(); iter < vectorTrials.end(); iter++)
+  bool bOutput = false;
   {
-    CUserLogTrial* pTrial = new CUserLogTrial(*iter, 0);
+    CUserLog objUserLog(reader.GetStartTime());
+    objUserLog.m_strFilename = strXMLFilename;
 
-    if (pTrial != NULL)
-      m_vpTrials.push_back(pTrial);
+    int iType;
+    long long iTime;
+    while (reader.Next(iType, iTime))
+    {
+      // Everything (time spans, timestamps, mouse updates) sees the time of the original event
+      CSimpleTimer::SetFixedTime(iTime);
+
+      switch (iType)
+      {
+      case CUserLogStream::recParam:
+        {
+          string strName  = reader.GetString();
+          string strValue = reader.GetString();
+          objUserLog.AddParam(strName, strValue, (int) reader.GetInt());
+          break;
+        }
+      case CUserLogStream::recStartWriting:
+        objUserLog.StartWriting();
+        break;
+      case CUserLogStream::recStopWriting:
+        {
+          objUserLog.m_dCycleNats = reader.GetDouble();
+          string strInfo          = reader.GetString();
+          objUserLog.StopWriting();
+          CUserLogTrial* pTrial = objUserLog.GetCurrentTrial();
+          if (pTrial != NULL)
+            pTrial->SetUserTrialInfo(strInfo);
+          break;
+        }
+      case CUserLogStream::recAddSymbols:
+        {
+          eUserLogEventType iEvent = (eUserLogEventType) reader.GetInt();
+          Dasher::VECTOR_SYMBOL_PROB vSymbols;
+          for (long long i = reader.GetInt(); i > 0; i--)
+          {
+            Dasher::symbol sym        = (Dasher::symbol) reader.GetInt();
+            string         strDisplay = reader.GetString();
+            vSymbols.push_back(Dasher::SymbolProb(sym, strDisplay, reader.GetDouble()));
+          }
+          objUserLog.AddSymbols(&vSymbols, iEvent);
+          break;
+        }
+      case CUserLogStream::recDeleteSymbols:
+        {
+          int iNumToDelete = (int) reader.GetInt();
+          objUserLog.DeleteSymbols(iNumToDelete, (eUserLogEventType) reader.GetInt());
+          break;
+        }
+      case CUserLogStream::recNewTrial:
+        objUserLog.NewTrial();
+        break;
+      case CUserLogStream::recWindowSize:
+      case CUserLogStream::recCanvasSize:
+        {
+          int iTop    = (int) reader.GetInt();
+          int iLeft   = (int) reader.GetInt();
+          int iBottom = (int) reader.GetInt();
+          int iRight  = (int) reader.GetInt();
+          if (iType == CUserLogStream::recWindowSize)
+            objUserLog.AddWindowSize(iTop, iLeft, iBottom, iRight);
+          else
+            objUserLog.AddCanvasSize(iTop, iLeft, iBottom, iRight);
+          break;
+        }
+      case CUserLogStream::recMouse:
+        {
+          int iX, iY;
+          reader.GetMouse(iX, iY);
+          objUserLog.AddMouseLocation(iX, iY, (float) reader.GetDouble());
+          break;
+        }
+      case CUserLogStream::recMouseNormalized:
+        {
+          int iX, iY;
+          reader.GetMouse(iX, iY);
+          bool bStoreIntegerRep = (reader.GetInt() != 0);
+          objUserLog.AddMouseLocationNormalized(iX, iY, bStoreIntegerRep, (float) reader.GetDouble());
+          break;
+        }
+      case CUserLogStream::recKeyDown:
+        {
+          int iId      = (int) reader.GetInt();
+          int iKeyType = (int) reader.GetInt();
+          objUserLog.KeyDown(iId, iKeyType, (int) reader.GetInt());
+          break;
+        }
+      case CUserLogStream::recOutputFile:
+        objUserLog.OutputFile();
+        bOutput = true;
+        break;
+      case CUserLogStream::recDropped:
+        g_pLogger->Log("CUserLog::ExportXML, %d events were dropped from %s", logNORMAL, (int) reader.GetInt(), strStreamFilename.c_str());
+        break;
+      }
+    }
+
+    // Dasher didn't exit normally, so output what we have
+    if (!bOutput)
+      objUserLog.OutputFile();
   }
 
+  CSimpleTimer::SetFixedTime(-1);
+  return true;
 }
 
 // Returns a vector that contains vectors of strings which each 
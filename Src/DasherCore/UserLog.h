@@ -8,6 +8,10 @@
 //      2) Detailed per session log file for use during
 //         user trials.
 //
+// If USER_LOG_STREAMING, the detailed log is not built up in memory, but each
+// event is appended to a binary file (see CUserLogStream) as it happens.
+// ExportXML() then replays the events through a CUserLog to produce the XML.
+//
 // If detailed mode isn't enabled, calls should stop here in this object
 // and not go on to create UserLogTrial objects or anything that isn't
 // strictly needed to do the simple logging.
@@ -31,6 +35,7 @@
 #include "SimpleTimer.h"
 #include "TimeSpan.h"
 #include "UserLogTrial.h"
+#include "UserLogStream.h"
 #include <algorithm>
 #include "UserLogParam.h"
 #include "UserLogBase.h"
@@ -48,6 +53,8 @@ const int LOG_MOUSE_EVERY_MS                = 200;      // How often to log the
 static const string    USER_LOG_SIMPLE_FILENAME         = "dasher_usage.log";      // Filename of the short text log file
 static const string    USER_LOG_DETAILED_PREFIX         = "dasher_";               // Prefix of the detailed XML log files
 static const bool      USER_LOG_DUMP_AFTER_TRIAL        = true;                    // Do we want to dump the XML after each trial is complete?
+static const bool      USER_LOG_STREAMING               = true;                    // Stream detailed logs to a binary file, instead of keeping them in memory? (see CUserLog::ExportXML)
+static const string    USER_LOG_STREAM_EXTENSION        = ".dul";                  // Extension of the streamed files, which replaces .xml
 static const string    USER_LOG_CURRENT_TRIAL_FILENAME  = "CurrentTrial.xml";      // Filename we look for information on what the subject is doing
 
 enum eUserLogLevel
@@ -101,14 +108,19 @@ public:
   void                        SetOuputFilename(const string& strFilename = "");
   int                         GetLogLevelMask();
   void KeyDown(int iId, int iType, int iEffect);
+  void ReportMemory(Dasher::CMemoryReport &report) const;
   void                        HandleEvent(int iParameter);
 
   // Methods used by utility that can post-process the log files:
   CUserLog(string strXMLFilename);
+  CUserLog(const string& strXMLFilename, Observer<CUserLogTrial*>* pTrialHandler);
+  static bool                 ExportXML(const string& strStreamFilename, const string& strXMLFilename);
   VECTOR_VECTOR_STRING        GetTabMouseXY(bool bReturnNormalized);
   VECTOR_VECTOR_DENSITY_GRIDS GetMouseDensity(int iGridSize);
 
 protected:
+  friend class CUserLogReader;
+
   CTimeSpan*                  m_pApplicationSpan;         // How long the application has been up
   string                      m_strFilename;              // Name we output our XML file to
   VECTOR_USER_LOG_TRIAL_PTR   m_vpTrials;                 // Holds object for each trial in this session
@@ -124,6 +136,8 @@ protected:
   bool                        m_bNeedToWriteCanvas;       // Do we need to write new canvas coordinates on the next navigation?
   int                         m_iLevelMask;               // What log level mask we were created with.
   string                      m_strCurrentTrialFilename;  // Where info about the current subject's trial is stored
+  CUserLogStream*             m_pStream;                  // Detailed events go here instead of into m_vpTrials, if streaming
+  bool                        m_bReplaying;               // Are we rebuilding the trials from a stream, for ExportXML()?
 
   // Used whenever we need a temporary char* buffer
   static const int            TEMP_BUFFER_SIZE = 4096;
@@ -141,6 +155,9 @@ protected:
   void                        InitMemberVars();
   void                        AddInitialParam();
   void                        UpdateParam(int iParameter, int iOptionMask);
+  void                        OpenStream();
+  void                        LoadXML(const string& strXMLFilename, Observer<CUserLogTrial*>* pTrialHandler);
+  CUserLog(long long iStartTime);
 
   // Things that support simple stats of a single Start/Stop cycle:
   Dasher::VECTOR_SYMBOL_PROB  m_vCycleHistory;          // Tracks just the most recent Start/Stop cycle, used for simple logging
@@ -11,6 +11,7 @@
 #include "Event.h"
 #include "DasherNode.h"
 #include "DasherInterfaceBase.h"
+#include "MemoryReport.h"
 
 using namespace Dasher;
 
@@ -39,3 +40,7 @@ void CUserLogBase::FrameEnded() {
     m_vAdded.clear();
   }
 }
+
+void CUserLogBase::ReportMemory(CMemoryReport &report) const {
+  report.Add("userlog/pending", m_vAdded.size(), m_vAdded.capacity() * sizeof(SymbolProb));
+}
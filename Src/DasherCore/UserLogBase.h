@@ -12,6 +12,7 @@
 
 namespace Dasher {
   class CDasherInterfaceBase;
+  class CMemoryReport;
 }
 
 /// \defgroup Logging Logging routines
@@ -43,6 +44,10 @@ class CUserLogBase : protected TransientObserver<const Dasher::CEditEvent *> {
   virtual void HandleEvent(const Dasher::CEditEvent *pEvent);
   ///Passes record of symbols added/deleted to AddSymbols/DeleteSymbols
   void FrameEnded();
+  ///Adds whatever the log is holding in memory (trials, buffers...) to a
+  /// report, under "userlog/"; subclasses holding more should override, and
+  /// call this for the symbols awaiting FrameEnded.
+  virtual void ReportMemory(Dasher::CMemoryReport &report) const;
 protected:
   virtual void AddSymbols(Dasher::VECTOR_SYMBOL_PROB* pVectorNewSymbolProbs, eUserLogEventType iEvent = userLogEventMouse) = 0;
   virtual void DeleteSymbols(int iNumToDelete, eUserLogEventType iEvent = userLogEventMouse) = 0;  
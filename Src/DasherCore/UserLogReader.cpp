@@ -0,0 +1,369 @@
+// UserLogReader.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "UserLogReader.h"
+#include "UserLog.h"
+
+#include <math.h>
+
+static const string NO_XML = "";
+
+CUserLogReader::CUserLogReader(CUserLog* pUserLog, Observer<CUserLogTrial*>* pTrialHandler)
+: m_pUserLog(pUserLog), m_pTrialHandler(pTrialHandler), m_pTrial(NULL), m_pCycle(NULL),
+  m_pLocation(NULL), m_pPos(NULL), m_pSpan(NULL), m_dProb(0.0) {
+}
+
+// Anything left over is from an incomplete file
+CUserLogReader::~CUserLogReader()
+{
+  delete m_pSpan;
+  delete m_pPos;
+  if (m_pLocation != NULL)
+  {
+    delete m_pLocation->span;
+    delete m_pLocation->pVectorAdded;
+    delete m_pLocation;
+  }
+  if (m_pCycle != NULL)
+  {
+    // Let the trial clean it up
+    if (m_pTrial != NULL)
+      m_pTrial->m_vpNavCycles.push_back(m_pCycle);
+    else
+      delete m_pCycle;
+  }
+  delete m_pTrial;
+}
+
+bool CUserLogReader::Read(const string& strXMLFilename)
+{
+  bool bResult = ParseFile(strXMLFilename);
+
+  // Like the old loader, we always have an application span
+  if (m_pUserLog->m_pApplicationSpan == NULL)
+    m_pUserLog->m_pApplicationSpan = new CTimeSpan("Application", NO_XML);
+
+  return bResult;
+}
+
+// <Application> and the <Time> of a trial (in its summary), nav cycle or location
+bool CUserLogReader::IsSpan(const string& strName, const string& strParent)
+{
+  if (strName == "Application")
+    return (strParent == "UserLog");
+  if (strName == "Time")
+    return ((strParent == "Summary") || (strParent == "Nav") || (strParent == "Location"));
+  return false;
+}
+
+// Parameters are the children of <Params> in the log or a trial
+bool CUserLogReader::IsParam(const string& strParent, const string& strGrandparent)
+{
+  return (strParent == "Params") && ((strGrandparent == "UserLog") || (strGrandparent == "Trial"));
+}
+
+// Elements that may contain anything, as the text is not escaped when written
+bool CUserLogReader::IsRawElement(const string& strName)
+{
+  const string& strParent = GetAncestor(1);
+
+  // Copied verbatim from the current trial file, so may be any XML
+  if (strName == "CurrentTrial")
+    return (strParent == "Trial");
+  // The text written
+  if (strName == "History")
+    return (strParent == "Location");
+  if (strName == "Text")
+    return (strParent == "Add") || (strParent == "Summary");
+  return false;
+}
+
+void CUserLogReader::StartElement(const string& strName)
+{
+  const string& strParent = GetAncestor(1);
+
+  if (IsSpan(strName, strParent))
+  {
+    delete m_pSpan;
+    m_pSpan = new CTimeSpan(strName, NO_XML);
+  }
+  else if (IsParam(strParent, GetAncestor(2)))
+  {
+    m_strValue  = "";
+    m_strTime   = "";
+  }
+  else if ((strName == "Trial") && (strParent == "Trials"))
+  {
+    delete m_pTrial;
+    m_pTrial = new CUserLogTrial(NO_XML);
+    // As if the coordinates were missing, unless we find them
+    m_pTrial->m_sWindowCoordinates.top = m_pTrial->m_sWindowCoordinates.bottom = -1;
+    m_pTrial->m_sWindowCoordinates.left = m_pTrial->m_sWindowCoordinates.right = -1;
+    m_pTrial->m_sCanvasCoordinates = m_pTrial->m_sWindowCoordinates;
+  }
+  else if (m_pTrial == NULL)
+    return;
+  else if ((strName == "Nav") && (strParent == "Navs"))
+  {
+    delete m_pCycle;
+    m_pCycle = new NavCycle();
+    m_pCycle->pSpan = NULL;
+    m_pCycle->dBits = 0.0;
+  }
+  else if (m_pCycle == NULL)
+    return;
+  else if ((strName == "Location") && (strParent == "Locations"))
+  {
+    if (m_pLocation == NULL)
+      m_pLocation = new NavLocation();
+    else
+    {
+      // Left over from an unterminated <Location>
+      delete m_pLocation->span;
+      delete m_pLocation->pVectorAdded;
+    }
+    m_pLocation->strHistory   = "";
+    m_pLocation->span         = NULL;
+    m_pLocation->event        = userLogEventMouse;
+    m_pLocation->numDeleted   = 0;
+    m_pLocation->pVectorAdded = new Dasher::VECTOR_SYMBOL_PROB;
+    m_pLocation->avgBits      = 0.0;
+  }
+  else if ((strName == "Add") && (strParent == "Location"))
+  {
+    m_strText   = "";
+    m_dProb     = 0.0;
+  }
+  else if ((strName == "Pos") && (strParent == "MousePositions"))
+  {
+    delete m_pPos;
+    m_pPos = new CUserLocation(NO_XML);
+    m_bFoundX = m_bFoundY = m_bFoundNormX = m_bFoundNormY = false;
+  }
+}
+
+void CUserLogReader::EndElement(const string& strName, const string& strText)
+{
+  const string& strParent       = GetAncestor(1);
+  const string& strGrandparent  = GetAncestor(2);
+
+  if ((m_pSpan != NULL) && (IsSpan(strParent, strGrandparent)))
+  {
+    if (strName == "Elapsed")
+      m_pSpan->m_dElapsed = (double) XMLUtil::ParseFloat(strText);
+    else if (strName == "Date")
+      m_pSpan->m_strStartDate = strText;
+    else if (strName == "Start")
+      m_pSpan->m_strStartTime = strText;
+    else if (strName == "End")
+      m_pSpan->m_strEndTime = strText;
+    return;
+  }
+
+  if ((m_pSpan != NULL) && (IsSpan(strName, strParent)))
+  {
+    CTimeSpan** ppSpan = NULL;
+    if (strParent == "UserLog")
+      ppSpan = &m_pUserLog->m_pApplicationSpan;
+    else if ((strParent == "Summary") && (m_pTrial != NULL))
+      ppSpan = &m_pTrial->m_pSpan;
+    else if ((strParent == "Nav") && (m_pCycle != NULL))
+      ppSpan = &m_pCycle->pSpan;
+    else if ((strParent == "Location") && (m_pLocation != NULL))
+      ppSpan = &m_pLocation->span;
+
+    if (ppSpan != NULL)
+    {
+      delete *ppSpan;
+      *ppSpan = m_pSpan;
+    }
+    else
+      delete m_pSpan;
+    m_pSpan = NULL;
+    return;
+  }
+
+  // Values of parameters that track when they were set, e.g.
+  //  <MaxBitRate>
+  //    <Value>7.0100</Value>
+  //    <Time>15:48:53.140</Time>
+  //  </MaxBitRate>
+  if (IsParam(strGrandparent, GetAncestor(3)))
+  {
+    if (strName == "Value")
+      m_strValue = strText;
+    else if (strName == "Time")
+      m_strTime = strText;
+    return;
+  }
+
+  if (IsParam(strParent, strGrandparent))
+  {
+    CUserLogParam* pParam = new CUserLogParam();
+    pParam->strName = strName;
+    if ((m_strValue.length() > 0) || (m_strTime.length() > 0))
+    {
+      pParam->strValue      = m_strValue;
+      pParam->strTimeStamp  = m_strTime;
+    }
+    else
+      pParam->strValue      = strText;
+    pParam->options = 0;
+
+    if (strGrandparent == "Trial")
+    {
+      if (m_pTrial != NULL)
+        m_pTrial->m_vpParams.push_back(pParam);
+      else
+        delete pParam;
+    }
+    else
+      m_pUserLog->m_vParams.push_back(pParam);
+    return;
+  }
+
+  if (m_pTrial == NULL)
+    return;
+
+  if ((strName == "Trial") && (strParent == "Trials"))
+  {
+    if (m_pTrial->m_pSpan == NULL)
+      m_pTrial->m_pSpan = new CTimeSpan("Time", NO_XML);
+
+    if (m_pTrialHandler != NULL)
+    {
+      m_pTrialHandler->HandleEvent(m_pTrial);
+      delete m_pTrial;
+    }
+    else
+      m_pUserLog->m_vpTrials.push_back(m_pTrial);
+    m_pTrial = NULL;
+  }
+  else if ((strParent == "WindowCoordinates") || (strParent == "CanvasCoordinates"))
+  {
+    if (strGrandparent != "Trial")
+      return;
+    WindowSize& sSize = (strParent == "WindowCoordinates") ? m_pTrial->m_sWindowCoordinates : m_pTrial->m_sCanvasCoordinates;
+    if (strName == "Top")
+      sSize.top = XMLUtil::ParseInt(strText);
+    else if (strName == "Bottom")
+      sSize.bottom = XMLUtil::ParseInt(strText);
+    else if (strName == "Left")
+      sSize.left = XMLUtil::ParseInt(strText);
+    else if (strName == "Right")
+      sSize.right = XMLUtil::ParseInt(strText);
+  }
+  else if ((strName == "CurrentTrial") && (strParent == "Trial"))
+  {
+    if (strText.length() > 0)
+    {
+      // The tags are part of what we write out again
+      m_pTrial->m_strCurrentTrial   =  "\t\t\t<CurrentTrial>\n";
+      m_pTrial->m_strCurrentTrial   += strText;
+      m_pTrial->m_strCurrentTrial   += "</CurrentTrial>\n";
+    }
+  }
+  else if (m_pCycle == NULL)
+    return;
+  else if ((strName == "Nav") && (strParent == "Navs"))
+  {
+    m_pTrial->m_vpNavCycles.push_back(m_pCycle);
+    m_pCycle = NULL;
+  }
+  else if ((strName == "Location") && (strParent == "Locations") && (m_pLocation != NULL))
+  {
+    if (m_pLocation->span == NULL)
+      m_pLocation->span = new CTimeSpan("Time", NO_XML);
+
+    // If this was a deleted event, then we need to erase some stuff from the running history
+    int iActualNumToDelete = min((int) m_pTrial->m_vHistory.size(), m_pLocation->numDeleted);
+    for (int i = 0; i < iActualNumToDelete; i++)
+      m_pTrial->m_vHistory.pop_back();
+
+    m_pCycle->vectorNavLocations.push_back(m_pLocation);
+    m_pLocation = NULL;
+  }
+  else if ((strParent == "Location") && (m_pLocation != NULL))
+  {
+    if (strName == "History")
+      m_pLocation->strHistory = XMLUtil::StripWhiteSpace(strText);
+    else if (strName == "AvgBits")
+      m_pLocation->avgBits = (double) XMLUtil::ParseFloat(strText);
+    else if (strName == "Event")
+    {
+      bool bFound = false;
+      int iEvent = XMLUtil::ParseInt(strText, &bFound);
+      if (bFound)
+        m_pLocation->event = (eUserLogEventType) iEvent;
+    }
+    else if (strName == "NumDeleted")
+      m_pLocation->numDeleted = max(0, XMLUtil::ParseInt(strText));
+    else if (strName == "Add")
+    {
+      // We don't have the original integer symbol index
+      Dasher::SymbolProb sAdd(0, m_strText, m_dProb);
+      m_pLocation->pVectorAdded->push_back(sAdd);
+
+      // Also track it in one complete vector of all the adds
+      m_pTrial->m_vHistory.push_back(sAdd);
+    }
+  }
+  else if ((strParent == "Add") && (strGrandparent == "Location"))
+  {
+    if (strName == "Text")
+      m_strText = XMLUtil::StripWhiteSpace(strText);
+    else if (strName == "Prob")
+      m_dProb = XMLUtil::ParseFloat(strText);
+  }
+  else if ((strName == "Pos") && (strParent == "MousePositions") && (m_pPos != NULL))
+  {
+    // If there weren't X, Y elements, we want them set to 0 and mark
+    // ourselves as not having them.
+    m_pPos->m_bHasInteger = (m_bFoundX || m_bFoundY);
+    if (!m_pPos->m_bHasInteger)
+      m_pPos->m_iLocationX = m_pPos->m_iLocationY = 0;
+
+    // Require that we find both XNorm and YNorm in order to count
+    m_pPos->m_bHasNormalized = (m_bFoundNormX && m_bFoundNormY);
+    if (!m_pPos->m_bHasNormalized)
+      m_pPos->m_dNormalizedLocationX = m_pPos->m_dNormalizedLocationY = 0.0;
+
+    m_pCycle->vectorMouseLocations.push_back(m_pPos);
+    m_pPos = NULL;
+  }
+  else if ((strGrandparent == "MousePositions") && (strParent == "Pos") && (m_pPos != NULL))
+  {
+    if (strName == "Time")
+      m_pPos->m_strTime = strText;
+    else if (strName == "X")
+      m_pPos->m_iLocationX = XMLUtil::ParseInt(strText, &m_bFoundX);
+    else if (strName == "Y")
+      m_pPos->m_iLocationY = XMLUtil::ParseInt(strText, &m_bFoundY);
+    else if (strName == "XNorm")
+      m_pPos->m_dNormalizedLocationX = XMLUtil::ParseFloat(strText, &m_bFoundNormX);
+    else if (strName == "YNorm")
+      m_pPos->m_dNormalizedLocationY = XMLUtil::ParseFloat(strText, &m_bFoundNormY);
+    else if (strName == "Bits")
+      // Convert the bits back to dNats
+      m_pPos->m_dNats = (float) ((double) XMLUtil::ParseFloat(strText) * (double) log(2.0));
+  }
+}
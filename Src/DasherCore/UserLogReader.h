@@ -0,0 +1,82 @@
+// UserLogReader.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __UserLogReader_h__
+#define __UserLogReader_h__
+
+#include "XMLUtil.h"
+#include "UserLogTrial.h"
+#include "Observable.h"
+
+class CUserLog;
+
+/// \ingroup Logging
+/// @{
+
+/// Loads the XML written by CUserLog in a single pass (see XMLStreamParser),
+/// building the application span, parameters and trials directly as their
+/// elements are read, rather than searching and copying each element's XML
+/// as CUserLog(string) and friends used to.
+///
+/// Each trial can either be kept (in the CUserLog), or passed to an observer
+/// as soon as it has been read and then deleted; the latter lets the analysis
+/// of many logs (e.g. GetTabMouseXY, GetMouseDensity for each trial) proceed
+/// with only one trial in memory at a time.
+class CUserLogReader : public XMLStreamParser
+{
+public:
+  /// \param pUserLog receives the application span and parameters, and
+  /// (if pTrialHandler is NULL) the trials
+  /// \param pTrialHandler if non-NULL, is given each trial, which is then deleted
+  CUserLogReader(CUserLog* pUserLog, Observer<CUserLogTrial*>* pTrialHandler);
+  ~CUserLogReader();
+
+  bool                        Read(const string& strXMLFilename);
+
+protected:
+  void                        StartElement(const string& strName);
+  void                        EndElement(const string& strName, const string& strText);
+  bool                        IsRawElement(const string& strName);
+
+private:
+  bool                        IsSpan(const string& strName, const string& strParent);
+  bool                        IsParam(const string& strParent, const string& strGrandparent);
+
+  CUserLog*                   m_pUserLog;
+  Observer<CUserLogTrial*>*   m_pTrialHandler;
+
+  // What is being read, NULL if not inside one
+  CUserLogTrial*              m_pTrial;
+  NavCycle*                   m_pCycle;
+  NavLocation*                m_pLocation;
+  CUserLocation*              m_pPos;
+  CTimeSpan*                  m_pSpan;
+
+  // Fields of the <Add> or parameter being read
+  string                      m_strText;
+  float                       m_dProb;
+  string                      m_strValue;
+  string                      m_strTime;
+  // Which fields of the <Pos> being read were found
+  bool                        m_bFoundX, m_bFoundY, m_bFoundNormX, m_bFoundNormY;
+};
+/// @}
+
+#endif
@@ -0,0 +1,283 @@
+// UserLogStream.cpp
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "../Common/Common.h"
+
+#include "UserLogStream.h"
+#include "SimpleTimer.h"
+#include "FileLogger.h"
+#include "PerfTrace.h"
+#include "MemoryReport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+extern CFileLogger* g_pLogger;
+
+const char CUserLogStream::MAGIC[4] = {'D', 'U', 'L', '1'};
+const size_t CUserLogStream::WRITE_SIZE;
+const size_t CUserLogStream::MAX_BUFFERED;
+const int CUserLogStream::MAX_LATENCY_MS;
+
+namespace {
+  void AppendVarint(string &str, unsigned long long iValue) {
+    while (iValue >= 0x80) {
+      str += static_cast<char>((iValue & 0x7F) | 0x80);
+      iValue >>= 7;
+    }
+    str += static_cast<char>(iValue);
+  }
+
+  unsigned long long ZigZag(long long iValue) {
+    return (static_cast<unsigned long long>(iValue) << 1) ^ static_cast<unsigned long long>(iValue >> 63);
+  }
+
+  void AppendFixed64(string &str, unsigned long long iValue) {
+    for (int i = 0; i < 8; i++, iValue >>= 8)
+      str += static_cast<char>(iValue & 0xFF);
+  }
+
+  unsigned long long ReadFixed64(const char *p) {
+    unsigned long long iValue = 0;
+    for (int i = 7; i >= 0; i--)
+      iValue = (iValue << 8) | static_cast<unsigned char>(p[i]);
+    return iValue;
+  }
+}
+
+CUserLogStream::CUserLogStream(const string& strFilename)
+: m_pFile(NULL), m_iLastTime(CSimpleTimer::GetTime()), m_iLastX(0), m_iLastY(0),
+  m_iRecordTime(0), m_iRecordX(0), m_iRecordY(0), m_iDropped(0), m_bFlushRequested(false), m_bStop(false) {
+  m_pFile = fopen(strFilename.c_str(), "wb");
+  if (m_pFile == NULL) {
+    g_pLogger->Log("CUserLogStream::CUserLogStream, failed to create %s", logNORMAL, strFilename.c_str());
+    return;
+  }
+  string strHeader(MAGIC, sizeof(MAGIC));
+  AppendFixed64(strHeader, static_cast<unsigned long long>(m_iLastTime));
+  fwrite(strHeader.data(), 1, strHeader.length(), m_pFile);
+  fflush(m_pFile);
+  m_thread = thread(&CUserLogStream::Run, this);
+}
+
+CUserLogStream::~CUserLogStream() {
+  if (m_pFile == NULL) return;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_bStop = true;
+  }
+  m_cond.notify_one();
+  m_thread.join();
+  fclose(m_pFile);
+}
+
+void CUserLogStream::Begin(int iType) {
+  m_strRecord.clear();
+  m_strRecord += static_cast<char>(iType);
+  m_iRecordTime = max(m_iLastTime, CSimpleTimer::GetTime());
+  AppendVarint(m_strRecord, m_iRecordTime - m_iLastTime);
+  m_iRecordX = m_iLastX; m_iRecordY = m_iLastY;
+}
+
+void CUserLogStream::PutInt(long long iValue) {
+  AppendVarint(m_strRecord, ZigZag(iValue));
+}
+
+void CUserLogStream::PutDouble(double dValue) {
+  unsigned long long iBits;
+  memcpy(&iBits, &dValue, sizeof(double));
+  AppendFixed64(m_strRecord, iBits);
+}
+
+void CUserLogStream::PutString(const string& strValue) {
+  AppendVarint(m_strRecord, strValue.length());
+  m_strRecord += strValue;
+}
+
+void CUserLogStream::PutMouse(int iX, int iY) {
+  //consecutive positions are close, so differences take one or two octets
+  PutInt(static_cast<long long>(iX) - m_iLastX);
+  PutInt(static_cast<long long>(iY) - m_iLastY);
+  m_iRecordX = iX; m_iRecordY = iY;
+}
+
+void CUserLogStream::End() {
+  if (m_pFile == NULL) return;
+  //Prefix the record (after its type) with its length, so readers can skip it
+  // (and tell if the last one is incomplete)
+  string strPrefix(1, m_strRecord[0]);
+  AppendVarint(strPrefix, m_strRecord.length() - 1);
+
+  bool bNotify = false;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    string strDropped;
+    if (m_iDropped) {
+      strDropped += static_cast<char>(recDropped);
+      string strBody;
+      AppendVarint(strBody, 0); //no time elapsed
+      AppendVarint(strBody, ZigZag(m_iDropped));
+      AppendVarint(strDropped, strBody.length());
+      strDropped += strBody;
+    }
+    if (m_strPending.length() + strDropped.length() + strPrefix.length() + m_strRecord.length() - 1 > MAX_BUFFERED) {
+      m_iDropped++;
+      return;
+    }
+    if (m_strPending.empty()) m_tOldestPending = chrono::steady_clock::now();
+    m_strPending += strDropped;
+    m_strPending += strPrefix;
+    m_strPending.append(m_strRecord, 1, string::npos);
+    m_iDropped = 0;
+    m_iLastTime = m_iRecordTime;
+    m_iLastX = m_iRecordX; m_iLastY = m_iRecordY;
+    bNotify = m_strPending.length() >= WRITE_SIZE;
+  }
+  if (bNotify) m_cond.notify_one();
+}
+
+void CUserLogStream::Flush() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_bFlushRequested = true;
+  }
+  m_cond.notify_one();
+}
+
+void CUserLogStream::ReportMemory(Dasher::CMemoryReport &report) const {
+  lock_guard<mutex> lock(m_mutex);
+  report.Add("userlog/stream", 1, sizeof(CUserLogStream) + m_strRecord.capacity() + m_strPending.capacity());
+}
+
+void CUserLogStream::Run() {
+  Dasher::CPerfTrace::SetThreadName("user log");
+  string strWriting;
+  bool bFailed = false;
+  unique_lock<mutex> lock(m_mutex);
+  while (true) {
+    if (m_strPending.empty()) {
+      if (m_bStop) break;
+      m_bFlushRequested = false;
+      m_cond.wait(lock);
+      continue;
+    }
+    //wait until the oldest event reaches the latency bound, unless told to write sooner
+    if (!m_bStop && !m_bFlushRequested && m_strPending.length() < WRITE_SIZE
+        && m_cond.wait_until(lock, m_tOldestPending + chrono::milliseconds(MAX_LATENCY_MS)) == cv_status::no_timeout)
+      continue;
+    //swap, rather than copy, so both buffers keep their capacity
+    strWriting.swap(m_strPending);
+    m_strPending.clear();
+    m_bFlushRequested = false;
+    lock.unlock();
+    {
+      PERF_TRACE_SPAN("UserLog write");
+      if (fwrite(strWriting.data(), 1, strWriting.length(), m_pFile) != strWriting.length()
+          || fflush(m_pFile) != 0) {
+        if (!bFailed) g_pLogger->Log("CUserLogStream::Run, failed to write user log", logNORMAL);
+        bFailed = true;
+      }
+    }
+    lock.lock();
+  }
+}
+
+CUserLogStreamReader::CUserLogStreamReader(const string& strFilename)
+: m_bOpen(false), m_iPos(0), m_iEnd(0), m_iStartTime(0), m_iTime(0), m_iLastX(0), m_iLastY(0) {
+  ifstream in(strFilename.c_str(), ios::in | ios::binary);
+  if (!in.is_open()) return;
+  ostringstream ss;
+  ss << in.rdbuf();
+  m_strData = ss.str();
+  const size_t iHeader = sizeof(CUserLogStream::MAGIC) + 8;
+  if (m_strData.length() < iHeader || memcmp(m_strData.data(), CUserLogStream::MAGIC, sizeof(CUserLogStream::MAGIC)))
+    return;
+  m_iTime = m_iStartTime = static_cast<long long>(ReadFixed64(m_strData.data() + sizeof(CUserLogStream::MAGIC)));
+  m_iPos = m_iEnd = iHeader;
+  m_bOpen = true;
+}
+
+bool CUserLogStreamReader::GetVarint(size_t iEnd, unsigned long long &iValue) {
+  iValue = 0;
+  for (int iShift = 0; m_iPos < iEnd && iShift < 64; iShift += 7) {
+    const unsigned char c = static_cast<unsigned char>(m_strData[m_iPos++]);
+    iValue |= static_cast<unsigned long long>(c & 0x7F) << iShift;
+    if (!(c & 0x80)) return true;
+  }
+  return false;
+}
+
+bool CUserLogStreamReader::Next(int &iType, long long &iTime) {
+  if (!m_bOpen) return false;
+  while (true) {
+    m_iPos = m_iEnd; //skip any fields not read
+    if (m_iPos >= m_strData.length()) return false;
+    iType = static_cast<unsigned char>(m_strData[m_iPos++]);
+    unsigned long long iLength, iDelta;
+    if (!GetVarint(m_strData.length(), iLength) || iLength > m_strData.length() - m_iPos) {
+      m_iEnd = m_strData.length();
+      return false;
+    }
+    m_iEnd = m_iPos + iLength;
+    if (!GetVarint(m_iEnd, iDelta)) continue;
+    m_iTime += static_cast<long long>(iDelta);
+    if (iType < CUserLogStream::recParam || iType > CUserLogStream::recDropped) continue;
+    iTime = m_iTime;
+    return true;
+  }
+}
+
+long long CUserLogStreamReader::GetInt() {
+  unsigned long long iValue;
+  if (!GetVarint(m_iEnd, iValue)) return 0;
+  return static_cast<long long>(iValue >> 1) ^ -static_cast<long long>(iValue & 1);
+}
+
+double CUserLogStreamReader::GetDouble() {
+  if (m_iEnd - m_iPos < 8) {
+    m_iPos = m_iEnd;
+    return 0.0;
+  }
+  const unsigned long long iBits = ReadFixed64(m_strData.data() + m_iPos);
+  m_iPos += 8;
+  double dValue;
+  memcpy(&dValue, &iBits, sizeof(double));
+  return dValue;
+}
+
+string CUserLogStreamReader::GetString() {
+  unsigned long long iLength;
+  if (!GetVarint(m_iEnd, iLength) || iLength > m_iEnd - m_iPos) {
+    m_iPos = m_iEnd;
+    return "";
+  }
+  string strValue(m_strData, m_iPos, iLength);
+  m_iPos += iLength;
+  return strValue;
+}
+
+void CUserLogStreamReader::GetMouse(int &iX, int &iY) {
+  m_iLastX = iX = static_cast<int>(m_iLastX + GetInt());
+  m_iLastY = iY = static_cast<int>(m_iLastY + GetInt());
+}
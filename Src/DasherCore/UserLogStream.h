@@ -0,0 +1,168 @@
+// UserLogStream.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// This file is part of Dasher.
+//
+// Dasher is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Dasher is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Dasher; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __UserLogStream_h__
+#define __UserLogStream_h__
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class CUserLogStream;
+class CUserLogStreamReader;
+namespace Dasher {
+  class CMemoryReport;
+}
+
+/// \ingroup Logging
+/// @{
+
+/// Append-only binary file of the events making up a detailed (userLogDetailed)
+/// user log, so that CUserLog need not hold a whole session in memory, nor
+/// rewrite the XML file after every trial. CUserLog::ExportXML replays the events
+/// to produce the XML, exactly as CUserLog would have written it.
+///
+/// Each event is recorded as a type, then the length of the rest, then the time
+/// since the previous event (in ms) and the event's fields (integers as zigzag
+/// varints, mouse positions as differences from the previous one). Recording an
+/// event only appends it to a buffer; a background thread writes the buffer out
+/// when it reaches WRITE_SIZE, or its oldest event is MAX_LATENCY_MS old, or on
+/// Flush(). At most MAX_BUFFERED bytes are held: if the disk cannot keep up, further
+/// events are dropped (and a recDropped event records how many), so the thread
+/// recording events never waits for I/O.
+class CUserLogStream {
+public:
+  ///Event types
+  enum eRecord {
+    recParam = 1,       // name, value, options
+    recStartWriting,
+    recStopWriting,     // nats (under the mouse), text from the current trial file
+    recAddSymbols,      // event type, count, then symbol, display text, probability for each
+    recDeleteSymbols,   // number, event type
+    recNewTrial,
+    recWindowSize,      // top, left, bottom, right
+    recCanvasSize,      // top, left, bottom, right
+    recMouse,           // mouse position, nats
+    recMouseNormalized, // mouse position, store integer representation, nats
+    recKeyDown,         // id, type, effect
+    recOutputFile,      // end of session
+    recDropped          // number of events dropped
+  };
+
+  ///Creates the file (replacing any existing one) and starts the writer thread
+  CUserLogStream(const std::string& strFilename);
+  ///Writes all events recorded, and closes the file
+  ~CUserLogStream();
+
+  bool IsOpen() const {return m_pFile != NULL;}
+
+  /// @name Recording an event
+  /// Call Begin, then Put* for each field, then End.
+  /// @{
+  void Begin(int iType);
+  void PutInt(long long iValue);
+  void PutDouble(double dValue);
+  void PutString(const std::string& strValue);
+  void PutMouse(int iX, int iY);
+  void End();
+  /// @}
+
+  ///Has everything recorded so far written soon (without waiting for it)
+  void Flush();
+
+  ///Adds the buffers of events recorded but not yet written, under "userlog/stream"
+  void ReportMemory(Dasher::CMemoryReport &report) const;
+
+  ///Identifies the file format; followed by the start time (8 bytes)
+  static const char MAGIC[4];
+
+  static const size_t WRITE_SIZE = 16*1024;
+  static const size_t MAX_BUFFERED = 1024*1024;
+  static const int MAX_LATENCY_MS = 1000;
+
+private:
+  ///Body of the background writer thread
+  void Run();
+
+  FILE *m_pFile;
+  ///Event being recorded (so recording does not allocate once it has grown)
+  std::string m_strRecord;
+  ///Time of the previous event, and mouse position of the previous mouse event,
+  /// _kept_ (only End updates these, so the differences of dropped events are not lost)
+  long long m_iLastTime;
+  int m_iLastX, m_iLastY;
+  ///Time and mouse position of the event being recorded
+  long long m_iRecordTime;
+  int m_iRecordX, m_iRecordY;
+
+  ///Guards everything below here, which is shared with the writer thread
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::thread m_thread;
+  ///Events recorded but not yet passed to the writer
+  std::string m_strPending;
+  ///When the oldest event in m_strPending was recorded
+  std::chrono::steady_clock::time_point m_tOldestPending;
+  ///Number of events dropped since the last recDropped event
+  unsigned long m_iDropped;
+  bool m_bFlushRequested, m_bStop;
+};
+
+/// Reads a file written by CUserLogStream
+class CUserLogStreamReader {
+public:
+  CUserLogStreamReader(const std::string& strFilename);
+
+  ///Whether the file was read, and is of the right format
+  bool IsOpen() const {return m_bOpen;}
+  ///Time at which the stream was created (ms since the epoch)
+  long long GetStartTime() const {return m_iStartTime;}
+
+  ///Moves to the next event (skipping any of unknown types).
+  /// \return false at the end of the file, or if the last event is incomplete
+  /// (e.g. if Dasher crashed while writing it).
+  bool Next(int &iType, long long &iTime);
+
+  /// @name Fields of the current event, in the order they were recorded
+  /// (zero or empty if the event has fewer)
+  /// @{
+  long long GetInt();
+  double GetDouble();
+  std::string GetString();
+  void GetMouse(int &iX, int &iY);
+  /// @}
+
+private:
+  bool GetVarint(size_t iEnd, unsigned long long &iValue);
+
+  bool m_bOpen;
+  std::string m_strData;
+  ///Position in m_strData, and end of the current event
+  size_t m_iPos, m_iEnd;
+  long long m_iStartTime, m_iTime;
+  int m_iLastX, m_iLastY;
+};
+
+/// @}
+
+#endif
@@ -2,6 +2,7 @@
 
 #include <cstring>
 #include "UserLogTrial.h"
+#include "MemoryReport.h"
 
 // Track memory leaks on Windows to the line that new'd the memory
 #ifdef _WIN32
@@ -485,29 +486,45 @@ void CUserLogTrial::GetUserTrialInfo()
 {
   //CFunctionLogger f1("CUserLogTrial::GetUserTrialInfo", g_pLogger);
 
-  m_strCurrentTrial = "";
+  m_strCurrentTrial = ReadUserTrialInfo(m_strCurrentTrialFilename);
+}
+
+// Reads what the UserTrial app has told us about the current trial, formatted
+// for inclusion in our XML.
+string CUserLogTrial::ReadUserTrialInfo(const string& strCurrentTrialFilename)
+{
+  string strResult = "";
 
-  if (m_strCurrentTrialFilename.length() > 0)
+  if (strCurrentTrialFilename.length() > 0)
   {
     // We want ios::nocreate, but not available in .NET 2003, arrgh
-    fstream fin(m_strCurrentTrialFilename.c_str(), ios::in);
+    fstream fin(strCurrentTrialFilename.c_str(), ios::in);
 
     // Make sure we successfully opened before we start reading it
     if (fin.is_open())
     {
+      char szBuffer[TEMP_BUFFER_SIZE];
       while (!fin.eof())
       {
-        fin.getline(m_szTempBuffer, TEMP_BUFFER_SIZE);
-        if (strlen(m_szTempBuffer) > 0)
+        fin.getline(szBuffer, TEMP_BUFFER_SIZE);
+        if (strlen(szBuffer) > 0)
         {
-          m_strCurrentTrial += "\t\t\t";
-          m_strCurrentTrial += m_szTempBuffer;
-          m_strCurrentTrial += "\n";
+          strResult += "\t\t\t";
+          strResult += szBuffer;
+          strResult += "\n";
         }
       }
       fin.close();
     }
   }
+
+  return strResult;
+}
+
+// Used when replaying a log, in place of reading the current trial file
+void CUserLogTrial::SetUserTrialInfo(const string& strInfo)
+{
+  m_strCurrentTrial = strInfo;
 }
 
 // Returns the concatenation of all our symbol history using
@@ -884,6 +901,20 @@ double CUserLogTrial::GetTotalBits() {
   return dBits;
 }
 
+void CUserLogTrial::ReportMemory(Dasher::CMemoryReport &report) const {
+  report.Add("userlog/trials", 1, sizeof(CUserLogTrial) + m_strCurrentTrial.capacity() + m_vHistory.capacity() * sizeof(Dasher::SymbolProb));
+  report.Add("userlog/params", m_vpParams.size(), m_vpParams.size() * sizeof(CUserLogParam));
+  for (VECTOR_NAV_CYCLE_PTR::const_iterator it(m_vpNavCycles.begin()); it != m_vpNavCycles.end(); ++it) {
+    const NavCycle *pCycle(*it);
+    report.Add("userlog/cycles", 1, sizeof(NavCycle));
+    for (VECTOR_NAV_LOCATION_PTR::const_iterator it2(pCycle->vectorNavLocations.begin()); it2 != pCycle->vectorNavLocations.end(); ++it2)
+      report.Add("userlog/locations", 1, sizeof(NavLocation) + (*it2)->strHistory.capacity()
+                 + ((*it2)->pVectorAdded ? (*it2)->pVectorAdded->capacity() * sizeof(Dasher::SymbolProb) : 0));
+    report.Add("userlog/mouse", pCycle->vectorMouseLocations.size(), pCycle->vectorMouseLocations.size() * sizeof(CUserLocation));
+    report.Add("userlog/buttons", pCycle->vectorButtons.size(), pCycle->vectorButtons.size() * sizeof(CUserButton));
+  }
+}
+
 // Parameters can optionally be specified to be added to the Trial objects.
 // This allows us to easily see what a certain parameter value was used
 // in a given trial.  
@@ -1130,202 +1161,6 @@ string CUserLogTrial::GetNavCyclesXML(const string& strPrefix)
   return strResult;
 }
 
-// Construct based on some XML, second parameter is just to make signature
-// different from the normal constructor.
-CUserLogTrial::CUserLogTrial(const string& strXML, int iIgnored)
-{
-  //CFunctionLogger f1("CUserLogTrial::CUserLogTrial(XML)", g_pLogger);
-
-  InitMemberVars();
-  VECTOR_STRING vNavs;
-
-  string strParams        = XMLUtil::GetElementString("Params", strXML, true);           
-  string strWindow        = XMLUtil::GetElementString("WindowCoordinates", strXML, true);           
-  string strCanvas        = XMLUtil::GetElementString("CanvasCoordinates", strXML, true);           
-  string strNavs          = XMLUtil::GetElementString("Navs", strXML, true);           
-  string strSummary       = XMLUtil::GetElementString("Summary", strXML, true);
-  string strSummaryTime   = XMLUtil::GetElementString("Time", strSummary, true);
-  vNavs                   = XMLUtil::GetElementStrings("Nav", strNavs, true);
-
-  string strCurrentTrial  = XMLUtil::GetElementString("CurrentTrial", strXML, false);
-  if (strCurrentTrial.length() > 0)
-  {
-    // We copied the XML string directly into the member variable
-    // including the start/end tag, so we need to reproduce the
-    // tags ourselves.
-    m_strCurrentTrial       =  "\t\t\t<CurrentTrial>\n";
-    m_strCurrentTrial       += strCurrentTrial;
-    m_strCurrentTrial       += "</CurrentTrial>\n";
-  }
-
-  m_vpParams                = ParseParamsXML(strParams);
-  m_sWindowCoordinates      = ParseWindowXML(strWindow);
-  m_sCanvasCoordinates      = ParseWindowXML(strCanvas);
-  m_pSpan                   = new CTimeSpan("Time", strSummaryTime);
-
-  // Process each <Nav> tag
-  string strTime              = "";
-  string strLocations         = "";
-  string strMousePositions    = "";
-
-  VECTOR_STRING vLocations;
-  VECTOR_STRING vMousePositions;
-  VECTOR_STRING vAdded;
-
-  for (VECTOR_STRING_ITER iter = vNavs.begin(); iter < vNavs.end(); iter++)
-  {
-    strTime              = "";
-    strLocations         = "";
-    strMousePositions    = "";
-    vLocations.erase(vLocations.begin(), vLocations.end());
-    vMousePositions.erase(vMousePositions.begin(), vMousePositions.end());
-
-    strTime             = XMLUtil::GetElementString("Time", *iter, true);
-    strLocations        = XMLUtil::GetElementString("Locations", *iter, true);
-    strMousePositions   = XMLUtil::GetElementString("MousePositions", *iter, true);
-
-    NavCycle* pCycle = new NavCycle();
-    if (pCycle == NULL)
-    {
-      g_pLogger->Log("CUserLogTrial::CUserLogTrial, failed to create NavCycle!", logNORMAL);
-      return;
-    }
-
-    pCycle->pSpan = NULL;
-
-    if (strTime.length() > 0)
-    {
-      pCycle->pSpan = new CTimeSpan("Time", strTime);
-    }
-    if (strLocations.length() > 0)
-    {
-      vLocations = XMLUtil::GetElementStrings("Location", strLocations, true);
-
-      for (VECTOR_STRING_ITER iter2 = vLocations.begin(); iter2 < vLocations.end(); iter2++)
-      {
-        vAdded.erase(vAdded.begin(), vAdded.end());
-
-        NavLocation* pLocation = new NavLocation();
-        if (pLocation == NULL)
-        {
-          g_pLogger->Log("CUserLogTrial::CUserLogTrial, failed to create NavLocation!", logNORMAL);
-          return;
-        }                
-
-        pLocation->strHistory     = XMLUtil::GetElementString("History", *iter2);
-        pLocation->avgBits        = (double) XMLUtil::GetElementFloat("AvgBits", *iter2);
-        pLocation->event          = (eUserLogEventType) XMLUtil::GetElementInt("Event", *iter2);
-        pLocation->numDeleted     = XMLUtil::GetElementInt("NumDeleted", *iter2);
-
-        pLocation->span           = NULL;
-        string strTime            = XMLUtil::GetElementString("Time", *iter2);
-        pLocation->span           = new CTimeSpan("Time", strTime);
-
-        // Handle the multiple <Add> tags that might exist
-        vAdded                    = XMLUtil::GetElementStrings("Add", *iter2);                
-        pLocation->pVectorAdded   = new Dasher::VECTOR_SYMBOL_PROB;
-
-        for (VECTOR_STRING_ITER iter3 = vAdded.begin(); iter3 < vAdded.end(); iter3++)
-        {
-          Dasher::SymbolProb sAdd(0, // We don't have the original integer symbol index
-                                  XMLUtil::GetElementString("Text", *iter3),
-                                  XMLUtil::GetElementFloat("Prob", *iter3));
-
-          if (pLocation->pVectorAdded != NULL)
-            pLocation->pVectorAdded->push_back(sAdd);
-
-          // Also track it in one complete vector of all the adds
-          m_vHistory.push_back(sAdd);        
-        }
-
-        // If this was a deleted event, then we need to erase some stuff from the running history
-        // Be careful not to pop more things than we have (this will hork the
-        // memory up on linux but not windows).
-        int iActualNumToDelete = min((int) m_vHistory.size(), pLocation->numDeleted);
-        for (int i = 0; i < iActualNumToDelete; i++)
-          m_vHistory.pop_back();
-
-        pCycle->vectorNavLocations.push_back(pLocation);
-      }
-    }
-
-    if (strMousePositions.length() > 0)
-    {
-      vMousePositions = XMLUtil::GetElementStrings("Pos", strMousePositions, true);
-      for (VECTOR_STRING_ITER iter2 = vMousePositions.begin(); iter2 < vMousePositions.end(); iter2++)
-      {
-        CUserLocation* pLocation = new CUserLocation(*iter2);
-        pCycle->vectorMouseLocations.push_back(pLocation);
-      }
-
-    }
-
-    m_vpNavCycles.push_back(pCycle);
-  }
-
-}
-
-// Helper that parses parameters out of the XML block, used by UserLog 
-// and by UserLogTrial to do the same thing.
-VECTOR_USER_LOG_PARAM_PTR CUserLogTrial::ParseParamsXML(const string& strXML)
-{
-  //CFunctionLogger f1("CUserLogTrial::ParseParamsXML", g_pLogger);
-
-  VECTOR_USER_LOG_PARAM_PTR   vResult;
-  VECTOR_NAME_VALUE_PAIR      vParams;
-
-  vParams = XMLUtil::GetNameValuePairs(strXML, true);
-
-  // Handle adding all the name/value parameter pairs.  XML looks like:
-  //      <Eyetracker>0</Eyetracker>
-  //      <MaxBitRate>
-  //	    	<Value>7.0100</Value>
-  //			<Time>15:48:53.140</Time>
-  //  	</MaxBitRate>
-  for (VECTOR_NAME_VALUE_PAIR_ITER iter = vParams.begin(); iter < vParams.end(); iter++)
-  {
-    CUserLogParam* pParam = new CUserLogParam();
-
-    if (pParam != NULL) 
-    {
-      pParam->strName      = iter->strName;
-
-      // See if we have a type that has a timestamp
-      string strValue     = XMLUtil::GetElementString("Value", iter->strValue, true);
-      string strTime      = XMLUtil::GetElementString("Time", iter->strValue, true);
-
-      if ((strValue.length() > 0)  || (strTime.length() > 0))
-      {
-        pParam->strValue     = strValue;
-        pParam->strTimeStamp = strTime;
-      }
-      else
-        pParam->strValue     = iter->strValue;
-
-      pParam->options = 0;
-
-      vResult.push_back(pParam);
-    }
-  }
-
-  return vResult;
-}
-
-// Parse our window or canvas coorindates from XML
-WindowSize CUserLogTrial::ParseWindowXML(const string& strXML)
-{
-  //CFunctionLogger f1("CUserLogTrial::ParseWindowXML", g_pLogger);
-
-  WindowSize sResult;
-
-  sResult.top      = XMLUtil::GetElementInt("Top", strXML);
-  sResult.bottom   = XMLUtil::GetElementInt("Bottom", strXML);
-  sResult.left     = XMLUtil::GetElementInt("Left", strXML);
-  sResult.right    = XMLUtil::GetElementInt("Right", strXML);
-
-  return sResult;
-}
-
 // Returns a vector that contains the tab delimited mouse
 // coordinates for each of our navigation cycles.
 VECTOR_STRING CUserLogTrial::GetTabMouseXY(bool bReturnNormalized)
@@ -20,6 +20,10 @@
 #include <algorithm>
 #include "XMLUtil.h"
 
+namespace Dasher {
+  class CMemoryReport;
+}
+
 // Types used to return two dimensional grid of double values
 typedef double**                                        DENSITY_GRID;
 typedef vector<DENSITY_GRID>                            VECTOR_DENSITY_GRIDS;
@@ -107,19 +111,23 @@ public:
   bool                        IsWriting();
   void                        AddParam(const string& strName, const string& strValue, int iOptionMask = 0);
   static string               GetParamXML(CUserLogParam* pParam, const string& strPrefix = "");
+  static string               ReadUserTrialInfo(const string& strCurrentTrialFilename);
+  void                        SetUserTrialInfo(const string& strInfo);
 
   int GetButtonCount();
   double GetTotalBits();
 
+  ///Adds the trial, its navigation cycles, and the events in them, under "userlog/"
+  void ReportMemory(Dasher::CMemoryReport &report) const;
+
   // Methods used by utility that can post-process the log files:
-  CUserLogTrial(const string& strXML, int iIgnored);
-  static VECTOR_USER_LOG_PARAM_PTR    ParseParamsXML(const string& strXML);
-  static WindowSize                   ParseWindowXML(const string& strXML);
   VECTOR_STRING                       GetTabMouseXY(bool bReturnNormalized);
   VECTOR_DENSITY_GRIDS                GetMouseDensity(int iGridSize);
   static DENSITY_GRID                 MergeGrids(int iGridSize, DENSITY_GRID pGridA, DENSITY_GRID pGridB);
 
 protected:
+  friend class CUserLogReader;
+
   CTimeSpan*                          m_pSpan;
   bool                                m_bWritingStart;
   string                              m_strCurrentTrial;          // Stores information passed to us from the UserTrial app
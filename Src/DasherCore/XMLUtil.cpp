@@ -5,6 +5,10 @@
 
 #include "XMLUtil.h"
 
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -125,8 +129,12 @@ string XMLUtil::GetElementString(const string& strTag, const string& strXML, boo
 // Return the integer representing an element
 int XMLUtil::GetElementInt(const string& strTag, const string& strXML, bool* pFound)
 {
-  string strElement = GetElementString(strTag, strXML);
+  return ParseInt(GetElementString(strTag, strXML), pFound);
+}
 
+// Return the integer represented by the text of an element
+int XMLUtil::ParseInt(const string& strElement, bool* pFound)
+{
   unsigned int i = 0;
   for (i = 0; i < strElement.size(); i++)
   {
@@ -194,8 +202,12 @@ int64 XMLUtil::GetElementLongLong(const string& strTag, const string& strXML, bo
 // Optionally can pass back a bool that tell us if the tag was found
 float XMLUtil::GetElementFloat(const string& strTag, const string& strXML, bool* pFound)
 {
-  string strElement = GetElementString(strTag, strXML);
+  return ParseFloat(GetElementString(strTag, strXML), pFound);
+}
 
+// Return the float represented by the text of an element
+float XMLUtil::ParseFloat(const string& strElement, bool* pFound)
+{
   bool bFoundDot = false;
 
   unsigned int i = 0;
@@ -358,3 +370,217 @@ VECTOR_NAME_VALUE_PAIR XMLUtil::GetNameValuePairs(const string& strXML, bool bSt
 
   return vResult;
 }
+
+const string XMLStreamParser::EMPTY = "";
+
+// Longest tag we accept; a '<' followed by more than this is taken to be text
+static const size_t XML_STREAM_MAX_TAG = 1024;
+
+bool XMLStreamParser::ParseFile(const string& strFilename)
+{
+  ifstream fin(strFilename.c_str(), ios::in | ios::binary);
+  if (!fin.is_open())
+    return false;
+  return Parse(fin);
+}
+
+bool XMLStreamParser::Parse(istream& in)
+{
+  m_vPath.clear();
+  m_vText.clear();
+  m_strTag    = "";
+  m_bInTag    = false;
+  m_bRaw      = false;
+  m_iRawEnd   = string::npos;
+
+  char szBuffer[XML_UTIL_READ_BUFFER_SIZE];
+  while (in.good())
+  {
+    in.read(szBuffer, XML_UTIL_READ_BUFFER_SIZE);
+    const char* pEnd = szBuffer + in.gcount();
+    for (const char* p = szBuffer; p < pEnd;)
+    {
+      // Copy runs of plain text in one go, up to the next character of interest
+      const char* pStop = NULL;
+      if ((m_bRaw) && (m_iRawEnd == string::npos))
+        pStop = (const char*) memchr(p, '>', pEnd - p);
+      else if ((!m_bRaw) && (!m_bInTag))
+        pStop = (const char*) memchr(p, '<', pEnd - p);
+      else
+      {
+        ProcessChar(*p++);
+        continue;
+      }
+      if (pStop == NULL)
+        pStop = pEnd;
+      if (pStop > p)
+      {
+        if ((m_bRaw) || (!m_vText.empty()))
+          m_vText.back().append(p, pStop - p);
+        p = pStop;
+      }
+      if (p < pEnd)
+        ProcessChar(*p++);
+    }
+  }
+  // The end of the file finishes a line too
+  if ((m_bRaw) && (m_iRawEnd != string::npos))
+    EndRaw();
+
+  return in.eof() && m_vPath.empty();
+}
+
+const string& XMLStreamParser::GetAncestor(unsigned int i) const
+{
+  if (i >= m_vPath.size())
+    return EMPTY;
+  return m_vPath[m_vPath.size() - 1 - i];
+}
+
+void XMLStreamParser::AddText(const string& strText)
+{
+  // Text outside the outermost element is ignored
+  if (!m_vText.empty())
+    m_vText.back() += strText;
+}
+
+// Ends the raw element being read, at the end tag found
+void XMLStreamParser::EndRaw()
+{
+  string& strText = m_vText.back();
+  string strTrailing = strText.substr(m_iRawEnd + m_vPath.back().length() + 3);
+  strText.erase(m_iRawEnd);
+  EndElement(m_vPath.back(), strText);
+  m_vPath.pop_back();
+  m_vText.pop_back();
+  m_bRaw = false;
+  m_iRawEnd = string::npos;
+  AddText(strTrailing);
+}
+
+void XMLStreamParser::ProcessChar(char c)
+{
+  if (m_bRaw)
+  {
+    // Everything up to our end tag is content, but as the text may contain
+    // anything, only an end tag that finishes the line counts
+    string& strText = m_vText.back();
+    if (m_iRawEnd != string::npos)
+    {
+      if (c == '\n')
+      {
+        EndRaw();
+        ProcessChar(c);
+        return;
+      }
+      if ((c != ' ') && (c != '\t') && (c != '\r'))
+        m_iRawEnd = string::npos;
+    }
+    strText += c;
+    if (c == '>')
+    {
+      const string& strName = m_vPath.back();
+      if ((strText.length() >= strName.length() + 3) &&
+        (strText.compare(strText.length() - strName.length() - 3, 2, "</") == 0) &&
+        (strText.compare(strText.length() - strName.length() - 1, strName.length(), strName) == 0))
+        m_iRawEnd = strText.length() - strName.length() - 3;
+    }
+    return;
+  }
+
+  if (!m_bInTag)
+  {
+    if (c == '<')
+    {
+      m_bInTag = true;
+      m_strTag = "";
+    }
+    else if (!m_vText.empty())
+      m_vText.back() += c;
+    return;
+  }
+
+  if (c == '>')
+  {
+    m_bInTag = false;
+    EndTag();
+  }
+  else if ((c == '<') || (m_strTag.length() >= XML_STREAM_MAX_TAG))
+  {
+    // Wasn't a tag after all
+    AddText("<" + m_strTag);
+    m_bInTag = false;
+    ProcessChar(c);
+  }
+  else
+    m_strTag += c;
+}
+
+// Handles the tag just read (between '<' and '>')
+void XMLStreamParser::EndTag()
+{
+  // Declarations, comments, etc.
+  if ((m_strTag.length() > 0) && ((m_strTag[0] == '?') || (m_strTag[0] == '!')))
+    return;
+
+  const bool bEnd = (m_strTag.length() > 0) && (m_strTag[0] == '/');
+  const bool bEmpty = (!bEnd) && (m_strTag.length() > 0) && (m_strTag[m_strTag.length() - 1] == '/');
+
+  size_t iStart = bEnd ? 1 : 0;
+  size_t iName = iStart;
+  while ((iName < m_strTag.length()) &&
+    (isalnum((unsigned char) m_strTag[iName]) || (m_strTag[iName] == '_') ||
+    (((m_strTag[iName] == '-') || (m_strTag[iName] == '.') || (m_strTag[iName] == ':')) && (iName > iStart))))
+    iName++;
+  string strName = m_strTag.substr(iStart, iName - iStart);
+
+  // The name must be followed by the end of the tag, or (for a start tag)
+  // by white space, before any attributes
+  bool bValid = (strName.length() > 0) && (!XMLUtil::IsDigit(strName[0]));
+  if (bValid)
+  {
+    size_t iRest = iName;
+    if (bEnd)
+      while ((iRest < m_strTag.length()) && (XMLUtil::IsWhiteSpace(m_strTag[iRest])))
+        iRest++;
+    bValid = (iRest == m_strTag.length()) ||
+      ((!bEnd) && ((XMLUtil::IsWhiteSpace(m_strTag[iRest])) || ((bEmpty) && (iRest == m_strTag.length() - 1))));
+  }
+  // End tags must close an open element
+  if ((bValid) && (bEnd))
+    bValid = (find(m_vPath.begin(), m_vPath.end(), strName) != m_vPath.end());
+
+  if (!bValid)
+  {
+    AddText("<" + m_strTag + ">");
+    return;
+  }
+
+  if (bEnd)
+  {
+    // Anything still open inside it must have been a stray start tag in
+    // some unescaped text, so close that too
+    bool bDone = false;
+    while (!bDone)
+    {
+      bDone = (m_vPath.back() == strName);
+      EndElement(m_vPath.back(), XMLUtil::StripWhiteSpace(m_vText.back()));
+      m_vPath.pop_back();
+      m_vText.pop_back();
+    }
+    return;
+  }
+
+  m_vPath.push_back(strName);
+  m_vText.push_back("");
+  StartElement(strName);
+
+  if (bEmpty)
+  {
+    EndElement(strName, "");
+    m_vPath.pop_back();
+    m_vText.pop_back();
+  }
+  else if (IsRawElement(strName))
+    m_bRaw = true;
+}
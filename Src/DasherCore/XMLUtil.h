@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 #include <stdio.h>
+#include <istream>
 #include "FileLogger.h"
 
 extern CFileLogger* gLogger;
@@ -54,6 +55,8 @@ public:
   static int				              GetElementInt(const string& strTag, const string& strXML, bool* pFound = NULL);
   static int64		            GetElementLongLong(const string& strTag, const string& strXML, bool* pFound = NULL);
   static float			              GetElementFloat(const string& strTag, const string& strXML, bool* pFound = NULL);
+  static int				              ParseInt(const string& strElement, bool* pFound = NULL);
+  static float			              ParseFloat(const string& strElement, bool* pFound = NULL);
   static VECTOR_STRING	          GetElementStrings(const string& strTag, const string& strXML, bool bStripWhiteSpace = true);
   static VECTOR_NAME_VALUE_PAIR   GetNameValuePairs(const string& strXML, bool bStripWhiteSpace = true);
 
@@ -62,6 +65,58 @@ public:
   static bool				        IsDigit(char cLetter);
 
 };
+
+/// Single pass (SAX style) reader for the XML we write ourselves, e.g. user logs.
+/// Reports the start of each element, and its end with the text directly inside
+/// it; the input is read in chunks, so memory use does not grow with the file.
+///
+/// Like the rest of XMLUtil (and unlike Expat), it is lenient, as our logs do not
+/// escape their text: a '<' that does not begin a well formed tag, or an end tag
+/// that does not match any open element, is just text, and an end tag closes any
+/// elements left open inside its own. Entities are not decoded.
+class XMLStreamParser
+{
+public:
+  virtual ~XMLStreamParser() {}
+
+  // Return false if the input could not be read, or ended inside an element
+  // (elements completed before that have still been reported)
+  bool                            ParseFile(const string& strFilename);
+  bool                            Parse(istream& in);
+
+protected:
+  virtual void                    StartElement(const string& strName) = 0;
+  // strText is the text directly inside the element (not inside its children),
+  // with leading and trailing white space stripped.
+  virtual void                    EndElement(const string& strName, const string& strText) = 0;
+  // Elements whose whole content is passed to EndElement as text (unstripped),
+  // rather than being parsed: e.g. those holding text we wrote unescaped, or
+  // copied verbatim from elsewhere. As that text may contain anything, they end
+  // at the first matching end tag which is the last thing on its line (we write
+  // each element's end tag on a line of its own, or at the end of its line).
+  virtual bool                    IsRawElement(const string& strName) { return false; }
+
+  // Names of the open elements, outermost first (including the one
+  // starting or ending, during StartElement and EndElement)
+  const VECTOR_STRING&            GetPath() const { return m_vPath; }
+  // Name of the i'th open element, counting outwards from the innermost (0),
+  // or "" if there are fewer open elements
+  const string&                   GetAncestor(unsigned int i) const;
+
+private:
+  void                            ProcessChar(char c);
+  void                            EndTag();
+  void                            AddText(const string& strText);
+  void                            EndRaw();
+
+  VECTOR_STRING                   m_vPath;
+  VECTOR_STRING                   m_vText;            // Text so far of each open element
+  string                          m_strTag;           // Tag being read, after the '<'
+  bool                            m_bInTag;
+  bool                            m_bRaw;             // Reading the content of a raw element?
+  size_t                          m_iRawEnd;          // Where its end tag might start, or npos
+  static const string             EMPTY;
+};
 /// @}
 
 #endif
@@ -4,6 +4,7 @@
 #include "DasherControl.h"
 
 #include "../DasherCore/DasherTypes.h"
+#include "../DasherCore/PerfTrace.h"
 
 
 using namespace Dasher;
@@ -399,6 +400,19 @@ CDasherScreen::Label *CCanvas::MakeLabel(const string &strText, unsigned int iWr
   return new CPangoLabel(this, strText, iWrapFontSize);
 }
 
+void CCanvas::ReportMemory(CMemoryReport &report) const {
+  CLabelListScreen::ReportMemory(report);
+  report.Add("screen/layouts", m_lLayouts.size(), 0);
+}
+
+CCanvas::CPangoLabel::~CPangoLabel() {
+  LayoutLRU &lru(static_cast<CCanvas *>(m_pScreen)->m_lLayouts);
+  for (map<unsigned int,pair<PangoLayout *,LayoutLRU::iterator> >::iterator it=m_mLayouts.begin(); it!=m_mLayouts.end(); it++) {
+    g_object_unref(it->second.first);
+    lru.erase(it->second.second);
+  }
+}
+
 void CCanvas::SetFont(const std::string &strName) {
   m_strFontName=strName;
   for (map<unsigned int,PangoFontDescription *>::iterator it=m_mFonts.begin(); it!=m_mFonts.end(); it++) {
@@ -407,25 +421,39 @@ void CCanvas::SetFont(const std::string &strName) {
     pango_font_description_set_size(it->second,it->first * PANGO_SCALE);
   }
   for (set<CLabelListScreen::Label *>::iterator it=LabelsBegin(); it!=LabelsEnd(); it++) {
-    map<unsigned int,PangoLayout *> &layouts(static_cast<CPangoLabel *>(*it)->m_mLayouts);
-    for (map<unsigned int,PangoLayout *>::iterator it2=layouts.begin(); it2!=layouts.end(); it2++) {
+    map<unsigned int,pair<PangoLayout *,LayoutLRU::iterator> > &layouts(static_cast<CPangoLabel *>(*it)->m_mLayouts);
+    for (map<unsigned int,pair<PangoLayout *,LayoutLRU::iterator> >::iterator it2=layouts.begin(); it2!=layouts.end(); it2++) {
       DASHER_ASSERT(m_mFonts.find(it2->first) != m_mFonts.end()); //central font repository knows about this size
-      pango_layout_set_font_description(it2->second,m_mFonts[it2->first]);
+      pango_layout_set_font_description(it2->second.first,m_mFonts[it2->first]);
     }
   }
 }
 
 PangoLayout *CCanvas::GetLayout(CPangoLabel *label, unsigned int iFontSize) {
   {
-    map<unsigned int,PangoLayout *>::iterator it = label->m_mLayouts.find(iFontSize);
-    if (it != label->m_mLayouts.end()) return it->second;
+    map<unsigned int,pair<PangoLayout *,LayoutLRU::iterator> >::iterator it = label->m_mLayouts.find(iFontSize);
+    if (it != label->m_mLayouts.end()) {
+      //now most recently used
+      m_lLayouts.splice(m_lLayouts.begin(), m_lLayouts, it->second.second);
+      return it->second.first;
+    }
+  }
+  PERF_TRACE_SPAN("CCanvas::GetLayout");
+  if (m_lLayouts.size() >= MAX_LAYOUTS) {
+    //free the least recently used layout (of whichever label)
+    CPangoLabel *pOld(m_lLayouts.back().first);
+    map<unsigned int,pair<PangoLayout *,LayoutLRU::iterator> >::iterator it = pOld->m_mLayouts.find(m_lLayouts.back().second);
+    g_object_unref(it->second.first);
+    pOld->m_mLayouts.erase(it);
+    m_lLayouts.pop_back();
   }
 #if WITH_CAIRO
     PangoLayout *pNewPangoLayout(pango_cairo_create_layout(cr));
 #else
     PangoLayout *pNewPangoLayout(gtk_widget_create_pango_layout(m_pCanvas, ""));
 #endif
-  label->m_mLayouts.insert(pair<unsigned int,PangoLayout *>(iFontSize, pNewPangoLayout));
+  m_lLayouts.push_front(make_pair(label, iFontSize));
+  label->m_mLayouts.insert(make_pair(iFontSize, make_pair(pNewPangoLayout, m_lLayouts.begin())));
   if (label->m_iWrapSize) pango_layout_set_width(pNewPangoLayout, GetWidth() * PANGO_SCALE);
   pango_layout_set_text(pNewPangoLayout, label->m_strText.c_str(), -1);
   
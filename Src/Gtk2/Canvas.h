@@ -10,6 +10,7 @@
 #include <gdk/gdk.h>
 #include <pango/pango.h>
 #include <map>
+#include <list>
 
 #include <iostream>
 
@@ -94,6 +95,10 @@ public:
   ///Make a label for use with this screen; caches Pango layout information inside it.
   CDasherScreen::Label *MakeLabel(const std::string &strText, unsigned int iWrapSize=0) override;
 
+  ///Adds the labels, and the Pango layouts cached for them (by count only, as
+  /// Pango's memory is its own)
+  void ReportMemory(Dasher::CMemoryReport &report) const override;
+
   ///
   /// Return the physical extent of a given string being rendered at a given size.
   /// \param String The string to be rendered
@@ -234,12 +239,21 @@ private:
   std::string m_strFontName;
   std::map<unsigned int,PangoFontDescription *> m_mFonts;
 
+  class CPangoLabel;
+  ///All layouts of all labels, as (label, font size), most recently used first
+  typedef std::list<std::pair<CPangoLabel *,unsigned int> > LayoutLRU;
+  LayoutLRU m_lLayouts;
+  ///Max number of layouts kept (across all labels); least recently used are freed beyond this
+  static const unsigned int MAX_LAYOUTS = 1024;
+
   class CPangoLabel : public CLabelListScreen::Label {
   public:
     CPangoLabel(CCanvas *pCanvas, const std::string &strText, unsigned int iWrapFontSize)
     : CLabelListScreen::Label(pCanvas, strText, iWrapFontSize) {
     }
-    std::map<unsigned int,PangoLayout *> m_mLayouts;
+    ~CPangoLabel();
+    ///Layouts by font size, each with its entry in the canvas' m_lLayouts
+    std::map<unsigned int,std::pair<PangoLayout *,LayoutLRU::iterator> > m_mLayouts;
   };
 
   PangoLayout *GetLayout(CPangoLabel *label, unsigned int iFontSize);
@@ -16,8 +16,10 @@
 #include <fcntl.h>
 
 #include <gtk/gtk.h>
+#include <glib-unix.h>
 #include <gdk/gdk.h>
 #include <gdk/gdkkeysyms.h>
+#include <signal.h>
 #include <sys/stat.h>
 #include <unistd.h>
 using namespace std;
@@ -30,19 +32,25 @@ extern "C" gint canvas_configure_event(GtkWidget *widget, GdkEventConfigure *eve
 extern "C" gint key_press_event(GtkWidget *widget, GdkEventKey *event, gpointer data);
 extern "C" void canvas_destroy_event(GtkWidget *pWidget, gpointer pUserData);
 extern "C" gboolean canvas_focus_event(GtkWidget *widget, GdkEventFocus *event, gpointer data);
+extern "C" gboolean canvas_motion_event(GtkWidget *widget, GdkEventMotion *event, gpointer data);
+extern "C" gboolean perf_trace_signal(gpointer data);
+extern "C" gboolean memory_report_signal(gpointer data);
 #ifdef HAVE_GTK_CAIRO_SHOULD_DRAW_WINDOW
 extern "C" gint canvas_draw_event(GtkWidget *widget, cairo_t *cr, gpointer data);
 #else
 extern "C" gint canvas_expose_event(GtkWidget *widget, GdkEventExpose *event, gpointer data);
 #endif
 
-static bool g_iTimeoutID = 0;
-
 // CDasherControl class definitions
 CDasherControl::CDasherControl(GtkVBox *pVBox, GtkDasherControl *pDasherControl,
                                CSettingsStore* settings)
  : CDashIntfScreenMsgs(settings, &file_utils_) {
   m_pScreen = NULL;
+  m_iTimeoutID = 0;
+  // Dump the performance trace (if BP_PERF_TRACE) on "kill -USR1"
+  m_iSignalID = g_unix_signal_add(SIGUSR1, perf_trace_signal, this);
+  // ...and a report of the memory in use on "kill -USR2"
+  m_iMemorySignalID = g_unix_signal_add(SIGUSR2, memory_report_signal, this);
 
   m_pDasherControl = pDasherControl;
   m_pVBox = GTK_WIDGET(pVBox);
@@ -76,6 +84,7 @@ CDasherControl::CDasherControl(GtkVBox *pVBox, GtkDasherControl *pDasherControl,
   g_signal_connect(m_pCanvas, "key_press_event", G_CALLBACK(key_press_event), this);
 
   g_signal_connect(m_pCanvas, "focus_in_event", G_CALLBACK(canvas_focus_event), this);
+  g_signal_connect(m_pCanvas, "motion_notify_event", G_CALLBACK(canvas_motion_event), this);
 #ifdef HAVE_GTK_CAIRO_SHOULD_DRAW_WINDOW
   g_signal_connect(m_pCanvas, "draw", G_CALLBACK(canvas_draw_event), this);
 #else
@@ -125,26 +134,31 @@ void CDasherControl::CreateModules() {
 
 
 void CDasherControl::ClearAllContext() {
+  FlushEdits();
   gtk_dasher_control_clear_all_context(m_pDasherControl);
   //SetBuffer(0); //the editor's clear method emits a "buffer_changed" signal,
                   //which does this for us automatically.
 }
 
 std::string CDasherControl::GetAllContext() {
+  FlushEdits();
   return gtk_dasher_control_get_all_text(m_pDasherControl);
 }
 
 int CDasherControl::GetAllContextLenght()
 {
+  FlushEdits();
   auto text = gtk_dasher_control_get_all_text(m_pDasherControl);
   return g_utf8_strlen(text.c_str(),-1);
 }
 
 std::string CDasherControl::GetTextAroundCursor(CControlManager::EditDistance dist) {
+  FlushEdits();
   return gtk_dasher_control_get_text_around_cursor(m_pDasherControl, dist);
 }
 
 std::string CDasherControl::GetContext(unsigned int iStart, unsigned int iLength) {
+  FlushEdits();
   return gtk_dasher_control_get_context(m_pDasherControl, iStart, iLength);
 }
 
@@ -169,6 +183,13 @@ void CDasherControl::Speak(const std::string &strText, bool bInterrupt) {
 #endif
 
 CDasherControl::~CDasherControl() {
+  if (m_iTimeoutID)
+    g_source_remove(m_iTimeoutID);
+  if (m_iSignalID)
+    g_source_remove(m_iSignalID);
+  if (m_iMemorySignalID)
+    g_source_remove(m_iMemorySignalID);
+
   if(m_pMouseInput) {
     m_pMouseInput = NULL;
   }
@@ -229,14 +250,38 @@ void CDasherControl::RealizeCanvas(GtkWidget *pWidget) {
 #ifdef DEBUG
   std::cout << "RealizeCanvas()" << std::endl;
 #endif
-  // Start the timer loops as everything is set up.
-  // Aim for 40 frames per second, computers are getting faster.
-
-  if(g_iTimeoutID == 0) {
-    g_iTimeoutID = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, 25, timer_callback, this, NULL);
-    // TODO: Reimplement this (or at least reimplement some kind of status reporting)
-    //g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, 5000, long_timer_callback, this, NULL);
+  // Start rendering frames as everything is set up. Rather than a fixed
+  // timer, we ask the core when the next frame is needed after each one.
+  RequestFrame();
+  ArmTimer();
+  // TODO: Reimplement this (or at least reimplement some kind of status reporting)
+  //g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, 5000, long_timer_callback, this, NULL);
+}
+
+void CDasherControl::ArmTimer() {
+  // Frames requested before the canvas is realized wait for RealizeCanvas
+  if (!gtk_widget_get_window(m_pCanvas)) return;
+  const long iDelay(GetFrameDelay());
+  if (iDelay == CFrameScheduler::NEVER) {
+    //nothing to do until some input event (which will call FrameRequested)
+    if (m_iTimeoutID) {
+      g_source_remove(m_iTimeoutID);
+      m_iTimeoutID = 0;
+    }
+    return;
   }
+  const long long iDue(CFrameScheduler::Now() + iDelay);
+  if (m_iTimeoutID) {
+    if (m_iTimerDue <= iDue) return; //will fire soon enough already
+    g_source_remove(m_iTimeoutID);
+  }
+  m_iTimerDue = iDue;
+  //round up, so we never fire before the frame is due (and then have to wait again)
+  m_iTimeoutID = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, (iDelay+999)/1000, timer_callback, this, NULL);
+}
+
+void CDasherControl::FrameRequested() {
+  ArmTimer();
 }
 
 int CDasherControl::CanvasConfigureEvent() {
@@ -273,17 +318,22 @@ void CDasherControl::HandleEvent(int iParameter) {
 }
 
 void CDasherControl::editOutput(const std::string &strText, CDasherNode *pNode) {
-  if (!GetGameModule()) //GameModule sets editbox directly
+  if (!GetGameModule() && !GetBatchEdits()) //GameModule sets editbox directly
     g_signal_emit_by_name(GTK_WIDGET(m_pDasherControl), "dasher_edit_insert", strText.c_str(), pNode->offset());
   CDasherInterfaceBase::editOutput(strText, pNode);
 }
 
 void CDasherControl::editDelete(const std::string &strText, CDasherNode *pNode) {
-  if (!GetGameModule()) //GameModule sets editbox directly
+  if (!GetGameModule() && !GetBatchEdits()) //GameModule sets editbox directly
     g_signal_emit_by_name(GTK_WIDGET(m_pDasherControl), "dasher_edit_delete", strText.c_str(), pNode->offset());
   CDasherInterfaceBase::editDelete(strText, pNode);
 }
 
+void CDasherControl::editFlush(unsigned int iDeletes, const std::string &strOutput) {
+  if (!GetGameModule())
+    gtk_dasher_control_commit(m_pDasherControl, iDeletes, strOutput.c_str());
+}
+
 void CDasherControl::editConvert(CDasherNode *pNode) {
   g_signal_emit_by_name(GTK_WIDGET(m_pDasherControl), "dasher_edit_convert");
   CDasherInterfaceBase::editConvert(pNode);
@@ -317,10 +367,12 @@ void CDasherControl::SetLockStatus(const string &strText, int iPercent) {
 //}
 
 unsigned int CDasherControl::ctrlMove(bool bForwards, CControlManager::EditDistance dist) {
+  FlushEdits();
   return gtk_dasher_control_ctrl_move(m_pDasherControl,bForwards,dist);
 }
 
 unsigned int CDasherControl::ctrlDelete(bool bForwards, CControlManager::EditDistance dist) {
+  FlushEdits();
   return gtk_dasher_control_ctrl_delete(m_pDasherControl,bForwards,dist);
 }
 
@@ -468,7 +520,10 @@ int CDasherControl::TimerEvent() {
 
   m_p1DMouseInput->SetCoordinates(y, GetLongParameter(LP_YSCALE));
 
+  // This timer has now fired; NewFrame will request another if it's needed.
+  m_iTimeoutID = 0;
   NewFrame(get_time(), false);
+  ArmTimer();
 
   // Update our UserLog object about the current mouse position
   CUserLogBase* pUserLog = GetUserLogPtr();
@@ -505,7 +560,8 @@ int CDasherControl::TimerEvent() {
       pUserLog->AddMouseLocationNormalized(iMouseX, iMouseY, true, GetNats());
   }
 
-  return 1;
+  // One-shot: ArmTimer has added a new timeout if we need another frame.
+  return FALSE;
 
   // See CVS for code which used to be here
 }
@@ -518,9 +574,16 @@ int CDasherControl::LongTimerEvent() {
 
 gboolean CDasherControl::ExposeEvent() {
   NewFrame(get_time(), true);
+  ArmTimer();
   return 0;
 }
 
+gboolean CDasherControl::MotionEvent() {
+  // Decorations (and start handlers) follow the pointer even when paused
+  RequestFrame();
+  return false;
+}
+
 void CDasherControl::Done() {
   CDasherInterfaceBase::Done();
   g_signal_emit_by_name(GTK_WIDGET(m_pDasherControl), "dasher_stop");
@@ -600,6 +663,12 @@ gint CDasherControl::KeyPressEvent(GdkEventKey *event) {
 }
 
 void CDasherControl::CanvasDestroyEvent() {
+  // No more frames
+  if (m_iTimeoutID) {
+    g_source_remove(m_iTimeoutID);
+    m_iTimeoutID = 0;
+  }
+
   // Delete the screen
 
   if(m_pScreen != NULL) {
@@ -640,6 +709,16 @@ extern "C" gint canvas_configure_event(GtkWidget *widget, GdkEventConfigure *eve
   return static_cast < CDasherControl * >(data)->CanvasConfigureEvent();
 }
 
+extern "C" gboolean perf_trace_signal(gpointer data) {
+  static_cast<CDasherControl*>(data)->WritePerfTrace();
+  return TRUE;
+}
+
+extern "C" gboolean memory_report_signal(gpointer data) {
+  static_cast<CDasherControl*>(data)->WriteMemoryReport();
+  return TRUE;
+}
+
 extern "C" void canvas_destroy_event(GtkWidget *pWidget, gpointer pUserData) {
   static_cast<CDasherControl*>(pUserData)->CanvasDestroyEvent();
 }
@@ -652,6 +731,10 @@ extern "C" gboolean canvas_focus_event(GtkWidget *widget, GdkEventFocus *event,
   return static_cast < CDasherControl * >(data)->FocusEvent(widget, event);
 }
 
+extern "C" gboolean canvas_motion_event(GtkWidget *widget, GdkEventMotion *event, gpointer data) {
+  return static_cast < CDasherControl * >(data)->MotionEvent();
+}
+
 #ifdef HAVE_GTK_CAIRO_SHOULD_DRAW_WINDOW
 extern "C" gint canvas_draw_event(GtkWidget *widget, cairo_t *cr, gpointer data) {
 #else
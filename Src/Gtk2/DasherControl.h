@@ -72,10 +72,11 @@ public:
   void RealizeCanvas(GtkWidget *pWidget);
 
   ///
-  /// Called periodically by a timer. Used to prompt the interface to perform a redraw
+  /// Called by a one-shot timer, armed by ArmTimer, when the core wants a new frame.
   /// \todo There's rather a lot which happens in this
   /// function. Ideally it should just be a simple call to the core
   /// which then figures out whether we're paused or not etc.
+  /// \return FALSE (the timer does not repeat)
   ///
 
   int TimerEvent();
@@ -131,6 +132,15 @@ public:
 
   gboolean ExposeEvent();
 
+  ///
+  /// Pointer moved over the canvas
+  ///
+
+  gboolean MotionEvent();
+
+  ///Override to (re)arm the timer, if the frame is needed sooner
+  void FrameRequested() override;
+
   ///Override to broadcast dasher_stop signal...
   void Done() override;
 
@@ -161,6 +171,8 @@ public:
   void editDelete(const std::string &strText, CDasherNode *pNode) override;
   void editConvert(CDasherNode *pNode) override;
   void editProtect(CDasherNode *pNode) override;
+  ///Override to send a frame's batched edits to the editor, in direct mode
+  void editFlush(unsigned int iDeletes, const std::string &strOutput) override;
 
   ///Override to emit Gtk2 signal
   void SetLockStatus(const string &strText, int iPercent) override;
@@ -169,6 +181,19 @@ public:
 private:
   virtual void CreateModules() override;
 
+  ///(Re)arms the timer to fire when the core next needs a frame
+  /// (per GetFrameDelay), or removes it if no frame is needed.
+  void ArmTimer();
+
+  ///ID of the timeout source calling TimerEvent, or 0 if none
+  guint m_iTimeoutID;
+  ///When that timeout is due, per CFrameScheduler::Now()
+  long long m_iTimerDue;
+  ///ID of the SIGUSR1 source writing the performance trace, or 0 if none
+  guint m_iSignalID;
+  ///ID of the SIGUSR2 source writing the memory report, or 0 if none
+  guint m_iMemorySignalID;
+
   GtkWidget *m_pVBox;
   GtkWidget *m_pCanvas;
 
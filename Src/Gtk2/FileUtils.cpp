@@ -52,3 +52,9 @@ bool FileUtils::WriteUserDataFile(const std::string &filename, const std::string
   fclose(f);
   return written == strNewText.length();
 }
+
+std::string FileUtils::GetUserDataFilePath(const std::string &filename) {
+  std::string strFilename = getenv("HOME");
+  strFilename += "/.dasher/";
+  return strFilename + filename;
+}
@@ -10,6 +10,7 @@ public:
   int GetFileSize(const std::string &strFileName) override;
   void ScanFiles(AbstractParser *parser, const std::string &strPattern) override;
   bool WriteUserDataFile(const std::string &filename, const std::string &strNewText, bool append) override;
+  std::string GetUserDataFilePath(const std::string &filename) override;
 };
 
 #endif //DASHER_FILEUTILS_H
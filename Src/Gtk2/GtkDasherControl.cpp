@@ -229,6 +229,17 @@ gint gtk_dasher_control_ctrl_delete(GtkDasherControl *pControl, bool bForwards,
   return dasher_editor_ctrl_delete(pPrivate->pEditor, bForwards, dist);
 }
 
+void gtk_dasher_control_set_batch_edits(GtkDasherControl *pControl, bool bBatch) {
+  GtkDasherControlPrivate *pPrivate = GTK_DASHER_CONTROL_GET_PRIVATE(pControl);
+  pPrivate->pControl->SetBatchEdits(bBatch);
+}
+
+void gtk_dasher_control_commit(GtkDasherControl *pControl, int iDeletes, const gchar *szText) {
+  GtkDasherControlPrivate *pPrivate = GTK_DASHER_CONTROL_GET_PRIVATE(pControl);
+  if (pPrivate->pEditor)
+    dasher_editor_commit(pPrivate->pEditor, iDeletes, szText);
+}
+
 void 
 gtk_dasher_control_external_key_down(GtkDasherControl *pControl, int iKeyVal) {
   GtkDasherControlPrivate *pPrivate = GTK_DASHER_CONTROL_GET_PRIVATE(pControl);
@@ -219,6 +219,7 @@ dasher_editor_initialise(DasherEditor *pSelf, DasherAppSettings *pAppSettings, G
 				     pPrivate->pAppSettings->GetString(APP_SP_EDIT_FONT).c_str());
 
   dasher_editor_external_create_buffer(pSelf);
+  gtk_dasher_control_set_batch_edits(pDasherCtrl, isdirect(pAppSettings));
   // TODO: is this still needed?
   dasher_editor_internal_create_buffer(pSelf);
 
@@ -291,6 +292,8 @@ dasher_editor_toggle_direct_mode(DasherEditor *pSelf) {
   DasherEditorPrivate *pPrivate = DASHER_EDITOR_GET_PRIVATE(pSelf);
 
   dasher_editor_external_toggle_direct_mode(pSelf, isdirect(pPrivate->pAppSettings));
+  // Other applications are costly to edit a character at a time
+  gtk_dasher_control_set_batch_edits(pPrivate->pDasherCtrl, isdirect(pPrivate->pAppSettings));
 }
 
 void
@@ -414,6 +417,24 @@ dasher_editor_delete(DasherEditor *pSelf, int iLength, int iOffset) {
   pPrivate->bFileModified = TRUE;
 }
 
+void
+dasher_editor_commit(DasherEditor *pSelf, int iDeletes, const gchar *szText) {
+  DasherEditorPrivate *pPrivate = DASHER_EDITOR_GET_PRIVATE(pSelf);
+
+  if (isdirect(pPrivate->pAppSettings))
+    return dasher_editor_external_commit(pSelf, iDeletes, szText);
+
+  // Only batched in direct mode, but just in case: apply at the cursor
+  GtkTextIter sIter;
+  gtk_text_buffer_get_iter_at_mark(pPrivate->pBuffer, &sIter, gtk_text_buffer_get_insert(pPrivate->pBuffer));
+  gint iCursor = gtk_text_iter_get_offset(&sIter);
+
+  if (iDeletes > 0)
+    dasher_editor_delete(pSelf, iDeletes, iCursor - 1);
+  if (*szText)
+    dasher_editor_output(pSelf, szText, iCursor - iDeletes + g_utf8_strlen(szText, -1) - 1);
+}
+
 // const gchar *
 // dasher_editor_get_context(DasherEditor *pSelf, int iOffset, int iLength) {
 //   if(DASHER_EDITOR_GET_CLASS(pSelf)->get_context)
@@ -67,6 +67,8 @@ std::string dasher_editor_get_all_text(DasherEditor *pSelf);
 /* Functions for editing the active buffer */
 void dasher_editor_output(DasherEditor *pSelf, const gchar *szText, int iOffset);
 void dasher_editor_delete(DasherEditor *pSelf, int iLength, int iOffset);
+/* Delete iDeletes characters before the cursor, then output szText: a frame's edits, batched */
+void dasher_editor_commit(DasherEditor *pSelf, int iDeletes, const gchar *szText);
 
 /* Function for reading the active buffer */
 std::string dasher_editor_get_context(DasherEditor *pSelf, int iOffset, int iLength);
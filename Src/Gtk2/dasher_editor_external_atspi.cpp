@@ -121,6 +121,17 @@ dasher_editor_external_delete(DasherEditor *pSelf, int iLength, int iOffset) {
   atspi_generate_keyboard_event(XK_BackSpace, NULL, ATSPI_KEY_SYM, NULL);
 }
 
+void
+dasher_editor_external_commit(DasherEditor *pSelf, int iDeletes, const char *szText) {
+  if (!initSPI()) return;
+
+  for (int i = 0; i < iDeletes; i++)
+    atspi_generate_keyboard_event(XK_BackSpace, NULL, ATSPI_KEY_SYM, NULL);
+  // All the text output in the frame, as a single event
+  if (*szText)
+    atspi_generate_keyboard_event(0, szText, ATSPI_KEY_STRING, NULL);
+}
+
 std::string
 dasher_editor_external_get_context(DasherEditor *pSelf, int iOffset, int iLength) {
   DasherEditorPrivate *pPrivate = DASHER_EDITOR_GET_PRIVATE(pSelf);
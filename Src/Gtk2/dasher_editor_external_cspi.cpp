@@ -114,6 +114,24 @@ dasher_editor_external_delete(DasherEditor *pSelf, int iLength, int iOffset) {
   SPI_generateKeyboardEvent(XK_BackSpace, NULL, SPI_KEY_SYM);
 }
 
+void
+dasher_editor_external_commit(DasherEditor *pSelf, int iDeletes, const gchar *szText) {
+  if(!initSPI()) return;
+
+  for(int i = 0; i < iDeletes; i++)
+    SPI_generateKeyboardEvent(XK_BackSpace, NULL, SPI_KEY_SYM);
+
+  if(*szText) {
+    char *szNewText;
+    szNewText = new char[strlen(szText) + 1];
+    strcpy(szNewText, szText);
+
+    SPI_generateKeyboardEvent(0, szNewText, SPI_KEY_STRING);
+
+    delete[] szNewText;
+  }
+}
+
 std::string
 dasher_editor_external_get_context(DasherEditor *pSelf, int iOffset, int iLength) {
   DasherEditorPrivate *pPrivate = DASHER_EDITOR_GET_PRIVATE(pSelf);
@@ -8,6 +8,7 @@
 
 #include <X11/keysym.h>
 #include <algorithm>
+#include <vector>
 
 #include "dasher_editor_external.h"
 #include "dasher_editor_private.h"
@@ -138,6 +139,84 @@ dasher_editor_external_delete(DasherEditor *pSelf, int iLength, int iOffset) {
   XFlush(dpy);
 }
 
+// Number of keycodes, at the top of the X server's range, which we
+// reprogram to generate the characters we output
+static const int NUM_SPARE_CODES = 10;
+
+static void
+fake_key(Display *dpy, KeyCode code) {
+  XTestFakeKeyEvent(dpy, code, True, CurrentTime);
+  XTestFakeKeyEvent(dpy, code, False, CurrentTime);
+}
+
+void
+dasher_editor_external_commit(DasherEditor *pSelf, int iDeletes, const gchar *szText) {
+  Display *dpy = gdk_x11_get_default_xdisplay();
+
+  KeyCode code = XKeysymToKeycode(dpy, XK_BackSpace);
+  for(int i = 0; i < iDeletes; i++)
+    fake_key(dpy, code);
+
+  glong numoutput;
+  gunichar *wideoutput = g_utf8_to_ucs4(szText, -1, NULL, &numoutput, NULL);
+  int min, max;
+  XDisplayKeycodes(dpy, &min, &max);
+  const KeyCode first = max - NUM_SPARE_CODES;
+  const KeyCode ret = XKeysymToKeycode(dpy, XK_Return);
+  bool bRemapped = false;
+
+  // As dasher_editor_external_output, but rather than reprogramming a
+  // keycode for every character, reprogram all the spare keycodes at once,
+  // for the next (up to) NUM_SPARE_CODES distinct characters, then type
+  // every character they cover - and only sync with the server for each
+  // such change of mapping, not for every key event.
+  for(glong i = 0; wideoutput && i < numoutput;) {
+    std::vector<KeySym> vSyms;
+    glong j = i;
+    for(; j < numoutput; j++) {
+      if(wideoutput[j] == '\n' || wideoutput[j] >= 0x01000000)
+        continue;
+      const KeySym sym = wideoutput[j] | 0x01000000;
+      if(std::find(vSyms.begin(), vSyms.end(), sym) == vSyms.end()) {
+        if(vSyms.size() == static_cast<size_t>(NUM_SPARE_CODES))
+          break;
+        vSyms.push_back(sym);
+      }
+    }
+
+    if(!vSyms.empty()) {
+      // Give the client time to process the events typed with the last
+      // mapping, before we change it
+      if(bRemapped) {
+        XSync(dpy, false);
+        usleep(200000);
+      }
+      int numcodes;
+      KeySym *keysym = XGetKeyboardMapping(dpy, first, NUM_SPARE_CODES, &numcodes);
+      for(size_t k = 0; k < vSyms.size(); k++)
+        keysym[k * numcodes] = vSyms[k];
+      XChangeKeyboardMapping(dpy, first, numcodes, keysym, NUM_SPARE_CODES);
+      XFree(keysym);
+      XSync(dpy, false);
+      bRemapped = true;
+    }
+
+    for(; i < j; i++) {
+      // Newlines are typed as enter presses, as dasher_editor_external_output
+      if(wideoutput[i] == '\n') {
+        if(ret != 0)
+          fake_key(dpy, ret);
+      }
+      else if(wideoutput[i] < 0x01000000) {
+        const KeySym sym = wideoutput[i] | 0x01000000;
+        fake_key(dpy, first + (std::find(vSyms.begin(), vSyms.end(), sym) - vSyms.begin()));
+      }
+    }
+  }
+  XSync(dpy, false);
+  g_free(wideoutput);
+}
+
 std::string dasher_editor_external_get_context(DasherEditor *pSelf, int iOffset, int iLength) {
   return "";
 }
@@ -0,0 +1,57 @@
+// Protocol.h
+//
+// Messages exchanged between DasherServer and its clients over a Unix-domain
+// stream socket. Each message is an SMessageHeader followed by iLength octets
+// of payload; integers are in the host's byte order (client and server are
+// always on the same machine), and text is UTF-8, not NUL-terminated.
+//
+// A client must first send MSG_OPEN; the server replies MSG_READY once the
+// session has been created (or MSG_ERROR, and closes the connection). Closing
+// the connection ends the session.
+//
+// Copyright (c) 2026 The Dasher Team
+
+#ifndef __DasherServer_Protocol_h__
+#define __DasherServer_Protocol_h__
+
+#include <stdint.h>
+
+namespace DasherServer {
+
+  struct SMessageHeader {
+    uint32_t iType;
+    uint32_t iLength;
+  };
+
+  enum MessageType {
+    //Client to server:
+    ///int32 width, int32 height (of the client's canvas, in pixels), then
+    /// the AlphabetID to write in (empty for the default)
+    MSG_OPEN = 1,
+    ///int32 x, int32 y: position of the pointer on the client's canvas
+    MSG_POINTER = 2,
+    ///int32 button id, as for CDasherInterfaceBase::KeyDown (100 = left mouse button)
+    MSG_KEY_DOWN = 3,
+    MSG_KEY_UP = 4,
+    ///"key=value", setting a parameter of this session only (as ClSet); only
+    /// speed, input and display parameters may be set (see main.cpp)
+    MSG_SET = 5,
+
+    //Server to client:
+    ///AlphabetID of the session created
+    MSG_READY = 16,
+    ///Text written, to be appended at the cursor
+    MSG_OUTPUT = 17,
+    ///Text to be deleted from before the cursor
+    MSG_DELETE = 18,
+    ///Message for the user
+    MSG_MESSAGE = 19,
+    ///Why the session could not be created, or a request was bad; the server then closes the connection
+    MSG_ERROR = 20,
+  };
+
+  ///Longest payload accepted from a client
+  static const uint32_t MAX_PAYLOAD = 4096;
+}
+
+#endif
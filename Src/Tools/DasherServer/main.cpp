@@ -0,0 +1,603 @@
+// Command line application hosting many concurrent Dasher sessions, for clients
+// connecting over a Unix-domain socket (see Protocol.h). Each session has its
+// own model tree, view and input state, and tells its client what to write.
+//
+// All sessions writing in the same alphabet predict using one PPM language
+// model, trained on the system training text when the first of them opens and
+// only read thereafter; each session learns what its user writes in a small
+// private overlay (COverlayLanguageModel). So memory grows with sessions x node
+// budget, rather than sessions x model. A pool of threads steps the sessions,
+// each frame.
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// Usage: DasherServer -s socket -d datadir [-d datadir...] [-j threads] [-f fps] [-n budget] [-v]
+//   -s  path of the Unix-domain socket to listen on (replaced if it exists)
+//   -d  directory containing alphabet, colour, control and training files (repeat for several)
+//   -j  threads stepping sessions (default the number of CPUs)
+//   -f  frames per second for each session (default 40)
+//   -n  NodeBudget of each session (default the default)
+//   -v  print messages, and sessions opening and closing, to stderr
+//
+// Sessions keep no data between connections: nothing is read from, or written
+// to, any user's own files.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../DasherCore/DashIntfSettings.h"
+#include "../../DasherCore/DasherInput.h"
+#include "../../DasherCore/DasherNode.h"
+#include "../../DasherCore/DasherScreen.h"
+#include "../../DasherCore/SettingsStore.h"
+#include "../../DasherCore/Trainer.h"
+#include "../../DasherCore/LanguageModelling/PPMLanguageModel.h"
+#include "../ToolSupport.h"
+
+#include "Protocol.h"
+
+using namespace Dasher;
+using namespace DasherServer;
+using std::string;
+using std::vector;
+
+static bool s_bVerbose(false);
+
+///Milliseconds since the server started, as the sessions' clock
+static unsigned long Now() {
+  static const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+  return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()) + 1;
+}
+
+///Screen which draws nothing: clients render text, not the canvas. Nodes are
+/// still laid out, and labels created and measured (as if in a fixed-width font).
+class CNullScreen : public CDasherScreen {
+public:
+  CNullScreen(screenint iWidth, screenint iHeight) : CDasherScreen(iWidth, iHeight) {}
+  std::pair<screenint,screenint> TextSize(Label *label, unsigned int iFontSize) {
+    return std::pair<screenint,screenint>(static_cast<screenint>(label->m_strText.length()*iFontSize/2), iFontSize);
+  }
+  void DrawString(Label *label, screenint x, screenint y, unsigned int iFontSize, int iColour) {}
+  void DrawRectangle(screenint x1, screenint y1, screenint x2, screenint y2, int Colour, int iOutlineColour, int iThickness) {}
+  void DrawCircle(screenint iCX, screenint iCY, screenint iR, int iFillColour, int iLineColour, int iLineWidth) {}
+  void Polyline(point *Points, int Number, int iWidth, int Colour) {}
+  void Polygon(point *Points, int Number, int fillColour, int outlineColour, int lineWidth) {}
+  void Display() {}
+  void SetColourScheme(const CColourIO::ColourInfo *pColourScheme) {}
+  bool IsWindowUnderCursor() {return true;}
+};
+
+///The language models shared between sessions, one per alphabet, each trained
+/// (on the system training text) when first asked for.
+class CSharedModels : private CSettingsUser {
+public:
+  CSharedModels(CSettingsStore *pSettings, CFileUtils *pFileUtils)
+  : CSettingsUser(pSettings), m_pFileUtils(pFileUtils) {}
+
+  ~CSharedModels() {
+    for (std::map<string, SModel *>::iterator it=m_mModels.begin(); it!=m_mModels.end(); it++) {
+      delete it->second->pLM;
+      delete it->second;
+    }
+  }
+
+  ///Model for the specified alphabet, training it first if no session has yet
+  /// asked for it; other sessions wanting the same alphabet wait meanwhile.
+  /// \param pMsgs where to report any problems training
+  CLanguageModel *Get(const CAlphInfo *pAlph, CMessageDisplay *pMsgs) {
+    SModel *pModel;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      SModel *&p(m_mModels[pAlph->GetID()]);
+      if (!p) p = new SModel();
+      pModel = p;
+    }
+    std::lock_guard<std::mutex> lock(pModel->mutex);
+    if (!pModel->pLM) {
+      CAlphabetMap map;
+      CAlphabetManager::MapSymbols(pAlph, map);
+      CPPMLanguageModel *pLM = new CPPMLanguageModel(this, pAlph->iEnd-1);
+      if (!pAlph->GetTrainingFile().empty()) {
+        CTrainer trainer(pMsgs, pLM, pAlph, &map);
+        for (const char * const *szSuffix = CTrainingInput::SUFFIXES; *szSuffix; szSuffix++)
+          m_pFileUtils->ScanFiles(&trainer, pAlph->GetTrainingFile() + *szSuffix);
+      }
+      if (s_bVerbose) fprintf(stderr, "Trained shared model for \"%s\"\n", pAlph->GetID().c_str());
+      pModel->pLM = pLM;
+    }
+    return pModel->pLM;
+  }
+
+private:
+  struct SModel {
+    SModel() : pLM(NULL) {}
+    ///Held while training
+    std::mutex mutex;
+    CLanguageModel *pLM;
+  };
+  CFileUtils * const m_pFileUtils;
+  ///Guards m_mModels (but not its elements)
+  std::mutex m_mutex;
+  std::map<string, SModel *> m_mModels;
+};
+
+///Sends a message to a client, blocking until it has all been written.
+static bool Send(int iFd, uint32_t iType, const string &strPayload) {
+  SMessageHeader header;
+  header.iType = iType;
+  header.iLength = static_cast<uint32_t>(strPayload.length());
+  string strMsg(reinterpret_cast<const char *>(&header), sizeof(header));
+  strMsg += strPayload;
+  for (size_t iSent = 0; iSent < strMsg.length(); ) {
+    const ssize_t n(send(iFd, strMsg.data() + iSent, strMsg.length() - iSent, MSG_NOSIGNAL));
+    if (n <= 0) return false;
+    iSent += n;
+  }
+  return true;
+}
+
+class CSession;
+
+///A client connection. The IO thread reads messages into the inbox; each frame,
+/// one of the worker threads steps the session, having first handled them.
+struct SConnection {
+  SConnection(int fd) : iFd(fd), bClosed(false), bQueued(false), bDone(false),
+    pSettings(NULL), pSession(NULL), iNumNodes(0), bFailed(false) {}
+  const int iFd;
+
+  ///Guards vInbox and bClosed
+  std::mutex inboxMutex;
+  vector<std::pair<uint32_t, string> > vInbox;
+  ///Client has disconnected (or sent something unreadable), or the server is stopping
+  bool bClosed;
+  ///Whether a step is waiting for, or running on, a worker
+  std::atomic<bool> bQueued;
+  ///Set by the worker once the session is deleted; then the IO thread closes the socket
+  std::atomic<bool> bDone;
+
+  //Only accessed by the worker stepping the session (with a node count scope on iNumNodes):
+  CDefaultSettings *pSettings;
+  CSession *pSession;
+  ///Nodes in this session's tree
+  int iNumNodes;
+  ///A send to the client failed, or it sent something bad
+  bool bFailed;
+
+  //Only accessed by the IO thread:
+  string strRead;
+};
+
+///Pointer position last sent by the client
+class CSessionInput : public CScreenCoordInput {
+public:
+  CSessionInput() : CScreenCoordInput(0, "Mouse Input"), m_bHave(false), m_iX(0), m_iY(0) {}
+  void SetPosition(screenint iX, screenint iY) {m_iX = iX; m_iY = iY; m_bHave = true;}
+  bool GetScreenCoords(screenint &iX, screenint &iY, CDasherView *pView) {
+    if (!m_bHave) return false;
+    iX = m_iX; iY = m_iY;
+    return true;
+  }
+private:
+  bool m_bHave;
+  screenint m_iX, m_iY;
+};
+
+class CSession : public CDashIntfSettings {
+public:
+  CSession(SConnection *pConn, CSettingsStore *pSettings, CFileUtils *pFileUtils, CSharedModels *pModels, screenint iWidth, screenint iHeight)
+  : CDashIntfSettings(pSettings, pFileUtils), m_pConn(pConn), m_pModels(pModels), m_screen(iWidth, iHeight), m_pInput(NULL) {
+  }
+
+  void Start() {
+    ChangeScreen(&m_screen);
+    Realize(Now());
+  }
+
+  ///Renders a frame, if one is due within iPeriod ms
+  void Step(unsigned long iPeriod) {
+    if (GetFrameDelay() < static_cast<long>(iPeriod * 1000)) NewFrame(Now(), false);
+  }
+
+  void SetPointer(screenint iX, screenint iY) {
+    if (m_pInput) m_pInput->SetPosition(iX, iY);
+  }
+
+  CLanguageModel *GetSharedLanguageModel(const CAlphInfo *pAlphabet) {
+    return m_pModels->Get(pAlphabet, this);
+  }
+
+  void Message(const std::string &strText, bool bInterrupt) {
+    if (s_bVerbose) fprintf(stderr, "[%d] %s\n", m_pConn->iFd, strText.c_str());
+    SendToClient(MSG_MESSAGE, strText);
+  }
+
+  //Edit buffer: only ever appended to, or deleted from, at the end; the client
+  // is told of each change. Positions are in bytes rather than characters,
+  // which is fine for context.
+  void editOutput(const std::string &strText, CDasherNode *pCause) {
+    m_strBuffer += strText;
+    SendToClient(MSG_OUTPUT, strText);
+    CDashIntfSettings::editOutput(strText, pCause);
+  }
+
+  void editDelete(const std::string &strText, CDasherNode *pCause) {
+    DeleteFromEnd(strText.length());
+    CDashIntfSettings::editDelete(strText, pCause);
+  }
+
+  unsigned int ctrlMove(bool bForwards, CControlManager::EditDistance dist) {
+    return m_strBuffer.length();
+  }
+
+  unsigned int ctrlDelete(bool bForwards, CControlManager::EditDistance dist) {
+    if (!bForwards) DeleteFromEnd(dist == CControlManager::EDIT_CHAR ? 1 : m_strBuffer.length());
+    return m_strBuffer.length();
+  }
+
+  std::string GetContext(unsigned int iStart, unsigned int iLength) {
+    return iStart < m_strBuffer.length() ? m_strBuffer.substr(iStart, iLength) : "";
+  }
+
+  std::string GetAllContext() {return m_strBuffer;}
+
+  int GetAllContextLenght() {return m_strBuffer.length();}
+
+protected:
+  void CreateModules() {
+    CDashIntfSettings::CreateModules();
+    m_pInput = new CSessionInput();
+    RegisterModule(m_pInput);
+    SetDefaultInputDevice(m_pInput);
+  }
+
+  ///Game mode is not supported (there is no input filter to enter it)
+  CGameModule *CreateGameModule() {
+    return NULL;
+  }
+
+private:
+  void SendToClient(uint32_t iType, const string &strText) {
+    if (!m_pConn->bFailed && !Send(m_pConn->iFd, iType, strText)) m_pConn->bFailed = true;
+  }
+
+  void DeleteFromEnd(size_t iLength) {
+    iLength = std::min(iLength, m_strBuffer.length());
+    if (!iLength) return;
+    SendToClient(MSG_DELETE, m_strBuffer.substr(m_strBuffer.length() - iLength));
+    m_strBuffer.erase(m_strBuffer.length() - iLength);
+  }
+
+  SConnection * const m_pConn;
+  CSharedModels * const m_pModels;
+  CNullScreen m_screen;
+  CSessionInput *m_pInput;
+  std::string m_strBuffer;
+};
+
+///Fixed number of threads running tasks in the order submitted.
+class CThreadPool {
+public:
+  CThreadPool(unsigned int iThreads) : m_bStop(false) {
+    for (unsigned int i=0; i<iThreads; i++)
+      m_vThreads.push_back(std::thread(&CThreadPool::Run, this));
+  }
+
+  ///Finishes all tasks submitted, then stops.
+  ~CThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_bStop = true;
+    }
+    m_cond.notify_all();
+    for (size_t i=0; i<m_vThreads.size(); i++) m_vThreads[i].join();
+  }
+
+  void Submit(const std::function<void()> &task) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_qTasks.push_back(task);
+    }
+    m_cond.notify_one();
+  }
+
+private:
+  void Run() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this]{return m_bStop || !m_qTasks.empty();});
+        if (m_qTasks.empty()) return;
+        task = m_qTasks.front();
+        m_qTasks.pop_front();
+      }
+      task();
+    }
+  }
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::deque<std::function<void()> > m_qTasks;
+  bool m_bStop;
+  vector<std::thread> m_vThreads;
+};
+
+static int32_t GetInt(const string &strPayload, size_t iPos) {
+  int32_t i;
+  memcpy(&i, strPayload.data() + iPos, sizeof(i));
+  return i;
+}
+
+///Per-session settings which the server imposes
+struct SServerConfig {
+  CDataDirFileUtils *pFileUtils;
+  CSharedModels *pModels;
+  long iNodeBudget;
+  unsigned long iPeriod;
+};
+
+///Parameters a client may change by MSG_SET: those of speed, input and display.
+/// Anything else (NodeBudget, logging, tracing, files, the language model shared
+/// with other sessions...) is for the server alone.
+static const char *const s_aClientParams[] = {
+  //speed
+  "MaxBitRateTimes100", "AutoSpeedControl", "AutospeedSensitivity", "SlowStart",
+  "SlowStartTime", "TurboMode", "ExactDynamics", "XLimitSpeed",
+  "DynamicSpeedInc", "DynamicSpeedDec", "DynamicSpeedFreq",
+  //input
+  "InputFilter", "StartOnLeft", "StartOnSpace", "CircleStart", "CirclePercent",
+  "StartOnMousePosition", "MousePositionBoxDistance", "PauseOutside",
+  "HoldTime", "TapTime", "MultipressTime", "BackoffButton", "Autocalibrate",
+  "ButtonMenuBoxes", "ButtonMenuScanTime", "ButtonMenuSafety",
+  "ButtonModeNonuniformity", "ButtonCompassModeRightZoom", "ClickMaxZoom",
+  "Zoomsteps", "Static1BTime", "Static1BZoom", "DynamicButtonLag",
+  "TwoButtonOffset", "TwoButtonReverse", "TwoButtonInvertDouble",
+  "TwoPushLong", "TwoPushShort", "TwoPushOuter", "TwoPushTolerance",
+  "TwoPushReleaseTime", "RemapXtreme", "NonlinearY", "NonLinearX", "YScaling",
+  "TargetOffset", "MarginWidth", "Geometry",
+  //display
+  "DasherFontSize", "DasherFont", "ColourID", "ScreenOrientation", "RenderStyle",
+  "LineWidth", "OutlineWidth", "DrawMouse", "DrawMouseLine", "CurveMouseLine",
+  "MinNodeSize", "MessageFontSize", "MessageTime", "PaletteChange",
+};
+
+static bool ClientMaySet(const string &strKey) {
+  for (const char *szParam : s_aClientParams)
+    if (strKey == szParam) return true;
+  return false;
+}
+
+///Handles a message from the client; false if it was bad.
+static bool Handle(SConnection *pConn, const SServerConfig &config, uint32_t iType, const string &strPayload) {
+  if (iType == MSG_OPEN) {
+    if (pConn->pSession || strPayload.length() < 2*sizeof(int32_t)) return false;
+    const int32_t iWidth(GetInt(strPayload, 0)), iHeight(GetInt(strPayload, sizeof(int32_t)));
+    if (iWidth <= 0 || iHeight <= 0) return false;
+    pConn->pSettings = new CDefaultSettings();
+    const string strAlph(strPayload.substr(2*sizeof(int32_t)));
+    if (!strAlph.empty()) pConn->pSettings->SetStringParameter(SP_ALPHABET_ID, strAlph);
+    if (config.iNodeBudget > 0) pConn->pSettings->SetLongParameter(LP_NODE_BUDGET, config.iNodeBudget);
+    pConn->pSettings->SetLongParameter(LP_USER_LOG_LEVEL_MASK, 0);
+    pConn->pSession = new CSession(pConn, pConn->pSettings, config.pFileUtils, config.pModels, iWidth, iHeight);
+    pConn->pSession->Start();
+    if (s_bVerbose) fprintf(stderr, "[%d] opened, writing \"%s\"\n", pConn->iFd, pConn->pSession->GetStringParameter(SP_ALPHABET_ID).c_str());
+    if (!Send(pConn->iFd, MSG_READY, pConn->pSession->GetStringParameter(SP_ALPHABET_ID))) pConn->bFailed = true;
+    return true;
+  }
+  if (!pConn->pSession) return false;
+  switch (iType) {
+    case MSG_POINTER:
+      if (strPayload.length() != 2*sizeof(int32_t)) return false;
+      pConn->pSession->SetPointer(GetInt(strPayload, 0), GetInt(strPayload, sizeof(int32_t)));
+      return true;
+    case MSG_KEY_DOWN:
+    case MSG_KEY_UP:
+      if (strPayload.length() != sizeof(int32_t)) return false;
+      if (iType == MSG_KEY_DOWN)
+        pConn->pSession->KeyDown(Now(), GetInt(strPayload, 0));
+      else
+        pConn->pSession->KeyUp(Now(), GetInt(strPayload, 0));
+      return true;
+    case MSG_SET: {
+      const size_t iEq(strPayload.find('='));
+      if (iEq == string::npos) return false;
+      const string strKey(strPayload.substr(0, iEq));
+      if (!ClientMaySet(strKey))
+        pConn->pSession->Message("Parameter " + strKey + " cannot be set by clients", false);
+      else if (const char *szErr = pConn->pSession->ClSet(strKey, strPayload.substr(iEq+1)))
+        pConn->pSession->Message(szErr, false);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+///Runs on a worker: handles messages received since the last step, then renders
+/// a frame if one is due; or, if the connection is closed, deletes the session.
+static void Step(SConnection *pConn, const SServerConfig &config) {
+  //all nodes of a session's tree are created and deleted here
+  CNodeCountScope scope(pConn->iNumNodes);
+  vector<std::pair<uint32_t, string> > vInbox;
+  bool bClosed;
+  {
+    std::lock_guard<std::mutex> lock(pConn->inboxMutex);
+    vInbox.swap(pConn->vInbox);
+    bClosed = pConn->bClosed;
+  }
+  for (size_t i=0; i<vInbox.size() && !bClosed && !pConn->bFailed; i++)
+    if (!Handle(pConn, config, vInbox[i].first, vInbox[i].second)) {
+      Send(pConn->iFd, MSG_ERROR, "Bad request");
+      pConn->bFailed = true;
+    }
+  if (bClosed || pConn->bFailed) {
+    if (s_bVerbose && pConn->pSession) fprintf(stderr, "[%d] closed\n", pConn->iFd);
+    delete pConn->pSession;
+    pConn->pSession = NULL;
+    delete pConn->pSettings;
+    pConn->pSettings = NULL;
+    //wake the IO thread's poll, if it is still reading; it closes the socket
+    shutdown(pConn->iFd, SHUT_RDWR);
+    pConn->bDone = true;
+  } else if (pConn->pSession)
+    pConn->pSession->Step(config.iPeriod);
+  pConn->bQueued = false;
+}
+
+///Reads what the client has sent, moving complete messages to the inbox.
+/// \return false if the client has disconnected or sent something bad
+static bool Read(SConnection *pConn) {
+  char buf[4096];
+  const ssize_t n(read(pConn->iFd, buf, sizeof(buf)));
+  if (n <= 0) return false;
+  pConn->strRead.append(buf, n);
+  size_t iPos(0);
+  vector<std::pair<uint32_t, string> > vMsgs;
+  while (pConn->strRead.length() - iPos >= sizeof(SMessageHeader)) {
+    SMessageHeader header;
+    memcpy(&header, pConn->strRead.data() + iPos, sizeof(header));
+    if (header.iLength > MAX_PAYLOAD) return false;
+    if (pConn->strRead.length() - iPos - sizeof(header) < header.iLength) break;
+    vMsgs.push_back(std::make_pair(header.iType, pConn->strRead.substr(iPos + sizeof(header), header.iLength)));
+    iPos += sizeof(header) + header.iLength;
+  }
+  pConn->strRead.erase(0, iPos);
+  if (!vMsgs.empty()) {
+    std::lock_guard<std::mutex> lock(pConn->inboxMutex);
+    pConn->vInbox.insert(pConn->vInbox.end(), vMsgs.begin(), vMsgs.end());
+  }
+  return true;
+}
+
+static void Close(SConnection *pConn) {
+  std::lock_guard<std::mutex> lock(pConn->inboxMutex);
+  pConn->bClosed = true;
+}
+
+static volatile sig_atomic_t s_bStop(0);
+
+static void OnSignal(int) {
+  s_bStop = 1;
+}
+
+static int Usage(const char *szName) {
+  fprintf(stderr, "Usage: %s -s socket -d datadir [-d datadir...] [-j threads] [-f fps] [-n budget] [-v]\n", szName);
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  vector<string> vDirs;
+  string strSocket;
+  unsigned int iThreads(std::max(1u, std::thread::hardware_concurrency()));
+  double dFPS(40.0);
+  long iNodeBudget(0);
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) s_bVerbose = true;
+    else if (i+1 >= argc) return Usage(argv[0]);
+    else if (!strcmp(argv[i], "-s")) strSocket = argv[++i];
+    else if (!strcmp(argv[i], "-d")) vDirs.push_back(argv[++i]);
+    else if (!strcmp(argv[i], "-j")) iThreads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-f")) dFPS = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-n")) iNodeBudget = atol(argv[++i]);
+    else return Usage(argv[0]);
+  }
+  sockaddr_un addr;
+  if (strSocket.empty() || strSocket.length() >= sizeof(addr.sun_path) || vDirs.empty() || iThreads == 0 || dFPS <= 0)
+    return Usage(argv[0]);
+
+  const int iListen(socket(AF_UNIX, SOCK_STREAM, 0));
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, strSocket.c_str());
+  unlink(strSocket.c_str());
+  if (iListen < 0 || bind(iListen, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) || listen(iListen, 16)) {
+    perror(strSocket.c_str());
+    return 1;
+  }
+  signal(SIGINT, OnSignal);
+  signal(SIGTERM, OnSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  CDataDirFileUtils fileUtils(vDirs);
+  CDefaultSettings modelSettings;
+  CSharedModels models(&modelSettings, &fileUtils);
+  SServerConfig config;
+  config.pFileUtils = &fileUtils;
+  config.pModels = &models;
+  config.iNodeBudget = iNodeBudget;
+  config.iPeriod = std::max(1UL, static_cast<unsigned long>(1000.0 / dFPS));
+  vector<std::shared_ptr<SConnection> > vConns;
+  {
+    CThreadPool pool(iThreads);
+    unsigned long iNextTick(Now());
+    //once stopping, we wait for every session to be deleted
+    while (!s_bStop || !vConns.empty()) {
+      vector<pollfd> vPoll;
+      vector<SConnection *> vPolled;
+      pollfd pfd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      if (!s_bStop) {
+        pfd.fd = iListen;
+        vPoll.push_back(pfd);
+        vPolled.push_back(NULL);
+      }
+      for (size_t i=0; i<vConns.size(); i++) {
+        std::lock_guard<std::mutex> lock(vConns[i]->inboxMutex);
+        if (s_bStop) vConns[i]->bClosed = true;
+        if (vConns[i]->bClosed) continue;
+        pfd.fd = vConns[i]->iFd;
+        vPoll.push_back(pfd);
+        vPolled.push_back(vConns[i].get());
+      }
+      const unsigned long iNow(Now());
+      const int iTimeout(iNextTick > iNow ? static_cast<int>(iNextTick - iNow) : 0);
+      if (poll(vPoll.empty() ? NULL : &vPoll[0], vPoll.size(), iTimeout) > 0)
+        for (size_t i=0; i<vPoll.size(); i++) {
+          if (!vPoll[i].revents) continue;
+          if (!vPolled[i]) {
+            const int iFd(accept(iListen, NULL, NULL));
+            if (iFd >= 0) vConns.push_back(std::shared_ptr<SConnection>(new SConnection(iFd)));
+          } else if (!Read(vPolled[i]))
+            Close(vPolled[i]);
+        }
+      if (Now() < iNextTick) continue;
+      iNextTick += config.iPeriod;
+      //if we've fallen behind (too many sessions for the threads), drop frames rather than catch up
+      iNextTick = std::max(iNextTick, Now());
+      for (size_t i=0; i<vConns.size(); ) {
+        std::shared_ptr<SConnection> pConn(vConns[i]);
+        if (pConn->bDone) {
+          close(pConn->iFd);
+          vConns.erase(vConns.begin() + i);
+          continue;
+        }
+        //a session still being stepped from the last tick misses this one
+        if (!pConn->bQueued.exchange(true))
+          pool.Submit([pConn, &config]() {Step(pConn.get(), config);});
+        i++;
+      }
+    }
+  }
+  close(iListen);
+  unlink(strSocket.c_str());
+  return 0;
+}
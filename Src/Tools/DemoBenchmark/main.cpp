@@ -0,0 +1,299 @@
+// Command line application that measures how fast Dasher can be written with,
+// and how much CPU that costs, for different alphabets, language models and
+// node budgets, without any human trials: the demo filter (a simulated user,
+// steering towards each target sentence in game mode) drives the full model,
+// view and expansion policy, on a virtual clock, as fast as the CPU allows.
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// Usage: DemoBenchmark -d datadir [-d datadir...] [-c corpus] [-a alphabet[,alphabet...]]
+//                      [-l lm[,lm...]] [-n budget[,budget...]] [-r bitrate] [-f fps]
+//                      [-j ms] [-t seconds] [-s seed] [-m] [-v]
+//   -d  directory containing alphabet, colour and training files (repeat for several)
+//   -c  sentences to write, one per line (GameTextFile; default the alphabet's own)
+//   -a  AlphabetID(s) to benchmark (default the default alphabet)
+//   -l  LanguageModelID(s) (default 0 = PPM)
+//   -n  NodeBudget(s) (default the default NodeBudget)
+//   -r  MaxBitRateTimes100, i.e. speed of the simulated user (default the default)
+//   -f  frames per simulated second (default 40)
+//   -j  delay up to this many ms (uniformly at random) each frame, as if
+//       rendering stuttered; so the frame rate fluctuates (default 0)
+//   -t  simulated seconds to run each configuration for, at most (default 600)
+//   -s  seed for the random number generator (default 1), so runs are repeatable
+//   -m  also report the memory in use at the end of each run (see CMemoryReport):
+//       the total as an extra column, and the full report as JSON to stderr
+//   -v  print messages from Dasher (including per-sentence statistics) to stderr
+//
+// Prints one line per configuration (every combination of -a, -l and -n):
+// characters per minute and bits per second written (over completed sentences,
+// in simulated time), CPU milliseconds per simulated second, and node
+// expansions per character written.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+
+#include "../../DasherCore/DashIntfSettings.h"
+#include "../../DasherCore/DasherModel.h"
+#include "../../DasherCore/DasherScreen.h"
+#include "../../DasherCore/DemoFilter.h"
+#include "../../DasherCore/GameModule.h"
+#include "../../DasherCore/MemoryReport.h"
+#include "../../DasherCore/SettingsStore.h"
+#include "../ToolSupport.h"
+
+using namespace Dasher;
+using std::string;
+using std::vector;
+
+///Screen which draws nothing. Nodes are still laid out, and labels created
+/// and measured (as if in a fixed-width font), just as on a real screen.
+class CNullScreen : public CDasherScreen {
+public:
+  CNullScreen(screenint iWidth, screenint iHeight) : CDasherScreen(iWidth, iHeight) {}
+  std::pair<screenint,screenint> TextSize(Label *label, unsigned int iFontSize) {
+    return std::pair<screenint,screenint>(static_cast<screenint>(label->m_strText.length()*iFontSize/2), iFontSize);
+  }
+  void DrawString(Label *label, screenint x, screenint y, unsigned int iFontSize, int iColour) {}
+  void DrawRectangle(screenint x1, screenint y1, screenint x2, screenint y2, int Colour, int iOutlineColour, int iThickness) {}
+  void DrawCircle(screenint iCX, screenint iCY, screenint iR, int iFillColour, int iLineColour, int iLineWidth) {}
+  void Polyline(point *Points, int Number, int iWidth, int Colour) {}
+  void Polygon(point *Points, int Number, int fillColour, int outlineColour, int lineWidth) {}
+  void Display() {}
+  void SetColourScheme(const CColourIO::ColourInfo *pColourScheme) {}
+  bool IsWindowUnderCursor() {return true;}
+};
+
+///Results of running one configuration
+struct SResults {
+  SResults() : ulTotalTime(0), dTotalNats(0.0), uiTotalSyms(0), ulSimTime(0), dCPUTime(0.0), ulExpansions(0) {}
+  ///Totals over completed sentences, from the game module
+  unsigned long ulTotalTime;
+  double dTotalNats;
+  unsigned int uiTotalSyms;
+  ///Simulated time (ms) for which frames were rendered
+  unsigned long ulSimTime;
+  ///CPU time (ms) taken to render them
+  double dCPUTime;
+  ///Number of nodes expanded (populated) meanwhile
+  unsigned long ulExpansions;
+};
+
+class CBenchmarkInterface : public CDashIntfSettings, private Observer<CDasherNode *> {
+public:
+  CBenchmarkInterface(CSettingsStore *pSettings, CFileUtils *pFileUtils, bool bVerbose)
+  : CDashIntfSettings(pSettings, pFileUtils), m_screen(800, 600), m_bVerbose(bVerbose), m_pDemo(NULL), m_pResults(NULL) {
+  }
+
+  ~CBenchmarkInterface() {
+    //Leave game mode while we can still clear the (game module's) text
+    if (GetGameModule()) LeaveGameMode();
+  }
+
+  ///Writes sentences until the corpus is exhausted or iSimTime (ms) has elapsed.
+  /// \param pReport if non-NULL, receives the memory in use at the end
+  SResults Run(unsigned long ulSeed, unsigned long iSimTime, double dFPS, unsigned long iJitter, CMemoryReport *pReport) {
+    ChangeScreen(&m_screen);
+    Realize(ulSeed);
+    SResults res;
+    if (!m_pDemo || GetActiveInputMethod() != m_pDemo) {
+      fprintf(stderr, "Demo filter could not be activated\n");
+      return res;
+    }
+    m_pResults = &res;
+    m_pDasherModel->Register(this);
+    //start from 1s: the game module treats a time of 0 as "not started"
+    const unsigned long iStart(1000);
+    unsigned long iTime(iStart);
+    //separate from rand(), so jitter doesn't change what the demo filter does
+    std::minstd_rand jitter(ulSeed);
+    double dNext(iStart);
+    const clock_t cStart(clock());
+    while (GetGameModule() && iTime < iStart + iSimTime) {
+      const bool bWasPaused(m_pDemo->isPaused());
+      NewFrame(iTime, false);
+      //The demo filter pauses at the end of each sentence; restart after one
+      // frame without movement, so the next sentence's time is measured from then.
+      if (bWasPaused && m_pDemo->isPaused() && GetGameModule()) KeyDown(iTime, 0);
+      dNext += 1000.0 / dFPS + (iJitter ? jitter() % (iJitter+1) : 0);
+      iTime = static_cast<unsigned long>(dNext);
+    }
+    res.dCPUTime = (clock() - cStart) * 1000.0 / CLOCKS_PER_SEC;
+    res.ulSimTime = iTime - iStart;
+    if (pReport) GetMemoryReport(*pReport);
+    m_pDasherModel->Unregister(this);
+    if (GetGameModule()) LeaveGameMode(); //records statistics
+    m_pResults = NULL;
+    return res;
+  }
+
+  void Message(const std::string &strText, bool bInterrupt) {
+    if (m_bVerbose) fprintf(stderr, "%s\n", strText.c_str());
+  }
+
+  //Edit buffer: only ever appended to, or deleted from, at the end.
+  // Positions are in bytes, rather than characters, which is fine for context.
+  void editOutput(const std::string &strText, CDasherNode *pCause) {
+    m_strBuffer += strText;
+    CDashIntfSettings::editOutput(strText, pCause);
+  }
+
+  void editDelete(const std::string &strText, CDasherNode *pCause) {
+    m_strBuffer.erase(m_strBuffer.length() - std::min(m_strBuffer.length(), strText.length()));
+    CDashIntfSettings::editDelete(strText, pCause);
+  }
+
+  unsigned int ctrlMove(bool bForwards, CControlManager::EditDistance dist) {
+    return m_strBuffer.length();
+  }
+
+  unsigned int ctrlDelete(bool bForwards, CControlManager::EditDistance dist) {
+    if (!bForwards) {
+      if (dist == CControlManager::EDIT_CHAR) {
+        if (!m_strBuffer.empty()) m_strBuffer.erase(m_strBuffer.length()-1);
+      } else m_strBuffer.clear();
+    }
+    return m_strBuffer.length();
+  }
+
+  std::string GetContext(unsigned int iStart, unsigned int iLength) {
+    return iStart < m_strBuffer.length() ? m_strBuffer.substr(iStart, iLength) : "";
+  }
+
+  std::string GetAllContext() {return m_strBuffer;}
+
+  int GetAllContextLenght() {return m_strBuffer.length();}
+
+protected:
+  void CreateModules() {
+    CDashIntfSettings::CreateModules();
+    m_pDemo = new CDemoFilter(this, this, m_pFramerate);
+    RegisterModule(m_pDemo);
+  }
+
+  CGameModule *CreateGameModule() {
+    return new CBenchmarkGameModule(this, this, GetView(), m_pDasherModel);
+  }
+
+private:
+  ///Game module displaying nothing, which passes its statistics back when deleted
+  class CBenchmarkGameModule : public CGameModule {
+  public:
+    CBenchmarkGameModule(CBenchmarkInterface *pIntf, CDasherInterfaceBase *pInterface, CDasherView *pView, CDasherModel *pModel)
+    : CGameModule(pIntf, pInterface, pView, pModel), m_pIntf(pIntf) {}
+    ~CBenchmarkGameModule() {
+      if (SResults *pRes = m_pIntf->m_pResults) {
+        pRes->ulTotalTime = GetTotalTime();
+        pRes->dTotalNats = GetTotalNats();
+        pRes->uiTotalSyms = GetTotalSyms();
+      }
+    }
+  protected:
+    void DrawText(CDasherView *pView) {}
+  private:
+    CBenchmarkInterface * const m_pIntf;
+  };
+
+  ///Node populated, i.e. expanded
+  void HandleEvent(CDasherNode *pNode) {
+    if (m_pResults) m_pResults->ulExpansions++;
+  }
+
+  CNullScreen m_screen;
+  const bool m_bVerbose;
+  CDemoFilter *m_pDemo;
+  SResults *m_pResults;
+  std::string m_strBuffer;
+};
+
+static int Usage(const char *szName) {
+  fprintf(stderr, "Usage: %s -d datadir [-d datadir...] [-c corpus] [-a alphabet[,alphabet...]]\n"
+          "  [-l lm[,lm...]] [-n budget[,budget...]] [-r bitrate] [-f fps] [-j ms] [-t seconds] [-s seed] [-m] [-v]\n", szName);
+  return 1;
+}
+
+static vector<string> Split(const char *szList) {
+  vector<string> v;
+  std::istringstream in(szList);
+  string s;
+  while (std::getline(in, s, ',')) if (!s.empty()) v.push_back(s);
+  return v;
+}
+
+int main(int argc, char *argv[]) {
+  vector<string> vDirs, vAlphabets(1, ""), vLMs(1, "0"), vBudgets(1, "");
+  string strCorpus;
+  long iBitrate(0);
+  double dFPS(40.0), dSeconds(600.0);
+  unsigned long iJitter(0);
+  unsigned long ulSeed(1);
+  bool bVerbose(false), bMemory(false);
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) bVerbose = true;
+    else if (!strcmp(argv[i], "-m")) bMemory = true;
+    else if (i+1 >= argc) return Usage(argv[0]);
+    else if (!strcmp(argv[i], "-d")) vDirs.push_back(argv[++i]);
+    else if (!strcmp(argv[i], "-c")) strCorpus = argv[++i];
+    else if (!strcmp(argv[i], "-a")) vAlphabets = Split(argv[++i]);
+    else if (!strcmp(argv[i], "-l")) vLMs = Split(argv[++i]);
+    else if (!strcmp(argv[i], "-n")) vBudgets = Split(argv[++i]);
+    else if (!strcmp(argv[i], "-r")) iBitrate = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-f")) dFPS = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-j")) iJitter = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "-t")) dSeconds = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-s")) ulSeed = strtoul(argv[++i], NULL, 10);
+    else return Usage(argv[0]);
+  }
+  if (vDirs.empty() || vAlphabets.empty() || vLMs.empty() || vBudgets.empty() || dFPS <= 0 || dSeconds <= 0)
+    return Usage(argv[0]);
+
+  CDataDirFileUtils fileUtils(vDirs);
+  printf("%-24s %3s %6s %8s %6s %8s %8s %10s %10s%s\n",
+         "alphabet", "lm", "budget", "sim_s", "chars", "cpm", "bits/s", "cpu_ms/s", "exp/char", bMemory ? "     mem_kb" : "");
+  for (size_t a=0; a<vAlphabets.size(); a++)
+    for (size_t l=0; l<vLMs.size(); l++)
+      for (size_t n=0; n<vBudgets.size(); n++) {
+        CDefaultSettings *pSettings = new CDefaultSettings();
+        if (!vAlphabets[a].empty()) pSettings->SetStringParameter(SP_ALPHABET_ID, vAlphabets[a]);
+        pSettings->SetLongParameter(LP_LANGUAGE_MODEL_ID, atol(vLMs[l].c_str()));
+        if (!vBudgets[n].empty()) pSettings->SetLongParameter(LP_NODE_BUDGET, atol(vBudgets[n].c_str()));
+        if (iBitrate > 0) pSettings->SetLongParameter(LP_MAX_BITRATE, iBitrate);
+        pSettings->SetStringParameter(SP_GAME_TEXT_FILE, strCorpus);
+        pSettings->SetStringParameter(SP_INPUT_FILTER, "Demo Mode (no input)");
+        pSettings->SetBoolParameter(BP_START_SPACE, true);
+        //fixed budget, and no per-user state
+        pSettings->SetLongParameter(LP_TARGET_FRAME_TIME, 0);
+        pSettings->SetLongParameter(LP_USER_LOG_LEVEL_MASK, 0);
+        pSettings->SetBoolParameter(BP_LM_ADAPTIVE, false);
+
+        CBenchmarkInterface *pIntf = new CBenchmarkInterface(pSettings, &fileUtils, bVerbose);
+        CMemoryReport report;
+        const SResults res(pIntf->Run(ulSeed, static_cast<unsigned long>(dSeconds*1000.0), dFPS, iJitter, bMemory ? &report : NULL));
+        const string strAlph(pSettings->GetStringParameter(SP_ALPHABET_ID));
+        const long iBudget(pSettings->GetLongParameter(LP_NODE_BUDGET));
+        delete pIntf;
+        delete pSettings;
+
+        const double dWriteSecs(res.ulTotalTime / 1000.0), dSimSecs(res.ulSimTime / 1000.0);
+        printf("%-24s %3s %6ld %8.1f %6u %8.1f %8.2f %10.2f %10.2f",
+               strAlph.c_str(), vLMs[l].c_str(), iBudget, dSimSecs, res.uiTotalSyms,
+               dWriteSecs > 0 ? res.uiTotalSyms * 60.0 / dWriteSecs : 0.0,
+               dWriteSecs > 0 ? res.dTotalNats / log(2.0) / dWriteSecs : 0.0,
+               dSimSecs > 0 ? res.dCPUTime / dSimSecs : 0.0,
+               res.uiTotalSyms ? res.ulExpansions / static_cast<double>(res.uiTotalSyms) : 0.0);
+        if (bMemory) printf(" %10.1f", report.TotalBytes() / 1024.0);
+        printf("\n");
+        fflush(stdout);
+        if (bMemory) report.WriteJSON(std::cerr);
+      }
+  return 0;
+}
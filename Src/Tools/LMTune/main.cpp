@@ -0,0 +1,131 @@
+// Command line application for tuning the PPM language model's parameters to an
+// alphabet: trains a model on some text, then scores held-out text under every
+// combination of max order, alpha and beta requested, using the batch prediction
+// API (CLanguageModel::GetSymbolProbs) on several threads. A model is trained
+// once per max order; alpha and beta only affect prediction, so every pair of
+// them is scored against the same model.
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// Usage: LMTune -d datadir [-d datadir...] -a alphabet -t training [-t training...] -h heldout
+//               [-o order[,order...]] [-A alpha[,alpha...]] [-B beta[,beta...]] [-j threads]
+//   -d  directory containing alphabet files (repeat for several)
+//   -a  AlphabetID to write in
+//   -t  text file to train the model on (repeat for several)
+//   -h  held-out text file to score
+//   -o  LMMaxOrder(s) (default the default)
+//   -A  LMAlpha(s) (default the default)
+//   -B  LMBeta(s) (default the default)
+//   -j  threads to score with (default the number of CPUs)
+//
+// Prints one line per combination: bits per symbol of the held-out text, as
+// Dasher would predict it (i.e. after mixing in LMUniform), and the time taken
+// to score it; then the best combination.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../DasherCore/Trainer.h"
+#include "../../DasherCore/LanguageModelling/PPMLanguageModel.h"
+#include "../ToolSupport.h"
+
+using namespace Dasher;
+using std::string;
+using std::vector;
+
+static vector<long> ParseList(const char *szList) {
+  vector<long> v;
+  std::istringstream in(szList);
+  for (string s; std::getline(in, s, ',');) v.push_back(atol(s.c_str()));
+  return v;
+}
+
+static double Seconds(const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int Usage(const char *szName) {
+  fprintf(stderr, "Usage: %s -d datadir [-d datadir...] -a alphabet -t training [-t training...] -h heldout\n"
+                  "       [-o order[,order...]] [-A alpha[,alpha...]] [-B beta[,beta...]] [-j threads]\n", szName);
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  vector<string> vDirs, vTraining;
+  string strAlph, strHeldOut;
+  vector<long> vOrders, vAlphas, vBetas;
+  unsigned int iThreads(std::max(1u, std::thread::hardware_concurrency()));
+
+  for (int i = 1; i < argc; i++) {
+    if (i+1 >= argc) return Usage(argv[0]);
+    if (!strcmp(argv[i], "-d")) vDirs.push_back(argv[++i]);
+    else if (!strcmp(argv[i], "-a")) strAlph = argv[++i];
+    else if (!strcmp(argv[i], "-t")) vTraining.push_back(argv[++i]);
+    else if (!strcmp(argv[i], "-h")) strHeldOut = argv[++i];
+    else if (!strcmp(argv[i], "-o")) vOrders = ParseList(argv[++i]);
+    else if (!strcmp(argv[i], "-A")) vAlphas = ParseList(argv[++i]);
+    else if (!strcmp(argv[i], "-B")) vBetas = ParseList(argv[++i]);
+    else if (!strcmp(argv[i], "-j")) iThreads = atoi(argv[++i]);
+    else return Usage(argv[0]);
+  }
+  if (vDirs.empty() || strAlph.empty() || vTraining.empty() || strHeldOut.empty() || iThreads == 0)
+    return Usage(argv[0]);
+
+  CStderrMessages msgs;
+  CDefaultSettings settings;
+  CSettingsUser root(&settings);
+  if (vOrders.empty()) vOrders.push_back(settings.GetLongParameter(LP_LM_MAX_ORDER));
+  if (vAlphas.empty()) vAlphas.push_back(settings.GetLongParameter(LP_LM_ALPHA));
+  if (vBetas.empty()) vBetas.push_back(settings.GetLongParameter(LP_LM_BETA));
+
+  CDataDirFileUtils fileUtils(vDirs);
+  CAlphIO alphIO(&msgs);
+  const CAlphInfo *pAlph = LoadAlphabet(alphIO, fileUtils, strAlph);
+  if (!pAlph) return 1;
+  CAlphabetMap map;
+  CAlphabetManager::MapSymbols(pAlph, map);
+
+  //Score every symbol of the held-out text the alphabet knows
+  vector<symbol> vCorpus;
+  vector<size_t> vPositions;
+  if (!ReadSymbols(strHeldOut, map, &msgs, vCorpus, vPositions)) return 1;
+  const unsigned int iSymbols(pAlph->iEnd-1);
+
+  printf("%lu held-out symbols, %u threads\n", static_cast<unsigned long>(vPositions.size()), iThreads);
+  printf("order alpha beta bits/sym seconds\n");
+  double dBest(HUGE_VAL);
+  long iBestOrder(0), iBestAlpha(0), iBestBeta(0);
+  for (size_t o = 0; o < vOrders.size(); o++) {
+    settings.SetLongParameter(LP_LM_MAX_ORDER, vOrders[o]);
+    CPPMLanguageModel lm(&root, iSymbols);
+    {
+      const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+      CTrainer trainer(&msgs, &lm, pAlph, &map);
+      for (size_t i=0; i<vTraining.size(); i++)
+        trainer.ParseFile(vTraining[i], false);
+      fprintf(stderr, "Trained order %ld in %.2fs\n", vOrders[o], Seconds(start));
+    }
+    for (size_t a = 0; a < vAlphas.size(); a++) {
+      settings.SetLongParameter(LP_LM_ALPHA, vAlphas[a]);
+      for (size_t b = 0; b < vBetas.size(); b++) {
+        settings.SetLongParameter(LP_LM_BETA, vBetas[b]);
+        const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+        const double dBits(BitsPerSymbol(lm, vCorpus, vPositions, iSymbols, settings.GetLongParameter(LP_UNIFORM), iThreads));
+        printf("%5ld %5ld %4ld %8.4f %7.2f\n", vOrders[o], vAlphas[a], vBetas[b], dBits, Seconds(start));
+        if (dBits < dBest) {
+          dBest = dBits;
+          iBestOrder = vOrders[o]; iBestAlpha = vAlphas[a]; iBestBeta = vBetas[b];
+        }
+      }
+    }
+  }
+  printf("Best: LMMaxOrder=%ld LMAlpha=%ld LMBeta=%ld (%.4f bits/sym)\n", iBestOrder, iBestAlpha, iBestBeta, dBest);
+  return 0;
+}
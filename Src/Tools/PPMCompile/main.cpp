@@ -0,0 +1,462 @@
+// Command line application compiling training text straight into a PPM model
+// file, as read by CPPMLanguageModel::ReadFromFile/ReadFromStream, without
+// streaming every symbol through CAbstractPPM::LearnSymbol.
+//
+// The text is tokenised by CTrainer itself (so compressed files, and escaped
+// characters, are handled just as when Dasher trains), into segments each
+// learnt from an empty context. A PPM model of max order k has a node for
+// every string of up to k+1 symbols occurring within a segment, so sorting the
+// positions of the text by the k+1 symbols following each (a suffix array cut
+// off at that depth; its LCPs give the shape of the trie) yields all the nodes
+// in order. Their counts are then determined in closed form:
+//  - without update exclusion, every node on the vine chain is incremented each
+//    time a symbol is learnt, so a node's count is its number of occurrences;
+//  - with update exclusion, only the longest context already seen is
+//    incremented, which happens once for each distinct symbol preceding the
+//    string (i.e. each node whose vine it is) and once for each time it begins
+//    a segment; except that nodes of order k+1 count every occurrence.
+// (The root's count is 1, plus, without update exclusion, one for every symbol
+// learnt except the first occurrence of each.) Counts are truncated to 16 bits,
+// just as the node's counter would have wrapped.
+//
+// The result is the same model as CTrainer would train from the same files,
+// except where training text switches context (using the alphabet's context
+// escape character): CTrainer enters the new context, and learns what follows
+// it in that context, whereas here it is learnt from an empty context.
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// Usage: PPMCompile -d datadir [-d datadir...] -a alphabet -m model [-o order] [-u 0|1]
+//                   [-j threads] [-x] training [training...]
+//   -d  directory containing alphabet files (repeat for several)
+//   -a  AlphabetID whose symbols the model predicts
+//   -m  model file to write
+//   -o  LMMaxOrder (default the default)
+//   -u  LMUpdateExclusion (default the default)
+//   -j  threads to sort with (default the number of CPUs)
+//   -x  also train a model the usual way, and check the compiled one is the same
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../DasherCore/Trainer.h"
+#include "../../DasherCore/LanguageModelling/PPMLanguageModel.h"
+#include "../ToolSupport.h"
+
+using namespace Dasher;
+using std::string;
+using std::vector;
+
+///Language model which only records what CTrainer teaches it: the symbols learnt,
+/// with a 0 (never learnt) before each new context, i.e. between segments.
+class CRecorder : public CLanguageModel {
+public:
+  CRecorder(int iNumSyms) : CLanguageModel(iNumSyms), m_vText(1, 0) {}
+  Context CreateEmptyContext() {
+    if (m_vText.back()) m_vText.push_back(0);
+    return 1;
+  }
+  Context CloneContext(Context context) {return CreateEmptyContext();}
+  void ReleaseContext(Context context) {}
+  ///Context only (after a context switch): see header comment
+  void EnterSymbol(Context context, int Symbol) {}
+  void LearnSymbol(Context context, int Symbol) {
+    if (Symbol) m_vText.push_back(static_cast<uint16_t>(Symbol));
+  }
+  void GetProbs(Context context, std::vector<unsigned int> &Probs, int iNorm, int iUniform) const {
+    DASHER_ASSERT(false);
+  }
+  ///Symbols learnt, each segment preceded by a 0
+  vector<uint16_t> m_vText;
+};
+
+///Calls fn(iBegin, iEnd) for each of iThreads chunks of [0,iSize) in parallel
+static void ParallelFor(size_t iSize, unsigned int iThreads, const std::function<void(size_t, size_t)> &fn) {
+  vector<std::thread> vThreads;
+  for (unsigned int i = 1; i < iThreads; i++)
+    vThreads.push_back(std::thread(fn, iSize*i/iThreads, iSize*(i+1)/iThreads));
+  fn(0, iSize/iThreads);
+  for (size_t i = 0; i < vThreads.size(); i++) vThreads[i].join();
+}
+
+///Sorts keys of up to iBits bits: by radix, 11 bits at a time...
+static void SortKeys(vector<uint64_t> &vKeys, int iBits) {
+  vector<uint64_t> vTemp(vKeys.size());
+  for (int iShift = 0; iShift < iBits; iShift += 11) {
+    size_t aCounts[(1<<11) + 1] = {0};
+    for (size_t i = 0; i < vKeys.size(); i++) aCounts[((vKeys[i] >> iShift) & 0x7ff) + 1]++;
+    for (int i = 1; i <= (1<<11); i++) aCounts[i] += aCounts[i-1];
+    for (size_t i = 0; i < vKeys.size(); i++) vTemp[aCounts[(vKeys[i] >> iShift) & 0x7ff]++] = vKeys[i];
+    vKeys.swap(vTemp);
+  }
+}
+
+///...unless too long to fit in 64 bits
+static void SortKeys(vector<unsigned __int128> &vKeys, int iBits) {
+  std::sort(vKeys.begin(), vKeys.end());
+}
+
+typedef CPPMLanguageModel::BinaryRecord BinaryRecord;
+
+///Compiles text into the nodes of a PPM trie, in preorder (children in symbol order).
+/// The Key type holds the (up to) k+1 symbols following a position, each in
+/// iBits bits, the first symbol in the most significant; 0s follow the end of
+/// the segment.
+template<typename Key> class CCompiler {
+public:
+  CCompiler(const vector<uint16_t> &vText, int iDepth, int iBits, bool bUpdateExclusion, unsigned int iThreads)
+  : m_vText(vText), m_iDepth(iDepth), m_iBits(iBits), m_bUpdateExclusion(bUpdateExclusion), m_iThreads(iThreads),
+    m_fullMask(iDepth * iBits == 8 * sizeof(Key) ? ~Key(0) : (Key(1) << (iDepth * iBits)) - 1) {}
+
+  void Compile() {
+    Sort();
+    BuildTrie();
+    LinkVines();
+    Count();
+  }
+
+  ///Writes the nodes, in preorder
+  bool Write(std::ostream &out) {
+    const size_t iNodes(m_vSym.size());
+    vector<int> vIdx(iNodes, 0);
+    int iNextIdx(1);
+    auto GetIndex = [&](int iNode) {
+      if (iNode < 0) return 0;
+      if (!vIdx[iNode]) vIdx[iNode] = iNextIdx++;
+      return vIdx[iNode];
+    };
+    for (size_t i = 0; i < iNodes; i++) {
+      BinaryRecord sBR;
+      sBR.SetIndices(GetIndex, static_cast<int>(i), m_vNext[i], m_vVine[i],
+                     i+1 < iNodes && m_vDepth[i+1] == m_vDepth[i]+1 ? static_cast<int>(i+1) : -1);
+      sBR.m_iCount = static_cast<unsigned short>(m_vCount[i]);
+      sBR.m_iSymbol = m_vSym[i];
+      out.write(reinterpret_cast<char *>(&sBR), sizeof(sBR));
+    }
+    return out.good();
+  }
+
+  size_t NumNodes() const {return m_vSym.size();}
+  size_t NumGrams() const {return m_vGrams.size();}
+
+private:
+  ///A distinct string of (up to) k+1 symbols
+  struct SGram {
+    Key key;
+    ///Number of positions followed by it, and how many of those begin segments
+    uint32_t iOcc, iStarts;
+    bool operator<(const SGram &other) const {return key < other.key;}
+  };
+
+  uint16_t Symbol(Key key, int iPos) const {
+    return static_cast<uint16_t>((key >> ((m_iDepth - 1 - iPos) * m_iBits)) & ((Key(1) << m_iBits) - 1));
+  }
+
+  int Length(Key key) const {
+    int i(0);
+    while (i < m_iDepth && Symbol(key, i)) i++;
+    return i;
+  }
+
+  ///Symbols in common at the start of two keys
+  int CommonPrefix(Key a, Key b) const {
+    int i(0);
+    while (i < m_iDepth && Symbol(a, i) == Symbol(b, i)) i++;
+    return i;
+  }
+
+  ///Sorts and counts the strings following every position, a block per thread,
+  /// then merges the blocks, pairwise in parallel.
+  void Sort() {
+    const size_t iBlocks(m_iThreads);
+    vector<vector<SGram> > vBlocks(iBlocks);
+    const size_t iLength(m_vText.size() - m_iDepth); //m_vText ends with m_iDepth 0s
+    ParallelFor(iBlocks, m_iThreads, [&](size_t iBegin, size_t iEnd) {
+      for (size_t b = iBegin; b < iEnd; b++) {
+        //the string after each position, with (in the low bit) whether the position begins a segment
+        vector<Key> vKeys;
+        vKeys.reserve(iLength*(b+1)/iBlocks - iLength*b/iBlocks);
+        for (size_t p = iLength*b/iBlocks; p < iLength*(b+1)/iBlocks; p++) {
+          if (!m_vText[p]) continue;
+          Key key(0);
+          for (int d = 0; d < m_iDepth && m_vText[p+d]; d++)
+            key |= Key(m_vText[p+d]) << ((m_iDepth - 1 - d) * m_iBits);
+          vKeys.push_back(key << 1 | (m_vText[p-1] ? 0 : 1));
+        }
+        SortKeys(vKeys, m_iDepth * m_iBits + 1);
+        vector<SGram> &vGrams(vBlocks[b]);
+        for (size_t i = 0; i < vKeys.size(); i++) {
+          const Key key(vKeys[i] >> 1);
+          if (vGrams.empty() || vGrams.back().key != key) {
+            SGram gram;
+            gram.key = key;
+            gram.iOcc = gram.iStarts = 0;
+            vGrams.push_back(gram);
+          }
+          vGrams.back().iOcc++;
+          vGrams.back().iStarts += static_cast<uint32_t>(vKeys[i] & 1);
+        }
+        vGrams.shrink_to_fit();
+      }
+    });
+    while (vBlocks.size() > 1) {
+      vector<vector<SGram> > vMerged((vBlocks.size() + 1) / 2);
+      ParallelFor(vMerged.size(), std::min<size_t>(m_iThreads, vMerged.size()), [&](size_t iBegin, size_t iEnd) {
+        for (size_t i = iBegin; i < iEnd; i++) {
+          if (2*i+1 == vBlocks.size()) {
+            vMerged[i].swap(vBlocks[2*i]);
+            continue;
+          }
+          vector<SGram> &a(vBlocks[2*i]), &b(vBlocks[2*i+1]);
+          vMerged[i].resize(a.size() + b.size());
+          std::merge(a.begin(), a.end(), b.begin(), b.end(), vMerged[i].begin());
+          vector<SGram>().swap(a);
+          vector<SGram>().swap(b);
+          Dedupe(vMerged[i]);
+        }
+      });
+      vBlocks.swap(vMerged);
+    }
+    m_vGrams.swap(vBlocks[0]);
+  }
+
+  ///Combines runs of equal keys in a sorted vector
+  static void Dedupe(vector<SGram> &vGrams) {
+    size_t iOut(0);
+    for (size_t i = 0; i < vGrams.size(); i++) {
+      if (iOut && vGrams[iOut-1].key == vGrams[i].key) {
+        vGrams[iOut-1].iOcc += vGrams[i].iOcc;
+        vGrams[iOut-1].iStarts += vGrams[i].iStarts;
+      } else
+        vGrams[iOut++] = vGrams[i];
+    }
+    vGrams.resize(iOut);
+    vGrams.shrink_to_fit();
+  }
+
+  ///Makes a node for each distinct prefix of the sorted strings, in preorder:
+  /// each string adds nodes for its symbols beyond those it has in common with
+  /// the one before.
+  void BuildTrie() {
+    const size_t iGrams(m_vGrams.size());
+    m_vFirstNode.resize(iGrams);
+    m_vCommon.resize(iGrams);
+    AddNode(0, static_cast<uint16_t>(-1), -1); //root
+    vector<int> vPath(m_iDepth + 1, 0), vLast(m_iDepth + 1, -1);
+    for (size_t g = 0; g < iGrams; g++) {
+      const Key key(m_vGrams[g].key);
+      const int iCommon(g ? CommonPrefix(m_vGrams[g-1].key, key) : 0), iLen(Length(key));
+      DASHER_ASSERT(iLen > iCommon);
+      m_vCommon[g] = static_cast<uint8_t>(iCommon);
+      m_vFirstNode[g] = m_vSym.size();
+      for (int d = iCommon + 1; d <= iLen; d++) {
+        const int iNode(AddNode(d, Symbol(key, d-1), g));
+        if (vLast[d] >= 0) m_vNext[vLast[d]] = iNode;
+        vLast[d] = iNode;
+        std::fill(vLast.begin() + d + 1, vLast.end(), -1);
+        vPath[d] = iNode;
+      }
+      for (int d = 1; d <= iLen; d++) {
+        m_vOcc[vPath[d]] += m_vGrams[g].iOcc;
+        m_vStarts[vPath[d]] += m_vGrams[g].iStarts;
+      }
+    }
+  }
+
+  int AddNode(int iDepth, uint16_t iSym, size_t iGram) {
+    m_vSym.push_back(iSym);
+    m_vDepth.push_back(static_cast<uint8_t>(iDepth));
+    m_vGram.push_back(static_cast<uint32_t>(iGram));
+    m_vOcc.push_back(0);
+    m_vStarts.push_back(0);
+    m_vNext.push_back(-1);
+    return static_cast<int>(m_vSym.size() - 1);
+  }
+
+  ///The vine of (the node for) a string is the node for the same string without
+  /// its first symbol: i.e. at one less depth, on the path of the first string
+  /// (in sorted order) beginning with that.
+  void LinkVines() {
+    m_vVine.assign(m_vSym.size(), 0);
+    m_vVine[0] = -1;
+    ParallelFor(m_vSym.size(), m_iThreads, [&](size_t iBegin, size_t iEnd) {
+      for (size_t i = std::max<size_t>(iBegin, 1); i < iEnd; i++) {
+        const int iDepth(m_vDepth[i]);
+        if (iDepth == 1) continue;
+        //keep the first iDepth-1 symbols, having shifted out the first
+        const Key mask((~Key(0) << ((m_iDepth - iDepth + 1) * m_iBits)) & m_fullMask);
+        SGram target;
+        target.key = (m_vGrams[m_vGram[i]].key << m_iBits) & mask;
+        const size_t g(std::lower_bound(m_vGrams.begin(), m_vGrams.end(), target) - m_vGrams.begin());
+        DASHER_ASSERT(g < m_vGrams.size() && m_vCommon[g] < iDepth - 1);
+        m_vVine[i] = static_cast<int>(m_vFirstNode[g] + (iDepth - 1) - (m_vCommon[g] + 1));
+        DASHER_ASSERT(m_vDepth[m_vVine[i]] == iDepth - 1);
+      }
+    });
+  }
+
+  void Count() {
+    const size_t iNodes(m_vSym.size());
+    m_vCount.resize(iNodes);
+    if (m_bUpdateExclusion) {
+      vector<uint32_t> vVinedTo(iNodes, 0);
+      for (size_t i = 1; i < iNodes; i++) vVinedTo[m_vVine[i]]++;
+      for (size_t i = 1; i < iNodes; i++)
+        m_vCount[i] = m_vDepth[i] == m_iDepth ? m_vOcc[i] : vVinedTo[i] + m_vStarts[i];
+      m_vCount[0] = 1;
+    } else {
+      uint32_t iFirsts(0), iLearnt(0);
+      for (size_t i = 1; i < iNodes; i++) {
+        m_vCount[i] = m_vOcc[i];
+        if (m_vDepth[i] == 1) {
+          iFirsts++;
+          iLearnt += m_vOcc[i];
+        }
+      }
+      m_vCount[0] = 1 + iLearnt - iFirsts;
+    }
+  }
+
+  const vector<uint16_t> &m_vText;
+  const int m_iDepth, m_iBits;
+  const bool m_bUpdateExclusion;
+  const unsigned int m_iThreads;
+  ///Bits of a Key used to hold symbols
+  const Key m_fullMask;
+
+  vector<SGram> m_vGrams;
+  ///For each gram, the first node it added, and the number of symbols it has
+  /// in common with the gram before (so it added nodes for depths beyond that)
+  vector<size_t> m_vFirstNode;
+  vector<uint8_t> m_vCommon;
+
+  //Nodes, in preorder; node 0 is the root
+  vector<uint16_t> m_vSym;
+  vector<uint8_t> m_vDepth;
+  ///Gram which added the node, i.e. the first beginning with its string
+  vector<uint32_t> m_vGram;
+  vector<uint32_t> m_vOcc, m_vStarts, m_vCount;
+  ///Next sibling, and vine (-1 for none)
+  vector<int> m_vNext, m_vVine;
+};
+
+static double Seconds(const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Key> static bool Compile(const vector<uint16_t> &vText, int iDepth, int iBits, bool bUpdateExclusion, unsigned int iThreads, const string &strModel) {
+  std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+  CCompiler<Key> compiler(vText, iDepth, iBits, bUpdateExclusion, iThreads);
+  compiler.Compile();
+  fprintf(stderr, "%lu distinct strings, %lu nodes, in %.2fs\n", static_cast<unsigned long>(compiler.NumGrams()),
+          static_cast<unsigned long>(compiler.NumNodes()), Seconds(start));
+  start = std::chrono::steady_clock::now();
+  std::ofstream out(strModel.c_str(), std::ios::binary);
+  if (!compiler.Write(out)) {
+    perror(strModel.c_str());
+    return false;
+  }
+  fprintf(stderr, "Wrote %s in %.2fs\n", strModel.c_str(), Seconds(start));
+  return true;
+}
+
+static int Usage(const char *szName) {
+  fprintf(stderr, "Usage: %s -d datadir [-d datadir...] -a alphabet -m model [-o order] [-u 0|1]\n"
+                  "       [-j threads] [-x] training [training...]\n", szName);
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  vector<string> vDirs, vTraining;
+  string strAlph, strModel;
+  long iOrder(-1), iUpdateExclusion(-1);
+  unsigned int iThreads(std::max(1u, std::thread::hardware_concurrency()));
+  bool bCheck(false);
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-x")) bCheck = true;
+    else if (argv[i][0] != '-') vTraining.push_back(argv[i]);
+    else if (i+1 >= argc) return Usage(argv[0]);
+    else if (!strcmp(argv[i], "-d")) vDirs.push_back(argv[++i]);
+    else if (!strcmp(argv[i], "-a")) strAlph = argv[++i];
+    else if (!strcmp(argv[i], "-m")) strModel = argv[++i];
+    else if (!strcmp(argv[i], "-o")) iOrder = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-u")) iUpdateExclusion = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-j")) iThreads = atoi(argv[++i]);
+    else return Usage(argv[0]);
+  }
+  if (vDirs.empty() || strAlph.empty() || strModel.empty() || vTraining.empty() || iThreads == 0)
+    return Usage(argv[0]);
+
+  CStderrMessages msgs;
+  CDefaultSettings settings;
+  CSettingsUser root(&settings);
+  if (iOrder >= 0) settings.SetLongParameter(LP_LM_MAX_ORDER, iOrder);
+  if (iUpdateExclusion >= 0) settings.SetLongParameter(LP_LM_UPDATE_EXCLUSION, iUpdateExclusion);
+  const int iDepth(static_cast<int>(settings.GetLongParameter(LP_LM_MAX_ORDER)) + 1);
+  const bool bUpdateExclusion(settings.GetLongParameter(LP_LM_UPDATE_EXCLUSION) != 0);
+
+  CDataDirFileUtils fileUtils(vDirs);
+  CAlphIO alphIO(&msgs);
+  const CAlphInfo *pAlph = LoadAlphabet(alphIO, fileUtils, strAlph);
+  if (!pAlph) return 1;
+  const int iNumSyms(pAlph->iEnd - 1);
+  //the file stores symbols as shorts
+  if (iNumSyms >= 0x8000) {
+    fprintf(stderr, "Alphabet \"%s\" has too many symbols for a PPM model file\n", strAlph.c_str());
+    return 1;
+  }
+  int iBits(1);
+  while ((1 << iBits) <= iNumSyms) iBits++;
+  if (iDepth * iBits > 127) {
+    fprintf(stderr, "Max order %d too high for an alphabet of %d symbols\n", iDepth - 1, iNumSyms);
+    return 1;
+  }
+  CAlphabetMap map;
+  CAlphabetManager::MapSymbols(pAlph, map);
+
+  std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+  CRecorder recorder(iNumSyms);
+  {
+    CTrainer trainer(&msgs, &recorder, pAlph, &map);
+    for (size_t i = 0; i < vTraining.size(); i++)
+      if (!trainer.ParseFile(vTraining[i], false)) return 1;
+  }
+  //padding, so every position is followed by iDepth symbols (or 0s)
+  recorder.m_vText.resize(recorder.m_vText.size() + iDepth, 0);
+  fprintf(stderr, "Read %lu symbols in %.2fs\n", static_cast<unsigned long>(recorder.m_vText.size()), Seconds(start));
+
+  //(keys need a spare bit while sorting)
+  if (!(iDepth * iBits < 64
+        ? Compile<uint64_t>(recorder.m_vText, iDepth, iBits, bUpdateExclusion, iThreads, strModel)
+        : Compile<unsigned __int128>(recorder.m_vText, iDepth, iBits, bUpdateExclusion, iThreads, strModel)))
+    return 1;
+
+  if (bCheck) {
+    start = std::chrono::steady_clock::now();
+    CPPMLanguageModel trained(&root, iNumSyms), compiled(&root, iNumSyms);
+    CTrainer trainer(&msgs, &trained, pAlph, &map);
+    for (size_t i = 0; i < vTraining.size(); i++)
+      trainer.ParseFile(vTraining[i], false);
+    fprintf(stderr, "Trained the usual way in %.2fs\n", Seconds(start));
+    std::ifstream in(strModel.c_str(), std::ios::binary);
+    if (!compiled.ReadFromStream(in)) {
+      fprintf(stderr, "Compiled model could not be read\n");
+      return 1;
+    }
+    if (!trained.eq(&compiled)) {
+      fprintf(stderr, "Compiled model differs from trained one\n");
+      return 1;
+    }
+    fprintf(stderr, "Compiled model is the same as trained one\n");
+  }
+  return 0;
+}
@@ -0,0 +1,498 @@
+// Command line application shrinking a PPM model file (as written by
+// CPPMLanguageModel::WriteToFile/WriteToStream, or PPMCompile) to fit a size
+// budget, by removing the contexts which do least for prediction.
+//
+// Every node is scored by how many bits the held-out text would cost more (or
+// less) without it, predicting as CPPMLanguageModel::GetProbs does (mixed with
+// LMUniform, as CAlphabetManager::GetProbs). A node matters to a symbol in two
+// ways: as a context on the vine chain, whose whole level of the blend would
+// be lost; and as a child of such a context, whose count would be lost from
+// the context's total (and, if it is the symbol predicted, from its
+// probability). Nodes are scored independently. Held-out text only reaches
+// a fraction of the nodes, and those it reaches rarely are scored noisily; so
+// no node is scored below zero (however much removing it would have helped the
+// held-out text), and each is also credited a few bits (-w) per its count.
+//
+// Removing a node means removing its subtree, and also every node vined into
+// that, as CAbstractPPM::EnterSymbol tracks the order of a context by assuming
+// each vine is exactly one order shorter (vining such nodes to a shorter
+// context instead would leave every context entered after them an order short).
+// Such sets are removed in order of the bits lost per node, cheapest first,
+// until the model fits each budget. Then, with update exclusion, each removed
+// node's count, less the one increment its creation made to its vine, is added
+// to its vine (or passed on, if that was removed too), as the occurrences it
+// counted would then have been.
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// Usage: PPMPrune -d datadir [-d datadir...] -a alphabet -i model -h heldout [-e eval]
+//                 -m pruned -b bytes[,bytes...] [-o order] [-u 0|1] [-A alpha] [-B beta] [-w bits]
+//   -d  directory containing alphabet files (repeat for several)
+//   -a  AlphabetID whose symbols the model predicts
+//   -i  model file to prune
+//   -h  held-out text file to score nodes against
+//   -e  text file to report bits per symbol on (default the held-out text, on
+//       which pruning will look better than on text it has not seen)
+//   -m  pruned model file to write (for several budgets, each gets "-<bytes>" appended)
+//   -b  size(s) of model file to fit within, in bytes
+//   -o  LMMaxOrder the model was trained with (default the default)
+//   -u  LMUpdateExclusion the model was trained with (default the default)
+//   -A  LMAlpha to predict with (default the default)
+//   -B  LMBeta to predict with (default the default)
+//   -w  bits credited to a node for each of its count (default 0.3)
+//
+// Prints, for the original model and each pruned one, its size in bytes and
+// nodes, and bits per symbol of the evaluation text as Dasher would predict it;
+// then the bits per symbol lost for the bytes saved.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../DasherCore/DasherModel.h"
+#include "../../DasherCore/LanguageModelling/PPMLanguageModel.h"
+#include "../ToolSupport.h"
+
+using namespace Dasher;
+using std::string;
+using std::vector;
+
+typedef CPPMLanguageModel::BinaryRecord BinaryRecord;
+
+///A PPM trie held as arrays, indexed by node number (0 = the root) in file order
+class CTrie {
+public:
+  bool Read(std::istream &in) {
+    //file index -> node number; the file lists every node exactly once
+    vector<int> vNode(1, -1);
+    vector<BinaryRecord> vRecords;
+    for (BinaryRecord sBR; in.read(reinterpret_cast<char *>(&sBR), sizeof(sBR));) {
+      if (sBR.m_iIndex <= 0 || sBR.m_iChild < 0 || sBR.m_iNext < 0 || sBR.m_iVine < 0) return false;
+      if (sBR.m_iIndex >= static_cast<int>(vNode.size())) vNode.resize(sBR.m_iIndex + 1, -1);
+      if (vNode[sBR.m_iIndex] != -1) return false;
+      vNode[sBR.m_iIndex] = static_cast<int>(vRecords.size());
+      vRecords.push_back(sBR);
+    }
+    if (vRecords.empty()) return false;
+    auto Node = [&vNode](int iIndex) {
+      return iIndex < static_cast<int>(vNode.size()) ? vNode[iIndex] : -2;
+    };
+    const size_t iNodes(vRecords.size());
+    m_vSym.resize(iNodes);
+    m_vCount.resize(iNodes);
+    m_vVine.resize(iNodes);
+    m_vParent.assign(iNodes, -1);
+    m_vDepth.assign(iNodes, 0);
+    vector<vector<int> > vChildren(iNodes);
+    for (size_t i = 0; i < iNodes; i++) {
+      const BinaryRecord &sBR(vRecords[i]);
+      m_vSym[i] = sBR.m_iSymbol;
+      m_vCount[i] = sBR.m_iCount;
+      if ((m_vVine[i] = sBR.m_iVine ? Node(sBR.m_iVine) : -1) < -1) return false;
+      for (int c = sBR.m_iChild ? Node(sBR.m_iChild) : -1; c != -1; c = vRecords[c].m_iNext ? Node(vRecords[c].m_iNext) : -1) {
+        if (c < 0 || m_vParent[c] != -1 || c == 0) return false;
+        m_vParent[c] = static_cast<int>(i);
+        vChildren[i].push_back(c);
+      }
+    }
+    //preorder, so parents come first
+    for (size_t i = 1; i < iNodes; i++) {
+      if (m_vParent[i] == -1 || m_vParent[i] >= static_cast<int>(i)) return false;
+      m_vDepth[i] = m_vDepth[m_vParent[i]] + 1;
+    }
+    for (size_t i = 1; i < iNodes; i++)
+      if (m_vVine[i] < 0 || m_vDepth[m_vVine[i]] != m_vDepth[i] - 1) return false;
+    m_vFirstChild.assign(1, 0);
+    for (size_t i = 0; i < iNodes; i++) {
+      m_vChildren.insert(m_vChildren.end(), vChildren[i].begin(), vChildren[i].end());
+      m_vFirstChild.push_back(m_vChildren.size());
+    }
+    m_vFirstVinedBy.assign(iNodes + 1, 0);
+    for (size_t i = 1; i < iNodes; i++) m_vFirstVinedBy[m_vVine[i] + 1]++;
+    for (size_t i = 0; i < iNodes; i++) m_vFirstVinedBy[i+1] += m_vFirstVinedBy[i];
+    m_vVinedBy.resize(iNodes - 1);
+    vector<size_t> vFill(m_vFirstVinedBy.begin(), m_vFirstVinedBy.end() - 1);
+    for (size_t i = 1; i < iNodes; i++) m_vVinedBy[vFill[m_vVine[i]]++] = static_cast<int>(i);
+    m_vStamp.assign(iNodes, 0);
+    m_iStamp = 0;
+    return true;
+  }
+
+  ///Writes the nodes not removed, in preorder
+  bool Write(std::ostream &out, const vector<bool> &vRemoved, const vector<unsigned int> &vCount) const {
+    vector<int> vIdx(Size(), 0);
+    int iNextIdx(1);
+    auto GetIndex = [&](int iNode) {
+      if (iNode < 0) return 0;
+      if (!vIdx[iNode]) vIdx[iNode] = iNextIdx++;
+      return vIdx[iNode];
+    };
+    std::function<void(int, int)> Write = [&](int iNode, int iNextSibling) {
+      vector<int> vKids;
+      for (size_t c = m_vFirstChild[iNode]; c < m_vFirstChild[iNode+1]; c++)
+        if (!vRemoved[m_vChildren[c]]) vKids.push_back(m_vChildren[c]);
+      BinaryRecord sBR;
+      sBR.SetIndices(GetIndex, iNode, iNextSibling, m_vVine[iNode], vKids.empty() ? -1 : vKids[0]);
+      sBR.m_iCount = static_cast<unsigned short>(std::min(vCount[iNode], 0xffffu));
+      sBR.m_iSymbol = m_vSym[iNode];
+      out.write(reinterpret_cast<char *>(&sBR), sizeof(sBR));
+      for (size_t k = 0; k < vKids.size(); k++)
+        Write(vKids[k], k+1 < vKids.size() ? vKids[k+1] : -1);
+    };
+    Write(0, -1);
+    return out.good();
+  }
+
+  ///Every node not yet removed which must go if iNode does: its children, and
+  /// nodes vined to it (CAbstractPPM::EnterSymbol relies on each node's vine
+  /// being exactly one order shorter), and so on recursively.
+  void Closure(int iNode, const vector<bool> &vRemoved, vector<int> &vClosure) {
+    vClosure.clear();
+    vector<int> vStack(1, iNode);
+    m_iStamp++;
+    while (!vStack.empty()) {
+      const int i(vStack.back());
+      vStack.pop_back();
+      if (vRemoved[i] || m_vStamp[i] == m_iStamp) continue;
+      m_vStamp[i] = m_iStamp;
+      vClosure.push_back(i);
+      for (size_t c = m_vFirstChild[i]; c < m_vFirstChild[i+1]; c++) vStack.push_back(m_vChildren[c]);
+      for (size_t v = m_vFirstVinedBy[i]; v < m_vFirstVinedBy[i+1]; v++) vStack.push_back(m_vVinedBy[v]);
+    }
+  }
+
+  int Size() const {return static_cast<int>(m_vSym.size());}
+  int FindChild(int iNode, symbol sym) const {
+    for (size_t c = m_vFirstChild[iNode]; c < m_vFirstChild[iNode+1]; c++)
+      if (m_vSym[m_vChildren[c]] == sym) return m_vChildren[c];
+    return -1;
+  }
+
+  vector<short> m_vSym;
+  vector<unsigned int> m_vCount;
+  vector<int> m_vVine, m_vParent, m_vDepth;
+  ///Children of node i are m_vChildren[m_vFirstChild[i]...m_vFirstChild[i+1]-1]
+  vector<int> m_vChildren;
+  vector<size_t> m_vFirstChild;
+  ///Nodes whose vine is node i are m_vVinedBy[m_vFirstVinedBy[i]...m_vFirstVinedBy[i+1]-1]
+  vector<int> m_vVinedBy;
+  vector<size_t> m_vFirstVinedBy;
+private:
+  ///Marks nodes visited by Closure
+  vector<unsigned int> m_vStamp;
+  unsigned int m_iStamp;
+};
+
+///Scores each node of a trie by the bits the held-out text would lose without it
+class CScorer {
+public:
+  ///\param iUniform LP_UNIFORM, mixed in as by CAlphabetManager::GetProbs
+  CScorer(const CTrie &trie, int iMaxOrder, bool bUpdateExclusion, int iAlpha, int iBeta, long iUniform, int iNumSyms)
+  : m_trie(trie), m_iMaxOrder(iMaxOrder), m_bUpdateExclusion(bUpdateExclusion), m_dAlpha(iAlpha), m_dBeta(iBeta),
+    m_iNumSyms(iNumSyms), m_vLoss(trie.Size(), 0.0) {
+    const unsigned long iNorm(CDasherModel::NORMALIZATION);
+    unsigned int iUniformAdd;
+    m_dModelShare = CAlphabetManager::UniformSplit(iNorm, iUniform, iNumSyms, iUniformAdd) / static_cast<double>(iNorm);
+    m_dUniformAdd = iUniformAdd / static_cast<double>(iNorm);
+  }
+
+  ///Walks the held-out text as CAbstractPPM::EnterSymbol, scoring every node
+  /// each symbol's prediction depends on.
+  void Score(const vector<symbol> &vText) {
+    int iHead(0), iOrder(0);
+    for (size_t i = 0; i < vText.size(); i++) {
+      const symbol sym(vText[i]);
+      if (sym <= 0) continue;
+      ScoreSymbol(iHead, sym);
+      for (; iHead != -1; iHead = m_trie.m_vVine[iHead], iOrder--)
+        if (iOrder < m_iMaxOrder) {
+          const int iChild(m_trie.FindChild(iHead, sym));
+          if (iChild != -1) {
+            iHead = iChild;
+            iOrder++;
+            break;
+          }
+        }
+      if (iHead == -1) iHead = iOrder = 0;
+    }
+  }
+
+  ///Bits lost (negative if saved) by removing each node alone
+  const vector<double> &Loss() const {return m_vLoss;}
+
+private:
+  ///A context on the vine chain: its total count and number of children, and
+  /// the count of the symbol being predicted
+  struct SLevel {
+    double dTotal, dChildren, dCount;
+  };
+
+  ///Probability of the symbol, blending the levels as CPPMLanguageModel::GetProbs
+  double Prob(const vector<SLevel> &vLevels) const {
+    double dSlice(1.0), dProb(0.0);
+    for (size_t l = 0; l < vLevels.size(); l++) {
+      const SLevel &lev(vLevels[l]);
+      if (lev.dTotal <= 0) continue;
+      const double dDenom(100 * lev.dTotal + m_dAlpha);
+      if (lev.dCount > 0) dProb += dSlice * (100 * lev.dCount - m_dBeta) / dDenom;
+      dSlice *= 1.0 - (100 * lev.dTotal - lev.dChildren * m_dBeta) / dDenom;
+    }
+    dProb += dSlice / m_iNumSyms;
+    return -log2(m_dUniformAdd + m_dModelShare * dProb);
+  }
+
+  void ScoreSymbol(int iHead, symbol sym) {
+    m_vChain.clear();
+    m_vLevels.clear();
+    for (int n = iHead; n != -1; n = m_trie.m_vVine[n]) {
+      SLevel lev = {0, 0, 0};
+      for (size_t c = m_trie.m_vFirstChild[n]; c < m_trie.m_vFirstChild[n+1]; c++) {
+        const int iChild(m_trie.m_vChildren[c]);
+        lev.dTotal += m_trie.m_vCount[iChild];
+        lev.dChildren++;
+        if (m_trie.m_vSym[iChild] == sym) lev.dCount = m_trie.m_vCount[iChild];
+      }
+      m_vChain.push_back(n);
+      m_vLevels.push_back(lev);
+    }
+    const double dBits(Prob(m_vLevels));
+    for (size_t l = 0; l < m_vChain.size(); l++) {
+      const int n(m_vChain[l]);
+      //without the context (unless it's the root), its level goes
+      if (n) {
+        const SLevel save(m_vLevels[l]);
+        m_vLevels[l].dTotal = 0;
+        m_vLoss[n] += Prob(m_vLevels) - dBits;
+        m_vLevels[l] = save;
+      }
+      //without each child, its count goes (to the next level, if excluded there)
+      for (size_t c = m_trie.m_vFirstChild[n]; c < m_trie.m_vFirstChild[n+1]; c++) {
+        const int iChild(m_trie.m_vChildren[c]);
+        const double dCount(m_trie.m_vCount[iChild]);
+        const bool bSym(m_trie.m_vSym[iChild] == sym);
+        const SLevel save(m_vLevels[l]);
+        m_vLevels[l].dTotal -= dCount;
+        m_vLevels[l].dChildren--;
+        if (bSym) m_vLevels[l].dCount = 0;
+        SLevel saveNext = {0, 0, 0};
+        const bool bNext(m_bUpdateExclusion && l+1 < m_vLevels.size() && dCount > 1);
+        if (bNext) {
+          saveNext = m_vLevels[l+1];
+          m_vLevels[l+1].dTotal += dCount - 1;
+          if (bSym) m_vLevels[l+1].dCount += dCount - 1;
+        }
+        m_vLoss[iChild] += Prob(m_vLevels) - dBits;
+        m_vLevels[l] = save;
+        if (bNext) m_vLevels[l+1] = saveNext;
+      }
+    }
+  }
+
+  const CTrie &m_trie;
+  const int m_iMaxOrder;
+  const bool m_bUpdateExclusion;
+  const double m_dAlpha, m_dBeta;
+  ///Of the probability Dasher shows, that added to every symbol, and the share the model predicts
+  double m_dUniformAdd, m_dModelShare;
+  const int m_iNumSyms;
+  vector<double> m_vLoss;
+  //scratch for ScoreSymbol
+  vector<int> m_vChain;
+  vector<SLevel> m_vLevels;
+};
+
+static double Seconds(const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int Usage(const char *szName) {
+  fprintf(stderr, "Usage: %s -d datadir [-d datadir...] -a alphabet -i model -h heldout [-e eval]\n"
+                  "       -m pruned -b bytes[,bytes...] [-o order] [-u 0|1] [-A alpha] [-B beta] [-w bits]\n", szName);
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  vector<string> vDirs;
+  string strAlph, strModel, strHeldOut, strEval, strPruned;
+  vector<long> vBudgets;
+  long iOrder(-1), iUpdateExclusion(-1), iAlpha(-1), iBeta(-1);
+  double dCountBits(0.3);
+
+  for (int i = 1; i < argc; i++) {
+    if (i+1 >= argc) return Usage(argv[0]);
+    if (!strcmp(argv[i], "-d")) vDirs.push_back(argv[++i]);
+    else if (!strcmp(argv[i], "-a")) strAlph = argv[++i];
+    else if (!strcmp(argv[i], "-i")) strModel = argv[++i];
+    else if (!strcmp(argv[i], "-h")) strHeldOut = argv[++i];
+    else if (!strcmp(argv[i], "-e")) strEval = argv[++i];
+    else if (!strcmp(argv[i], "-m")) strPruned = argv[++i];
+    else if (!strcmp(argv[i], "-b")) {
+      std::istringstream in(argv[++i]);
+      for (string s; std::getline(in, s, ',');) vBudgets.push_back(atol(s.c_str()));
+    }
+    else if (!strcmp(argv[i], "-o")) iOrder = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-u")) iUpdateExclusion = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-A")) iAlpha = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-B")) iBeta = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-w")) dCountBits = atof(argv[++i]);
+    else return Usage(argv[0]);
+  }
+  if (vDirs.empty() || strAlph.empty() || strModel.empty() || strHeldOut.empty() || strPruned.empty() || vBudgets.empty())
+    return Usage(argv[0]);
+  //largest first, as each pruned model is a subset of the one before
+  std::sort(vBudgets.rbegin(), vBudgets.rend());
+
+  CStderrMessages msgs;
+  CDefaultSettings settings;
+  CSettingsUser root(&settings);
+  if (iOrder >= 0) settings.SetLongParameter(LP_LM_MAX_ORDER, iOrder);
+  if (iUpdateExclusion >= 0) settings.SetLongParameter(LP_LM_UPDATE_EXCLUSION, iUpdateExclusion);
+  if (iAlpha >= 0) settings.SetLongParameter(LP_LM_ALPHA, iAlpha);
+  if (iBeta >= 0) settings.SetLongParameter(LP_LM_BETA, iBeta);
+
+  CDataDirFileUtils fileUtils(vDirs);
+  CAlphIO alphIO(&msgs);
+  const CAlphInfo *pAlph = LoadAlphabet(alphIO, fileUtils, strAlph);
+  if (!pAlph) return 1;
+  CAlphabetMap map;
+  CAlphabetManager::MapSymbols(pAlph, map);
+
+  vector<symbol> vCorpus, vEvalCorpus;
+  vector<size_t> vPositions, vEvalPositions;
+  if (!ReadSymbols(strHeldOut, map, &msgs, vCorpus, vPositions)) return 1;
+  if (strEval.empty()) {
+    vEvalCorpus = vCorpus;
+    vEvalPositions = vPositions;
+  } else if (!ReadSymbols(strEval, map, &msgs, vEvalCorpus, vEvalPositions)) return 1;
+
+  const unsigned int iSymbols(pAlph->iEnd-1);
+  const long iUniform(settings.GetLongParameter(LP_UNIFORM));
+  //Bits per symbol of the evaluation text predicted by a model file, loaded as Dasher would
+  auto Evaluate = [&](const string &strFile, double &dBits) {
+    CPPMLanguageModel lm(&root, iSymbols);
+    std::ifstream in(strFile.c_str(), std::ios::binary);
+    if (!lm.ReadFromStream(in)) return false;
+    dBits = BitsPerSymbol(lm, vEvalCorpus, vEvalPositions, iSymbols, iUniform);
+    return true;
+  };
+
+  CTrie trie;
+  {
+    std::ifstream in(strModel.c_str(), std::ios::binary);
+    if (!in) {
+      perror(strModel.c_str());
+      return 1;
+    }
+    if (!trie.Read(in)) {
+      fprintf(stderr, "%s is not a PPM model\n", strModel.c_str());
+      return 1;
+    }
+  }
+  double dOrigBits;
+  if (!Evaluate(strModel, dOrigBits)) {
+    fprintf(stderr, "%s could not be loaded for alphabet \"%s\"\n", strModel.c_str(), strAlph.c_str());
+    return 1;
+  }
+  const int iNodes(trie.Size());
+  const long iOrigBytes(static_cast<long>(iNodes * sizeof(BinaryRecord)));
+
+  std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+  const bool bUpdateExclusion(settings.GetLongParameter(LP_LM_UPDATE_EXCLUSION) != 0);
+  CScorer scorer(trie, settings.GetLongParameter(LP_LM_MAX_ORDER), bUpdateExclusion,
+                 settings.GetLongParameter(LP_LM_ALPHA), settings.GetLongParameter(LP_LM_BETA),
+                 iUniform, iSymbols);
+  scorer.Score(vCorpus);
+  //Order of removal: lazily greedy, by the loss per node of removing each node
+  // along with everything that must go with it (see Closure), initially
+  // estimated from its subtree. Children follow their parents, so sum backwards.
+  //What the held-out text says of each node is noisy where it reaches the node
+  // only a few times, and silent for the many it never reaches; so don't trust
+  // it to say that removing any node would help, and credit every node with a
+  // little for each time it was counted in training.
+  vector<double> vLoss(scorer.Loss());
+  for (int i = 0; i < iNodes; i++) vLoss[i] = std::max(vLoss[i], 0.0) + dCountBits * trie.m_vCount[i];
+  vector<double> vSubLoss(vLoss);
+  vector<int> vSubSize(iNodes, 1);
+  for (int i = iNodes; --i > 0;) {
+    vSubLoss[trie.m_vParent[i]] += vSubLoss[i];
+    vSubSize[trie.m_vParent[i]] += vSubSize[i];
+  }
+  typedef std::pair<double, int> SCandidate; //(loss per node, node)
+  std::priority_queue<SCandidate, vector<SCandidate>, std::greater<SCandidate> > queue;
+  for (int i = 1; i < iNodes; i++) queue.push(SCandidate(vSubLoss[i] / vSubSize[i], i));
+  fprintf(stderr, "Scored %d nodes against %lu symbols in %.2fs\n", iNodes,
+          static_cast<unsigned long>(vPositions.size()), Seconds(start));
+
+  printf("%10s %9s %8s %8s %10s\n", "bytes", "nodes", "bits/sym", "lost", "saved");
+  printf("%10ld %9d %8.4f %8.4f %10d\n", iOrigBytes, iNodes, dOrigBits, 0.0, 0);
+
+  vector<bool> vRemoved(iNodes, false);
+  int iLeft(iNodes);
+  vector<int> vClosure;
+  for (size_t b = 0; b < vBudgets.size(); b++) {
+    const long iBudget(vBudgets[b]);
+    start = std::chrono::steady_clock::now();
+    while (iLeft * static_cast<long>(sizeof(BinaryRecord)) > iBudget && !queue.empty()) {
+      const int n(queue.top().second);
+      queue.pop();
+      if (vRemoved[n]) continue;
+      trie.Closure(n, vRemoved, vClosure);
+      double dLoss(0.0);
+      for (size_t k = 0; k < vClosure.size(); k++) dLoss += vLoss[vClosure[k]];
+      const double dKey(dLoss / vClosure.size());
+      if (!queue.empty() && dKey > queue.top().first) {
+        //costlier than estimated; try again when it's the cheapest
+        queue.push(SCandidate(dKey, n));
+        continue;
+      }
+      for (size_t k = 0; k < vClosure.size(); k++) vRemoved[vClosure[k]] = true;
+      iLeft -= static_cast<int>(vClosure.size());
+    }
+    if (iLeft * static_cast<long>(sizeof(BinaryRecord)) > iBudget) {
+      fprintf(stderr, "Cannot fit within %ld bytes (the root alone is %lu)\n", iBudget,
+              static_cast<unsigned long>(sizeof(BinaryRecord)));
+      return 1;
+    }
+
+    //With update exclusion, pass the counts of removed nodes down their vines,
+    // deepest first, so that they pass on through any vine removed too
+    vector<unsigned int> vCount(trie.m_vCount);
+    if (bUpdateExclusion) {
+      vector<int> vByDepth;
+      for (int i = 1; i < iNodes; i++)
+        if (vRemoved[i]) vByDepth.push_back(i);
+      std::stable_sort(vByDepth.begin(), vByDepth.end(), [&](int a, int b) {return trie.m_vDepth[a] > trie.m_vDepth[b];});
+      for (size_t k = 0; k < vByDepth.size(); k++) {
+        const int i(vByDepth[k]), v(trie.m_vVine[i]);
+        if (v > 0 && vCount[i] > 1) vCount[v] += vCount[i] - 1;
+      }
+    }
+
+    const string strFile(vBudgets.size() == 1 ? strPruned : strPruned + "-" + std::to_string(iBudget));
+    {
+      std::ofstream out(strFile.c_str(), std::ios::binary);
+      if (!trie.Write(out, vRemoved, vCount)) {
+        perror(strFile.c_str());
+        return 1;
+      }
+    }
+    fprintf(stderr, "Pruned to %ld bytes in %.2fs\n", iBudget, Seconds(start));
+    double dBits;
+    if (!Evaluate(strFile, dBits)) {
+      fprintf(stderr, "Pruned model %s could not be read\n", strFile.c_str());
+      return 1;
+    }
+    const long iBytes(iLeft * static_cast<long>(sizeof(BinaryRecord)));
+    printf("%10ld %9d %8.4f %8.4f %10ld\n", iBytes, iLeft, dBits, dBits - dOrigBits, iOrigBytes - iBytes);
+  }
+  return 0;
+}
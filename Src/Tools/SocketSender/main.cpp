@@ -0,0 +1,108 @@
+// Command line application that sends synthetic coordinates to Dasher's
+// socket input on this machine, for testing it (and its behaviour at high
+// sample rates) without a BCI rig or other device.
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// Usage: SocketSender [-p port] [-r rate] [-t seconds] [-b] [-x label] [-y label]
+//   -p  UDP port Dasher is listening on (SocketPort; default 20320)
+//   -r  datagrams per second (default 1000)
+//   -t  seconds to run for (default 10)
+//   -b  send binary datagrams rather than text lines
+//   -x, -y  labels for text datagrams (SocketInputXLabel/YLabel; default x, y)
+//
+// The coordinates trace a circle (once every 4 seconds) within the range
+// 0.0-1.0, i.e. the default SocketInputX/YMin/MaxTimes1000.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <chrono>
+#include <thread>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+//Must match CSocketInputBase::BINARY_MAGIC
+static const unsigned char BINARY_MAGIC[4] = {0xDA, 0x5E, 'B', 0x01};
+
+static int Usage(const char *szName) {
+  fprintf(stderr, "Usage: %s [-p port] [-r rate] [-t seconds] [-b] [-x label] [-y label]\n", szName);
+  return 1;
+}
+
+static void PutDouble(unsigned char *p, double d) {
+  unsigned long long iBits;
+  memcpy(&iBits, &d, sizeof(double));
+  for (int i = 0; i < 8; i++, iBits >>= 8) p[i] = iBits & 0xFF;
+}
+
+int main(int argc, char *argv[]) {
+  int iPort(20320);
+  double dRate(1000.0), dSeconds(10.0);
+  bool bBinary(false);
+  std::string strX("x"), strY("y");
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-b")) bBinary = true;
+    else if (i+1 >= argc) return Usage(argv[0]);
+    else if (!strcmp(argv[i], "-p")) iPort = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-r")) dRate = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-t")) dSeconds = atof(argv[++i]);
+    else if (!strcmp(argv[i], "-x")) strX = argv[++i];
+    else if (!strcmp(argv[i], "-y")) strY = argv[++i];
+    else return Usage(argv[0]);
+  }
+  if (dRate <= 0 || iPort <= 0 || iPort > 65535) return Usage(argv[0]);
+
+  int sock = socket(PF_INET, SOCK_DGRAM, 0);
+  if (sock == -1) {
+    perror("socket");
+    return 1;
+  }
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(iPort);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  using namespace std::chrono;
+  const steady_clock::time_point start(steady_clock::now());
+  const long long iCount(static_cast<long long>(dRate * dSeconds));
+  long long iFailed(0);
+  for (long long i = 0; i < iCount; i++) {
+    //send each datagram at its scheduled time, so errors in sleeping don't accumulate
+    const double dTime(i / dRate);
+    std::this_thread::sleep_until(start + duration_cast<steady_clock::duration>(duration<double>(dTime)));
+    const double dAngle(dTime * M_PI / 2.0);
+    const double dX(0.5 + 0.4*cos(dAngle)), dY(0.5 + 0.4*sin(dAngle));
+
+    char buffer[512];
+    int iLength;
+    if (bBinary) {
+      unsigned char *p(reinterpret_cast<unsigned char *>(buffer));
+      memcpy(p, BINARY_MAGIC, 4);
+      p[4] = 2; p[5] = 0;
+      PutDouble(p+6, dX);
+      PutDouble(p+14, dY);
+      iLength = 22;
+    } else {
+      iLength = snprintf(buffer, sizeof(buffer), "%s %.6f\n%s %.6f\n", strX.c_str(), dX, strY.c_str(), dY);
+      if (iLength >= static_cast<int>(sizeof(buffer))) {
+        fprintf(stderr, "Labels too long\n");
+        return 1;
+      }
+    }
+    if (sendto(sock, buffer, iLength, 0, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != iLength)
+      iFailed++;
+  }
+  const double dElapsed(duration<double>(steady_clock::now() - start).count());
+  printf("Sent %lld datagrams in %.2fs (%.0f/s), %lld failed\n", iCount - iFailed, dElapsed,
+         (iCount - iFailed) / dElapsed, iFailed);
+  close(sock);
+  return 0;
+}
@@ -0,0 +1,126 @@
+// ToolSupport.h
+//
+// Copyright (c) 2026 The Dasher Team
+//
+// What the command line tools share: reporting to stderr, default settings,
+// finding data files (e.g. alphabets) in the directories named on the command
+// line, and reading and scoring text in an alphabet's symbols as Dasher would.
+
+#ifndef __TOOLSUPPORT_H__
+#define __TOOLSUPPORT_H__
+
+#include <stdio.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../../Common/Globber.h"
+#include "../../DasherCore/Alphabet/AlphIO.h"
+#include "../../DasherCore/Alphabet/AlphabetMap.h"
+#include "../../DasherCore/AlphabetManager.h"
+#include "../../DasherCore/DasherInterfaceBase.h"
+#include "../../DasherCore/DasherModel.h"
+#include "../../DasherCore/SettingsStore.h"
+
+namespace Dasher {
+
+class CStderrMessages : public CMessageDisplay {
+public:
+  void Message(const std::string &strText, bool bInterrupt) {
+    fprintf(stderr, "%s\n", strText.c_str());
+  }
+};
+
+///Default settings, not loaded from or saved anywhere.
+class CDefaultSettings : public CSettingsStore {
+public:
+  CDefaultSettings() {LoadPersistent();}
+};
+
+///Finds files in the data directories only: nothing a tool does should read,
+/// or write, the user's own data.
+class CDataDirFileUtils : public CFileUtils {
+public:
+  CDataDirFileUtils(const std::vector<std::string> &vDirs) : m_vDirs(vDirs) {}
+
+  int GetFileSize(const std::string &strFileName) {
+    struct stat sStatInfo;
+    return stat(strFileName.c_str(), &sStatInfo) ? 0 : sStatInfo.st_size;
+  }
+
+  void ScanFiles(AbstractParser *parser, const std::string &strPattern) {
+    std::vector<std::string> vPaths;
+    for (size_t i=0; i<m_vDirs.size(); i++) vPaths.push_back(m_vDirs[i] + "/" + strPattern);
+    std::vector<const char *> vSys;
+    for (size_t i=0; i<vPaths.size(); i++) vSys.push_back(vPaths[i].c_str());
+    vSys.push_back(NULL);
+    const char *user[1] = {NULL};
+    globScan(parser, user, &vSys[0]);
+  }
+
+  bool WriteUserDataFile(const std::string &filename, const std::string &strNewText, bool append) {
+    return true;
+  }
+
+private:
+  const std::vector<std::string> m_vDirs;
+};
+
+///Reads every alphabet file, as CDasherInterfaceBase::Realize does, and finds one.
+/// \return the alphabet with ID strAlph, or NULL (having said so on stderr)
+inline const CAlphInfo *LoadAlphabet(CAlphIO &alphIO, CFileUtils &fileUtils, const std::string &strAlph) {
+  fileUtils.ScanFiles(&alphIO, "alphabet*.xml");
+  const CAlphInfo *pAlph = alphIO.GetInfo(strAlph);
+  //(GetInfo falls back to the default alphabet)
+  if (!pAlph || pAlph->GetID() != strAlph) {
+    fprintf(stderr, "No alphabet \"%s\"\n", strAlph.c_str());
+    return NULL;
+  }
+  return pAlph;
+}
+
+///Reads a text file into symbols of an alphabet.
+/// \param vCorpus receives every character read, as 0 if not in the map
+/// \param vPositions receives the indices into vCorpus of those in the map
+/// \return false, having said why on stderr, if the file could not be read or
+/// had nothing in the map
+inline bool ReadSymbols(const std::string &strFile, const CAlphabetMap &map, CMessageDisplay *pMsgs,
+                        std::vector<symbol> &vCorpus, std::vector<size_t> &vPositions) {
+  std::ifstream in(strFile.c_str());
+  if (!in) {
+    perror(strFile.c_str());
+    return false;
+  }
+  CAlphabetMap::SymbolStream syms(in, pMsgs);
+  for (symbol sym; (sym = syms.next(&map)) != -1;) {
+    if (sym > 0) vPositions.push_back(vCorpus.size());
+    vCorpus.push_back(sym);
+  }
+  if (vPositions.empty()) {
+    fprintf(stderr, "No symbols in %s\n", strFile.c_str());
+    return false;
+  }
+  return true;
+}
+
+///Bits per symbol of the symbols at vPositions in vCorpus, as Dasher would
+/// predict them: mixed with iUniform (as LP_UNIFORM) by CAlphabetManager, with
+/// control mode off.
+inline double BitsPerSymbol(CLanguageModel &lm, const std::vector<symbol> &vCorpus, const std::vector<size_t> &vPositions,
+                            unsigned int iSymbols, long iUniform, unsigned int iThreads=1) {
+  const unsigned long iNorm(CDasherModel::NORMALIZATION);
+  unsigned int iUniformAdd;
+  const unsigned long iNonUniformNorm(CAlphabetManager::UniformSplit(iNorm, iUniform, iSymbols, iUniformAdd));
+  std::vector<unsigned int> vProbs;
+  lm.GetSymbolProbs(vCorpus, vPositions, vProbs, iNonUniformNorm, 0, iThreads);
+  double dBits(0.0);
+  for (size_t i = 0; i < vProbs.size(); i++)
+    dBits -= log2((vProbs[i] + iUniformAdd) / static_cast<double>(iNorm));
+  return dBits / vProbs.size();
+}
+
+}
+
+#endif
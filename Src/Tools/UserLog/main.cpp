@@ -48,6 +48,30 @@ typedef vector<VECTOR_VECTOR_STRING>            VECTOR_VECTOR_VECTOR_STRING;
 typedef vector<VECTOR_VECTOR_STRING>::iterator  VECTOR_VECTOR_VECTOR_STRING_ITER;
 #endif
 
+// Analyses each trial as it is read, so the whole log is never in memory at once
+class CTrialAnalyser : public Observer<CUserLogTrial*>
+{
+public:
+  CTrialAnalyser(bool bNormMouse, bool bDensityMouse, int gridSize)
+    : m_bNormMouse(bNormMouse), m_bDensityMouse(bDensityMouse), m_gridSize(gridSize) {}
+
+  void HandleEvent(CUserLogTrial* pTrial)
+  {
+    if (m_bNormMouse)
+      m_vectorStrResult.push_back(pTrial->GetTabMouseXY(true));
+    else if (m_bDensityMouse)
+      m_vectorGridResult.push_back(pTrial->GetMouseDensity(m_gridSize));
+  }
+
+  VECTOR_VECTOR_STRING          m_vectorStrResult;
+  VECTOR_VECTOR_DENSITY_GRIDS   m_vectorGridResult;
+
+private:
+  bool  m_bNormMouse;
+  bool  m_bDensityMouse;
+  int   m_gridSize;
+};
+
 string GetOutputName(const string& strBase, int numFile, int numTrial, int numNav);
 void OutputToFile(const string& strData, const string& strBase, int numFile, int numTrial, int numNav);
 void OutputToFile(DENSITY_GRID data, int gridSize, const string& strBase, int numFile, int numTrial, int numNav);
@@ -328,7 +352,7 @@ int main(int argc, char* argv[])
     if (argc <= 2)
     {
       cout << "UserLog" << endl;
-      cout << "  -in              <XML log filename>" << endl;
+      cout << "  -in              <XML log filename, or streamed log (exported to XML)>" << endl;
       cout << "  -inList          <file with list of log filenames>" << endl;
       cout << "  -out             <output base name>" << endl;
       cout << "  -separateFiles" << endl;
@@ -435,17 +459,27 @@ int main(int argc, char* argv[])
     {
       string strFile = (string) *iter;
 
-      CUserLog objUserLog(strFile);
-
-      if (bNormMouse)
-      {
-        VECTOR_VECTOR_STRING vectorMouse = objUserLog.GetTabMouseXY(true);
-        vectorStrResult.push_back(vectorMouse);
-      } else if (bDensityMouse)
+      // Streamed logs are first exported to XML (alongside), which we then read
+      size_t iExt = strFile.length() - min(strFile.length(), USER_LOG_STREAM_EXTENSION.length());
+      if (strFile.compare(iExt, string::npos, USER_LOG_STREAM_EXTENSION) == 0)
       {
-        VECTOR_VECTOR_DENSITY_GRIDS vectorGrid = objUserLog.GetMouseDensity(gridSize);
-        vectorGridResult.push_back(vectorGrid);
+        string strXML = strFile.substr(0, iExt) + ".xml";
+        if (!CUserLog::ExportXML(strFile, strXML))
+        {
+          cout << "Failed to export: " << strFile << endl;
+          continue;
+        }
+        cout << "Exported: " << strXML << endl;
+        strFile = strXML;
       }
+
+      CTrialAnalyser analyser(bNormMouse, bDensityMouse, gridSize);
+      CUserLog objUserLog(strFile, &analyser);
+
+      if (bNormMouse)
+        vectorStrResult.push_back(analyser.m_vectorStrResult);
+      else if (bDensityMouse)
+        vectorGridResult.push_back(analyser.m_vectorGridResult);
     }        
 
     if (vectorStrResult.size() > 0)
@@ -0,0 +1,9 @@
+# Shared settings for the tool makefiles that link against the libtool
+# archives of an already configured and built tree; include from Src/Tools/<Tool>.
+inc = -I. -I../../DasherCore -I../../DasherCore/Alphabet -I../../DasherCore/LanguageModelling -I../../Common
+lib = ../../DasherCore/.libs/libdashercore.a ../../DasherCore/.libs/libdasherprefs.a ../../DasherCore/LanguageModelling/.libs/libdasherlm.a ../../Common/.libs/libdashermisc.a -lexpat -lpthread
+# plus whichever compression libraries configure found (see TrainingInput.cpp)
+config = ../../../config.h
+lib += $(if $(shell grep -s "define HAVE_LIBZ 1" $(config)),-lz) $(if $(shell grep -s "define HAVE_LIBZSTD 1" $(config)),-lzstd)
+
+CXXFLAGS = -O2 -std=c++11 $(inc)
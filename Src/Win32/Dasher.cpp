@@ -176,6 +176,10 @@ bool CWinFileUtils::WriteUserDataFile(const std::string &filename, const std::st
     return NumberOfBytesWritten == strNewText.size();
 }
 
+std::string CWinFileUtils::GetUserDataFilePath(const std::string &filename) {
+  return GetDataPath(true) + filename;
+}
+
 void CWinFileUtils::ScanDirectory(const string &strMask, std::vector<std::string> &vFileList) {
   using namespace WinUTF8;
   WIN32_FIND_DATA find;
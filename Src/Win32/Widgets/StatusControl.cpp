@@ -5,7 +5,7 @@
 #include <string>
 
 CStatusControl::CStatusControl(Dasher::CSettingsUser *pCreateFrom, CAppSettings *pAppSettings)
-  : CSettingsObserver(pCreateFrom),
+  : CSettingsObserver(pCreateFrom, {SP_ALPHABET_ID, SP_ALPHABET_1, SP_ALPHABET_2, SP_ALPHABET_3, SP_ALPHABET_4, LP_MAX_BITRATE}),
   m_pAppSettings(pAppSettings),
   m_dialogHeight(0) {
 }
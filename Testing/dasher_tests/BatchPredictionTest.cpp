@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+#include "../../Src/TestPlatform/MockSettingsStore.h"
+#include "../../Src/DasherCore/LanguageModelling/PPMLanguageModel.h"
+using namespace Dasher;
+
+//Fixture - a small PPM model, trained on some text, and a corpus to predict
+// which includes unknown (0) symbols, some in runs longer than the context.
+class BatchPredictionTest : public ::testing::Test {
+  public:
+    BatchPredictionTest() : root(&settings), lm(&root, iSymbols) {
+      CLanguageModel::CWriter writer(&lm);
+      CLanguageModel::Context ctx = lm.CreateEmptyContext();
+      for (int i = 0; i < 5000; i++) lm.LearnSymbol(ctx, 1 + (i * i + i / 3) % (iSymbols - 1));
+      lm.ReleaseContext(ctx);
+
+      for (int i = 0; i < 3000; i++) {
+        if (i % 97 == 50)
+          vCorpus.insert(vCorpus.end(), lm.GetContextLength() + 2, 0);
+        else if (i % 13 == 0)
+          vCorpus.push_back(0);
+        else
+          vCorpus.push_back(1 + (i * i + i / 3) % (iSymbols - 1));
+      }
+      //score every third position; gaps between those scored by one thread
+      // then sometimes (with the 0s) span more than the context length
+      for (size_t i = 0; i < vCorpus.size(); i += 3) vPositions.push_back(i);
+    }
+
+  protected:
+    static const int iSymbols = 12;
+    static const int iNorm = 1 << 16;
+    CMockSettingsStore settings;
+    CSettingsUser root;
+    CPPMLanguageModel lm;
+    std::vector<symbol> vCorpus;
+    std::vector<size_t> vPositions;
+
+    ///Probability of each position, entering the whole corpus one symbol at a time
+    std::vector<unsigned int> SerialProbs() {
+      std::vector<unsigned int> vProbs, vDist;
+      CLanguageModel::Context ctx = lm.CreateEmptyContext();
+      size_t iEntered = 0;
+      for (size_t i = 0; i < vPositions.size(); i++) {
+        for (; iEntered < vPositions[i]; iEntered++) lm.EnterSymbol(ctx, vCorpus[iEntered]);
+        lm.GetProbs(ctx, vDist, iNorm, 0);
+        vProbs.push_back(vDist[vCorpus[vPositions[i]]]);
+      }
+      lm.ReleaseContext(ctx);
+      return vProbs;
+    }
+};
+
+/*
+ * Tests that GetSymbolProbs on one thread gives the same as a serial walk.
+ */
+TEST_F(BatchPredictionTest, SymbolProbsOneThread) {
+  std::vector<unsigned int> vProbs;
+  lm.GetSymbolProbs(vCorpus, vPositions, vProbs, iNorm, 0, 1);
+  ASSERT_TRUE(SerialProbs() == vProbs);
+}
+
+/*
+ * Tests that GetSymbolProbs split between several threads gives the same as
+ * a serial walk.
+ */
+TEST_F(BatchPredictionTest, SymbolProbsManyThreads) {
+  const std::vector<unsigned int> vSerial(SerialProbs());
+  for (unsigned int iThreads = 2; iThreads <= 7; iThreads++) {
+    std::vector<unsigned int> vProbs;
+    lm.GetSymbolProbs(vCorpus, vPositions, vProbs, iNorm, 0, iThreads);
+    ASSERT_TRUE(vSerial == vProbs) << iThreads << " threads";
+  }
+}
+
+/*
+ * Tests that GetProbsBatch gives the same distributions as entering each
+ * context in turn, on one thread or several.
+ */
+TEST_F(BatchPredictionTest, ProbsBatch) {
+  std::vector<std::vector<symbol> > vContexts;
+  for (size_t i = 0; i < 200; i++) {
+    const size_t iStart = (i * 37) % (vCorpus.size() - 20);
+    vContexts.push_back(std::vector<symbol>(vCorpus.begin() + iStart, vCorpus.begin() + iStart + i % 20));
+  }
+  std::vector<std::vector<unsigned int> > vSerial;
+  for (size_t i = 0; i < vContexts.size(); i++) {
+    CLanguageModel::Context ctx = lm.CreateEmptyContext();
+    for (size_t j = 0; j < vContexts[i].size(); j++) lm.EnterSymbol(ctx, vContexts[i][j]);
+    vSerial.push_back(std::vector<unsigned int>());
+    lm.GetProbs(ctx, vSerial.back(), iNorm, 0);
+    lm.ReleaseContext(ctx);
+  }
+  for (unsigned int iThreads = 1; iThreads <= 4; iThreads++) {
+    std::vector<std::vector<unsigned int> > vProbs;
+    lm.GetProbsBatch(vContexts, vProbs, iNorm, 0, iThreads);
+    ASSERT_TRUE(vSerial == vProbs) << iThreads << " threads";
+  }
+}
@@ -0,0 +1,195 @@
+#include "gtest/gtest.h"
+#include "../../Src/TestPlatform/MockSettingsStore.h"
+#include "../../Src/DasherCore/LanguageModelling/Epoch.h"
+#include "../../Src/DasherCore/LanguageModelling/PPMLanguageModel.h"
+#include <atomic>
+#include <numeric>
+#include <sstream>
+#include <thread>
+using namespace Dasher;
+
+static std::atomic<int> g_iFreed(0);
+static void CountFree(void *) {g_iFreed++;}
+
+//Holds a CReader on its own thread, from construction until Exit()
+class ReaderThread {
+  public:
+    ReaderThread() : m_bReading(false), m_bExit(false), m_thread(&ReaderThread::Run, this) {
+      while (!m_bReading) std::this_thread::yield();
+    }
+    void Exit() {
+      m_bExit = true;
+      m_thread.join();
+    }
+  private:
+    void Run() {
+      CEpoch::CReader reader;
+      m_bReading = true;
+      while (!m_bExit) std::this_thread::yield();
+    }
+    std::atomic<bool> m_bReading, m_bExit;
+    std::thread m_thread;
+};
+
+/*
+ * Tests that memory retired while a reader is active is not freed until
+ * that reader exits, but readers starting afterwards don't hold it up.
+ */
+TEST(ConcurrentLMTest, EpochKeepsRetiredUntilReaderExits) {
+  g_iFreed = 0;
+  CEpoch::CRetireList retired;
+  ReaderThread *pOld = new ReaderThread();
+  retired.Retire(NULL, CountFree);
+  ReaderThread *pNew = new ReaderThread();
+  retired.Reclaim();
+  ASSERT_EQ(0, g_iFreed);
+  pOld->Exit();
+  delete pOld;
+  retired.Reclaim();
+  ASSERT_EQ(1, g_iFreed);
+  pNew->Exit();
+  delete pNew;
+}
+
+/*
+ * Tests that nested CReaders on one thread hold retired memory until the
+ * outermost exits, and that the CRetireList frees anything left when destroyed.
+ */
+TEST(ConcurrentLMTest, EpochNestedReaders) {
+  g_iFreed = 0;
+  {
+    CEpoch::CRetireList retired;
+    std::atomic<int> iStage(0);
+    std::thread reader([&iStage]() {
+      CEpoch::CReader outer;
+      {
+        CEpoch::CReader inner;
+        iStage = 1;
+        while (iStage == 1) std::this_thread::yield();
+      }
+      //inner has exited, outer still reading
+      iStage = 3;
+      while (iStage == 3) std::this_thread::yield();
+    });
+    while (iStage != 1) std::this_thread::yield();
+    retired.Retire(NULL, CountFree);
+    iStage = 2;
+    while (iStage != 3) std::this_thread::yield();
+    retired.Reclaim();
+    ASSERT_EQ(0, g_iFreed);
+    retired.Retire(NULL, CountFree);
+    iStage = 4;
+    reader.join();
+    ASSERT_EQ(0, g_iFreed);
+  }
+  ASSERT_EQ(2, g_iFreed);
+}
+
+///Deterministic pseudo-random text over symbols 1..iSymbols-1, with some structure
+static std::vector<symbol> MakeText(size_t iLength, int iSymbols) {
+  std::vector<symbol> v;
+  unsigned int r = 12345;
+  while (v.size() < iLength) {
+    r = r * 1103515245 + 12345;
+    const int iWord = (r >> 16) % 50;
+    //each "word" is a short, fixed, run of symbols
+    for (int i = 0; i < 2 + iWord % 5; i++) v.push_back(1 + (iWord * 7 + i * 3) % (iSymbols - 1));
+  }
+  v.resize(iLength);
+  return v;
+}
+
+/*
+ * Tests that while one thread learns, others calling GetProbs always get a
+ * distribution summing to the normalization, and that the model learnt is
+ * the same as one trained with no readers.
+ */
+TEST(ConcurrentLMTest, ReadersDuringLearning) {
+  CMockSettingsStore settings;
+  CSettingsUser root(&settings);
+  const int iSymbols = 30;
+  const std::vector<symbol> vText(MakeText(200000, iSymbols));
+  CPPMLanguageModel lm(&root, iSymbols);
+  ASSERT_TRUE(lm.SupportsConcurrentReaders());
+
+  std::atomic<bool> bDone(false);
+  std::thread writer([&]() {
+    CLanguageModel::Context ctx = lm.CreateEmptyContext();
+    for (size_t i = 0; i < vText.size(); i += 1000) {
+      //as CTrainer, hold the writer lane a batch at a time
+      CLanguageModel::CWriter writer(&lm);
+      for (size_t j = i; j < std::min(i + 1000, vText.size()); j++) lm.LearnSymbol(ctx, vText[j]);
+    }
+    lm.ReleaseContext(ctx);
+    bDone = true;
+  });
+
+  const unsigned int iNorm = 1 << 16, iUniform = 1000;
+  const int iReaders = 4;
+  std::atomic<long> iCalls(0), iBad(0);
+  std::vector<std::thread> vReaders;
+  for (int t = 0; t < iReaders; t++)
+    vReaders.push_back(std::thread([&, t]() {
+      std::vector<unsigned int> vProbs;
+      size_t iPos = t * 997;
+      do {
+        //predict following a few symbols of the text, as the user might write
+        CLanguageModel::Context ctx = lm.CreateEmptyContext();
+        for (int j = 0; j < 8; j++) {
+          lm.EnterSymbol(ctx, vText[(iPos + j) % vText.size()]);
+          lm.GetProbs(ctx, vProbs, iNorm, iUniform);
+          if (std::accumulate(vProbs.begin(), vProbs.end(), 0u) != iNorm || vProbs[0] != 0) iBad++;
+          iCalls++;
+        }
+        lm.ReleaseContext(ctx);
+        iPos += 7919;
+      } while (!bDone);
+    }));
+  writer.join();
+  for (int t = 0; t < iReaders; t++) vReaders[t].join();
+  ASSERT_EQ(0, iBad);
+  ASSERT_LT(0, iCalls);
+
+  CPPMLanguageModel serial(&root, iSymbols);
+  {
+    CLanguageModel::CWriter writer(&serial);
+    CLanguageModel::Context ctx = serial.CreateEmptyContext();
+    for (size_t i = 0; i < vText.size(); i++) serial.LearnSymbol(ctx, vText[i]);
+    serial.ReleaseContext(ctx);
+  }
+  ASSERT_TRUE(lm.eq(&serial));
+  ASSERT_TRUE(serial.eq(&lm));
+}
+
+/*
+ * Tests that a model written while it is learning can be read back, i.e.
+ * WriteToStream takes a consistent snapshot.
+ */
+TEST(ConcurrentLMTest, WriteDuringLearning) {
+  CMockSettingsStore settings;
+  CSettingsUser root(&settings);
+  const int iSymbols = 30;
+  const std::vector<symbol> vText(MakeText(100000, iSymbols));
+  CPPMLanguageModel lm(&root, iSymbols);
+
+  std::atomic<bool> bDone(false);
+  std::thread writer([&]() {
+    CLanguageModel::Context ctx = lm.CreateEmptyContext();
+    for (size_t i = 0; i < vText.size(); i += 100) {
+      CLanguageModel::CWriter writer(&lm);
+      for (size_t j = i; j < std::min(i + 100, vText.size()); j++) lm.LearnSymbol(ctx, vText[j]);
+    }
+    lm.ReleaseContext(ctx);
+    bDone = true;
+  });
+  int iSnapshots = 0;
+  do {
+    std::stringstream s;
+    ASSERT_TRUE(lm.WriteToStream(s));
+    CPPMLanguageModel copy(&root, iSymbols);
+    ASSERT_TRUE(copy.ReadFromStream(s));
+    iSnapshots++;
+  } while (!bDone);
+  writer.join();
+  ASSERT_LT(0, iSnapshots);
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+#include "../../Src/DasherCore/Observable.h"
+
+//Records the batches it receives, and optionally unregisters (and/or
+// registers) another BatchObserver when it receives one.
+class RecordingObserver : public BatchObserver<int> {
+  public:
+    RecordingObserver(BatchedObservable<int> *pObservable)
+    : m_pObservable(pObservable), m_pToRemove(NULL), m_pToAdd(NULL) {
+    }
+
+    virtual void HandleEvents(const std::vector<int> &vEvents) {
+      batches.push_back(vEvents);
+      if (m_pToRemove) m_pObservable->UnregisterBatched(m_pToRemove);
+      if (m_pToAdd) m_pObservable->RegisterBatched(m_pToAdd);
+    }
+
+    std::vector<std::vector<int> > batches;
+    BatchedObservable<int> *m_pObservable;
+    BatchObserver<int> *m_pToRemove, *m_pToAdd;
+};
+
+/*
+ * Tests that events are queued, in order, until flushed.
+ */
+TEST(ObservableTest, FlushDeliversQueuedEvents) {
+  BatchedObservable<int> observable;
+  RecordingObserver a(&observable);
+  observable.RegisterBatched(&a);
+  observable.DispatchEvent(1);
+  observable.DispatchEvent(2);
+  ASSERT_TRUE(a.batches.empty());
+  observable.FlushEvents();
+  ASSERT_EQ(1u, a.batches.size());
+  ASSERT_TRUE(std::vector<int>({1, 2}) == a.batches[0]);
+  observable.FlushEvents();
+  ASSERT_EQ(1u, a.batches.size());
+}
+
+/*
+ * Tests that a BatchObserver unregistered by an earlier one during a flush
+ * is not called (so may safely be deleted by it).
+ */
+TEST(ObservableTest, UnregisterDuringFlush) {
+  BatchedObservable<int> observable;
+  RecordingObserver a(&observable), b(&observable);
+  observable.RegisterBatched(&a);
+  observable.RegisterBatched(&b);
+  a.m_pToRemove = &b;
+  observable.DispatchEvent(1);
+  observable.FlushEvents();
+  ASSERT_EQ(1u, a.batches.size());
+  ASSERT_TRUE(b.batches.empty());
+  a.m_pToRemove = NULL;
+  observable.DispatchEvent(2);
+  observable.FlushEvents();
+  ASSERT_EQ(2u, a.batches.size());
+  ASSERT_TRUE(b.batches.empty());
+}
+
+/*
+ * Tests that a BatchObserver registered during a flush only receives
+ * later batches.
+ */
+TEST(ObservableTest, RegisterDuringFlush) {
+  BatchedObservable<int> observable;
+  RecordingObserver a(&observable), b(&observable);
+  observable.RegisterBatched(&a);
+  a.m_pToAdd = &b;
+  observable.DispatchEvent(1);
+  observable.FlushEvents();
+  ASSERT_TRUE(b.batches.empty());
+  observable.DispatchEvent(2);
+  observable.FlushEvents();
+  ASSERT_EQ(1u, b.batches.size());
+  ASSERT_TRUE(std::vector<int>(1, 2) == b.batches[0]);
+}
@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "../../Src/DasherCore/OutputQueue.h"
+using namespace Dasher;
+
+/*
+ * Tests that a new queue has nothing to send, and that Clear empties it.
+ */
+TEST(OutputQueueTest, EmptyAndClear) {
+  COutputQueue queue;
+  ASSERT_TRUE(queue.IsEmpty());
+  queue.Delete("a");
+  queue.Output("bc");
+  ASSERT_FALSE(queue.IsEmpty());
+  queue.Clear();
+  ASSERT_TRUE(queue.IsEmpty());
+  ASSERT_EQ(0u, queue.GetDeletes());
+  ASSERT_EQ("", queue.GetOutput());
+}
+
+/*
+ * Tests that output is queued in order, and deleting it again just removes
+ * it from the queue, so nothing is sent.
+ */
+TEST(OutputQueueTest, DeleteCancelsQueuedOutput) {
+  COutputQueue queue;
+  queue.Output("ab");
+  queue.Output("c");
+  ASSERT_EQ("abc", queue.GetOutput());
+  queue.Delete("c");
+  ASSERT_EQ("ab", queue.GetOutput());
+  queue.Delete("ab");
+  ASSERT_TRUE(queue.IsEmpty());
+}
+
+/*
+ * Tests that deleting text output before the queue began counts characters,
+ * not bytes, of UTF-8 text.
+ */
+TEST(OutputQueueTest, DeletesCountUTF8Characters) {
+  COutputQueue queue;
+  queue.Delete("x");
+  queue.Delete("\xc3\xa9");       // U+00E9, 2 bytes
+  queue.Delete("\xe2\x82\xac");   // U+20AC, 3 bytes
+  queue.Delete("\xf0\x9f\x98\x80"); // U+1F600, 4 bytes
+  ASSERT_EQ(4u, queue.GetDeletes());
+  ASSERT_EQ("", queue.GetOutput());
+}
+
+/*
+ * Tests that a deletion reaching past the queued output removes all of that
+ * and deletes only the rest from before the cursor.
+ */
+TEST(OutputQueueTest, DeletePastQueuedOutput) {
+  COutputQueue queue;
+  queue.Output("\xc3\xa9" "b");
+  queue.Delete("a\xc3\xa9" "b");
+  ASSERT_EQ(1u, queue.GetDeletes());
+  ASSERT_EQ("", queue.GetOutput());
+}
+
+/*
+ * Tests that output queued after a deletion is sent after it, i.e. the
+ * deletes are always applied first.
+ */
+TEST(OutputQueueTest, DeletesBeforeOutput) {
+  COutputQueue queue;
+  queue.Output("a");
+  queue.Delete("za");
+  queue.Output("bc");
+  queue.Delete("c");
+  queue.Output("d");
+  ASSERT_EQ(1u, queue.GetDeletes());
+  ASSERT_EQ("bd", queue.GetOutput());
+}
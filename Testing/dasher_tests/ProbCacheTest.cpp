@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "../../Src/TestPlatform/MockSettingsStore.h"
+#include "../../Src/DasherCore/ProbCache.h"
+#include "../../Src/DasherCore/LanguageModelling/PPMLanguageModel.h"
+using namespace Dasher;
+
+static CProbCache::Probs Table(unsigned int i) {
+  return CProbCache::Probs(new std::vector<unsigned int>(1, i));
+}
+
+/*
+ * Tests that beyond its capacity the cache forgets the least recently used
+ * table, where Find and Add (even of an existing key) count as uses.
+ */
+TEST(ProbCacheTest, EvictsLeastRecentlyUsed) {
+  CProbCache cache(3);
+  const std::vector<symbol> a(1, 1), b(1, 2), c(1, 3), d(1, 4);
+  cache.Add(0, a, Table(1));
+  cache.Add(0, b, Table(2));
+  cache.Add(0, c, Table(3));
+  ASSERT_TRUE(cache.Find(0, a) != NULL); // b is now least recently used
+  cache.Add(0, d, Table(4));
+  ASSERT_TRUE(cache.Find(0, b) == NULL);
+  ASSERT_EQ(1u, (*cache.Find(0, a))[0]);
+  ASSERT_EQ(3u, (*cache.Find(0, c))[0]);
+  ASSERT_EQ(4u, (*cache.Find(0, d))[0]);
+
+  //replacing doesn't grow the cache; c is now least recently used
+  cache.Add(0, a, Table(5));
+  ASSERT_EQ(5u, (*cache.Find(0, a))[0]);
+  cache.Add(1, a, Table(6)); // same symbols, different offset
+  ASSERT_TRUE(cache.Find(0, c) == NULL);
+  ASSERT_EQ(6u, (*cache.Find(1, a))[0]);
+  ASSERT_EQ(5u, (*cache.Find(0, a))[0]);
+
+  cache.Clear();
+  ASSERT_TRUE(cache.Find(0, a) == NULL);
+  ASSERT_TRUE(cache.Find(1, a) == NULL);
+}
+
+/*
+ * Tests that a table found in the cache is the one added, and the same as
+ * the language model would give for a context rebuilt from the key.
+ */
+TEST(ProbCacheTest, HitMatchesFreshGetProbs) {
+  CMockSettingsStore settings;
+  CSettingsUser root(&settings);
+  const int iSymbols = 5;
+  CPPMLanguageModel lm(&root, iSymbols);
+  {
+    CLanguageModel::CWriter writer(&lm);
+    CLanguageModel::Context ctx = lm.CreateEmptyContext();
+    const int text[] = {1, 2, 3, 1, 2, 4, 1, 2, 3, 3, 2, 1, 5, 1, 2, 3};
+    for (size_t i = 0; i < sizeof(text)/sizeof(text[0]); i++) lm.LearnSymbol(ctx, text[i]);
+    lm.ReleaseContext(ctx);
+  }
+  const unsigned int iNorm = 1 << 16;
+  CProbCache cache;
+  std::vector<std::vector<symbol> > vKeys;
+  for (symbol s = 1; s <= iSymbols; s++)
+    for (symbol t = 1; t <= iSymbols; t++)
+      vKeys.push_back(std::vector<symbol>({s, t}));
+  std::vector<CProbCache::Probs> vAdded;
+  for (size_t i = 0; i < vKeys.size(); i++) {
+    CLanguageModel::Context ctx = lm.CreateEmptyContext();
+    for (size_t j = 0; j < vKeys[i].size(); j++) lm.EnterSymbol(ctx, vKeys[i][j]);
+    std::vector<unsigned int> *pProbs = new std::vector<unsigned int>();
+    lm.GetProbs(ctx, *pProbs, iNorm, 0);
+    lm.ReleaseContext(ctx);
+    vAdded.push_back(CProbCache::Probs(pProbs));
+    cache.Add(2, vKeys[i], vAdded.back());
+  }
+  for (size_t i = 0; i < vKeys.size(); i++) {
+    CProbCache::Probs pHit(cache.Find(2, vKeys[i]));
+    ASSERT_TRUE(pHit == vAdded[i]);
+    CLanguageModel::Context ctx = lm.CreateEmptyContext();
+    for (size_t j = 0; j < vKeys[i].size(); j++) lm.EnterSymbol(ctx, vKeys[i][j]);
+    std::vector<unsigned int> vFresh;
+    lm.GetProbs(ctx, vFresh, iNorm, 0);
+    lm.ReleaseContext(ctx);
+    ASSERT_TRUE(vFresh == *pHit);
+  }
+}
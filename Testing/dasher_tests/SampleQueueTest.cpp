@@ -0,0 +1,103 @@
+#include "gtest/gtest.h"
+#include "../../Src/DasherCore/SampleQueue.h"
+#include <thread>
+using namespace Dasher;
+
+/*
+ * Tests popping from an empty queue, and that the capacity is rounded up
+ * to a power of two, beyond which pushes are dropped and counted.
+ */
+TEST(SampleQueueTest, EmptyAndFull) {
+  CSampleQueue<int> queue(3);
+  int i = -1;
+  ASSERT_FALSE(queue.Pop(i));
+  ASSERT_EQ(-1, i);
+  for (int j = 0; j < 4; j++) ASSERT_TRUE(queue.Push(j));
+  ASSERT_FALSE(queue.Push(4));
+  ASSERT_FALSE(queue.Push(5));
+  ASSERT_EQ(2ul, queue.TakeDropped());
+  ASSERT_EQ(0ul, queue.TakeDropped());
+  for (int j = 0; j < 4; j++) {
+    ASSERT_TRUE(queue.Pop(i));
+    ASSERT_EQ(j, i);
+  }
+  ASSERT_FALSE(queue.Pop(i));
+}
+
+/*
+ * Tests that samples come out in order as the slots are reused many times.
+ */
+TEST(SampleQueueTest, Wraparound) {
+  CSampleQueue<int> queue(4);
+  int iNext = 0, i;
+  for (int j = 0; j < 100; j++) {
+    //leave the queue partly full each time, so head and tail wrap at different times
+    ASSERT_TRUE(queue.Push(2*j));
+    ASSERT_TRUE(queue.Push(2*j+1));
+    ASSERT_TRUE(queue.Pop(i));
+    ASSERT_EQ(iNext++, i);
+    if (j % 2) {
+      ASSERT_TRUE(queue.Pop(i));
+      ASSERT_EQ(iNext++, i);
+    }
+    if (j % 4 == 3) {
+      while (queue.Pop(i)) ASSERT_EQ(iNext++, i);
+    }
+  }
+  while (queue.Pop(i)) ASSERT_EQ(iNext++, i);
+  ASSERT_EQ(200, iNext);
+  ASSERT_EQ(0ul, queue.TakeDropped());
+}
+
+/*
+ * Tests a producer and a consumer thread: a producer that retries when the
+ * queue is full gets every sample through, exactly once and in order.
+ */
+TEST(SampleQueueTest, ProducerConsumer) {
+  const int N = 1000000;
+  CSampleQueue<int> queue(64);
+  std::thread producer([&queue, N]() {
+    for (int j = 0; j < N; j++)
+      while (!queue.Push(j)) std::this_thread::yield();
+  });
+  int iNext = 0, i;
+  bool bInOrder = true;
+  while (iNext < N) {
+    if (queue.Pop(i)) {
+      if (i != iNext) bInOrder = false;
+      iNext++;
+    } else std::this_thread::yield();
+  }
+  producer.join();
+  ASSERT_TRUE(bInOrder);
+  ASSERT_FALSE(queue.Pop(i));
+}
+
+/*
+ * Tests that when a producer doesn't retry, samples that arrive do so once
+ * and in order, and all others are counted as dropped.
+ */
+TEST(SampleQueueTest, ProducerConsumerDropping) {
+  const int N = 1000000;
+  CSampleQueue<int> queue(16);
+  std::atomic<bool> bDone(false);
+  std::thread producer([&queue, &bDone, N]() {
+    for (int j = 0; j < N; j++) queue.Push(j);
+    bDone = true;
+  });
+  int iLast = -1, iReceived = 0, i;
+  bool bInOrder = true;
+  for (;;) {
+    const bool bFinished(bDone);
+    while (queue.Pop(i)) {
+      if (i <= iLast) bInOrder = false;
+      iLast = i;
+      iReceived++;
+    }
+    if (bFinished) break;
+    std::this_thread::yield();
+  }
+  producer.join();
+  ASSERT_TRUE(bInOrder);
+  ASSERT_EQ((unsigned long) N, iReceived + queue.TakeDropped());
+}
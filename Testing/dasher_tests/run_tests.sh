@@ -2,3 +2,9 @@
 
 ./EventTest
 ./WordGenTest
+./OutputQueueTest
+./ObservableTest
+./SampleQueueTest
+./ProbCacheTest
+./ConcurrentLMTest
+./BatchPredictionTest